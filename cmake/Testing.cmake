@@ -6,8 +6,41 @@ set(
     TEST_SOURCE
 
     ${SRC_DIR}/testing/ExampleUnitTests.cpp
+    ${SRC_DIR}/testing/ConnectedNetTests.cpp
+    ${SRC_DIR}/testing/ArenaTests.cpp
+    ${SRC_DIR}/testing/GemmTests.cpp
+    ${SRC_DIR}/testing/SoftmaxTests.cpp
+    ${SRC_DIR}/testing/LookupTableTests.cpp
+    ${SRC_DIR}/testing/ThresholdClassifierTests.cpp
+    ${SRC_DIR}/testing/MultiTrainerTests.cpp
+    ${SRC_DIR}/testing/HyperSearchTests.cpp
+    ${SRC_DIR}/testing/SampleQueueTests.cpp
+    ${SRC_DIR}/testing/ValidatorTests.cpp
+    ${SRC_DIR}/testing/SparseNetTests.cpp
+    ${SRC_DIR}/testing/ConvNetTests.cpp
+    ${SRC_DIR}/testing/SceneTests.cpp
+    ${SRC_DIR}/helpers/Scene.cpp
+    ${SRC_DIR}/helpers/Intersections.cpp
+    ${SRC_DIR}/testing/LatencyTests.cpp
+    ${SRC_DIR}/server/Latency.cpp
     )
 
+# the servers only build on Unix (as does the test that
+# compiles an exported header with a shell command)
+if ( UNIX )
+
+  list(
+       APPEND TEST_SOURCE
+       ${SRC_DIR}/testing/HeaderExporterTests.cpp
+       ${SRC_DIR}/testing/InferenceServerTests.cpp
+       ${SRC_DIR}/testing/ParameterServerTests.cpp
+       ${SRC_DIR}/server/InferenceServer.cpp
+       ${SRC_DIR}/server/ParameterServer.cpp
+       ${SRC_DIR}/server/Socket.cpp
+       )
+
+endif( UNIX )
+
 
 ####################################################
 # Download and unpack googletest at configure time
@@ -50,6 +83,13 @@ target_link_libraries     ( ${TEST_NAME}        ${NET_LIBRARY} gmock gmock_main
 add_dependencies          ( ${TEST_NAME}        ${NET_LIBRARY} gmock gmock_main                 )
 set_property              ( TARGET ${TEST_NAME} PROPERTY CXX_STANDARD 14                        )
 
+if ( UNIX )
+  target_compile_definitions( ${TEST_NAME} PRIVATE NET_TEST_CXX="${CMAKE_CXX_COMPILER}" )
+endif( UNIX )
+
+enable_testing( )
+add_test( NAME ${TEST_NAME} COMMAND ${TEST_NAME} )
+
 if ( INTENSE_FLAGS )
   set_target_properties( ${EXEC_NAME} PROPERTIES COMPILE_FLAGS ${INTENSE_FLAGS} )
 endif( )
@@ -59,6 +59,12 @@ public:
   ////////////////////////////////////////////////////////////////////
   virtual bool onUserLoop ( const std::string &line ) final;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief tableAxes
+  /// \return every input is 0 or 1
+  ////////////////////////////////////////////////////////////////////
+  virtual std::vector< net::TableAxis > tableAxes ( unsigned gridPoints ) const final;
+
 };
 
 
@@ -170,18 +176,36 @@ AdditionApp::onUserLoop( const std::string &line )
 
 
 
+////////////////////////////////////////////////////////////////////
+/// \brief AdditionApp::tableAxes
+////////////////////////////////////////////////////////////////////
+std::vector< net::TableAxis >
+AdditionApp::tableAxes( unsigned ) const
+{
+
+  // the inputs are binary, so the table is the net exactly
+  return std::vector< net::TableAxis >( 4, net::TableAxis::discrete( { 0.0, 1.0 } ) );
+
+}
+
+
+
 ////////////////////////////////////////////////////////////////////
 /// \brief main
 /// \return
 ////////////////////////////////////////////////////////////////////
 int
-main( )
+main(
+     int    argc,
+     char **argv
+     )
 {
 
   try
   {
 
     AdditionApp app;
+    app.configure( AppOptions::parse( argc, argv ) );
     app.run( );
 
   }
@@ -1,5 +1,8 @@
 // XOR.cpp
 #include "App.hpp"
+#include "HyperSearch.hpp"
+#include "SamplePipeline.hpp"
+#include "HeaderExporter.hpp"
 
 #include <iostream>
 #include <vector>
@@ -12,6 +15,487 @@
 #include <stdexcept>
 #include <chrono>
 #include <string>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+#include <regex>
+
+
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////
+/// \brief precisionName
+/// \return --precision value naming a precision
+////////////////////////////////////////////////////////////////////
+const char *
+precisionName( net::Precision precision )
+{
+
+  switch ( precision )
+  {
+
+  case net::Precision::BFloat16:
+    return "bf16";
+
+  case net::Precision::Half:
+    return "fp16";
+
+  default:
+    return "double";
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief csvField
+/// \return value quoted per RFC 4180 when it holds a separator,
+///         quote or line break
+////////////////////////////////////////////////////////////////////
+std::string
+csvField( const std::string &value )
+{
+
+  if ( value.find_first_of( ",\"\r\n" ) == std::string::npos )
+  {
+
+    return value;
+
+  }
+
+  std::string field = "\"";
+
+  for ( char c : value )
+  {
+
+    field += ( c == '"' ? "\"\"" : std::string( 1, c ) );
+
+  }
+
+  return field + "\"";
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief jsonString
+/// \return value as a quoted and escaped JSON string
+////////////////////////////////////////////////////////////////////
+std::string
+jsonString( const std::string &value )
+{
+
+  std::ostringstream stream;
+
+  stream << '"';
+
+  for ( char c : value )
+  {
+
+    switch ( c )
+    {
+
+    case '"':
+      stream << "\\\"";
+      break;
+
+    case '\\':
+      stream << "\\\\";
+      break;
+
+    case '\n':
+      stream << "\\n";
+      break;
+
+    case '\r':
+      stream << "\\r";
+      break;
+
+    case '\t':
+      stream << "\\t";
+      break;
+
+    default:
+
+      if ( static_cast< unsigned char >( c ) < 0x20 )
+      {
+
+        stream << "\\u" << std::hex << std::setw( 4 ) << std::setfill( '0' )
+               << static_cast< unsigned >( c ) << std::dec << std::setfill( ' ' );
+
+      }
+      else
+      {
+
+        stream << c;
+
+      }
+
+      break;
+
+    } // switch
+
+  }
+
+  stream << '"';
+
+  return stream.str( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief isJsonNumber
+/// \return whether value is a number in JSON syntax (so not empty,
+///         inf or nan)
+////////////////////////////////////////////////////////////////////
+bool
+isJsonNumber( const std::string &value )
+{
+
+  static const std::regex number( "-?(0|[1-9][0-9]*)(\\.[0-9]+)?([eE][+-]?[0-9]+)?" );
+
+  return std::regex_match( value, number );
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief AppOptions::parse
+////////////////////////////////////////////////////////////////////
+AppOptions
+AppOptions::parse(
+                  int    argc,
+                  char **argv,
+                  int    firstArg
+                  )
+{
+
+  AppOptions options;
+
+  if ( argc > 0 )
+  {
+
+    options.name = argv[ 0 ];
+    options.name = options.name.substr( options.name.find_last_of( "/\\" ) + 1 );
+
+  }
+
+  for ( int i = firstArg; i < argc; ++i )
+  {
+
+    std::string arg = argv[ i ];
+
+    auto value = [ & ]( )
+    {
+
+      if ( i + 1 >= argc )
+      {
+
+        throw std::runtime_error( "Missing value for " + arg + "\n" + usage( ) );
+
+      }
+
+      return std::string( argv[ ++i ] );
+
+    };
+
+    try
+    {
+
+      if ( arg == "--help" || arg == "-h" )
+      {
+
+        std::cout << usage( );
+        std::exit( EXIT_SUCCESS );
+
+      }
+      else if ( arg == "--benchmark" )
+      {
+
+        options.headless = true;
+
+      }
+      else if ( arg == "--seed" )
+      {
+
+        options.seed    = static_cast< unsigned >( std::stoul( value( ) ) );
+        options.hasSeed = true;
+
+      }
+      else if ( arg == "--threads" )
+      {
+
+        options.numThreads = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--iterations" )
+      {
+
+        options.maxIterations = std::stoul( value( ) );
+
+      }
+      else if ( arg == "--error" )
+      {
+
+        options.targetError = std::stod( value( ) );
+
+      }
+      else if ( arg == "--samples" )
+      {
+
+        options.numSamples = std::stoul( value( ) );
+
+      }
+      else if ( arg == "--search" )
+      {
+
+        options.numCandidates = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--precision" )
+      {
+
+        std::string precision = value( );
+
+        if ( precision == "double" )
+        {
+
+          options.precision = net::Precision::Double;
+
+        }
+        else if ( precision == "bf16" )
+        {
+
+          options.precision = net::Precision::BFloat16;
+
+        }
+        else if ( precision == "fp16" )
+        {
+
+          options.precision = net::Precision::Half;
+
+        }
+        else
+        {
+
+          throw std::runtime_error( "Unknown precision '" + precision + "'\n" + usage( ) );
+
+        }
+
+      }
+      else if ( arg == "--pipeline" )
+      {
+
+        options.pipelineSlots = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--perf" )
+      {
+
+        options.perfCounters = true;
+
+      }
+      else if ( arg == "--validate" )
+      {
+
+        options.validateSamples = std::stoul( value( ) );
+
+      }
+      else if ( arg == "--validate-every" )
+      {
+
+        options.validateEvery = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--validate-accuracy" )
+      {
+
+        options.validateAccuracy = std::stod( value( ) );
+
+      }
+      else if ( arg == "--save" )
+      {
+
+        options.savePath = value( );
+
+      }
+      else if ( arg == "--export-header" )
+      {
+
+        options.headerPath = value( );
+
+      }
+      else if ( arg == "--table" )
+      {
+
+        options.tablePoints = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--ps-serve" )
+      {
+
+        options.psServe = value( );
+
+      }
+      else if ( arg == "--ps-worker" )
+      {
+
+        options.psWorker = value( );
+
+      }
+      else if ( arg == "--ps-workers" )
+      {
+
+        options.psWorkers = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--ps-staleness" )
+      {
+
+        options.psStaleness = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--ps-steps" )
+      {
+
+        options.psSteps = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--ps-timeout" )
+      {
+
+        options.psTimeout = std::stod( value( ) );
+
+      }
+      else if ( arg == "--format" )
+      {
+
+        std::string format = value( );
+
+        if ( format == "text" )
+        {
+
+          options.format = Format::Text;
+
+        }
+        else if ( format == "json" )
+        {
+
+          options.format = Format::Json;
+
+        }
+        else if ( format == "csv" )
+        {
+
+          options.format = Format::Csv;
+
+        }
+        else
+        {
+
+          throw std::runtime_error( "Unknown format '" + format + "'\n" + usage( ) );
+
+        }
+
+        // a report format only makes sense without the user loop
+        options.headless = true;
+
+      }
+      else
+      {
+
+        throw std::runtime_error( "Unknown option '" + arg + "'\n" + usage( ) );
+
+      }
+
+    }
+    catch ( const std::logic_error & )
+    {
+
+      // std::stoul and friends
+      throw std::runtime_error( "Invalid value for " + arg + "\n" + usage( ) );
+
+    }
+
+  }
+
+  if ( !options.psServe.empty( ) && !options.psWorker.empty( ) )
+  {
+
+    throw std::runtime_error( "A process can't be both parameter server and worker\n" + usage( ) );
+
+  }
+
+  // (a worker's shard is seeded once it knows its rank, and its net comes from the server)
+  if ( !options.psWorker.empty( ) && ( options.pipelineSlots > 0 || options.numCandidates > 0 ) )
+  {
+
+    throw std::runtime_error( "--pipeline and --search can't be used by a parameter server worker\n" + usage( ) );
+
+  }
+
+  // (the workers train outside trainNet, which drives the validation)
+  if ( options.validateSamples > 0 && ( !options.psServe.empty( ) || !options.psWorker.empty( ) ) )
+  {
+
+    throw std::runtime_error( "--validate can't be used with parameter server training\n" + usage( ) );
+
+  }
+
+  return options;
+
+} // AppOptions::parse
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief AppOptions::usage
+////////////////////////////////////////////////////////////////////
+std::string
+AppOptions::usage( )
+{
+
+  return "Options:\n"
+         "  --benchmark           train, evaluate and print a report (no user loop)\n"
+         "  --format <fmt>        report format: text, json or csv (implies --benchmark)\n"
+         "  --seed <n>            seed for the initial weights and random samples\n"
+         "  --threads <n>         evaluation threads (default: one per core)\n"
+         "  --iterations <n>      training iteration limit (default: none)\n"
+         "  --error <e>           acceptable training error (default: 1e-4)\n"
+         "  --samples <n>         random samples evaluated after training (default: 100000)\n"
+         "  --search <n>          pick rate, momentum and hidden sizes from n candidates first\n"
+         "  --precision <p>       training weights: double, bf16 or fp16 (default: double)\n"
+         "  --pipeline <n>        generate up to n training samples ahead on another thread\n"
+         "  --perf                report hardware counters per training phase (Linux)\n"
+         "  --validate <n>        hold out n samples, evaluated in the background while training\n"
+         "  --validate-every <n>  training iterations between validation snapshots (default: 10000)\n"
+         "  --validate-accuracy <a> stop training once the held-out accuracy reaches a\n"
+         "  --save <path>         write the trained model to a file (see netServer)\n"
+         "  --export-header <path> write the trained model as a standalone C++ header\n"
+         "  --table <n>           also evaluate through a lookup table of the trained net\n"
+         "                        (n grid points per continuous input) and report its error\n"
+         "  --ps-serve <addr>     hold the weights for --ps-worker processes training them\n"
+         "                        (addr: tcp:<host>:<port>, unix:<path> or a socket path)\n"
+         "  --ps-workers <n>      workers the parameter server waits for (default: 1)\n"
+         "  --ps-worker <addr>    train a shard for the parameter server at addr\n"
+         "  --ps-staleness <n>    drop pushes more than n updates behind (default: 4)\n"
+         "  --ps-steps <n>        samples a worker trains between pushes (default: 32)\n"
+         "  --ps-timeout <s>      seconds the parameter server waits for each worker to\n"
+         "                        connect (default: 60, 0 waits forever)\n"
+         "  --help                show this message\n";
+
+}
 
 
 ////////////////////////////////////////////////////////////////////
@@ -21,15 +505,50 @@ App::App(
          const std::vector< unsigned > &netTopology,
          double                         errorSmoothing
          )
-  : upNet_      ( new net::ConnectedNet( netTopology, errorSmoothing ) ) // will throw error if topology is empty
-  , gen_        ( static_cast< unsigned >( std::chrono::high_resolution_clock::now( ).
-                                          time_since_epoch( ).count( ) ) )
-  , dist_       ( 0, std::numeric_limits< unsigned >::max( ) )
-  , inputVals_  ( netTopology.front( ) )
-  , targetVals_ ( netTopology.back( ) )
+  : netTopology_      ( netTopology )
+  , errorSmoothing_   ( errorSmoothing )
+  , upNet_            ( new net::ConnectedNet( netTopology, errorSmoothing ) ) // will throw error if topology is empty
+  , validation_       ( net::ValidationReport{ 0, 0.0, 0.0 } )
+  , validationStopped_( false )
+  , gen_              ( static_cast< unsigned >( std::chrono::high_resolution_clock::now( ).
+                                                time_since_epoch( ).count( ) ) )
+  , dist_             ( 0, std::numeric_limits< unsigned >::max( ) )
+  , inputVals_        ( netTopology.front( ) )
+  , targetVals_       ( netTopology.back( ) )
 {}
 
 
+////////////////////////////////////////////////////////////////////
+/// \brief App::configure
+////////////////////////////////////////////////////////////////////
+void
+App::configure( const AppOptions &options )
+{
+
+  options_ = options;
+
+  if ( !options_.hasSeed )
+  {
+
+    options_.seed = static_cast< unsigned >( std::chrono::high_resolution_clock::now( ).
+                                             time_since_epoch( ).count( ) );
+
+  }
+
+  //
+  // reseed everything random so the seed reproduces the run
+  //
+  gen_.seed( options_.seed );
+  dist_.reset( );
+
+  net::ConnectedNet::seedWeights( options_.seed );
+  upNet_.reset( new net::ConnectedNet( netTopology_, errorSmoothing_ ) );
+  upNet_->setPrecision( options_.precision );
+
+} // App::configure
+
+
+
 ////////////////////////////////////////////////////////////////////
 /// \brief App::run
 ////////////////////////////////////////////////////////////////////
@@ -37,17 +556,23 @@ void
 App::run( )
 {
 
-  upNet_->trainNet(
-                   std::bind( &App::inputFunction,  this ),
-                   std::bind( &App::targetFunction, this ),
-                   1.0e-4,
-                   10000
-                   );
+  if ( !options_.psWorker.empty( ) )
+  {
 
-  std::cout << std::endl;
-  std::cout << "Done training (Error: ";
-  std::cout << upNet_->getAverageError( ) << ")" << std::endl;
-  std::cout << std::endl;
+    train( ); // the server evaluates the trained net
+    return;
+
+  }
+
+  if ( options_.headless )
+  {
+
+    benchmark( );
+    return;
+
+  }
+
+  train( );
 
   std::cout << "Results: " << std::endl;
   std::cout << std::endl;
@@ -61,3 +586,624 @@ App::run( )
   while ( onUserLoop( line ) && std::getline( std::cin, line ) );
 
 } // App::run
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief App::train
+////////////////////////////////////////////////////////////////////
+unsigned long
+App::train( )
+{
+
+  unsigned long iterations = 0;
+
+  if ( options_.numCandidates > 0 )
+  {
+
+    iterations += search( options_.numCandidates );
+
+  }
+
+  net::TrainFun inputFun  = std::bind( &App::inputFunction,  this );
+  net::TrainFun targetFun = std::bind( &App::targetFunction, this );
+
+  //
+  // optional held-out set, drawn before a pipeline takes over the
+  // generator functions
+  //
+  std::unique_ptr< net::Validator > upValidator;
+
+  if ( options_.validateSamples > 0 )
+  {
+
+    std::vector< std::vector< double > > inputs;
+    std::vector< std::vector< double > > targets;
+
+    for ( unsigned long i = 0; i < options_.validateSamples; ++i )
+    {
+
+      inputs.push_back ( inputFunction( )  );
+      targets.push_back( targetFunction( ) );
+
+    }
+
+    upValidator.reset( new net::Validator( std::move( inputs ), std::move( targets ),
+                                           options_.validateEvery, options_.numThreads ) );
+    upValidator->setStopAccuracy( options_.validateAccuracy );
+
+  }
+
+  //
+  // optionally generate samples on another thread (the app's
+  // generator functions are only called from that thread until
+  // the pipeline stops)
+  //
+  std::unique_ptr< net::SamplePipeline > upPipeline;
+
+  if ( options_.pipelineSlots > 0 )
+  {
+
+    upPipeline.reset( new net::SamplePipeline( inputFun, targetFun, options_.pipelineSlots ) );
+
+    inputFun  = upPipeline->getInputFun( );
+    targetFun = upPipeline->getTargetFun( );
+
+  }
+
+  upNet_->setPerfCounters( options_.perfCounters );
+
+  if ( !options_.psServe.empty( ) || !options_.psWorker.empty( ) )
+  {
+
+    iterations += trainDistributed( inputFun, targetFun );
+
+  }
+  else
+  {
+
+    iterations += upNet_->trainNet(
+                                   inputFun,
+                                   targetFun,
+                                   options_.targetError,
+                                   ( options_.headless ? 0 : 10000 ),
+                                   upValidator.get( ),
+                                   options_.maxIterations
+                                   );
+
+  }
+
+  if ( upValidator )
+  {
+
+    upValidator->wait( );
+
+    validationStopped_ = upValidator->shouldStop( );
+
+    upNet_->prepareBatch( );
+    validation_ = upValidator->evaluate( *upNet_ );
+
+  }
+
+  if ( upPipeline )
+  {
+
+    upPipeline->stop( );
+    queueStats_ = upPipeline->getStats( );
+
+  }
+
+  if ( options_.perfCounters )
+  {
+
+    perfReport_ = upNet_->getPerfReport( );
+    upNet_->setPerfCounters( false );
+
+  }
+
+  if ( !options_.psWorker.empty( ) )
+  {
+
+    return iterations; // the server's net is the trained one
+
+  }
+
+  if ( !options_.savePath.empty( ) )
+  {
+
+    upNet_->save( options_.savePath );
+
+  }
+
+  if ( !options_.headerPath.empty( ) )
+  {
+
+    net::HeaderExporter::writeFile( *upNet_, options_.headerPath );
+
+  }
+
+  if ( !options_.headless )
+  {
+
+    std::cout << std::endl;
+    std::cout << "Done training (Error: ";
+    std::cout << ( options_.psServe.empty( ) ? upNet_->getAverageError( ) : paramStats_.error ) << ")" << std::endl;
+
+    if ( upValidator )
+    {
+
+      std::cout << "Validation error " << validation_.rmsError
+                << ", accuracy " << validation_.accuracy * 100.0 << "%"
+                << ( validationStopped_ ? " (stopped training)" : "" ) << std::endl;
+
+    }
+
+    std::cout << std::endl;
+
+  }
+
+  return iterations;
+
+} // App::train
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief App::search
+////////////////////////////////////////////////////////////////////
+unsigned long
+App::search( unsigned numCandidates )
+{
+
+  //
+  // hidden layers scaled around the app's own topology
+  //
+  net::SearchSpace space;
+
+  for ( double scale : { 0.5, 1.0, 2.0, 3.0 } )
+  {
+
+    std::vector< unsigned > topology = netTopology_;
+
+    for ( size_t l = 1; l + 1 < topology.size( ); ++l )
+    {
+
+      topology[ l ] = std::max( 1u, static_cast< unsigned >( std::lround( topology[ l ] * scale ) ) );
+
+    }
+
+    space.topologies.push_back( topology );
+
+  }
+
+  net::SearchOptions searchOptions;
+  searchOptions.numThreads     = options_.numThreads;
+  searchOptions.errorSmoothing = errorSmoothing_;
+
+  net::HyperSearch hyperSearch( searchOptions );
+  hyperSearch.addRandomCandidates( numCandidates, space, options_.seed );
+
+  net::SearchResult result = hyperSearch.run(
+                                             std::bind( &App::inputFunction,  this ),
+                                             std::bind( &App::targetFunction, this )
+                                             );
+
+  upNet_ = std::move( result.upNet );
+  upNet_->setPrecision( options_.precision );
+
+  // keep reports machine readable
+  std::ostream &out = ( options_.headless ? std::clog : std::cout );
+
+  out << "Search winner (" << numCandidates << " candidates, "
+      << result.numRounds << " rounds): topology";
+
+  for ( unsigned size : result.config.topology )
+  {
+
+    out << " " << size;
+
+  }
+
+  out << ", eta " << result.config.params.eta
+      << ", alpha " << result.config.params.alpha
+      << ", validation error " << result.validationError << std::endl;
+
+  return result.iterations;
+
+} // App::search
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief App::trainDistributed
+////////////////////////////////////////////////////////////////////
+unsigned long
+App::trainDistributed(
+                      net::TrainFun inputFun,
+                      net::TrainFun targetFun
+                      )
+{
+
+#if defined( NET_PARAMETER_SERVER )
+
+  server::ParamOptions params;
+  params.numWorkers    = options_.psWorkers;
+  params.maxStaleness  = options_.psStaleness;
+  params.localSteps    = options_.psSteps;
+  params.targetError   = options_.targetError;
+  params.maxSamples    = options_.maxIterations;
+  params.acceptTimeout = options_.psTimeout;
+
+  if ( !options_.psServe.empty( ) )
+  {
+
+    params.address = options_.psServe;
+
+    server::ParameterServer paramServer( params );
+
+    paramStats_ = paramServer.train( upNet_.get( ) );
+
+    return paramStats_.samples;
+
+  }
+
+  params.address = options_.psWorker;
+
+  server::ParameterWorker worker( params );
+
+  //
+  // a shard of its own: samples from a seed neither the other
+  // workers nor the server's evaluation use
+  //
+  gen_.seed( options_.seed + 1 + worker.getRank( ) );
+  dist_.reset( );
+
+  paramStats_ = worker.train( upNet_.get( ), inputFun, targetFun );
+
+  std::clog << options_.name << " worker " << worker.getRank( ) << ": "
+            << paramStats_.samples << " samples, "
+            << paramStats_.pushes << " pushes ("
+            << paramStats_.stalePushes << " stale), "
+            << paramStats_.bytesSent << " bytes sent, error "
+            << paramStats_.error << ", "
+            << paramStats_.seconds << " s" << std::endl;
+
+  return paramStats_.samples;
+
+#else
+
+  static_cast< void >( inputFun );
+  static_cast< void >( targetFun );
+
+  throw std::runtime_error( "Parameter server training needs Unix sockets (built without NET_PARAMETER_SERVER)" );
+
+#endif
+
+} // App::trainDistributed
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief App::tableAxes
+////////////////////////////////////////////////////////////////////
+std::vector< net::TableAxis >
+App::tableAxes( unsigned ) const
+{
+
+  throw std::runtime_error( options_.name + " has no lookup table input domain" );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief App::benchmark
+////////////////////////////////////////////////////////////////////
+void
+App::benchmark( )
+{
+
+  using Clock = std::chrono::steady_clock;
+
+  auto seconds = [ ]( Clock::time_point start )
+  {
+    return std::chrono::duration< double >( Clock::now( ) - start ).count( );
+  };
+
+  //
+  // training
+  //
+  Clock::time_point start = Clock::now( );
+
+  unsigned long iterations   = train( );
+  double        trainSeconds = seconds( start );
+  double        trainError   = ( options_.psServe.empty( ) ? upNet_->getAverageError( ) : paramStats_.error );
+  bool          reached      = trainError <= options_.targetError;
+
+  //
+  // evaluation on fresh random samples
+  //
+  const size_t numInputs  = inputVals_.size( );
+  const size_t numOutputs = targetVals_.size( );
+
+  std::vector< double > inputs;
+  std::vector< double > targets;
+  std::vector< double > results;
+
+  inputs.reserve ( options_.numSamples * numInputs  );
+  targets.reserve( options_.numSamples * numOutputs );
+
+  for ( unsigned long i = 0; i < options_.numSamples; ++i )
+  {
+
+    std::vector< double > input  = inputFunction( );
+    std::vector< double > target = targetFunction( );
+
+    inputs.insert ( inputs.end( ),  input.begin( ),  input.end( )  );
+    targets.insert( targets.end( ), target.begin( ), target.end( ) );
+
+  }
+
+  start = Clock::now( );
+
+  upNet_->prepareBatch( );
+  upNet_->feedForwardBatch( inputs, &results, options_.numThreads );
+
+  double evalSeconds = seconds( start );
+
+  double sumSquares = 0.0;
+
+  for ( size_t i = 0; i < results.size( ); ++i )
+  {
+
+    double delta = targets[ i ] - results[ i ];
+    sumSquares  += delta * delta;
+
+  }
+
+  double evalError = ( results.empty( ) ? 0.0 : std::sqrt( sumSquares / results.size( ) ) );
+
+  //
+  // optionally the same samples through a lookup table of the net
+  // (one thread), with its error against the net's own outputs
+  //
+  std::unique_ptr< net::LookupTable > upTable;
+  double                              tableCompileSeconds = 0.0;
+  double                              tableEvalSeconds    = 0.0;
+  net::TableError                     tableError;
+
+  if ( options_.tablePoints > 0 )
+  {
+
+    start = Clock::now( );
+
+    upTable.reset( new net::LookupTable( net::LookupTable::compileToTable( *upNet_,
+                                                                          tableAxes( options_.tablePoints ),
+                                                                          options_.numThreads ) ) );
+
+    tableCompileSeconds = seconds( start );
+
+    std::vector< double > tableResults;
+
+    start = Clock::now( );
+
+    upTable->lookupBatch( inputs, &tableResults );
+
+    tableEvalSeconds = seconds( start );
+    tableError       = upTable->measureError( *upNet_, inputs, options_.numThreads );
+
+  }
+
+  unsigned numThreads = options_.numThreads;
+
+  if ( numThreads == 0 )
+  {
+
+    numThreads = std::max( std::thread::hardware_concurrency( ), 1u );
+
+  }
+
+  //
+  // report
+  //
+  std::vector< std::pair< std::string, std::string > > fields;
+
+  auto add = [ & ]( const std::string &key, auto val )
+  {
+
+    std::ostringstream stream;
+    stream << std::setprecision( 6 ) << val;
+    fields.emplace_back( key, stream.str( ) );
+
+  };
+
+  add( "seed",                  options_.seed                                   );
+  add( "threads",               numThreads                                      );
+  add( "target_error",          options_.targetError                            );
+  add( "max_iterations",        options_.maxIterations                          );
+  add( "reached_target",        ( reached ? "true" : "false" )                  );
+  add( "iterations",            iterations                                      );
+  add( "train_seconds",         trainSeconds                                    );
+  add( "train_samples_per_sec", ( trainSeconds > 0.0 ? iterations / trainSeconds : 0.0 ) );
+  add( "final_error",           trainError                                      );
+  add( "eval_samples",          options_.numSamples                             );
+  add( "eval_seconds",          evalSeconds                                     );
+  add( "eval_samples_per_sec",  ( evalSeconds > 0.0 ? options_.numSamples / evalSeconds : 0.0 ) );
+  add( "eval_rms_error",        evalError                                       );
+  add( "search_candidates",     options_.numCandidates                          );
+  add( "precision",             precisionName( options_.precision )             );
+
+  if ( options_.pipelineSlots > 0 )
+  {
+
+    add( "queue_capacity",              queueStats_.capacity            );
+    add( "queue_mean_depth",            queueStats_.meanDepth           );
+    add( "queue_max_depth",             queueStats_.maxDepth            );
+    add( "queue_producer_stalls",       queueStats_.producerStalls      );
+    add( "queue_consumer_stalls",       queueStats_.consumerStalls      );
+    add( "queue_producer_wait_seconds", queueStats_.producerWaitSeconds );
+    add( "queue_consumer_wait_seconds", queueStats_.consumerWaitSeconds );
+
+  }
+
+  if ( options_.validateSamples > 0 )
+  {
+
+    add( "validation_samples",   options_.validateSamples                 );
+    add( "validation_rms_error", validation_.rmsError                     );
+    add( "validation_accuracy",  validation_.accuracy                     );
+    add( "validation_stopped",   ( validationStopped_ ? "true" : "false" ) );
+
+  }
+
+  if ( upTable )
+  {
+
+    add( "table_grid_points",          options_.tablePoints     );
+    add( "table_points",               upTable->getNumPoints( ) );
+    add( "table_bytes",                upTable->getBytes( )     );
+    add( "table_compile_seconds",      tableCompileSeconds      );
+    add( "table_eval_seconds",         tableEvalSeconds         );
+    add( "table_eval_samples_per_sec", ( tableEvalSeconds > 0.0 ? options_.numSamples / tableEvalSeconds : 0.0 ) );
+    add( "table_net_max_error",        tableError.maxError      );
+    add( "table_net_rms_error",        tableError.rmsError      );
+
+  }
+
+  if ( !options_.psServe.empty( ) )
+  {
+
+    double bytesPerSample = ( paramStats_.samples > 0 ? 1.0 * paramStats_.bytesReceived / paramStats_.samples : 0.0 );
+
+    add( "ps_workers",               paramStats_.numWorkers    );
+    add( "ps_local_steps",           options_.psSteps          );
+    add( "ps_max_staleness",         options_.psStaleness      );
+    add( "ps_pushes",                paramStats_.pushes        );
+    add( "ps_stale_pushes",          paramStats_.stalePushes   );
+    add( "ps_mean_staleness",        paramStats_.meanStaleness );
+    add( "ps_bytes_received",        paramStats_.bytesReceived );
+    add( "ps_bytes_sent",            paramStats_.bytesSent     );
+    add( "ps_push_bytes_per_sample", bytesPerSample            );
+
+  }
+
+  if ( options_.perfCounters )
+  {
+
+    add( "perf_status", perfReport_.status );
+
+    if ( !perfReport_.detail.empty( ) )
+    {
+
+      add( "perf_detail", perfReport_.detail );
+
+    }
+
+    //
+    // per phase seconds and IPC, then each counted event per sample
+    //
+    for ( unsigned p = 0; p < net::numPerfPhases; ++p )
+    {
+
+      net::PerfPhase            phase    = static_cast< net::PerfPhase >( p );
+      const net::PhaseCounters &counters = perfReport_[ phase ];
+      std::string               prefix   = std::string( "perf_" ) + net::perfPhaseName( phase ) + "_";
+
+      add( prefix + "seconds", counters.seconds );
+
+      if ( perfReport_.counted[ net::Cycles ] && perfReport_.counted[ net::Instructions ] )
+      {
+
+        add( prefix + "ipc", counters.ipc( ) );
+
+      }
+
+      for ( int e = 0; e < net::NumPerfEvents; ++e )
+      {
+
+        net::PerfEvent event = static_cast< net::PerfEvent >( e );
+
+        if ( perfReport_.counted[ event ] )
+        {
+
+          add( prefix + net::perfEventName( event ) + "_per_sample", counters.perSample( event ) );
+
+        }
+
+      }
+
+    }
+
+  }
+
+  // text keys padded to a common column (at least 24 wide)
+  size_t width = 24;
+
+  for ( const auto &field : fields )
+  {
+
+    width = std::max( width, field.first.size( ) + 2 );
+
+  }
+
+  switch ( options_.format )
+  {
+
+  case AppOptions::Format::Json:
+
+    std::cout << "{\"app\": " << jsonString( options_.name );
+
+    for ( const auto &field : fields )
+    {
+
+      // numbers and booleans as they are, anything else as a string
+      bool literal = ( field.second == "true" || field.second == "false" || isJsonNumber( field.second ) );
+
+      std::cout << ", " << jsonString( field.first ) << ": "
+                << ( literal ? field.second : jsonString( field.second ) );
+
+    }
+
+    std::cout << "}" << std::endl;
+    break;
+
+  case AppOptions::Format::Csv:
+
+    std::cout << "app";
+
+    for ( const auto &field : fields )
+    {
+
+      std::cout << "," << csvField( field.first );
+
+    }
+
+    std::cout << std::endl << csvField( options_.name );
+
+    for ( const auto &field : fields )
+    {
+
+      std::cout << "," << csvField( field.second );
+
+    }
+
+    std::cout << std::endl;
+    break;
+
+  case AppOptions::Format::Text:
+  default:
+
+    std::cout << std::left << std::setw( width ) << "app" << options_.name << std::endl;
+
+    for ( const auto &field : fields )
+    {
+
+      std::cout << std::left << std::setw( width ) << field.first << field.second << std::endl;
+
+    }
+
+    break;
+
+  }
+
+} // App::benchmark
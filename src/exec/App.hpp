@@ -4,8 +4,80 @@
 #include <vector>
 #include <random>
 #include <iostream>
+#include <string>
 
 #include "ConnectedNet.hpp"
+#include "SampleQueue.hpp"
+#include "Validator.hpp"
+#include "LookupTable.hpp"
+#include "ParameterServer.hpp"
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The AppOptions struct
+///
+///        Command line options shared by the run* executables
+///
+////////////////////////////////////////////////////////////////////
+struct AppOptions
+{
+
+  enum class Format
+  {
+    Text,
+    Json,
+    Csv
+  };
+
+  std::string    name          = "app";  ///< executable name used in reports
+  bool           headless      = false;  ///< benchmark and report instead of the interactive loop
+  bool           hasSeed       = false;  ///< seed given (otherwise taken from the clock)
+  unsigned       seed          = 0;      ///< seed for the weights and the sample generator
+  unsigned       numThreads    = 0;      ///< evaluation threads (0 for one per core)
+  unsigned long  maxIterations = 0;      ///< training iteration limit (0 for no limit)
+  double         targetError   = 1.0e-4; ///< acceptable training error
+  unsigned long  numSamples    = 100000; ///< random samples evaluated after training
+  unsigned       numCandidates = 0;      ///< hyperparameter search candidates (0 for no search)
+  Format         format        = Format::Text;
+  net::Precision precision     = net::Precision::Double; ///< training weight precision
+  unsigned       pipelineSlots = 0;      ///< samples generated ahead on a separate thread (0 for none)
+  bool           perfCounters  = false;  ///< count hardware events per training phase
+  unsigned long  validateSamples = 0;    ///< held-out samples evaluated in the background while training (0 for none)
+  unsigned       validateEvery = 10000;  ///< training iterations between validation snapshots
+  double         validateAccuracy = -1.0; ///< held-out accuracy that stops training (negative for never)
+  std::string    savePath;               ///< model file written after training (empty for none)
+  std::string    headerPath;             ///< C++ header the trained model is exported to (empty for none)
+  unsigned       tablePoints   = 0;      ///< grid points per continuous input of a lookup table (0 for no table)
+  std::string    psServe;                ///< address to serve the weights on as a parameter server (empty for none)
+  std::string    psWorker;               ///< parameter server address to train for as a worker (empty for none)
+  unsigned       psWorkers     = 1;      ///< workers the parameter server waits for
+  unsigned       psStaleness   = 4;      ///< most pushes applied between a worker's pull and its push
+  unsigned       psSteps       = 32;     ///< samples a worker trains between pushes
+  double         psTimeout     = 60.0;   ///< seconds the parameter server waits for each worker to connect (0 for ever)
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief parse
+  ///
+  ///        Parses the arguments from argv[ firstArg ] on. Prints
+  ///        the usage and exits for --help, throws on anything
+  ///        it does not understand.
+  ///
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  static AppOptions parse (
+                           int    argc,
+                           char **argv,
+                           int    firstArg = 1
+                           );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief usage
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  static std::string usage ( );
+
+};
 
 
 ////////////////////////////////////////////////////////////////////
@@ -27,11 +99,77 @@ public:
   virtual
   ~App( ) = default;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief configure
+  ///
+  ///        Applies command line options. Reseeds the sample
+  ///        generator and rebuilds the net from that seed so
+  ///        runs are reproducible.
+  ///
+  /// \param options
+  ////////////////////////////////////////////////////////////////////
+  void configure ( const AppOptions &options );
+
   ////////////////////////////////////////////////////////////////////
   /// \brief run
+  ///
+  ///        Trains the net then either starts the interactive loop
+  ///        or, in headless mode, runs benchmark
+  ///
   ////////////////////////////////////////////////////////////////////
   virtual void run ( );
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief train
+  ///
+  ///        Trains the net until the error is acceptable (the first
+  ///        half of run, without the interactive loop). Starts with
+  ///        the hyperparameter search when one is configured.
+  ///
+  /// \return number of training iterations (including the search)
+  ////////////////////////////////////////////////////////////////////
+  unsigned long train ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief search
+  ///
+  ///        Successive halving search over training rate, momentum
+  ///        and hidden layer sizes (from half to triple the app's
+  ///        topology). The winner replaces the current net.
+  ///
+  /// \param numCandidates
+  /// \return training iterations the winner received
+  ////////////////////////////////////////////////////////////////////
+  unsigned long search ( unsigned numCandidates );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief trainDistributed
+  ///
+  ///        Trains through a parameter server instead of locally:
+  ///        with --ps-serve this process holds the weights and
+  ///        ends up with the trained net, with --ps-worker it trains
+  ///        its own shard of samples (seeded from its rank) for the
+  ///        server. Unix only.
+  ///
+  /// \param inputFun
+  /// \param targetFun
+  /// \return samples trained (over every worker)
+  ////////////////////////////////////////////////////////////////////
+  unsigned long trainDistributed (
+                                  net::TrainFun inputFun,
+                                  net::TrainFun targetFun
+                                  );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief benchmark
+  ///
+  ///        Times training, evaluates the configured number of
+  ///        random samples with batched inference and writes a
+  ///        report in the configured format to std::cout
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void benchmark ( );
+
 
 protected:
 
@@ -54,6 +192,17 @@ protected:
   ////////////////////////////////////////////////////////////////////
   virtual bool onUserLoop ( const std::string &line ) = 0;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief tableAxes
+  ///
+  ///        Input domain for compiling the net to a lookup table
+  ///        (throws for apps without one)
+  ///
+  /// \param gridPoints - points per continuous input
+  /// \return one axis per input
+  ////////////////////////////////////////////////////////////////////
+  virtual std::vector< net::TableAxis > tableAxes ( unsigned gridPoints ) const;
+
 
   ////////////////////////////////////////////////////////////////////
   /// \brief printVector
@@ -68,8 +217,21 @@ protected:
                     );
 
 
+  std::vector< unsigned > netTopology_;
+  double                  errorSmoothing_;
+
+  AppOptions options_;
+
   std::unique_ptr< net::ConnectedNet > upNet_;
 
+  net::QueueStats queueStats_; // sample pipeline of the latest train call
+  net::PerfReport perfReport_; // hardware counters of the latest train call
+
+  server::ParamStats paramStats_; // parameter server training of the latest train call
+
+  net::ValidationReport validation_;        // held-out set on the net the latest train call left
+  bool                  validationStopped_; // the held-out accuracy stopped that training
+
   std::default_random_engine gen_;
   std::uniform_int_distribution< unsigned > dist_;
 
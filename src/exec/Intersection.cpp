@@ -11,8 +11,17 @@
 #include <stdexcept>
 #include <chrono>
 #include <string>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <mutex>
+#include <memory>
 
 #include "Intersections.hpp"
+#include "ThresholdClassifier.hpp"
+#include "LookupTable.hpp"
 
 #include "App.hpp"
 
@@ -27,6 +36,40 @@ constexpr double focalZoom  = 1.0;
 
 constexpr unsigned imgSize = 8;
 
+constexpr unsigned tableGridPoints = 64; // per direction component when rendering without --table
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief writeImage
+///
+///        Writes a binary PGM (1 channel) or PPM (3 channels)
+///
+////////////////////////////////////////////////////////////////////
+void
+writeImage(
+           const std::string                  &path,
+           unsigned                            width,
+           unsigned                            height,
+           unsigned                            channels,
+           const std::vector< unsigned char > &data
+           )
+{
+
+  std::ofstream file( path, std::ios::binary );
+
+  if ( !file )
+  {
+
+    throw std::runtime_error( "Could not open " + path + " for writing" );
+
+  }
+
+  file << ( channels == 3 ? "P6" : "P5" ) << "\n" << width << " " << height << "\n255\n";
+  file.write( reinterpret_cast< const char* >( data.data( ) ), static_cast< std::streamsize >( data.size( ) ) );
+
+}
+
 }
 
 
@@ -64,6 +107,13 @@ public:
   ////////////////////////////////////////////////////////////////////
   virtual bool onUserLoop ( const std::string &line ) final;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief tableAxes
+  /// \return a grid over the encoded ray direction (the fourth
+  ///         input is always 0)
+  ////////////////////////////////////////////////////////////////////
+  virtual std::vector< net::TableAxis > tableAxes ( unsigned gridPoints ) const final;
+
 
   ////////////////////////////////////////////////////////////////////
   /// \brief buildImage
@@ -79,6 +129,48 @@ public:
                                   bool              exact
                                   );
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief evaluatePixels
+  ///
+  ///        Per pixel hit value (> 0.0 is a hit) computed over
+  ///        tiles of rows in parallel
+  ///
+  /// \param pClassifier - if set, the net's hits come from it as
+  ///                      1.0 / -1.0 instead of the net's outputs
+  /// \param pStats - early exit counters of pClassifier (optional)
+  /// \param pTable - if set (and pClassifier isn't), the net's
+  ///                 outputs are looked up in it instead
+  /// \return width * height values
+  ////////////////////////////////////////////////////////////////////
+  std::vector< double > evaluatePixels (
+                                        unsigned                        width,
+                                        unsigned                        height,
+                                        const glm::dvec3               &eye,
+                                        const double                    fPlane,
+                                        bool                            exact,
+                                        const net::ThresholdClassifier *pClassifier = nullptr,
+                                        net::ThresholdStats            *pStats      = nullptr,
+                                        const net::LookupTable         *pTable      = nullptr
+                                        );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief render
+  ///
+  ///        Non-interactive mode: renders the net and the exact
+  ///        reference at full resolution, writes both images and
+  ///        a disagreement map, and reports throughput and
+  ///        agreement
+  ///
+  /// \param width
+  /// \param height
+  /// \param prefix - output file prefix
+  ////////////////////////////////////////////////////////////////////
+  void render (
+               unsigned           width,
+               unsigned           height,
+               const std::string &prefix
+               );
+
 
 protected:
 
@@ -292,6 +384,28 @@ IntersectionApp::onUserLoop( const std::string &line )
 
 
 
+////////////////////////////////////////////////////////////////////
+/// \brief IntersectionApp::tableAxes
+////////////////////////////////////////////////////////////////////
+std::vector< net::TableAxis >
+IntersectionApp::tableAxes( unsigned gridPoints ) const
+{
+
+  //
+  // directions are encoded as d * 0.5 + 0.5; rays leave the eye
+  // towards -z, so the z component stays in [ 0, 0.5 ]
+  //
+  return {
+          net::TableAxis::grid( 0.0, 1.0, gridPoints ),
+          net::TableAxis::grid( 0.0, 1.0, gridPoints ),
+          net::TableAxis::grid( 0.0, 0.5, gridPoints ),
+          net::TableAxis::discrete( { 0.0 } )
+         };
+
+}
+
+
+
 ////////////////////////////////////////////////////////////////////
 /// \brief IntersectionApp::buildImage
 /// \param w
@@ -310,62 +424,396 @@ IntersectionApp::buildImage(
                             )
 {
 
-  std::vector< char > image( width * height );
+  // only hits are needed, which the classifier decides early
+  std::unique_ptr< net::ThresholdClassifier > upClassifier;
+
+  if ( !exact )
+  {
+
+    upClassifier.reset( new net::ThresholdClassifier( *upNet_ ) );
+
+  }
+
+  std::vector< double > results = evaluatePixels( width, height, eye, fPlane, exact, upClassifier.get( ) );
+
+  //
+  // threshold
+  //
+  std::vector< char > image( results.size( ) );
+
+  for ( size_t i = 0; i < results.size( ); ++i )
+  {
+
+    image[ i ] = ( results[ i ] > 0.0 ? '0' : ' ' );
+
+  }
+
+  return image;
+
+} // IntersectionApp::buildImage
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief IntersectionApp::evaluatePixels
+///
+///        Each tile generates its ray directions up front and
+///        evaluates them all at once, either exactly (ray
+///        packets) or through the net's batched inference path
+///
+////////////////////////////////////////////////////////////////////
+std::vector< double >
+IntersectionApp::evaluatePixels(
+                                const unsigned                  width,
+                                const unsigned                  height,
+                                const glm::dvec3               &eye,
+                                const double                    fPlane,
+                                bool                            exact,
+                                const net::ThresholdClassifier *pClassifier,
+                                net::ThresholdStats            *pStats,
+                                const net::LookupTable         *pTable
+                                )
+{
+
+  constexpr unsigned packetSize = 8;
+  constexpr unsigned tileRows   = 16;
+
+  const size_t numInputs  = inputVals_.size( );
+  const size_t numOutputs = targetVals_.size( );
 
-  std::vector< double > result;
+  glm::dvec3 up = glm::dvec3( 0.0, 1.0, 0.0 ); // up axis of world
+  double f      = fPlane;                      // distance between eye and focal plane
 
-  for ( unsigned y = 0; y < height; ++y )
+  // camera basis
+  glm::dvec3 w = glm::normalize( -eye );
+  glm::dvec3 u = glm::normalize( cross( w, up ) );
+  glm::dvec3 v = glm::normalize( cross( u, w ) );
+
+  std::vector< double > pixels( width * height );
+  std::mutex            statsMutex;
+
+  // packed once here, the tiles' feedForwardBatch calls only read the net
+  if ( !exact && !pClassifier && !pTable )
   {
 
-    for ( unsigned x = 0; x < width; ++x )
+    upNet_->prepareBatch( );
+
+  }
+
+  auto evaluateTile = [ & ]( unsigned rowBegin, unsigned rowEnd )
+  {
+
+    const size_t numPixels = ( rowEnd - rowBegin ) * width;
+
+    //
+    // ray directions (encoded as net inputs) for every pixel
+    //
+    std::vector< double > inputs( numPixels * numInputs, 0.0 );
+
+    for ( unsigned y = rowBegin; y < rowEnd; ++y )
     {
 
-      glm::dvec2 uv = glm::dvec2( x * 1.0 / width, y * 1.0 / height );
+      for ( unsigned x = 0; x < width; ++x )
+      {
+
+        glm::dvec2 uv = glm::dvec2( x * 1.0 / width, y * 1.0 / height );
+
+        // pixel space of the focal plane
+        glm::dvec2 p = -1.0 + 2.0 * uv;
+        p.x *= width * 1.0 / height;
 
-      glm::dvec3 up = glm::dvec3( 0.0, 1.0, 0.0 ); // up axis of world
-      double f      = fPlane;                      // distance between eye and focal plane
+        glm::dvec3 d = glm::normalize( p.x * u + p.y * v + f * w );
 
-      // camera basis
-      glm::dvec3 w = glm::normalize( -eye );
-      glm::dvec3 u = glm::normalize( cross( w, up ) );
-      glm::dvec3 v = glm::normalize( cross( u, w ) );
+        d = d * 0.5 + 0.5;
 
-      // pixel space of the focal plane
-      glm::dvec2 p = -1.0 + 2.0 * uv;
-      p.x *= width * 1.0 / height;
+        double *input = &inputs[ ( ( y - rowBegin ) * width + x ) * numInputs ];
+        input[ 0 ] = d.x;
+        input[ 1 ] = d.y;
+        input[ 2 ] = d.z;
 
-      glm::dvec3 d = glm::normalize( p.x * u + p.y * v + f * w );
+      }
+
+    }
 
-      d = d * 0.5 + 0.5;
+    double *out = &pixels[ rowBegin * width ];
 
-      inputVals_[ 0 ] = d.x;
-      inputVals_[ 1 ] = d.y;
-      inputVals_[ 2 ] = d.z;
+    if ( exact )
+    {
 
-      upNet_->feedForward( inputVals_ );
+      hit::RayPacket< double, packetSize > rays;
+      hit::HitPacket< double, packetSize > hits;
 
-      if ( exact )
+      //
+      // intersect packets of rays (the last packet repeats its
+      // final ray in the unused lanes)
+      //
+      for ( size_t first = 0; first < numPixels; first += packetSize )
       {
 
-        result = targetFunction( );
+        for ( unsigned lane = 0; lane < packetSize; ++lane )
+        {
+
+          size_t        i     = std::min( first + lane, numPixels - 1 );
+          const double *input = &inputs[ i * numInputs ];
+
+          rays.ox[ lane ] = eye.x;
+          rays.oy[ lane ] = eye.y;
+          rays.oz[ lane ] = eye.z;
+
+          rays.dx[ lane ] = ( input[ 0 ] - 0.5 ) * 2.0;
+          rays.dy[ lane ] = ( input[ 1 ] - 0.5 ) * 2.0;
+          rays.dz[ lane ] = ( input[ 2 ] - 0.5 ) * 2.0;
+
+        }
+
+        hit::intersectSpherePacket( rays, &hits );
+
+        for ( unsigned lane = 0; lane < packetSize && first + lane < numPixels; ++lane )
+        {
+
+          out[ first + lane ] = ( hits.t[ lane ] == std::numeric_limits< double >::infinity( ) ? -1.0 : 1.0 );
+
+        }
+
+      }
+
+    }
+    else if ( pClassifier )
+    {
+
+      std::vector< char >  hits;
+      net::ThresholdStats stats;
+
+      pClassifier->classifyBatch( inputs, &hits, &stats );
+
+      for ( size_t i = 0; i < numPixels; ++i )
+      {
+
+        out[ i ] = ( hits[ i ] ? 1.0 : -1.0 );
 
       }
-      else
+
+      if ( pStats )
       {
 
-        upNet_->getResults ( &result );
+        std::lock_guard< std::mutex > lock( statsMutex );
+        pStats->add( stats );
 
       }
 
-      image[ y * width + x ] = ( result[ 0 ] > 0.0 ? '0' : ' ' );
+    }
+    else if ( pTable )
+    {
+
+      std::vector< double > results;
+
+      pTable->lookupBatch( inputs, &results );
+
+      for ( size_t i = 0; i < numPixels; ++i )
+      {
+
+        out[ i ] = results[ i * numOutputs ];
+
+      }
 
     }
+    else
+    {
+
+      std::vector< double > results;
+
+      // tiles are already spread over the threads
+      upNet_->feedForwardBatch( inputs, &results, 1 );
+
+      for ( size_t i = 0; i < numPixels; ++i )
+      {
+
+        out[ i ] = results[ i * numOutputs ];
+
+      }
+
+    }
+
+  };
+
+  //
+  // worker threads pull row tiles off a shared counter
+  //
+  const unsigned numTiles   = ( height + tileRows - 1 ) / tileRows;
+  unsigned       numThreads = options_.numThreads;
+
+  if ( numThreads == 0 )
+  {
+
+    numThreads = std::max( std::thread::hardware_concurrency( ), 1u );
 
   }
 
-  return image;
+  numThreads = std::min( numThreads, numTiles );
 
-} // IntersectionApp::buildImage
+  std::atomic< unsigned > nextTile( 0 );
+
+  auto worker = [ & ]( )
+  {
+
+    for ( unsigned tile = nextTile++; tile < numTiles; tile = nextTile++ )
+    {
+
+      unsigned rowBegin = tile * tileRows;
+      evaluateTile( rowBegin, std::min( rowBegin + tileRows, height ) );
+
+    }
+
+  };
+
+  std::vector< std::future< void > > futures;
+
+  for ( unsigned t = 1; t < numThreads; ++t )
+  {
+
+    futures.push_back( std::async( std::launch::async, worker ) );
+
+  }
+
+  worker( );
+
+  for ( auto &future : futures )
+  {
+
+    future.get( );
+
+  }
+
+  return pixels;
+
+} // IntersectionApp::evaluatePixels
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief IntersectionApp::render
+/// \param width
+/// \param height
+/// \param prefix
+////////////////////////////////////////////////////////////////////
+void
+IntersectionApp::render(
+                        const unsigned     width,
+                        const unsigned     height,
+                        const std::string &prefix
+                        )
+{
+
+  glm::dvec3 p ( 0.0, 0.0, eyeDist );
+
+  const size_t numPixels = width * height;
+
+  auto timeSeconds = [ ]( auto start )
+  {
+    return std::chrono::duration< double >( std::chrono::steady_clock::now( ) - start ).count( );
+  };
+
+  auto start = std::chrono::steady_clock::now( );
+
+  std::vector< double > netPixels = evaluatePixels( width, height, p, focalPlane_, false );
+
+  double netSeconds = timeSeconds( start );
+
+  start = std::chrono::steady_clock::now( );
+
+  std::vector< double > exactPixels = evaluatePixels( width, height, p, focalPlane_, true );
+
+  double exactSeconds = timeSeconds( start );
+
+  //
+  // hits only, deciding most pixels from part of the hidden layer
+  //
+  net::ThresholdClassifier classifier( *upNet_ );
+  net::ThresholdStats      stats;
+
+  start = std::chrono::steady_clock::now( );
+
+  std::vector< double > hitPixels = evaluatePixels( width, height, p, focalPlane_, false, &classifier, &stats );
+
+  double hitSeconds = timeSeconds( start );
+
+  //
+  // the net precomputed over a grid of ray directions
+  //
+  unsigned gridPoints = ( options_.tablePoints > 0 ? options_.tablePoints : tableGridPoints );
+
+  start = std::chrono::steady_clock::now( );
+
+  net::LookupTable table = net::LookupTable::compileToTable( *upNet_, tableAxes( gridPoints ), options_.numThreads );
+
+  double tableCompileSeconds = timeSeconds( start );
+
+  start = std::chrono::steady_clock::now( );
+
+  std::vector< double > tablePixels = evaluatePixels( width, height, p, focalPlane_, false, nullptr, nullptr, &table );
+
+  double tableSeconds = timeSeconds( start );
+
+  //
+  // images: net output as grayscale ([-1, 1] -> [0, 255]), exact
+  // hits as white and the disagreement map as white/black where
+  // both agree, red for false hits and blue for false misses
+  //
+  std::vector< unsigned char > netImage( numPixels );
+  std::vector< unsigned char > exactImage( numPixels );
+  std::vector< unsigned char > diffImage( numPixels * 3 );
+
+  size_t numAgree      = 0;
+  size_t numHitAgree   = 0;
+  size_t numTableAgree = 0;
+  double maxTableError = 0.0;
+
+  for ( size_t i = 0; i < numPixels; ++i )
+  {
+
+    bool netHit   = netPixels[ i ] > 0.0;
+    bool exactHit = exactPixels[ i ] > 0.0;
+
+    numHitAgree   += ( ( hitPixels[ i ] > 0.0 ) == netHit ? 1u : 0u );
+    numTableAgree += ( ( tablePixels[ i ] > 0.0 ) == netHit ? 1u : 0u );
+    maxTableError  = std::max( maxTableError, std::abs( tablePixels[ i ] - netPixels[ i ] ) );
+
+    double gray = glm::clamp( netPixels[ i ] * 0.5 + 0.5, 0.0, 1.0 );
+
+    netImage[ i ]   = static_cast< unsigned char >( gray * 255.0 + 0.5 );
+    exactImage[ i ] = ( exactHit ? 255 : 0 );
+
+    unsigned char *rgb = &diffImage[ i * 3 ];
+
+    rgb[ 0 ] = ( netHit ? 255 : 0 );
+    rgb[ 1 ] = ( netHit == exactHit && exactHit ? 255 : 0 );
+    rgb[ 2 ] = ( exactHit ? 255 : 0 );
+
+    numAgree += ( netHit == exactHit ? 1 : 0 );
+
+  }
+
+  writeImage( prefix + "_net.pgm",   width, height, 1, netImage   );
+  writeImage( prefix + "_exact.pgm", width, height, 1, exactImage );
+  writeImage( prefix + "_diff.ppm",  width, height, 3, diffImage  );
+
+  std::cout << "Resolution: " << width << "x" << height << std::endl;
+  std::cout << "Net:   " << numPixels / netSeconds   << " pixels/sec" << std::endl;
+  std::cout << "Exact: " << numPixels / exactSeconds << " pixels/sec" << std::endl;
+  std::cout << "Net hits only: " << numPixels / hitSeconds << " pixels/sec ("
+            << 100.0 * stats.earlyFraction( ) << "% decided early, "
+            << 100.0 * stats.neuronFraction( ) << "% of hidden neurons, "
+            << 100.0 * numHitAgree / numPixels << "% same as the net)" << std::endl;
+  std::cout << "Net table: " << numPixels / tableSeconds << " pixels/sec ("
+            << gridPoints << "^3 grid, " << table.getBytes( ) / 1024 << " KiB compiled in "
+            << tableCompileSeconds << " s, max error " << maxTableError << ", "
+            << 100.0 * numTableAgree / numPixels << "% same hits as the net)" << std::endl;
+  std::cout << "Agreement: " << 100.0 * numAgree / numPixels << "%" << std::endl;
+  std::cout << "Wrote " << prefix << "_net.pgm, "
+            << prefix << "_exact.pgm, "
+            << prefix << "_diff.ppm" << std::endl;
+
+} // IntersectionApp::render
 
 
 
@@ -374,14 +822,64 @@ IntersectionApp::buildImage(
 /// \return
 ////////////////////////////////////////////////////////////////////
 int
-main( )
+main(
+     int    argc,
+     char **argv
+     )
 {
 
   try
   {
 
     IntersectionApp app;
-    app.run( );
+
+    //
+    // runIntersection --render <width> <height> [<output prefix>] [<options>]
+    //
+    if ( argc > 1 && std::string( argv[ 1 ] ) == "--render" )
+    {
+
+      if ( argc < 4 )
+      {
+
+        std::cerr << "Usage: " << argv[ 0 ] << " [--render <width> <height> [<output prefix>]] [<options>]\n"
+                  << AppOptions::usage( );
+        return EXIT_FAILURE;
+
+      }
+
+      unsigned    width    = static_cast< unsigned >( std::stoul( argv[ 2 ] ) );
+      unsigned    height   = static_cast< unsigned >( std::stoul( argv[ 3 ] ) );
+      std::string prefix   = "intersection";
+      int         firstArg = 4;
+
+      if ( argc > 4 && argv[ 4 ][ 0 ] != '-' )
+      {
+
+        prefix   = argv[ 4 ];
+        firstArg = 5;
+
+      }
+
+      if ( width == 0 || height == 0 )
+      {
+
+        throw std::runtime_error( "Render width and height must be positive" );
+
+      }
+
+      app.configure( AppOptions::parse( argc, argv, firstArg ) );
+      app.train( );
+      app.render( width, height, prefix );
+
+    }
+    else
+    {
+
+      app.configure( AppOptions::parse( argc, argv ) );
+      app.run( );
+
+    }
 
   }
   catch ( const std::exception &e )
@@ -50,6 +50,12 @@ public:
   ////////////////////////////////////////////////////////////////////
   virtual bool onUserLoop ( const std::string &line ) final;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief tableAxes
+  /// \return both inputs are 0 or 1
+  ////////////////////////////////////////////////////////////////////
+  virtual std::vector< net::TableAxis > tableAxes ( unsigned gridPoints ) const final;
+
 };
 
 
@@ -146,18 +152,36 @@ XORApp::onUserLoop( const std::string &line )
 
 
 
+////////////////////////////////////////////////////////////////////
+/// \brief XORApp::tableAxes
+////////////////////////////////////////////////////////////////////
+std::vector< net::TableAxis >
+XORApp::tableAxes( unsigned ) const
+{
+
+  // the inputs are binary, so the table is the net exactly
+  return std::vector< net::TableAxis >( 2, net::TableAxis::discrete( { 0.0, 1.0 } ) );
+
+}
+
+
+
 ////////////////////////////////////////////////////////////////////
 /// \brief main
 /// \return
 ////////////////////////////////////////////////////////////////////
 int
-main( )
+main(
+     int    argc,
+     char **argv
+     )
 {
 
   try
   {
 
     XORApp app;
+    app.configure( AppOptions::parse( argc, argv ) );
     app.run( );
 
   }
@@ -1,6 +1,7 @@
 #include "Intersections.hpp"
 
 #include <limits>
+#include <cstdint>
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
 
@@ -78,6 +79,75 @@ cosine_sample_hemisphere_z(
 
 
 
+////////////////////////////////////////////////////////////////
+/// \brief mixBits
+///
+///        32 bit integer hash (bijective, full avalanche) used as
+///        the round function of the counter based generator.
+///        Only shifts, xors and 32 bit multiplies so loops over
+///        it vectorize.
+///
+////////////////////////////////////////////////////////////////
+inline
+std::uint32_t
+mixBits( std::uint32_t x )
+{
+
+  x ^= x >> 16;
+  x *= 0x7feb352dU;
+  x ^= x >> 15;
+  x *= 0x846ca68bU;
+  x ^= x >> 16;
+
+  return x;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief sinCosQuarter
+///
+///        Polynomial sin and cos for |a| <= pi / 4 (Taylor
+///        series, error below 1e-16 in that range)
+///
+////////////////////////////////////////////////////////////////
+template< typename T >
+inline
+void
+sinCosQuarter(
+              const T a,    ///< angle in [-pi/4, pi/4]
+              T      *pSin, ///< output sine
+              T      *pCos  ///< output cosine
+              )
+{
+
+  const T a2 = a * a;
+
+  T s = T( 1.0 / 1307674368000.0 );
+  s   = s * a2 - T( 1.0 / 6227020800.0 );
+  s   = s * a2 + T( 1.0 / 39916800.0 );
+  s   = s * a2 - T( 1.0 / 362880.0 );
+  s   = s * a2 + T( 1.0 / 5040.0 );
+  s   = s * a2 - T( 1.0 / 120.0 );
+  s   = s * a2 + T( 1.0 / 6.0 );
+
+  T c = T( 1.0 / 20922789888000.0 );
+  c   = c * a2 - T( 1.0 / 87178291200.0 );
+  c   = c * a2 + T( 1.0 / 479001600.0 );
+  c   = c * a2 - T( 1.0 / 3628800.0 );
+  c   = c * a2 + T( 1.0 / 40320.0 );
+  c   = c * a2 - T( 1.0 / 720.0 );
+  c   = c * a2 + T( 1.0 / 24.0 );
+  c   = c * a2 - T( 0.5 );
+
+  *pSin = a - a * a2 * s;
+  *pCos = T( 1.0 ) + a2 * c;
+
+}
+
+
+
 ////////////////////////////////////////////////////////////////
 /// \brief solveQuadratic
 /// \param a
@@ -213,6 +283,85 @@ cosine_sample_hemisphere(
 
 
 
+////////////////////////////////////////////////////////////////
+/// \brief cosine_sample_hemisphere_batch
+///
+///        Each sample hashes its counter into two 32 bit words:
+///        one becomes u1 (disk radius squared), the other picks
+///        a quadrant with its top two bits and a uniform angle
+///        inside that quadrant with the rest, so sin and cos
+///        only need the short polynomials above plus a swap and
+///        sign flips. The z component is sqrt(1 - u1) directly.
+///
+////////////////////////////////////////////////////////////////
+template< typename T >
+void
+cosine_sample_hemisphere_batch(
+                               const glm::tvec3< T > &dir,         ///< normal of hemisphere plane
+                               const std::uint64_t    stream,      ///< independent random sequence id
+                               const std::uint32_t    firstSample, ///< counter of the first sample
+                               const std::size_t      count,       ///< number of directions
+                               T                     *pX,          ///< output x components
+                               T                     *pY,          ///< output y components
+                               T                     *pZ           ///< output z components
+                               )
+{
+
+  constexpr T quarterPi  = glm::pi< T >( ) / T( 4.0 );
+  constexpr T halfPi     = glm::pi< T >( ) / T( 2.0 );
+  constexpr T radiusStep = T( 1.0 / 2147483648.0 ); // 2^-31
+  constexpr T angleStep  = T( 1.0 / 1073741824.0 ); // 2^-30
+
+  // local copies so the output stores can't alias the basis
+  const glm::tvec3< T > n = dir;
+  glm::tvec3< T >       u, v;
+  createONB( n, &u, &v );
+
+  // per stream keys
+  const std::uint32_t key0 = mixBits( static_cast< std::uint32_t >( stream ) ^ 0x9e3779b9U );
+  const std::uint32_t key1 = mixBits( static_cast< std::uint32_t >( stream >> 32 ) ^ key0 );
+  const std::uint32_t key2 = mixBits( key1 + 0x632be5abU );
+
+  for ( std::size_t i = 0; i < count; ++i )
+  {
+
+    const std::uint32_t counter = mixBits( ( firstSample + static_cast< std::uint32_t >( i ) ) ^ key0 );
+
+    const std::uint32_t radiusBits = mixBits( counter ^ key1 );
+    const std::uint32_t angleBits  = mixBits( counter ^ key2 );
+
+    // u1 in [0, 1], angle within quadrant in [-pi/4, pi/4)
+    const T u1 = static_cast< T >( static_cast< std::int32_t >( radiusBits >> 1 ) ) * radiusStep;
+    const T a  = static_cast< T >( static_cast< std::int32_t >( angleBits & 0x3fffffffU ) ) * angleStep
+                 * halfPi - quarterPi;
+
+    T s, c;
+    sinCosQuarter( a, &s, &c );
+
+    //
+    // rotate by the quadrant (multiples of pi/2)
+    //
+    const std::uint32_t quadrant = angleBits >> 30;
+
+    const T sinPhi = ( quadrant & 1U ? c : s ) * ( ( quadrant & 2U ) ? T( -1.0 ) : T( 1.0 ) );
+    const T cosPhi = ( quadrant & 1U ? s : c ) * ( ( ( quadrant + 1U ) & 2U ) ? T( -1.0 ) : T( 1.0 ) );
+
+    // (clamped so the compiler can drop the sqrt domain checks)
+    const T r  = glm::sqrt( glm::max( u1, T( 0.0 ) ) );
+    const T px = r * cosPhi;
+    const T py = r * sinPhi;
+    const T pz = glm::sqrt( glm::max( T( 1.0 ) - u1, T( 0.0 ) ) );
+
+    pX[ i ] = u.x * px + v.x * py + n.x * pz;
+    pY[ i ] = u.y * px + v.y * py + n.y * pz;
+    pZ[ i ] = u.z * px + v.z * py + n.z * pz;
+
+  }
+
+} // cosine_sample_hemisphere_batch
+
+
+
 ////////////////////////////////////////////////////////////////
 /// \brief intersectSphere
 ///
@@ -297,6 +446,74 @@ intersectSphere(
 
 
 
+////////////////////////////////////////////////////////////////
+/// \brief intersectSpherePacket
+////////////////////////////////////////////////////////////////
+template< typename T, unsigned N >
+void
+intersectSpherePacket(
+                      const RayPacket< T, N > &rays, ///< ray origins and directions
+                      HitPacket< T, N >       *pHits ///< normals and distances
+                      )
+{
+
+  constexpr T INF    = std::numeric_limits< T >::infinity( );
+  constexpr T EPS    = T( 1.0e-5 );
+  constexpr T radius = 1.0;
+
+  T b   [ N ];
+  T disc[ N ];
+
+  //
+  // quadratic terms (a = 1)
+  //
+  for ( unsigned i = 0; i < N; ++i )
+  {
+
+    b[ i ] = rays.ox[ i ] * rays.dx[ i ] + rays.oy[ i ] * rays.dy[ i ] + rays.oz[ i ] * rays.dz[ i ];
+
+    T c = rays.ox[ i ] * rays.ox[ i ] + rays.oy[ i ] * rays.oy[ i ] + rays.oz[ i ] * rays.oz[ i ]
+          - radius * radius;
+
+    disc[ i ] = b[ i ] * b[ i ] - c;
+
+  }
+
+  //
+  // roots and nearest non-negative hit, selected per lane:
+  //   disc <= -EPS      -> miss
+  //   |disc| < EPS      -> one root at -b
+  //   otherwise         -> t2 = -b - sqrt <= t1 = -b + sqrt
+  //
+  for ( unsigned i = 0; i < N; ++i )
+  {
+
+    const bool valid  = disc[ i ] > -EPS;
+    const bool single = disc[ i ] < EPS;
+
+    T root = glm::sqrt( glm::max( disc[ i ], T( 0.0 ) ) );
+    root   = ( single ? T( 0.0 ) : root );
+
+    const T t1 = -b[ i ] + root;
+    const T t2 = -b[ i ] - root;
+
+    T t = ( t2 >= T( 0.0 ) ? t2 : ( t1 >= T( 0.0 ) ? t1 : INF ) );
+    t   = ( valid ? t : INF );
+
+    const bool hit = t < INF;
+    const T    s   = ( hit ? t : T( 0.0 ) );
+
+    pHits->nx[ i ] = ( hit ? rays.ox[ i ] + rays.dx[ i ] * s : T( 0.0 ) );
+    pHits->ny[ i ] = ( hit ? rays.oy[ i ] + rays.dy[ i ] * s : T( 0.0 ) );
+    pHits->nz[ i ] = ( hit ? rays.oz[ i ] + rays.dz[ i ] * s : T( 0.0 ) );
+    pHits->t [ i ] = t;
+
+  }
+
+} // intersectSpherePacket
+
+
+
 //
 // define allowed templated functions
 //
@@ -315,6 +532,28 @@ glm::dvec3 cosine_sample_hemisphere< double >(
                                               const double      z2
                                               );
 
+template
+void cosine_sample_hemisphere_batch< float >(
+                                             const glm::vec3    &dir,
+                                             const std::uint64_t stream,
+                                             const std::uint32_t firstSample,
+                                             const std::size_t   count,
+                                             float              *pX,
+                                             float              *pY,
+                                             float              *pZ
+                                             );
+
+template
+void cosine_sample_hemisphere_batch< double >(
+                                              const glm::dvec3   &dir,
+                                              const std::uint64_t stream,
+                                              const std::uint32_t firstSample,
+                                              const std::size_t   count,
+                                              double             *pX,
+                                              double             *pY,
+                                              double             *pZ
+                                              );
+
 template
 glm::vec4 intersectSphere< float >(
                                    const glm::vec3 p,
@@ -327,5 +566,41 @@ glm::dvec4 intersectSphere< double >(
                                      const glm::dvec3 d
                                      );
 
+template
+void intersectSpherePacket< float, 4 >(
+                                       const RayPacket< float, 4 > &rays,
+                                       HitPacket< float, 4 >       *pHits
+                                       );
+
+template
+void intersectSpherePacket< float, 8 >(
+                                       const RayPacket< float, 8 > &rays,
+                                       HitPacket< float, 8 >       *pHits
+                                       );
+
+template
+void intersectSpherePacket< float, 16 >(
+                                        const RayPacket< float, 16 > &rays,
+                                        HitPacket< float, 16 >       *pHits
+                                        );
+
+template
+void intersectSpherePacket< double, 4 >(
+                                        const RayPacket< double, 4 > &rays,
+                                        HitPacket< double, 4 >       *pHits
+                                        );
+
+template
+void intersectSpherePacket< double, 8 >(
+                                        const RayPacket< double, 8 > &rays,
+                                        HitPacket< double, 8 >       *pHits
+                                        );
+
+template
+void intersectSpherePacket< double, 16 >(
+                                         const RayPacket< double, 16 > &rays,
+                                         HitPacket< double, 16 >       *pHits
+                                         );
+
 
 } // namespace hit
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <limits>
+#include <cstdint>
+#include <cstddef>
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
 
@@ -9,6 +11,47 @@ namespace hit
 {
 
 
+////////////////////////////////////////////////////////////////
+/// \brief The RayPacket struct
+///
+///        Structure-of-arrays bundle of N rays
+///
+////////////////////////////////////////////////////////////////
+template< typename T, unsigned N >
+struct RayPacket
+{
+
+  alignas( 64 ) T ox[ N ]; ///< ray origin x components
+  alignas( 64 ) T oy[ N ]; ///< ray origin y components
+  alignas( 64 ) T oz[ N ]; ///< ray origin z components
+
+  alignas( 64 ) T dx[ N ]; ///< ray direction x components
+  alignas( 64 ) T dy[ N ]; ///< ray direction y components
+  alignas( 64 ) T dz[ N ]; ///< ray direction z components
+
+};
+
+
+////////////////////////////////////////////////////////////////
+/// \brief The HitPacket struct
+///
+///        Structure-of-arrays counterpart of the vec4 returned
+///        by intersectSphere for each ray of a RayPacket
+///
+////////////////////////////////////////////////////////////////
+template< typename T, unsigned N >
+struct HitPacket
+{
+
+  alignas( 64 ) T nx[ N ]; ///< normal x components
+  alignas( 64 ) T ny[ N ]; ///< normal y components
+  alignas( 64 ) T nz[ N ]; ///< normal z components
+  alignas( 64 ) T t [ N ]; ///< distance to hit (infinity on a miss)
+
+};
+
+
+
 ////////////////////////////////////////////////////////////////
 /// \brief cosine_sample_hemisphere
 /// \return
@@ -21,6 +64,30 @@ glm::tvec3< T > cosine_sample_hemisphere (
                                           );
 
 
+////////////////////////////////////////////////////////////////
+/// \brief cosine_sample_hemisphere_batch
+///
+///        Writes count cosine weighted directions around one
+///        normal into separate x, y and z arrays. The basis is
+///        built once per call and the random numbers come from
+///        a counter based generator: sample i of a stream only
+///        depends on (stream, firstSample + i), so batches can
+///        be generated in any order or on any thread and still
+///        reproduce the same directions.
+///
+////////////////////////////////////////////////////////////////
+template< typename T >
+void cosine_sample_hemisphere_batch (
+                                     const glm::tvec3< T > &dir,         ///< normal of hemisphere plane
+                                     std::uint64_t          stream,      ///< independent random sequence id
+                                     std::uint32_t          firstSample, ///< counter of the first sample
+                                     std::size_t            count,       ///< number of directions
+                                     T                     *pX,          ///< output x components
+                                     T                     *pY,          ///< output y components
+                                     T                     *pZ           ///< output z components
+                                     );
+
+
 ////////////////////////////////////////////////////////////////
 /// \brief intersectSphere
 ///
@@ -40,5 +107,21 @@ glm::tvec4< T > intersectSphere (
                                  );
 
 
+////////////////////////////////////////////////////////////////
+/// \brief intersectSpherePacket
+///
+///        Same intersection as intersectSphere for N rays at a
+///        time (N = 4, 8 or 16). Roots are selected with lane
+///        masks instead of branches so the loops compile to
+///        SIMD code.
+///
+////////////////////////////////////////////////////////////////
+template< typename T, unsigned N >
+void intersectSpherePacket (
+                            const RayPacket< T, N > &rays, ///< ray origins and directions
+                            HitPacket< T, N >       *pHits ///< normals and distances
+                            );
+
+
 
 } // namespace hit
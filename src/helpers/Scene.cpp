@@ -0,0 +1,732 @@
+#include "Scene.hpp"
+
+#include <limits>
+#include <algorithm>
+
+
+namespace hit
+{
+
+
+
+namespace
+{
+
+constexpr unsigned numBins     = 16; // SAH candidate planes per axis (bins - 1)
+constexpr unsigned maxLeafSize = 8;  // larger leaves are always split
+constexpr unsigned maxDepth    = 64; // tree depth limit (and traversal stack size)
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief halfArea
+///
+///        Half the surface area of a box (enough for SAH ratios)
+///
+////////////////////////////////////////////////////////////////
+template< typename T >
+T
+halfArea(
+         const glm::tvec3< T > &minCorner,
+         const glm::tvec3< T > &maxCorner
+         )
+{
+
+  glm::tvec3< T > e = glm::max( maxCorner - minCorner, glm::tvec3< T >( 0.0 ) );
+
+  return e.x * e.y + e.y * e.z + e.z * e.x;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief intersectBounds
+/// \return entry distance of the ray into the box (clamped to
+///         zero when starting inside) or infinity on a miss
+////////////////////////////////////////////////////////////////
+template< typename T >
+T
+intersectBounds(
+                const glm::tvec3< T > &minCorner, ///< lowest box corner
+                const glm::tvec3< T > &maxCorner, ///< highest box corner
+                const glm::tvec3< T > &p,         ///< ray origin point
+                const glm::tvec3< T > &invD       ///< 1 / ray direction
+                )
+{
+
+  glm::tvec3< T > t0 = ( minCorner - p ) * invD;
+  glm::tvec3< T > t1 = ( maxCorner - p ) * invD;
+
+  glm::tvec3< T > tMin = glm::min( t0, t1 );
+  glm::tvec3< T > tMax = glm::max( t0, t1 );
+
+  T tNear = glm::max( glm::max( tMin.x, tMin.y ), glm::max( tMin.z, T( 0.0 ) ) );
+  T tFar  = glm::min( glm::min( tMax.x, tMax.y ), tMax.z );
+
+  return ( tNear <= tFar ? tNear : std::numeric_limits< T >::infinity( ) );
+
+}
+
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::addSphere
+////////////////////////////////////////////////////////////////
+template< typename T >
+void
+Scene< T >::addSphere(
+                      const glm::tvec3< T > &center,
+                      T                      radius
+                      )
+{
+
+  Primitive prim;
+  prim.type   = Primitive::Sphere;
+  prim.a      = center;
+  prim.radius = radius;
+
+  primitives_.push_back( prim );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::addTriangle
+////////////////////////////////////////////////////////////////
+template< typename T >
+void
+Scene< T >::addTriangle(
+                        const glm::tvec3< T > &a,
+                        const glm::tvec3< T > &b,
+                        const glm::tvec3< T > &c
+                        )
+{
+
+  Primitive prim;
+  prim.type   = Primitive::Triangle;
+  prim.a      = a;
+  prim.b      = b;
+  prim.c      = c;
+  prim.radius = T( 0.0 );
+
+  primitives_.push_back( prim );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::addBox
+////////////////////////////////////////////////////////////////
+template< typename T >
+void
+Scene< T >::addBox(
+                   const glm::tvec3< T > &minCorner,
+                   const glm::tvec3< T > &maxCorner
+                   )
+{
+
+  Primitive prim;
+  prim.type   = Primitive::Box;
+  prim.a      = glm::min( minCorner, maxCorner );
+  prim.b      = glm::max( minCorner, maxCorner );
+  prim.radius = T( 0.0 );
+
+  primitives_.push_back( prim );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::build
+////////////////////////////////////////////////////////////////
+template< typename T >
+void
+Scene< T >::build( )
+{
+
+  std::uint32_t numPrims = static_cast< std::uint32_t >( primitives_.size( ) );
+
+  nodes_.clear( );
+  indices_.resize( numPrims );
+  primMins_.resize( numPrims );
+  primMaxs_.resize( numPrims );
+  centroids_.resize( numPrims );
+
+  if ( numPrims == 0 )
+  {
+
+    return;
+
+  }
+
+  //
+  // primitive bounds
+  //
+  for ( std::uint32_t i = 0; i < numPrims; ++i )
+  {
+
+    const Primitive &prim = primitives_[ i ];
+
+    switch ( prim.type )
+    {
+
+    case Primitive::Sphere:
+      primMins_[ i ] = prim.a - glm::tvec3< T >( prim.radius );
+      primMaxs_[ i ] = prim.a + glm::tvec3< T >( prim.radius );
+      break;
+
+    case Primitive::Triangle:
+      primMins_[ i ] = glm::min( prim.a, glm::min( prim.b, prim.c ) );
+      primMaxs_[ i ] = glm::max( prim.a, glm::max( prim.b, prim.c ) );
+      break;
+
+    default:
+      primMins_[ i ] = prim.a;
+      primMaxs_[ i ] = prim.b;
+      break;
+
+    } // switch
+
+    centroids_[ i ] = ( primMins_[ i ] + primMaxs_[ i ] ) * T( 0.5 );
+    indices_[ i ]   = i;
+
+  }
+
+  nodes_.reserve( 2 * numPrims );
+  nodes_.push_back( Node( ) );
+
+  _buildNode( 0, 0, numPrims, 0 );
+
+  //
+  // store primitives in leaf order so every leaf is one
+  // contiguous range
+  //
+  std::vector< Primitive > ordered;
+  ordered.reserve( numPrims );
+
+  for ( std::uint32_t index : indices_ )
+  {
+
+    ordered.push_back( primitives_[ index ] );
+
+  }
+
+  primitives_.swap( ordered );
+
+  indices_.clear( );
+  primMins_.clear( );
+  primMaxs_.clear( );
+  centroids_.clear( );
+
+  nodes_.shrink_to_fit( );
+
+} // Scene::build
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::_buildNode
+///
+///        Binned SAH split of indices_[ first, first + count )
+///
+////////////////////////////////////////////////////////////////
+template< typename T >
+void
+Scene< T >::_buildNode(
+                       std::uint32_t nodeIndex,
+                       std::uint32_t first,
+                       std::uint32_t count,
+                       unsigned      depth
+                       )
+{
+
+  constexpr T INF = std::numeric_limits< T >::infinity( );
+
+  glm::tvec3< T > boundsMin( INF );
+  glm::tvec3< T > boundsMax( -INF );
+  glm::tvec3< T > centroidMin( INF );
+  glm::tvec3< T > centroidMax( -INF );
+
+  for ( std::uint32_t i = first; i < first + count; ++i )
+  {
+
+    std::uint32_t index = indices_[ i ];
+
+    boundsMin   = glm::min( boundsMin, primMins_[ index ] );
+    boundsMax   = glm::max( boundsMax, primMaxs_[ index ] );
+    centroidMin = glm::min( centroidMin, centroids_[ index ] );
+    centroidMax = glm::max( centroidMax, centroids_[ index ] );
+
+  }
+
+  nodes_[ nodeIndex ].boundsMin = boundsMin;
+  nodes_[ nodeIndex ].boundsMax = boundsMax;
+  nodes_[ nodeIndex ].offset    = first;
+  nodes_[ nodeIndex ].count     = count;
+
+  // the traversal stack never holds more than one node per level
+  if ( count <= 1 || depth + 1 >= maxDepth )
+  {
+
+    return;
+
+  }
+
+  //
+  // find the cheapest bin boundary over all axes
+  //
+  T   bestCost  = INF;
+  int bestAxis  = -1;
+  int bestSplit = 0;
+
+  for ( int axis = 0; axis < 3; ++axis )
+  {
+
+    T extent = centroidMax[ axis ] - centroidMin[ axis ];
+
+    if ( extent <= T( 0.0 ) )
+    {
+
+      continue;
+
+    }
+
+    T scale = numBins / extent;
+
+    std::uint32_t   binCounts[ numBins ] = { };
+    glm::tvec3< T > binMins[ numBins ];
+    glm::tvec3< T > binMaxs[ numBins ];
+
+    for ( unsigned b = 0; b < numBins; ++b )
+    {
+
+      binMins[ b ] = glm::tvec3< T >( INF );
+      binMaxs[ b ] = glm::tvec3< T >( -INF );
+
+    }
+
+    for ( std::uint32_t i = first; i < first + count; ++i )
+    {
+
+      std::uint32_t index = indices_[ i ];
+      unsigned      b     = std::min( numBins - 1, static_cast< unsigned >( ( centroids_[ index ][ axis ] - centroidMin[ axis ] ) * scale ) );
+
+      ++binCounts[ b ];
+      binMins[ b ] = glm::min( binMins[ b ], primMins_[ index ] );
+      binMaxs[ b ] = glm::max( binMaxs[ b ], primMaxs_[ index ] );
+
+    }
+
+    // sweep from the right to get the cost of every right side
+    T               rightCosts[ numBins ];
+    glm::tvec3< T > runMin( INF );
+    glm::tvec3< T > runMax( -INF );
+    std::uint32_t   runCount = 0;
+
+    for ( unsigned b = numBins - 1; b > 0; --b )
+    {
+
+      runMin    = glm::min( runMin, binMins[ b ] );
+      runMax    = glm::max( runMax, binMaxs[ b ] );
+      runCount += binCounts[ b ];
+
+      rightCosts[ b ] = ( runCount > 0 ? halfArea( runMin, runMax ) * runCount : T( 0.0 ) );
+
+    }
+
+    runMin   = glm::tvec3< T >( INF );
+    runMax   = glm::tvec3< T >( -INF );
+    runCount = 0;
+
+    for ( unsigned b = 0; b < numBins - 1; ++b )
+    {
+
+      runMin    = glm::min( runMin, binMins[ b ] );
+      runMax    = glm::max( runMax, binMaxs[ b ] );
+      runCount += binCounts[ b ];
+
+      if ( runCount == 0 || runCount == count )
+      {
+
+        continue;
+
+      }
+
+      T cost = halfArea( runMin, runMax ) * runCount + rightCosts[ b + 1 ];
+
+      if ( cost < bestCost )
+      {
+
+        bestCost  = cost;
+        bestAxis  = axis;
+        bestSplit = static_cast< int >( b );
+
+      }
+
+    }
+
+  }
+
+  //
+  // compare against intersecting every primitive in a leaf
+  // (one traversal step costs about as much as one primitive)
+  //
+  T leafCost  = halfArea( boundsMin, boundsMax ) * count;
+  T splitCost = halfArea( boundsMin, boundsMax ) + bestCost;
+
+  if ( bestAxis < 0 || ( splitCost >= leafCost && count <= maxLeafSize ) )
+  {
+
+    // all centroids coincide and the leaf is large: split by count
+    if ( bestAxis < 0 && count > maxLeafSize )
+    {
+
+      std::uint32_t half = count / 2;
+
+      std::uint32_t leftIndex = static_cast< std::uint32_t >( nodes_.size( ) );
+      nodes_.push_back( Node( ) );
+      _buildNode( leftIndex, first, half, depth + 1 );
+
+      std::uint32_t rightIndex = static_cast< std::uint32_t >( nodes_.size( ) );
+      nodes_.push_back( Node( ) );
+      nodes_[ nodeIndex ].offset = rightIndex;
+      nodes_[ nodeIndex ].count  = 0;
+      _buildNode( rightIndex, first + half, count - half, depth + 1 );
+
+    }
+
+    return;
+
+  }
+
+  T scale = numBins / ( centroidMax[ bestAxis ] - centroidMin[ bestAxis ] );
+
+  auto midIter = std::partition(
+                                indices_.begin( ) + first,
+                                indices_.begin( ) + first + count,
+                                [ & ]( std::uint32_t index )
+    {
+
+      unsigned b = std::min( numBins - 1, static_cast< unsigned >( ( centroids_[ index ][ bestAxis ] - centroidMin[ bestAxis ] ) * scale ) );
+      return static_cast< int >( b ) <= bestSplit;
+
+    } );
+
+  std::uint32_t mid = static_cast< std::uint32_t >( midIter - indices_.begin( ) );
+
+  //
+  // left child directly follows this node, right child after
+  // the whole left subtree
+  //
+  std::uint32_t leftIndex = static_cast< std::uint32_t >( nodes_.size( ) );
+  nodes_.push_back( Node( ) );
+  _buildNode( leftIndex, first, mid - first, depth + 1 );
+
+  std::uint32_t rightIndex = static_cast< std::uint32_t >( nodes_.size( ) );
+  nodes_.push_back( Node( ) );
+  nodes_[ nodeIndex ].offset = rightIndex;
+  nodes_[ nodeIndex ].count  = 0;
+  _buildNode( rightIndex, mid, first + count - mid, depth + 1 );
+
+} // Scene::_buildNode
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::_intersectPrimitive
+/// \return true if the primitive is hit at a non-negative
+///         distance (written to pT with its normal)
+////////////////////////////////////////////////////////////////
+template< typename T >
+bool
+Scene< T >::_intersectPrimitive(
+                                const Primitive       &prim,
+                                const glm::tvec3< T > &p,
+                                const glm::tvec3< T > &d,
+                                T                     *pT,
+                                glm::tvec3< T >       *pNormal
+                                )
+{
+
+  constexpr T EPS = T( 1.0e-7 );
+
+  switch ( prim.type )
+  {
+
+  case Primitive::Sphere:
+  {
+
+    glm::tvec3< T > oc = p - prim.a;
+
+    T a    = glm::dot( d, d );
+    T b    = glm::dot( oc, d );
+    T c    = glm::dot( oc, oc ) - prim.radius * prim.radius;
+    T disc = b * b - a * c;
+
+    if ( disc < T( 0.0 ) )
+    {
+
+      return false;
+
+    }
+
+    T root = glm::sqrt( disc );
+    T t    = ( -b - root ) / a;
+
+    if ( t < T( 0.0 ) )
+    {
+
+      t = ( -b + root ) / a;
+
+    }
+
+    if ( t < T( 0.0 ) )
+    {
+
+      return false;
+
+    }
+
+    *pT      = t;
+    *pNormal = ( p + d * t - prim.a ) / prim.radius;
+    return true;
+
+  }
+
+  case Primitive::Triangle:
+  {
+
+    // Moller-Trumbore
+    glm::tvec3< T > e1 = prim.b - prim.a;
+    glm::tvec3< T > e2 = prim.c - prim.a;
+    glm::tvec3< T > pv = glm::cross( d, e2 );
+
+    T det = glm::dot( e1, pv );
+
+    if ( glm::abs( det ) < EPS )
+    {
+
+      return false;
+
+    }
+
+    T               invDet = T( 1.0 ) / det;
+    glm::tvec3< T > tv     = p - prim.a;
+    T               u      = glm::dot( tv, pv ) * invDet;
+
+    if ( u < T( 0.0 ) || u > T( 1.0 ) )
+    {
+
+      return false;
+
+    }
+
+    glm::tvec3< T > qv = glm::cross( tv, e1 );
+    T               v  = glm::dot( d, qv ) * invDet;
+
+    if ( v < T( 0.0 ) || u + v > T( 1.0 ) )
+    {
+
+      return false;
+
+    }
+
+    T t = glm::dot( e2, qv ) * invDet;
+
+    if ( t < T( 0.0 ) )
+    {
+
+      return false;
+
+    }
+
+    *pT      = t;
+    *pNormal = glm::normalize( glm::cross( e1, e2 ) );
+    return true;
+
+  }
+
+  default:
+  {
+
+    // slab test keeping track of which face is entered/exited
+    T   tNear    = -std::numeric_limits< T >::infinity( );
+    T   tFar     =  std::numeric_limits< T >::infinity( );
+    int nearAxis = 0;
+    int farAxis  = 0;
+
+    for ( int axis = 0; axis < 3; ++axis )
+    {
+
+      T invD = T( 1.0 ) / d[ axis ];
+      T t0   = ( prim.a[ axis ] - p[ axis ] ) * invD;
+      T t1   = ( prim.b[ axis ] - p[ axis ] ) * invD;
+
+      if ( t0 > t1 )
+      {
+
+        std::swap( t0, t1 );
+
+      }
+
+      if ( t0 > tNear )
+      {
+
+        tNear    = t0;
+        nearAxis = axis;
+
+      }
+
+      if ( t1 < tFar )
+      {
+
+        tFar    = t1;
+        farAxis = axis;
+
+      }
+
+    }
+
+    if ( tNear > tFar || tFar < T( 0.0 ) )
+    {
+
+      return false;
+
+    }
+
+    // entering face points against the ray, exit face (from inside) with it
+    bool inside = tNear < T( 0.0 );
+    int  axis   = ( inside ? farAxis : nearAxis );
+
+    glm::tvec3< T > normal( 0.0 );
+    normal[ axis ] = ( ( d[ axis ] > T( 0.0 ) ) == inside ? T( 1.0 ) : T( -1.0 ) );
+
+    *pT      = ( inside ? tFar : tNear );
+    *pNormal = normal;
+    return true;
+
+  }
+
+  } // switch
+
+} // Scene::_intersectPrimitive
+
+
+
+////////////////////////////////////////////////////////////////
+/// \brief Scene::intersect
+////////////////////////////////////////////////////////////////
+template< typename T >
+glm::tvec4< T >
+Scene< T >::intersect(
+                      const glm::tvec3< T > &p,
+                      const glm::tvec3< T > &d
+                      ) const
+{
+
+  constexpr T INF = std::numeric_limits< T >::infinity( );
+
+  glm::tvec4< T > n = glm::tvec4< T >( 0.0, 0.0, 0.0, INF );
+
+  if ( nodes_.empty( ) )
+  {
+
+    return n;
+
+  }
+
+  glm::tvec3< T > invD = glm::tvec3< T >( T( 1.0 ) ) / d;
+
+  std::uint32_t stack[ maxDepth ];
+  unsigned      stackSize = 0;
+
+  if ( intersectBounds( nodes_[ 0 ].boundsMin, nodes_[ 0 ].boundsMax, p, invD ) < INF )
+  {
+
+    stack[ stackSize++ ] = 0;
+
+  }
+
+  T               t;
+  glm::tvec3< T > normal;
+
+  while ( stackSize > 0 )
+  {
+
+    const Node &node = nodes_[ stack[ --stackSize ] ];
+
+    if ( node.count > 0 )
+    {
+
+      for ( std::uint32_t i = node.offset; i < node.offset + node.count; ++i )
+      {
+
+        if ( _intersectPrimitive( primitives_[ i ], p, d, &t, &normal ) && t < n.w )
+        {
+
+          n = glm::tvec4< T >( normal, t );
+
+        }
+
+      }
+
+      continue;
+
+    }
+
+    //
+    // visit the nearer child first, skipping children that
+    // start beyond the closest hit found so far
+    //
+    std::uint32_t left  = static_cast< std::uint32_t >( &node - nodes_.data( ) ) + 1;
+    std::uint32_t right = node.offset;
+
+    T tLeft  = intersectBounds( nodes_[ left  ].boundsMin, nodes_[ left  ].boundsMax, p, invD );
+    T tRight = intersectBounds( nodes_[ right ].boundsMin, nodes_[ right ].boundsMax, p, invD );
+
+    if ( tLeft > tRight )
+    {
+
+      std::swap( tLeft, tRight );
+      std::swap( left, right );
+
+    }
+
+    if ( tRight < n.w )
+    {
+
+      stack[ stackSize++ ] = right;
+
+    }
+
+    if ( tLeft < n.w )
+    {
+
+      stack[ stackSize++ ] = left;
+
+    }
+
+  }
+
+  return n;
+
+} // Scene::intersect
+
+
+
+//
+// define allowed templated classes
+//
+
+template class Scene< float >;
+template class Scene< double >;
+
+
+} // namespace hit
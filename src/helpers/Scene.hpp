@@ -0,0 +1,157 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "glm/glm.hpp"
+
+
+namespace hit
+{
+
+
+////////////////////////////////////////////////////////////////
+/// \brief The Scene class
+///
+///        Collection of spheres, triangles and axis-aligned
+///        boxes with a bounding volume hierarchy for closest
+///        hit queries. The hierarchy is built with the surface
+///        area heuristic and stored depth-first in one flat
+///        array (left child directly follows its parent).
+///
+////////////////////////////////////////////////////////////////
+template< typename T >
+class Scene
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief addSphere
+  ////////////////////////////////////////////////////////////////
+  void addSphere (
+                  const glm::tvec3< T > &center, ///< sphere center
+                  T                      radius  ///< sphere radius
+                  );
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief addTriangle
+  ///
+  ///        The normal follows the right hand rule (a, b, c)
+  ///
+  ////////////////////////////////////////////////////////////////
+  void addTriangle (
+                    const glm::tvec3< T > &a, ///< first vertex
+                    const glm::tvec3< T > &b, ///< second vertex
+                    const glm::tvec3< T > &c  ///< third vertex
+                    );
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief addBox
+  ////////////////////////////////////////////////////////////////
+  void addBox (
+               const glm::tvec3< T > &minCorner, ///< lowest corner
+               const glm::tvec3< T > &maxCorner  ///< highest corner
+               );
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief build
+  ///
+  ///        (Re)builds the hierarchy. Must be called after adding
+  ///        primitives and before intersecting.
+  ///
+  ////////////////////////////////////////////////////////////////
+  void build ( );
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief intersect
+  ///
+  ///        Closest hit in the same form as intersectSphere:
+  ///        xyz is the surface normal at the hit and w the ray
+  ///        parameter of the hit (p + w * d). On a miss the
+  ///        normal is zero and w is infinity.
+  ///
+  /// \return
+  ////////////////////////////////////////////////////////////////
+  glm::tvec4< T > intersect (
+                             const glm::tvec3< T > &p, ///< ray origin point
+                             const glm::tvec3< T > &d  ///< ray direction vector
+                             ) const;
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief getNumPrimitives
+  ////////////////////////////////////////////////////////////////
+  size_t getNumPrimitives ( ) const { return primitives_.size( ); }
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief getNumNodes
+  ////////////////////////////////////////////////////////////////
+  size_t getNumNodes ( ) const { return nodes_.size( ); }
+
+
+private:
+
+  /// \brief Primitive
+  struct Primitive
+  {
+
+    enum Type : std::uint32_t
+    {
+      Sphere,
+      Triangle,
+      Box
+    };
+
+    glm::tvec3< T > a;      // sphere center, triangle vertex, box min
+    glm::tvec3< T > b;      // triangle vertex, box max
+    glm::tvec3< T > c;      // triangle vertex
+    T               radius; // sphere radius
+    Type            type;
+
+  };
+
+  /// \brief Node - 32 bytes for floats (two per cache line)
+  struct Node
+  {
+
+    glm::tvec3< T > boundsMin;
+    std::uint32_t   offset;    // first primitive (leaf) or right child (inner)
+    glm::tvec3< T > boundsMax;
+    std::uint32_t   count;     // number of primitives (0 for inner nodes)
+
+  };
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief _buildNode
+  ////////////////////////////////////////////////////////////////
+  void _buildNode (
+                   std::uint32_t nodeIndex,
+                   std::uint32_t first,
+                   std::uint32_t count,
+                   unsigned      depth
+                   );
+
+  ////////////////////////////////////////////////////////////////
+  /// \brief _intersectPrimitive
+  ////////////////////////////////////////////////////////////////
+  static bool _intersectPrimitive (
+                                   const Primitive       &prim,
+                                   const glm::tvec3< T > &p,
+                                   const glm::tvec3< T > &d,
+                                   T                     *pT,
+                                   glm::tvec3< T >       *pNormal
+                                   );
+
+  std::vector< Primitive > primitives_;
+  std::vector< Node >      nodes_;
+
+  // primitive order, bounds and centroids, only needed while building
+  std::vector< std::uint32_t >   indices_;
+  std::vector< glm::tvec3< T > > primMins_;
+  std::vector< glm::tvec3< T > > primMaxs_;
+  std::vector< glm::tvec3< T > > centroids_;
+
+};
+
+
+
+} // namespace hit
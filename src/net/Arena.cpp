@@ -0,0 +1,199 @@
+#include "Arena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined( _WIN32 )
+#include <malloc.h>
+#elif defined( __linux__ )
+#include <sys/mman.h>
+#endif
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr size_t hugePageSize = size_t( 2 ) << 20; // 2 MiB
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Arena::Arena
+////////////////////////////////////////////////////////////////////
+Arena::Arena(
+             size_t capacity,
+             bool   hugePages
+             )
+  : data_         ( nullptr )
+  , capacity_     ( 0 )
+  , used_         ( 0 )
+  , mappedBytes_  ( 0 )
+  , wantHugePages_( hugePages )
+  , hugePages_    ( false )
+{
+
+  _allocate( capacity, hugePages );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Arena::Arena
+////////////////////////////////////////////////////////////////////
+Arena::Arena( const Arena &other )
+  : data_         ( nullptr )
+  , capacity_     ( 0 )
+  , used_         ( other.used_ )
+  , mappedBytes_  ( 0 )
+  , wantHugePages_( other.wantHugePages_ )
+  , hugePages_    ( false )
+{
+
+  _allocate( other.capacity_, other.wantHugePages_ );
+
+  if ( used_ > 0 )
+  {
+
+    std::memcpy( data_, other.data_, used_ );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Arena::~Arena
+////////////////////////////////////////////////////////////////////
+Arena::~Arena( )
+{
+
+#if defined( __linux__ )
+
+  if ( mappedBytes_ > 0 )
+  {
+
+    munmap( data_, mappedBytes_ );
+    return;
+
+  }
+
+#endif
+
+#if defined( _WIN32 )
+  _aligned_free( data_ );
+#else
+  std::free( data_ );
+#endif
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Arena::_allocate
+////////////////////////////////////////////////////////////////////
+void
+Arena::_allocate(
+                 size_t capacity,
+                 bool   hugePages
+                 )
+{
+
+  capacity_ = padded( capacity );
+
+  if ( capacity_ == 0 )
+  {
+
+    return;
+
+  }
+
+#if defined( __linux__ )
+
+  //
+  // explicit huge pages, then transparent huge pages (both only
+  // pay off for arenas of at least one huge page)
+  //
+  if ( hugePages && capacity_ >= hugePageSize )
+  {
+
+    size_t bytes = ( capacity_ + hugePageSize - 1 ) / hugePageSize * hugePageSize;
+    void  *p     = nullptr;
+
+#if defined( MAP_HUGETLB )
+
+    p = mmap( nullptr, bytes, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+
+    if ( p != MAP_FAILED )
+    {
+
+      data_        = static_cast< char* >( p );
+      mappedBytes_ = bytes;
+      hugePages_   = true;
+      return;
+
+    }
+
+#endif
+
+    p = mmap( nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+    if ( p != MAP_FAILED )
+    {
+
+      data_        = static_cast< char* >( p );
+      mappedBytes_ = bytes;
+
+#if defined( MADV_HUGEPAGE )
+      hugePages_ = ( madvise( p, bytes, MADV_HUGEPAGE ) == 0 );
+#endif
+
+      return;
+
+    }
+
+  }
+
+#else
+
+  static_cast< void >( hugePages );
+  static_cast< void >( hugePageSize );
+
+#endif
+
+  void *p = nullptr;
+
+#if defined( _WIN32 )
+  p = _aligned_malloc( capacity_, alignment );
+#else
+  if ( posix_memalign( &p, alignment, capacity_ ) != 0 )
+  {
+    p = nullptr;
+  }
+#endif
+
+  if ( !p )
+  {
+
+    throw std::bad_alloc( );
+
+  }
+
+  // (mmap memory is already zeroed)
+  std::memset( p, 0, capacity_ );
+
+  data_ = static_cast< char* >( p );
+
+} // Arena::_allocate
+
+
+} // namespace net
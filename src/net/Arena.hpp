@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The Arena class
+///
+///        One zero-initialized, 64 byte aligned block of memory
+///        handed out front to back. Everything allocated from it
+///        lives until the arena is destroyed; nothing is freed
+///        individually and no destructors are run, so only
+///        trivially destructible types belong in it.
+///
+///        Huge pages are requested with MAP_HUGETLB where
+///        available, falling back to transparent huge pages and
+///        then to regular pages.
+///
+////////////////////////////////////////////////////////////////////
+class Arena
+{
+
+public:
+
+  static constexpr size_t alignment = 64;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief Arena
+  /// \param capacity - total bytes (every allocation is padded to
+  ///                   the alignment, see padded)
+  /// \param hugePages - try to back the arena with huge pages
+  ////////////////////////////////////////////////////////////////////
+  explicit
+  Arena(
+        size_t capacity  = 0,
+        bool   hugePages = false
+        );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief Arena - deep copy of the other arena's contents
+  ////////////////////////////////////////////////////////////////////
+  Arena( const Arena &other );
+
+  Arena &operator= ( const Arena& ) = delete;
+
+  ~Arena( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief allocate
+  ///
+  ///        Next 'count' objects of the arena (zeroed, not
+  ///        constructed). Throws std::bad_alloc past capacity.
+  ///
+  ////////////////////////////////////////////////////////////////////
+  template< typename T >
+  T *allocate ( size_t count )
+  {
+
+    size_t bytes = padded( sizeof( T ) * count );
+
+    if ( bytes > capacity_ - used_ )
+    {
+
+      throw std::bad_alloc( );
+
+    }
+
+    T *p   = reinterpret_cast< T* >( data_ + used_ );
+    used_ += bytes;
+
+    return p;
+
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief padded - bytes taken by an allocation of 'bytes'
+  ////////////////////////////////////////////////////////////////////
+  static size_t padded ( size_t bytes ) { return ( bytes + alignment - 1 ) / alignment * alignment; }
+
+  char       *data ( )       { return data_; }
+  const char *data ( ) const { return data_; }
+
+  size_t getCapacity ( ) const { return capacity_; }
+  size_t getUsed ( ) const { return used_; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief hasHugePages
+  /// \return true if huge pages were requested and granted
+  ////////////////////////////////////////////////////////////////////
+  bool hasHugePages ( ) const { return hugePages_; }
+
+
+private:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _allocate
+  ////////////////////////////////////////////////////////////////////
+  void _allocate (
+                  size_t capacity,
+                  bool   hugePages
+                  );
+
+  char  *data_;
+  size_t capacity_;
+  size_t used_;
+  size_t mappedBytes_;  // nonzero if data_ came from mmap
+  bool   wantHugePages_;
+  bool   hugePages_;
+
+};
+
+
+} // namespace net
@@ -1,10 +1,42 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
 
 namespace net
 {
 
+constexpr double eta   = 0.15; // default overall net training rate [0.0, 1.0]
+constexpr double alpha = 0.5;  // default momentum - multiplier of last weight change [0.0, n]
+
+/// \brief LearningParams - weight update settings of a net
+struct LearningParams
+{
+
+  double eta   = net::eta;   // overall net training rate [0.0, 1.0]
+  double alpha = net::alpha; // momentum - multiplier of last weight change [0.0, n]
+
+};
+
+/// \brief Precision - weight storage and arithmetic of dense training
+enum class Precision
+{
+
+  Double,   // double weights and arithmetic (default)
+  BFloat16, // bfloat16 weights, fp32 arithmetic and fp32 master weights
+  Half      // IEEE half weights, fp32 arithmetic and fp32 master weights
+
+};
+
+/// \brief OutputHead - output layer activation and training loss
+enum class OutputHead
+{
+
+  Tanh,    // tanh outputs, RMS error (default)
+  Softmax  // softmax outputs, cross entropy loss
+
+};
+
 struct Connection
 {
 
@@ -15,7 +47,44 @@ struct Connection
 
 class Neuron;
 
-/// \brief Layer
-typedef std::vector< Neuron > Layer;
+
+/// \brief Span - fixed size view of contiguous objects
+template< typename T >
+class Span
+{
+
+public:
+
+  Span(
+       T     *first = nullptr,
+       size_t size  = 0
+       )
+    : first_( first )
+    , size_ ( size )
+  {}
+
+  size_t size ( ) const { return size_; }
+  bool  empty ( ) const { return size_ == 0; }
+
+  T *begin ( ) const { return first_; }
+  T *end   ( ) const { return first_ + size_; }
+
+  T &front ( ) const { return first_[ 0 ]; }
+  T &back  ( ) const { return first_[ size_ - 1 ]; }
+
+  T &operator[] ( size_t i ) const { return first_[ i ]; }
+
+
+private:
+
+  T     *first_;
+  size_t size_;
+
+};
+
+
+/// \brief Layer - neurons of one layer padded with zeroed neurons to a whole
+///        number of vectors, stored in the net's arena (biases are kept apart)
+typedef Span< Neuron > Layer;
 
 } // namespace net
@@ -6,8 +6,19 @@
 #include <cmath>
 #include <chrono>
 #include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <type_traits>
+#include <fstream>
+#include <cstdint>
 
 #include "Neuron.hpp"
+#include "Arena.hpp"
+#include "Gemm.hpp"
+#include "MixedPrecision.hpp"
+#include "Softmax.hpp"
 
 namespace net
 {
@@ -24,12 +35,21 @@ public:
   ////////////////////////////////////////////////////////////////////
   /// \brief NetImpl
   /// \param topology
+  /// \param errorSmoothing
+  /// \param hugePages
   ////////////////////////////////////////////////////////////////////
   NetImpl(
           const std::vector< unsigned > &topology,
-          double                         errorSmoothing
+          double                         errorSmoothing,
+          bool                           hugePages
           );
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief NetImpl
+  /// \param other - net to deep copy (arena included)
+  ////////////////////////////////////////////////////////////////////
+  NetImpl( const NetImpl &other );
+
   ////////////////////////////////////////////////////////////////////
   /// \brief feedForward
   /// \param inputVals
@@ -37,6 +57,35 @@ public:
   virtual
   void feedForward ( const std::vector< double > &inputVals ) final;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForwardSparse
+  /// \param inputVals
+  ////////////////////////////////////////////////////////////////////
+  void feedForwardSparse ( const SparseVals &inputVals );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForwardSparse
+  /// \param activeInputs
+  ////////////////////////////////////////////////////////////////////
+  void feedForwardSparse ( const std::vector< unsigned > &activeInputs );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForwardBatch
+  /// \param inputVals
+  /// \param pResultVals
+  /// \param numThreads
+  ////////////////////////////////////////////////////////////////////
+  void feedForwardBatch (
+                         const std::vector< double > &inputVals,
+                         std::vector< double >       *pResultVals,
+                         unsigned                     numThreads
+                         ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief prepareBatch
+  ////////////////////////////////////////////////////////////////////
+  void prepareBatch ( );
+
   ////////////////////////////////////////////////////////////////////
   /// \brief backProp
   /// \param targetVals
@@ -51,318 +100,2476 @@ public:
   virtual
   void getResults ( std::vector< double > *pResultVals ) const final;
 
-  ////////////////////////////////////////////////////////////////////
-  /// \brief getAverageError
-  /// \return
-  ////////////////////////////////////////////////////////////////////
-  virtual
-  double getAverageError ( ) final;
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getAverageError
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  double getAverageError ( ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief clone
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  std::unique_ptr< Net > clone ( ) const final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getTopology
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  std::vector< unsigned > getTopology ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getWeights
+  /// \param layerNum
+  /// \param pWeights
+  ////////////////////////////////////////////////////////////////////
+  void getWeights (
+                   unsigned               layerNum,
+                   std::vector< double > *pWeights
+                   ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setWeights
+  /// \param layerNum
+  /// \param weights
+  /// \param keepMomentum
+  ////////////////////////////////////////////////////////////////////
+  void setWeights (
+                   unsigned                     layerNum,
+                   const std::vector< double > &weights,
+                   bool                         keepMomentum
+                   );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setLearningParams
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  void setLearningParams ( const LearningParams &params );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getLearningParams
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  const LearningParams &getLearningParams ( ) const { return m_params; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getArena
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  const Arena &getArena ( ) const { return m_arena; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setPrecision
+  /// \param precision
+  ////////////////////////////////////////////////////////////////////
+  void setPrecision ( Precision precision );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getPrecision
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  Precision getPrecision ( ) const { return m_precision; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setOutputHead
+  /// \param outputHead
+  ////////////////////////////////////////////////////////////////////
+  void setOutputHead ( OutputHead outputHead ) { m_outputHead = outputHead; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getOutputHead
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  OutputHead getOutputHead ( ) const { return m_outputHead; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setPerfCounters
+  /// \param enabled
+  ////////////////////////////////////////////////////////////////////
+  void setPerfCounters ( bool enabled ) { m_perf.reset( enabled ? new PerfCounters( ) : nullptr ); }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getPerfReport
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  PerfReport getPerfReport ( ) const { return m_perf ? m_perf->getReport( ) : PerfReport( ); }
+
+
+protected:
+
+private:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _feedForwardSparse
+  ////////////////////////////////////////////////////////////////////
+  template< typename IndexFun, typename ValueFun >
+  void _feedForwardSparse (
+                           size_t   numInputs,
+                           IndexFun indexFun,
+                           ValueFun valueFun
+                           );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _forwardHiddenLayers
+  /// \param firstLayer - first layer to propagate into
+  ////////////////////////////////////////////////////////////////////
+  void _forwardHiddenLayers ( unsigned firstLayer );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _activate
+  ///
+  ///        Sets a layer's outputs from its input sums (through the
+  ///        output head for the output layer)
+  ///
+  /// \param layerNum
+  /// \param sums - one per neuron, padding excluded
+  ////////////////////////////////////////////////////////////////////
+  template< typename T >
+  void _activate (
+                  unsigned layerNum,
+                  const T *sums
+                  );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _backPropMixed
+  ///
+  ///        backProp's weight sweep on the mixed precision weights
+  ///        (output gradients already calculated)
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void _backPropMixed ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _catchUpInputRow
+  /// \param index - input neuron whose outgoing weights are brought
+  ///                up to date with the skipped momentum steps
+  ////////////////////////////////////////////////////////////////////
+  void _catchUpInputRow ( unsigned index );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _catchUpInputRows
+  ///
+  ///        Brings every input row up to date before dense use
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void _catchUpInputRows ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _useMixed
+  /// \return true if dense training runs on the 16 bit weights
+  ////////////////////////////////////////////////////////////////////
+  bool _useMixed ( ) const { return m_precision != Precision::Double && !m_sparseInput; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _syncMixedWeights
+  ///
+  ///        Copies the double weights into the mixed precision
+  ///        weights if they changed since the last copy
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void _syncMixedWeights ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _syncDoubleWeights
+  ///
+  ///        Copies the fp32 master weights back into the double
+  ///        weights if mixed precision training changed them
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void _syncDoubleWeights ( );
+
+  /// \brief BatchWeights - every layer's weights packed for feedForwardBatch
+  struct BatchWeights
+  {
+
+    std::vector< PackedMatrix >          weights; // weights[ layerNum - 1 ] feeds layerNum
+    std::vector< std::vector< double > > biases;
+
+  };
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _readWeights
+  ///
+  ///        The weights feeding 'layerNum' as the next dense pass
+  ///        would use them, without writing anything: input rows
+  ///        owing lazy momentum steps are caught up on the fly, and
+  ///        the fp32 master weights are read while the double
+  ///        weights are behind them
+  ///
+  /// \param layerNum - layer in [1, numLayers)
+  /// \param pWeights - filled with one row of topology[ layerNum ]
+  ///                   weights per neuron of the previous layer
+  /// \param pBiases - filled with topology[ layerNum ] biases
+  ////////////////////////////////////////////////////////////////////
+  void _readWeights (
+                     unsigned               layerNum,
+                     std::vector< double > *pWeights,
+                     std::vector< double > *pBiases
+                     ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _packBatch
+  /// \return the current weights packed for feedForwardBatch
+  ////////////////////////////////////////////////////////////////////
+  BatchWeights _packBatch ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _weights
+  /// \return outgoing weight matrix of a layer (one row per neuron)
+  ////////////////////////////////////////////////////////////////////
+  Connection *_weights ( unsigned layerNum ) const { return m_layers[ layerNum ].front( ).getOutputWeights( ); }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _arenaBytes
+  /// \return arena size needed for a topology
+  ////////////////////////////////////////////////////////////////////
+  static size_t _arenaBytes ( const std::vector< unsigned > &topology );
+
+  //
+  // all neurons (activations, gradients) and connections (weights,
+  // momentum), laid out layer by layer: the layer's neurons
+  // followed by its outgoing weight matrix (one row per neuron)
+  // and the biases of the next layer. Layers are padded with
+  // zeroed neurons to a multiple of Gemm::vectorLanes, and their
+  // weights and biases stay zero, so the kernels need no remainder
+  // loops.
+  //
+  Arena m_arena;
+
+  std::vector< unsigned > m_topology; // neurons per layer (padding excluded)
+
+  /// \brief m_layers
+  std::vector< Layer > m_layers; // m_layers[ layerNum ][ neuronNum ]
+
+  std::vector< Connection* > m_biases; // m_biases[ layerNum ] (none for the input layer)
+
+  double m_error;
+  double m_recentAverageError;
+  double m_recentAverageSmoothingFactor;
+
+  LearningParams m_params;
+
+  //
+  // output head (OutputHead::Softmax keeps the latest logits and
+  // their log-sum-exp for the loss)
+  //
+  OutputHead            m_outputHead;
+  std::vector< double > m_logits;
+  std::vector< double > m_probs;
+  double                m_logSumExp;
+
+  // contiguous per layer values for the dense kernels
+  std::vector< double > m_rowVals;  // a layer's outputs
+  std::vector< double > m_colVals;  // next layer's input sums (or gradients)
+  std::vector< double > m_sumVals;  // a layer's sums of weighted downstream gradients
+
+  //
+  // mixed precision state (Precision::BFloat16 or Half): per weight
+  // matrix fp32 master weights and momentum plus a 16 bit copy, in
+  // the same row per neuron layout as the connections but with rows
+  // padded to MixedPrecision::vectorLanes columns. The biases only
+  // have the fp32 values.
+  //
+  struct MixedMatrix
+  {
+
+    size_t    numCols;
+    float    *weights;
+    float    *deltas;
+    uint16_t *lowWeights;
+    float    *biases;
+    float    *biasDeltas;
+
+  };
+
+  Precision                  m_precision;
+  std::unique_ptr< Arena >   m_mixedArena;
+  std::vector< MixedMatrix > m_mixed;       // m_mixed[ layerNum ] feeds layerNum + 1
+  bool                       m_mixedStale;  // double weights changed since the mixed copy
+  bool                       m_doubleStale; // mixed weights trained since the double copy
+
+  std::vector< float > m_rowFloats;
+  std::vector< float > m_colFloats;
+  std::vector< float > m_sumFloats;
+
+  //
+  // sparse input state
+  //
+  bool                              m_sparseInput;    // latest feedForward was sparse
+  std::vector< unsigned >           m_sparseIndices;  // nonzero inputs of latest sparse feedForward
+  std::vector< double >             m_sparseSums;     // first hidden layer input sums
+  unsigned long long                m_sparseStep;     // number of sparse backProp calls
+  std::vector< unsigned long long > m_inputRowSteps;  // m_sparseStep each input row is current at
+  bool                              m_lazyInputRows;  // some input rows are behind m_sparseStep
+
+  //
+  // weights packed by prepareBatch, current while m_batchVersion
+  // matches m_weightsVersion (bumped by every weight change)
+  //
+  BatchWeights       m_batch;
+  unsigned long long m_weightsVersion;
+  unsigned long long m_batchVersion;
+
+  // optional hardware counters per training phase (not copied)
+  std::unique_ptr< PerfCounters > m_perf;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::NetImpl
+////////////////////////////////////////////////////////////////////
+NetImpl::NetImpl(
+                 const std::vector< unsigned > &topology,
+                 double                         errorSmoothing,
+                 bool                           hugePages
+                 )
+  : m_arena( _arenaBytes( topology ), hugePages )
+  , m_topology( topology )
+  , m_biases( topology.size( ), nullptr )
+  , m_error( 0.0 )
+  , m_recentAverageError( 1.0 )
+  , m_recentAverageSmoothingFactor( errorSmoothing )
+  , m_outputHead( OutputHead::Tanh )
+  , m_logits( topology.empty( ) ? 0 : topology.back( ) )
+  , m_probs( topology.empty( ) ? 0 : topology.back( ) )
+  , m_logSumExp( 0.0 )
+  , m_precision( Precision::Double )
+  , m_mixedStale( true )
+  , m_doubleStale( false )
+  , m_sparseInput( false )
+  , m_sparseSums( topology.size( ) > 1 ? Gemm::padLanes( topology[ 1 ] ) : 0 )
+  , m_sparseStep( 0 )
+  , m_inputRowSteps( topology.empty( ) ? 0 : topology[ 0 ], 0 )
+  , m_lazyInputRows( false )
+  , m_weightsVersion( 1 )
+  , m_batchVersion( 0 )
+{
+
+  // net doesn't make sense without at least input and output layers
+  if ( topology.size() < 2 )
+  {
+
+    throw std::runtime_error( "Must provide a topology with at least 2 layers" );
+
+  }
+
+  unsigned maxLayerSize = *std::max_element( topology.begin( ), topology.end( ) );
+
+  m_rowVals.resize( Gemm::padLanes( maxLayerSize ) );
+  m_colVals.resize( Gemm::padLanes( maxLayerSize ) );
+  m_sumVals.resize( Gemm::padLanes( maxLayerSize ) );
+  m_rowFloats.resize( MixedPrecision::padLanes( maxLayerSize ) );
+  m_colFloats.resize( MixedPrecision::padLanes( maxLayerSize ) );
+  m_sumFloats.resize( MixedPrecision::padLanes( maxLayerSize ) );
+
+  static_assert( std::is_trivially_copyable< Neuron >::value
+                 && std::is_trivially_destructible< Neuron >::value,
+                 "Neurons live in the arena and are copied bytewise with it" );
+
+  unsigned numLayers = topology.size( );
+
+  m_layers.reserve( numLayers );
+
+  for ( unsigned layerNum = 0; layerNum < numLayers; ++layerNum )
+  {
+
+    unsigned numNeurons = static_cast< unsigned >( Gemm::padLanes( topology[ layerNum ] ) );
+    unsigned numOutputs = ( layerNum == topology.size( ) - 1 ? 0 : topology[ layerNum + 1 ] );
+    unsigned rowStride  = static_cast< unsigned >( Gemm::padLanes( numOutputs ) );
+
+    Neuron     *neurons     = m_arena.allocate< Neuron >( numNeurons );
+    Connection *connections = m_arena.allocate< Connection >( numNeurons * rowStride );
+
+    // fill layer with neurons (padding neurons get no weights)
+    for ( unsigned neuronNum = 0; neuronNum < numNeurons; ++neuronNum )
+    {
+
+      unsigned neuronOutputs = ( neuronNum < topology[ layerNum ] ? numOutputs : 0 );
+
+      new ( neurons + neuronNum ) Neuron( connections + neuronNum * rowStride, neuronOutputs, neuronNum );
+
+    }
+
+    m_layers.push_back( Layer( neurons, numNeurons ) );
+
+    //
+    // biases of the next layer, drawn right after this layer's
+    // weights (where the bias neuron's row used to be)
+    //
+    if ( numOutputs > 0 )
+    {
+
+      Connection *biases = m_arena.allocate< Connection >( rowStride );
+
+      for ( unsigned c = 0; c < numOutputs; ++c )
+      {
+
+        biases[ c ].weight = Neuron::randomWeight( );
+
+      }
+
+      m_biases[ layerNum + 1 ] = biases;
+
+    }
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::NetImpl
+////////////////////////////////////////////////////////////////////
+NetImpl::NetImpl( const NetImpl &other )
+  : Net( other )
+  , m_arena( other.m_arena )
+  , m_topology( other.m_topology )
+  , m_error( other.m_error )
+  , m_recentAverageError( other.m_recentAverageError )
+  , m_recentAverageSmoothingFactor( other.m_recentAverageSmoothingFactor )
+  , m_params( other.m_params )
+  , m_outputHead( other.m_outputHead )
+  , m_logits( other.m_logits )
+  , m_probs( other.m_probs )
+  , m_logSumExp( other.m_logSumExp )
+  , m_rowVals( other.m_rowVals.size( ) )
+  , m_colVals( other.m_colVals.size( ) )
+  , m_sumVals( other.m_sumVals.size( ) )
+  , m_precision( other.m_precision )
+  , m_mixedStale( other.m_mixedStale )
+  , m_doubleStale( other.m_doubleStale )
+  , m_rowFloats( other.m_rowFloats.size( ) )
+  , m_colFloats( other.m_colFloats.size( ) )
+  , m_sumFloats( other.m_sumFloats.size( ) )
+  , m_sparseInput( other.m_sparseInput )
+  , m_sparseIndices( other.m_sparseIndices )
+  , m_sparseSums( other.m_sparseSums )
+  , m_sparseStep( other.m_sparseStep )
+  , m_inputRowSteps( other.m_inputRowSteps )
+  , m_lazyInputRows( other.m_lazyInputRows )
+  , m_batch( other.m_batch )
+  , m_weightsVersion( other.m_weightsVersion )
+  , m_batchVersion( other.m_batchVersion )
+{
+
+  //
+  // same layout in the copied arena
+  //
+  const char *oldBase = other.m_arena.data( );
+  char       *newBase = m_arena.data( );
+
+  for ( const Connection *biases : other.m_biases )
+  {
+
+    m_biases.push_back( biases ? reinterpret_cast< Connection* >( newBase + ( reinterpret_cast< const char* >( biases ) - oldBase ) )
+                               : nullptr );
+
+  }
+
+  m_layers.reserve( other.m_layers.size( ) );
+
+  for ( const Layer &layer : other.m_layers )
+  {
+
+    std::ptrdiff_t offset  = reinterpret_cast< const char* >( layer.begin( ) ) - oldBase;
+    Neuron        *neurons = reinterpret_cast< Neuron* >( newBase + offset );
+
+    m_layers.push_back( Layer( neurons, layer.size( ) ) );
+
+    for ( Neuron &neuron : m_layers.back( ) )
+    {
+
+      neuron.relocate( oldBase, newBase );
+
+    }
+
+  }
+
+  if ( other.m_mixedArena )
+  {
+
+    m_mixedArena.reset( new Arena( *other.m_mixedArena ) );
+
+    const char *oldMixed = other.m_mixedArena->data( );
+    char       *newMixed = m_mixedArena->data( );
+
+    auto relocate = [ & ]( auto *p )
+    {
+
+      return reinterpret_cast< decltype( p ) >( newMixed + ( reinterpret_cast< const char* >( p ) - oldMixed ) );
+
+    };
+
+    for ( const MixedMatrix &matrix : other.m_mixed )
+    {
+
+      m_mixed.push_back( MixedMatrix{
+                                     matrix.numCols,
+                                     relocate( matrix.weights ),
+                                     relocate( matrix.deltas ),
+                                     relocate( matrix.lowWeights ),
+                                     relocate( matrix.biases ),
+                                     relocate( matrix.biasDeltas )
+                                     } );
+
+    }
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_arenaBytes
+////////////////////////////////////////////////////////////////////
+size_t
+NetImpl::_arenaBytes( const std::vector< unsigned > &topology )
+{
+
+  size_t bytes = 0;
+
+  for ( size_t layerNum = 0; layerNum < topology.size( ); ++layerNum )
+  {
+
+    size_t numNeurons = Gemm::padLanes( topology[ layerNum ] );
+    size_t rowStride  = ( layerNum + 1 == topology.size( ) ? 0 : Gemm::padLanes( topology[ layerNum + 1 ] ) );
+
+    bytes += Arena::padded( sizeof( Neuron ) * numNeurons );
+    bytes += Arena::padded( sizeof( Connection ) * numNeurons * rowStride );
+    bytes += Arena::padded( sizeof( Connection ) * rowStride ); // next layer's biases
+
+  }
+
+  return bytes;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::feedForward
+/// \param inputVals
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::feedForward( const std::vector< double > &inputVals )
+{
+
+  assert( inputVals.size( ) == m_topology.front( ) );
+
+  PerfScope perf( m_perf.get( ), PerfPhase::Forward );
+
+  // dense propagation reads every first layer weight
+  _catchUpInputRows( );
+  m_sparseInput = false;
+
+  if ( _useMixed( ) )
+  {
+
+    _syncMixedWeights( );
+
+  }
+  else
+  {
+
+    _syncDoubleWeights( );
+
+  }
+
+  //
+  // assign (latch) the input values into the input neurons
+  //
+  for ( unsigned i = 0; i < inputVals.size( ); ++i )
+  {
+
+    m_layers[ 0 ][ i ].setOutputVal( inputVals[ i ] );
+
+  }
+
+  //
+  // forward propogate
+  //
+  // start at one because first layer already set
+  _forwardHiddenLayers( 1 );
+
+} // NetImpl::feedForward
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::feedForwardSparse
+/// \param inputVals
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::feedForwardSparse( const SparseVals &inputVals )
+{
+
+  _feedForwardSparse(
+                     inputVals.size( ),
+                     [ &inputVals ]( size_t i ) { return inputVals[ i ].first;  },
+                     [ &inputVals ]( size_t i ) { return inputVals[ i ].second; }
+                     );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::feedForwardSparse
+/// \param activeInputs
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::feedForwardSparse( const std::vector< unsigned > &activeInputs )
+{
+
+  _feedForwardSparse(
+                     activeInputs.size( ),
+                     [ &activeInputs ]( size_t i ) { return activeInputs[ i ]; },
+                     [ ]( size_t ) { return 1.0; }
+                     );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_feedForwardSparse
+///
+///        Accumulates only the first layer weight rows of the
+///        nonzero inputs (onto the biases) instead of a full
+///        dot product per first layer neuron
+///
+////////////////////////////////////////////////////////////////////
+template< typename IndexFun, typename ValueFun >
+void
+NetImpl::_feedForwardSparse(
+                            size_t   numInputs,
+                            IndexFun indexFun,
+                            ValueFun valueFun
+                            )
+{
+
+  PerfScope perf( m_perf.get( ), PerfPhase::Forward );
+
+  // sparse input runs on the double weights
+  _syncDoubleWeights( );
+
+  Layer &inputLayer = m_layers[ 0 ];
+
+  //
+  // clear the inputs latched by the previous call so the input
+  // layer always holds the full (mostly zero) input vector
+  //
+  if ( m_sparseInput )
+  {
+
+    for ( unsigned index : m_sparseIndices )
+    {
+
+      inputLayer[ index ].setOutputVal( 0.0 );
+
+    }
+
+  }
+  else
+  {
+
+    for ( unsigned i = 0; i < m_topology.front( ); ++i )
+    {
+
+      inputLayer[ i ].setOutputVal( 0.0 );
+
+    }
+
+  }
+
+  m_sparseInput = true;
+  m_sparseIndices.clear( );
+
+  // start from the biases
+  for ( size_t c = 0; c < m_sparseSums.size( ); ++c )
+  {
+
+    m_sparseSums[ c ] = m_biases[ 1 ][ c ].weight;
+
+  }
+
+  for ( size_t i = 0; i < numInputs; ++i )
+  {
+
+    unsigned index = indexFun( i );
+    double   val   = valueFun( i );
+
+    assert( index < m_topology.front( ) );
+
+    _catchUpInputRow( index );
+
+    inputLayer[ index ].setOutputVal( val );
+    inputLayer[ index ].accumulateOutputs( val, &m_sparseSums );
+
+    m_sparseIndices.push_back( index );
+
+  }
+
+  _activate( 1, m_sparseSums.data( ) );
+  _forwardHiddenLayers( 2 );
+
+} // NetImpl::_feedForwardSparse
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::feedForwardBatch
+///
+///        Streams tiles of samples through all layers on worker
+///        threads, with the weights packed for Gemm::multiply by
+///        prepareBatch (or packed once for this call if they
+///        changed since). Only reads the net, so any number of
+///        calls may run at once.
+///
+/// \param inputVals
+/// \param pResultVals
+/// \param numThreads
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::feedForwardBatch(
+                          const std::vector< double > &inputVals,
+                          std::vector< double >       *pResultVals,
+                          unsigned                     numThreads
+                          ) const
+{
+
+  constexpr size_t tileSize = 128; // samples per tile
+
+  size_t numInputs  = m_topology.front( );
+  size_t numOutputs = m_topology.back( );
+  size_t numSamples = inputVals.size( ) / numInputs;
+
+  assert( inputVals.size( ) == numSamples * numInputs );
+
+  pResultVals->resize( numSamples * numOutputs );
+
+  if ( numSamples == 0 )
+  {
+
+    return;
+
+  }
+
+  BatchWeights        localBatch;
+  const BatchWeights *pBatch = &m_batch;
+
+  if ( m_batchVersion != m_weightsVersion )
+  {
+
+    localBatch = _packBatch( );
+    pBatch     = &localBatch;
+
+  }
+
+  const std::vector< PackedMatrix >          &weights = pBatch->weights;
+  const std::vector< std::vector< double > > &biases  = pBatch->biases;
+
+  size_t maxWidth = *std::max_element( m_topology.begin( ), m_topology.end( ) );
+
+  //
+  // each tile runs through every layer while its activations
+  // are still in cache
+  //
+  auto runTile = [ & ]( size_t begin, size_t end, std::vector< double > *pScratch )
+  {
+
+    std::vector< double > &scratch = *pScratch;
+    size_t                 count   = end - begin;
+
+    double *in  = scratch.data( );
+    double *out = scratch.data( ) + tileSize * maxWidth;
+
+    std::copy( inputVals.data( ) + begin * numInputs,
+               inputVals.data( ) + end * numInputs,
+               in );
+
+    size_t width = numInputs;
+
+    for ( unsigned layerNum = 1; layerNum < m_layers.size( ); ++layerNum )
+    {
+
+      const std::vector< double > &bias    = biases[ layerNum - 1 ];
+      size_t                       numCols = bias.size( );
+
+      for ( size_t s = 0; s < count; ++s )
+      {
+
+        std::copy( bias.begin( ), bias.end( ), out + s * numCols );
+
+      }
+
+      MatrixView inView = { in, width, 1 };
+
+      Gemm::multiply( count, inView, weights[ layerNum - 1 ], out, numCols, true );
+
+      if ( layerNum + 1 == m_layers.size( ) && m_outputHead == OutputHead::Softmax )
+      {
+
+        for ( size_t s = 0; s < count; ++s )
+        {
+
+          Softmax::forward( numCols, out + s * numCols, out + s * numCols );
+
+        }
+
+      }
+      else
+      {
+
+        for ( size_t i = 0; i < count * numCols; ++i )
+        {
+
+          out[ i ] = std::tanh( out[ i ] );
+
+        }
+
+      }
+
+      std::swap( in, out );
+      width = numCols;
+
+    }
+
+    std::copy( in, in + count * numOutputs, pResultVals->data( ) + begin * numOutputs );
+
+  };
+
+  size_t numTiles = ( numSamples + tileSize - 1 ) / tileSize;
+
+  if ( numThreads == 0 )
+  {
+
+    numThreads = std::max( std::thread::hardware_concurrency( ), 1u );
+
+  }
+
+  numThreads = static_cast< unsigned >( std::min< size_t >( numThreads, numTiles ) );
+
+  //
+  // threads pull tiles off a shared counter
+  //
+  std::atomic< size_t > nextTile( 0 );
+
+  auto worker = [ & ]( )
+  {
+
+    std::vector< double > scratch( 2 * tileSize * maxWidth );
+
+    for ( size_t tile = nextTile++; tile < numTiles; tile = nextTile++ )
+    {
+
+      size_t begin = tile * tileSize;
+      runTile( begin, std::min( begin + tileSize, numSamples ), &scratch );
+
+    }
+
+  };
+
+  std::vector< std::future< void > > futures;
+
+  for ( unsigned t = 1; t < numThreads; ++t )
+  {
+
+    futures.push_back( std::async( std::launch::async, worker ) );
+
+  }
+
+  worker( );
+
+  for ( auto &future : futures )
+  {
+
+    future.get( );
+
+  }
+
+} // NetImpl::feedForwardBatch
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::prepareBatch
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::prepareBatch( )
+{
+
+  if ( m_batchVersion != m_weightsVersion )
+  {
+
+    m_batch        = _packBatch( );
+    m_batchVersion = m_weightsVersion;
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_packBatch
+/// \return
+////////////////////////////////////////////////////////////////////
+NetImpl::BatchWeights
+NetImpl::_packBatch( ) const
+{
+
+  BatchWeights          batch;
+  std::vector< double > weights;
+
+  batch.biases.resize( m_layers.size( ) - 1 );
+
+  // (padding left out)
+  for ( unsigned layerNum = 1; layerNum < m_layers.size( ); ++layerNum )
+  {
+
+    size_t numRows = m_topology[ layerNum - 1 ];
+    size_t numCols = m_topology[ layerNum ];
+
+    _readWeights( layerNum, &weights, &batch.biases[ layerNum - 1 ] );
+
+    MatrixView view = { weights.data( ), numCols, 1 };
+
+    batch.weights.push_back( PackedMatrix( numRows, numCols, view ) );
+
+  }
+
+  return batch;
+
+} // NetImpl::_packBatch
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_readWeights
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_readWeights(
+                      unsigned               layerNum,
+                      std::vector< double > *pWeights,
+                      std::vector< double > *pBiases
+                      ) const
+{
+
+  size_t            numRows     = m_topology[ layerNum - 1 ];
+  size_t            numCols     = m_topology[ layerNum ];
+  size_t            rowStride   = m_layers[ layerNum ].size( );
+  const Connection *connections = _weights( layerNum - 1 );
+  const Connection *biases      = m_biases[ layerNum ];
+
+  pWeights->resize( numRows * numCols );
+  pBiases->resize( numCols );
+
+  if ( m_doubleStale )
+  {
+
+    // same conversion as _syncDoubleWeights
+    const MixedMatrix &matrix = m_mixed[ layerNum - 1 ];
+
+    for ( size_t r = 0; r < numRows; ++r )
+    {
+
+      for ( size_t c = 0; c < numCols; ++c )
+      {
+
+        ( *pWeights )[ r * numCols + c ] = matrix.weights[ r * matrix.numCols + c ];
+
+      }
+
+    }
+
+    for ( size_t c = 0; c < numCols; ++c )
+    {
+
+      ( *pBiases )[ c ] = matrix.biases[ c ];
+
+    }
+
+    return;
+
+  }
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    const Connection *row = connections + r * rowStride;
+    double           *out = pWeights->data( ) + r * numCols;
+
+    if ( layerNum == 1 && m_lazyInputRows && m_inputRowSteps[ r ] != m_sparseStep )
+    {
+
+      // same arithmetic as Neuron::catchUpMomentum
+      double momentumSum = Neuron::idleMomentumSum( m_sparseStep - m_inputRowSteps[ r ], m_params );
+
+      for ( size_t c = 0; c < numCols; ++c )
+      {
+
+        out[ c ] = row[ c ].weight + row[ c ].deltaWeight * momentumSum;
+
+      }
+
+    }
+    else
+    {
+
+      for ( size_t c = 0; c < numCols; ++c )
+      {
+
+        out[ c ] = row[ c ].weight;
+
+      }
+
+    }
+
+  }
+
+  for ( size_t c = 0; c < numCols; ++c )
+  {
+
+    ( *pBiases )[ c ] = biases[ c ].weight;
+
+  }
+
+} // NetImpl::_readWeights
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_forwardHiddenLayers
+/// \param firstLayer
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_forwardHiddenLayers( unsigned firstLayer )
+{
+
+  double *x = m_rowVals.data( );
+  double *y = m_colVals.data( );
+
+  float *xFloats = m_rowFloats.data( );
+  float *yFloats = m_colFloats.data( );
+
+  bool mixed = _useMixed( );
+
+  for ( unsigned layerNum = firstLayer; layerNum < m_layers.size( ); ++layerNum )
+  {
+
+    Layer &prevLayer = m_layers[ layerNum - 1 ];
+    Layer &currLayer = m_layers[ layerNum ];
+
+    if ( mixed )
+    {
+
+      for ( unsigned n = 0; n < prevLayer.size( ); ++n )
+      {
+
+        xFloats[ n ] = static_cast< float >( prevLayer[ n ].getOutputVal( ) );
+
+      }
+
+      const MixedMatrix &matrix = m_mixed[ layerNum - 1 ];
+
+      MixedPrecision::multiplyVector(
+                                     m_precision,
+                                     prevLayer.size( ),
+                                     matrix.numCols,
+                                     xFloats,
+                                     matrix.lowWeights,
+                                     matrix.biases,
+                                     yFloats
+                                     );
+
+      _activate( layerNum, yFloats );
+
+      continue;
+
+    }
+
+    for ( unsigned n = 0; n < prevLayer.size( ); ++n )
+    {
+
+      x[ n ] = prevLayer[ n ].getOutputVal( );
+
+    }
+
+    Gemm::multiplyVector( prevLayer.size( ), currLayer.size( ), x, _weights( layerNum - 1 ), m_biases[ layerNum ], y );
+
+    _activate( layerNum, y );
+
+  }
+
+} // NetImpl::_forwardHiddenLayers
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_activate
+/// \param layerNum
+/// \param sums
+////////////////////////////////////////////////////////////////////
+template< typename T >
+void
+NetImpl::_activate(
+                   unsigned layerNum,
+                   const T *sums
+                   )
+{
+
+  Layer &layer = m_layers[ layerNum ];
+
+  if ( layerNum + 1 < m_layers.size( ) || m_outputHead == OutputHead::Tanh )
+  {
+
+    for ( unsigned n = 0; n < m_topology[ layerNum ]; ++n )
+    {
+
+      layer[ n ].activate( sums[ n ] );
+
+    }
+
+    return;
+
+  }
+
+  std::copy( sums, sums + m_logits.size( ), m_logits.begin( ) );
+
+  m_logSumExp = Softmax::forward( m_logits.size( ), m_logits.data( ), m_probs.data( ) );
+
+  for ( unsigned n = 0; n < m_logits.size( ); ++n )
+  {
+
+    layer[ n ].setOutputVal( m_probs[ n ] );
+
+  }
+
+} // NetImpl::_activate
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::backProp
+/// \param targetVals
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::backProp( const std::vector< double > &targetVals )
+{
+
+  //
+  // calculate overall net error (RMS of output neuron errors)
+  //
+  Layer   &outputLayer = m_layers.back( );
+  unsigned numOutputs  = m_topology.back( );
+
+  assert( targetVals.size( ) == numOutputs );
+
+  PerfScope perf( m_perf.get( ), PerfPhase::Backward );
+
+  if ( m_outputHead == OutputHead::Softmax )
+  {
+
+    //
+    // cross entropy loss and output gradients in one pass
+    //
+    double *gradients = m_colVals.data( );
+
+    m_error = Softmax::crossEntropy(
+                                    m_logits.size( ),
+                                    m_logits.data( ),
+                                    m_logSumExp,
+                                    m_probs.data( ),
+                                    targetVals.data( ),
+                                    gradients
+                                    );
+
+    for ( unsigned n = 0; n < numOutputs; ++n )
+    {
+
+      outputLayer[ n ].setGradient( gradients[ n ] );
+
+    }
+
+  }
+  else
+  {
+
+    // root mean square error
+    m_error = 0.0;
+
+    for ( unsigned n = 0; n < numOutputs; ++n )
+    {
+
+      double delta = targetVals[ n ] - outputLayer[ n ].getOutputVal( );
+      m_error += delta * delta;
+
+    }
+
+    m_error /= numOutputs;
+    m_error  = std::sqrt( m_error );
+
+    //
+    // calculate output layer gradients
+    //
+    for ( unsigned n = 0; n < numOutputs; ++n )
+    {
+
+      outputLayer[ n ].calcOutputGradients( targetVals[ n ] );
+
+    }
+
+  }
+
+  // recent average measurement
+  m_recentAverageError = ( m_recentAverageError * m_recentAverageSmoothingFactor )
+                         + ( m_error * ( 1.0 - m_recentAverageSmoothingFactor ) );
+
+  // the sweeps below propagate the hidden gradients and update the
+  // weights together, so both count as the update phase
+  perf.next( PerfPhase::Update );
+
+  ++m_weightsVersion;
+
+  if ( _useMixed( ) )
+  {
+
+    _backPropMixed( );
+    return;
+
+  }
+
+  double *rowVals = m_rowVals.data( );
+  double *colVals = m_colVals.data( );
+  double *sumVals = m_sumVals.data( );
+
+  // the mixed precision copy no longer matches
+  m_mixedStale = true;
+
+  //
+  // one pass over each weight matrix from the output back: the
+  // previous layer's gradients are summed from the weights as they
+  // were before this step, and the weights are updated in the
+  // same sweep
+  //
+  // (after sparse input the first layer is updated row by row below)
+  unsigned lastLayer = ( m_sparseInput ? 1 : 0 );
+
+  for ( unsigned layerNum = m_layers.size( ) - 1; layerNum > lastLayer; --layerNum )
+  {
+
+    Layer &layer     = m_layers[ layerNum     ];
+    Layer &prevLayer = m_layers[ layerNum - 1 ];
+
+    for ( unsigned n = 0; n < prevLayer.size( ); ++n )
+    {
+
+      rowVals[ n ] = prevLayer[ n ].getOutputVal( );
+
+    }
+
+    for ( unsigned n = 0; n < layer.size( ); ++n )
+    {
+
+      colVals[ n ] = layer[ n ].getGradient( );
+
+    }
+
+    Gemm::updateBiases( layer.size( ), colVals, m_biases[ layerNum ], m_params );
+
+    // input neurons don't need gradients
+    if ( layerNum == 1 )
+    {
+
+      Gemm::updateWeights(
+                          prevLayer.size( ),
+                          layer.size( ),
+                          rowVals,
+                          colVals,
+                          _weights( layerNum - 1 ),
+                          m_params
+                          );
+
+    }
+    else
+    {
+
+      Gemm::updateWeightsAndPropagate(
+                                      prevLayer.size( ),
+                                      layer.size( ),
+                                      rowVals,
+                                      colVals,
+                                      _weights( layerNum - 1 ),
+                                      m_params,
+                                      sumVals
+                                      );
+
+      for ( unsigned n = 0; n < m_topology[ layerNum - 1 ]; ++n )
+      {
+
+        prevLayer[ n ].calcHiddenGradients( sumVals[ n ] );
+
+      }
+
+    }
+
+  }
+
+  if ( m_sparseInput )
+  {
+
+    Layer &inputLayer = m_layers[ 0 ];
+    Layer &firstLayer = m_layers[ 1 ];
+
+    for ( unsigned n = 0; n < firstLayer.size( ); ++n )
+    {
+
+      colVals[ n ] = firstLayer[ n ].getGradient( );
+
+    }
+
+    Gemm::updateBiases( firstLayer.size( ), colVals, m_biases[ 1 ], m_params );
+
+    ++m_sparseStep;
+
+    for ( unsigned index : m_sparseIndices )
+    {
+
+      inputLayer[ index ].updateOutputWeights( firstLayer, m_params );
+      m_inputRowSteps[ index ] = m_sparseStep;
+
+    }
+
+    // every other row skipped this step's momentum update
+    m_lazyInputRows = true;
+
+  }
+
+} // NetImpl::backProp
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_backPropMixed
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_backPropMixed( )
+{
+
+  float *rowFloats = m_rowFloats.data( );
+  float *colFloats = m_colFloats.data( );
+  float *sumFloats = m_sumFloats.data( );
+
+  for ( unsigned layerNum = m_layers.size( ) - 1; layerNum > 0; --layerNum )
+  {
+
+    Layer       &layer     = m_layers[ layerNum     ];
+    Layer       &prevLayer = m_layers[ layerNum - 1 ];
+    MixedMatrix &matrix    = m_mixed [ layerNum - 1 ];
+
+    for ( unsigned n = 0; n < prevLayer.size( ); ++n )
+    {
+
+      rowFloats[ n ] = static_cast< float >( prevLayer[ n ].getOutputVal( ) );
+
+    }
+
+    for ( unsigned n = 0; n < layer.size( ); ++n )
+    {
+
+      colFloats[ n ] = static_cast< float >( layer[ n ].getGradient( ) );
+
+    }
+
+    std::fill( colFloats + layer.size( ), colFloats + matrix.numCols, 0.0f );
+
+    MixedPrecision::updateBiases( matrix.numCols, colFloats, matrix.biases, matrix.biasDeltas, m_params );
+
+    // input neurons don't need gradients
+    MixedPrecision::updateWeights(
+                                  m_precision,
+                                  prevLayer.size( ),
+                                  matrix.numCols,
+                                  rowFloats,
+                                  colFloats,
+                                  matrix.weights,
+                                  matrix.deltas,
+                                  matrix.lowWeights,
+                                  m_params,
+                                  ( layerNum == 1 ? nullptr : sumFloats )
+                                  );
+
+    if ( layerNum > 1 )
+    {
+
+      for ( unsigned n = 0; n < m_topology[ layerNum - 1 ]; ++n )
+      {
+
+        prevLayer[ n ].calcHiddenGradients( sumFloats[ n ] );
+
+      }
+
+    }
+
+  }
+
+  m_doubleStale = true;
+
+} // NetImpl::_backPropMixed
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_syncMixedWeights
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_syncMixedWeights( )
+{
+
+  if ( !m_mixedStale )
+  {
+
+    return;
+
+  }
+
+  for ( unsigned layerNum = 0; layerNum < m_mixed.size( ); ++layerNum )
+  {
+
+    const Connection *connections = _weights( layerNum );
+    const Connection *biases      = m_biases[ layerNum + 1 ];
+    MixedMatrix      &matrix      = m_mixed[ layerNum ];
+    size_t            numRows     = m_layers[ layerNum ].size( );
+    size_t            numCols     = m_layers[ layerNum + 1 ].size( ); // mixed rows may be padded further
+
+    for ( size_t r = 0; r < numRows; ++r )
+    {
+
+      for ( size_t c = 0; c < numCols; ++c )
+      {
+
+        matrix.weights[ r * matrix.numCols + c ] = static_cast< float >( connections[ r * numCols + c ].weight );
+        matrix.deltas [ r * matrix.numCols + c ] = static_cast< float >( connections[ r * numCols + c ].deltaWeight );
+
+      }
+
+    }
+
+    for ( size_t c = 0; c < numCols; ++c )
+    {
+
+      matrix.biases    [ c ] = static_cast< float >( biases[ c ].weight );
+      matrix.biasDeltas[ c ] = static_cast< float >( biases[ c ].deltaWeight );
+
+    }
+
+    MixedPrecision::convert( m_precision, numRows * matrix.numCols, matrix.weights, matrix.lowWeights );
+
+  }
+
+  m_mixedStale = false;
+
+} // NetImpl::_syncMixedWeights
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_syncDoubleWeights
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_syncDoubleWeights( )
+{
+
+  if ( !m_doubleStale )
+  {
+
+    return;
+
+  }
+
+  for ( unsigned layerNum = 0; layerNum < m_mixed.size( ); ++layerNum )
+  {
+
+    Connection        *connections = _weights( layerNum );
+    Connection        *biases      = m_biases[ layerNum + 1 ];
+    const MixedMatrix &matrix      = m_mixed[ layerNum ];
+    size_t             numRows     = m_layers[ layerNum ].size( );
+    size_t             numCols     = m_layers[ layerNum + 1 ].size( );
+
+    for ( size_t r = 0; r < numRows; ++r )
+    {
+
+      for ( size_t c = 0; c < numCols; ++c )
+      {
+
+        connections[ r * numCols + c ].weight      = matrix.weights[ r * matrix.numCols + c ];
+        connections[ r * numCols + c ].deltaWeight = matrix.deltas [ r * matrix.numCols + c ];
+
+      }
+
+    }
+
+    for ( size_t c = 0; c < numCols; ++c )
+    {
+
+      biases[ c ].weight      = matrix.biases    [ c ];
+      biases[ c ].deltaWeight = matrix.biasDeltas[ c ];
+
+    }
+
+  }
+
+  m_doubleStale = false;
+
+} // NetImpl::_syncDoubleWeights
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::setPrecision
+///
+///        The mixed precision weights are allocated on first use
+///        and filled from the double weights lazily
+///
+/// \param precision
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::setPrecision( Precision precision )
+{
+
+  _syncDoubleWeights( );
+
+  m_precision  = precision;
+  m_mixedStale = true;
+
+  if ( precision == Precision::Double || m_mixedArena )
+  {
+
+    return;
+
+  }
+
+  size_t bytes = 0;
+
+  for ( unsigned layerNum = 0; layerNum + 1 < m_layers.size( ); ++layerNum )
+  {
+
+    size_t numCols = MixedPrecision::padLanes( m_topology[ layerNum + 1 ] );
+    size_t count   = m_layers[ layerNum ].size( ) * numCols;
+
+    bytes += 2 * Arena::padded( sizeof( float ) * count ) + Arena::padded( sizeof( uint16_t ) * count );
+    bytes += 2 * Arena::padded( sizeof( float ) * numCols );
+
+  }
+
+  m_mixedArena.reset( new Arena( bytes, m_arena.hasHugePages( ) ) );
+
+  for ( unsigned layerNum = 0; layerNum + 1 < m_layers.size( ); ++layerNum )
+  {
+
+    size_t numCols = MixedPrecision::padLanes( m_topology[ layerNum + 1 ] );
+    size_t count   = m_layers[ layerNum ].size( ) * numCols;
+
+    m_mixed.push_back( MixedMatrix{
+                                   numCols,
+                                   m_mixedArena->allocate< float >( count ),
+                                   m_mixedArena->allocate< float >( count ),
+                                   m_mixedArena->allocate< uint16_t >( count ),
+                                   m_mixedArena->allocate< float >( numCols ),
+                                   m_mixedArena->allocate< float >( numCols )
+                                   } );
+
+  }
+
+} // NetImpl::setPrecision
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_catchUpInputRow
+/// \param index
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_catchUpInputRow( unsigned index )
+{
+
+  m_layers[ 0 ][ index ].catchUpMomentum( m_sparseStep - m_inputRowSteps[ index ], m_params );
+  m_inputRowSteps[ index ] = m_sparseStep;
+  m_mixedStale             = true;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::_catchUpInputRows
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::_catchUpInputRows( )
+{
+
+  if ( !m_lazyInputRows )
+  {
+
+    return;
+
+  }
+
+  for ( unsigned i = 0; i < m_inputRowSteps.size( ); ++i )
+  {
+
+    _catchUpInputRow( i );
+
+  }
+
+  m_lazyInputRows = false;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::getResults
+/// \param resultVals - vector to be filled with output values
+///                     computed by the neural net
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::getResults( std::vector< double > *pResultVals ) const
+{
+
+  pResultVals->clear( );
+
+  for ( unsigned n = 0; n < m_topology.back( ); ++n )
+  {
+
+    pResultVals->push_back( m_layers.back( )[ n ].getOutputVal( ) );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::getAverageError
+/// \return - smoothed current average error for neural net
+////////////////////////////////////////////////////////////////////
+double
+NetImpl::getAverageError( )
+{
+
+  return m_recentAverageError;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::clone
+/// \return - copy of every layer, neuron and connection
+////////////////////////////////////////////////////////////////////
+std::unique_ptr< Net >
+NetImpl::clone( ) const
+{
+
+  return std::unique_ptr< Net >( new NetImpl( *this ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::getTopology
+/// \return
+////////////////////////////////////////////////////////////////////
+std::vector< unsigned >
+NetImpl::getTopology( ) const
+{
+
+  return m_topology;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::getWeights
+/// \param layerNum
+/// \param pWeights
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::getWeights(
+                    unsigned               layerNum,
+                    std::vector< double > *pWeights
+                    ) const
+{
+
+  if ( layerNum == 0 || layerNum >= m_layers.size( ) )
+  {
+
+    throw std::runtime_error( "Weight layer must be in [1, numLayers)" );
+
+  }
+
+  std::vector< double > weights;
+  std::vector< double > biases;
+
+  _readWeights( layerNum, &weights, &biases );
+
+  // one row per neuron: its input weights followed by its bias
+  unsigned numRows = m_topology[ layerNum ];
+  unsigned numCols = m_topology[ layerNum - 1 ] + 1;
+
+  pWeights->resize( numRows * numCols );
+
+  for ( unsigned r = 0; r < numRows; ++r )
+  {
+
+    for ( unsigned c = 0; c + 1 < numCols; ++c )
+    {
+
+      ( *pWeights )[ r * numCols + c ] = weights[ c * numRows + r ];
+
+    }
+
+    ( *pWeights )[ r * numCols + numCols - 1 ] = biases[ r ];
+
+  }
+
+} // NetImpl::getWeights
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::setWeights
+/// \param layerNum
+/// \param weights
+/// \param keepMomentum
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::setWeights(
+                    unsigned                     layerNum,
+                    const std::vector< double > &weights,
+                    bool                         keepMomentum
+                    )
+{
+
+  if ( layerNum == 0 || layerNum >= m_layers.size( ) )
+  {
+
+    throw std::runtime_error( "Weight layer must be in [1, numLayers)" );
+
+  }
+
+  // (skipped momentum steps are taken first, so a kept momentum
+  // isn't applied again on top of the new weights)
+  if ( layerNum == 1 )
+  {
+
+    _catchUpInputRows( );
+
+  }
+
+  _syncDoubleWeights( );
+  m_mixedStale = true;
+  ++m_weightsVersion;
+
+  Layer   &prevLayer = m_layers[ layerNum - 1 ];
+  unsigned numRows   = m_topology[ layerNum ];
+  unsigned numCols   = m_topology[ layerNum - 1 ] + 1;
+
+  if ( weights.size( ) != numRows * numCols )
+  {
+
+    throw std::runtime_error( "Weight matrix size does not match layer sizes" );
+
+  }
+
+  for ( unsigned r = 0; r < numRows; ++r )
+  {
+
+    for ( unsigned c = 0; c + 1 < numCols; ++c )
+    {
+
+      prevLayer[ c ].setOutputWeight( r, weights[ r * numCols + c ], keepMomentum );
+
+    }
+
+    Connection &bias = m_biases[ layerNum ][ r ];
+
+    bias.weight      = weights[ r * numCols + numCols - 1 ];
+    bias.deltaWeight = ( keepMomentum ? bias.deltaWeight : 0.0 );
+
+  }
+
+} // NetImpl::setWeights
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief NetImpl::setLearningParams
+/// \param params
+////////////////////////////////////////////////////////////////////
+void
+NetImpl::setLearningParams( const LearningParams &params )
+{
+
+  // skipped momentum steps were taken with the old momentum
+  _catchUpInputRows( );
+
+  m_params = params;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::ConnectedNet
+///
+///        Simple API wrapper around actual implementation class
+///
+////////////////////////////////////////////////////////////////////
+ConnectedNet::ConnectedNet(
+                           const std::vector< unsigned > &topology,
+                           double                         errorSmoothing,
+                           bool                           hugePages
+                           )
+  : netImpl_( new NetImpl( topology, errorSmoothing, hugePages ) )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::ConnectedNet
+///
+///        Deep copies the wrapped implementation
+///
+////////////////////////////////////////////////////////////////////
+ConnectedNet::ConnectedNet( const ConnectedNet &other )
+  : Net( other )
+  , netImpl_( new NetImpl( *other.netImpl_ ) )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::~ConnectedNet
+////////////////////////////////////////////////////////////////////
+ConnectedNet::~ConnectedNet( )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::feedForward
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param inputVals
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::feedForward( const std::vector< double > &inputVals )
+{
+
+  netImpl_->feedForward( inputVals );
+
+} // ConnectedNet::feedForward
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::feedForwardSparse
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param inputVals
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::feedForwardSparse( const SparseVals &inputVals )
+{
+
+  netImpl_->feedForwardSparse( inputVals );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::feedForwardSparse
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param activeInputs
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::feedForwardSparse( const std::vector< unsigned > &activeInputs )
+{
+
+  netImpl_->feedForwardSparse( activeInputs );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::feedForwardBatch
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param inputVals
+/// \param pResultVals
+/// \param numThreads
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::feedForwardBatch(
+                               const std::vector< double > &inputVals,
+                               std::vector< double >       *pResultVals,
+                               unsigned                     numThreads
+                               ) const
+{
+
+  netImpl_->feedForwardBatch( inputVals, pResultVals, numThreads );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::prepareBatch
+///
+///        Simple API wrapper around actual implementation class
+///
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::prepareBatch( )
+{
+
+  netImpl_->prepareBatch( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::backProp
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param targetVals
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::backProp( const std::vector< double > &targetVals )
+{
+
+  netImpl_->backProp( targetVals );
+
+} // ConnectedNet::backProp
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::getResults
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param pResultVals
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::getResults( std::vector< double > *pResultVals ) const
+{
+
+  netImpl_->getResults( pResultVals );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::getAverageError
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \return
+////////////////////////////////////////////////////////////////////
+double
+ConnectedNet::getAverageError( )
+{
+
+  return netImpl_->getAverageError( );
 
+}
 
-protected:
 
-private:
 
-  /// \brief m_layers
-  std::vector< Layer > m_layers; // m_layers[ layerNum ][ neuronNum ]
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::clone
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \return
+////////////////////////////////////////////////////////////////////
+std::unique_ptr< Net >
+ConnectedNet::clone( ) const
+{
 
-  double m_error;
-  double m_recentAverageError;
-  double m_recentAverageSmoothingFactor;
+  return std::unique_ptr< Net >( new ConnectedNet( *this ) );
 
-};
+}
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief NetImpl::NetImpl
+/// \brief ConnectedNet::seedWeights
+/// \param seed
 ////////////////////////////////////////////////////////////////////
-NetImpl::NetImpl(
-                 const std::vector< unsigned > &topology,
-                 double                         errorSmoothing
-                 )
-  : m_error( 0.0 )
-  , m_recentAverageError( 1.0 )
-  , m_recentAverageSmoothingFactor( errorSmoothing )
+void
+ConnectedNet::seedWeights( unsigned seed )
 {
 
-  // net doesn't make sense without at least input and output layers
-  if ( topology.size() < 2 )
-  {
+  Neuron::seedRandomWeights( seed );
 
-    throw std::runtime_error( "Must provide a topology with at least 2 layers" );
+}
 
-  }
 
-  unsigned numLayers = topology.size( );
 
-  for ( unsigned layerNum = 0; layerNum < numLayers; ++layerNum )
-  {
+namespace
+{
 
-    m_layers.push_back( Layer( ) );
-    unsigned numOutputs = ( layerNum == topology.size( ) - 1 ? 0 : topology[ layerNum + 1 ] );
+//
+// model file: magic, version, output head, number of layers, the
+// topology and then every layer's getWeights matrix (host byte
+// order, uint32_t and double values)
+//
+constexpr uint32_t modelMagic   = 0x4D54454E; // "NETM"
+constexpr uint32_t modelVersion = 1;
+constexpr uint32_t maxLayerSize = 1u << 20; // far beyond any net this trains
 
-    // fill layer with neurons and add bias neuron to the layer
-    for ( unsigned neuronNum = 0; neuronNum <= topology[ layerNum ]; ++neuronNum )
-    {
 
-      Neuron neuron( numOutputs, neuronNum );
-      m_layers.back( ).push_back( std::move( neuron ) );
+template< typename T >
+void
+writeValues(
+            std::ostream &out,
+            const T      *values,
+            size_t        count
+            )
+{
 
-    }
+  out.write( reinterpret_cast< const char* >( values ), static_cast< std::streamsize >( sizeof( T ) * count ) );
 
-    //
-    // force the bias node's output value to 1.0
-    //
-    m_layers.back( ).back( ).setOutputVal( 1.0 );
+}
+
+
+template< typename T >
+void
+readValues(
+           std::istream &in,
+           T            *values,
+           size_t        count
+           )
+{
+
+  in.read( reinterpret_cast< char* >( values ), static_cast< std::streamsize >( sizeof( T ) * count ) );
+
+  if ( !in )
+  {
+
+    throw std::runtime_error( "Model file is truncated" );
 
   }
 
 }
 
+} // namespace
+
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief NetImpl::feedForward
-/// \param inputVals
+/// \brief ConnectedNet::save
+/// \param path
 ////////////////////////////////////////////////////////////////////
 void
-NetImpl::feedForward( const std::vector< double > &inputVals )
+ConnectedNet::save( const std::string &path ) const
 {
 
-  assert( inputVals.size( ) == m_layers[ 0 ].size( ) - 1 );
+  std::ofstream out( path, std::ios::binary );
 
-  //
-  // assign (latch) the input values into the input neurons
-  //
-  for ( unsigned i = 0; i < inputVals.size( ); ++i )
+  if ( !out )
   {
 
-    m_layers[ 0 ][ i ].setOutputVal( inputVals[ i ] );
+    throw std::runtime_error( "Could not open '" + path + "' for writing" );
 
   }
 
-  //
-  // forward propogate
-  //
-  // start at one because first layer already set
-  for ( unsigned layerNum = 1; layerNum < m_layers.size( ); ++layerNum )
+  std::vector< unsigned > topology = getTopology( );
+
+  std::vector< uint32_t > header = {
+    modelMagic,
+    modelVersion,
+    static_cast< uint32_t >( getOutputHead( ) ),
+    static_cast< uint32_t >( topology.size( ) )
+  };
+
+  header.insert( header.end( ), topology.begin( ), topology.end( ) );
+
+  writeValues( out, header.data( ), header.size( ) );
+
+  std::vector< double > weights;
+
+  for ( unsigned layerNum = 1; layerNum < topology.size( ); ++layerNum )
   {
 
-    Layer &prevLayer = m_layers[ layerNum - 1 ];
-    Layer &currLayer = m_layers[ layerNum ];
+    getWeights( layerNum, &weights );
+    writeValues( out, weights.data( ), weights.size( ) );
 
-    std::for_each ( currLayer.begin( ), currLayer.end( ) - 1, [ &prevLayer ]( Neuron &neuron )
-      {
+  }
 
-        neuron.feedForward( prevLayer );
+  if ( !out )
+  {
 
-      } );
+    throw std::runtime_error( "Could not write '" + path + "'" );
 
   }
 
-} // NetImpl::feedForward
+} // ConnectedNet::save
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief NetImpl::backProp
-/// \param targetVals
+/// \brief ConnectedNet::load
+/// \param path
+/// \return
 ////////////////////////////////////////////////////////////////////
-void
-NetImpl::backProp( const std::vector< double > &targetVals )
+std::unique_ptr< ConnectedNet >
+ConnectedNet::load( const std::string &path )
 {
 
-  //
-  // calculate overall net error (RMS of output neuron errors)
-  //
-  Layer &outputLayer = m_layers.back( );
-
-  assert( targetVals.size( ) == outputLayer.size( ) - 1 );
-
-  // root mean square error
-  m_error = 0.0;
+  std::ifstream in( path, std::ios::binary );
 
-  for ( unsigned n = 0; n < outputLayer.size( ) - 1; ++n )
+  if ( !in )
   {
 
-    double delta = targetVals[ n ] - outputLayer[ n ].getOutputVal( );
-    m_error += delta * delta;
+    throw std::runtime_error( "Could not open '" + path + "'" );
 
   }
 
-  m_error /= outputLayer.size( ) - 1;
-  m_error  = std::sqrt( m_error );
+  uint32_t header[ 4 ];
 
-  // recent average measurement
-  m_recentAverageError = ( m_recentAverageError * m_recentAverageSmoothingFactor )
-                         + ( m_error * ( 1.0 - m_recentAverageSmoothingFactor ) );
+  readValues( in, header, 4 );
 
+  if ( header[ 0 ] != modelMagic || header[ 1 ] != modelVersion )
+  {
 
-  //
-  // calculate output layer gradients
-  //
-  for ( unsigned n = 0; n < outputLayer.size( ) - 1; ++n )
+    throw std::runtime_error( "'" + path + "' is not a version " + std::to_string( modelVersion ) + " model file" );
+
+  }
+
+  if ( header[ 2 ] > static_cast< uint32_t >( OutputHead::Softmax ) || header[ 3 ] < 2 || header[ 3 ] > 1024 )
   {
 
-    outputLayer[ n ].calcOutputGradients( targetVals[ n ] );
+    throw std::runtime_error( "'" + path + "' has a corrupt header" );
 
   }
 
+  std::vector< uint32_t > sizes( header[ 3 ] );
+
+  readValues( in, sizes.data( ), sizes.size( ) );
+
   //
-  // calculate gradients on hidden layers
+  // check every size and the weights that should follow before
+  // allocating anything, so a corrupt file cannot ask for a huge net
   //
-  for ( unsigned layerNum = m_layers.size( ) - 2; layerNum > 0; --layerNum )
+  unsigned long long numWeights = 0;
+
+  for ( size_t l = 0; l < sizes.size( ); ++l )
   {
 
-    Layer &hiddenLayer = m_layers[ layerNum     ];
-    Layer &nextLayer   = m_layers[ layerNum + 1 ];
+    if ( sizes[ l ] == 0 || sizes[ l ] > maxLayerSize )
+    {
 
-    std::for_each( hiddenLayer.begin( ), hiddenLayer.end( ) - 1, [ &nextLayer ]( Neuron &neuron )
-      {
+      throw std::runtime_error( "'" + path + "' has a corrupt layer size " + std::to_string( sizes[ l ] ) );
+
+    }
+
+    if ( l > 0 )
+    {
 
-        neuron.calcHiddenGradients( nextLayer );
+      numWeights += static_cast< unsigned long long >( sizes[ l ] ) * ( sizes[ l - 1 ] + 1ull );
 
-      } );
+    }
 
   }
 
-  //
-  // update connection weights
-  //
-  for ( unsigned layerNum = m_layers.size( ) - 1; layerNum > 0; --layerNum )
+  std::streamoff position = in.tellg( );
+
+  in.seekg( 0, std::ios::end );
+
+  std::streamoff remaining = in.tellg( ) - position;
+
+  in.seekg( position );
+
+  if ( !in || remaining < 0 || static_cast< unsigned long long >( remaining ) != numWeights * sizeof( double ) )
   {
 
-    Layer &layer     = m_layers[ layerNum     ];
-    Layer &prevLayer = m_layers[ layerNum - 1 ];
+    throw std::runtime_error( "'" + path + "' holds " + std::to_string( remaining ) + " bytes of weights, expected "
+                             + std::to_string( numWeights * sizeof( double ) ) );
 
-    std::for_each ( layer.begin( ), layer.end( ) - 1, [ &prevLayer ]( Neuron &neuron )
-      {
+  }
+
+  std::unique_ptr< ConnectedNet > upNet( new ConnectedNet( std::vector< unsigned >( sizes.begin( ), sizes.end( ) ) ) );
+
+  upNet->setOutputHead( static_cast< OutputHead >( header[ 2 ] ) );
+
+  std::vector< double > weights;
+
+  for ( unsigned layerNum = 1; layerNum < sizes.size( ); ++layerNum )
+  {
 
-        neuron.updateInputWeights( prevLayer );
+    weights.resize( static_cast< size_t >( sizes[ layerNum ] ) * ( sizes[ layerNum - 1 ] + 1 ) );
 
-      } );
+    readValues( in, weights.data( ), weights.size( ) );
+    upNet->setWeights( layerNum, weights );
 
   }
 
-} // NetImpl::backProp
+  return upNet;
+
+} // ConnectedNet::load
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief NetImpl::getResults
-/// \param resultVals - vector to be filled with output values
-///                     computed by the neural net
+/// \brief ConnectedNet::getTopology
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \return
+////////////////////////////////////////////////////////////////////
+std::vector< unsigned >
+ConnectedNet::getTopology( ) const
+{
+
+  return netImpl_->getTopology( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::getWeights
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param layerNum
+/// \param pWeights
 ////////////////////////////////////////////////////////////////////
 void
-NetImpl::getResults( std::vector< double > *pResultVals ) const
+ConnectedNet::getWeights(
+                         unsigned               layerNum,
+                         std::vector< double > *pWeights
+                         ) const
 {
 
-  pResultVals->clear( );
+  netImpl_->getWeights( layerNum, pWeights );
 
-  for ( unsigned n = 0; n < m_layers.back( ).size( ) - 1; ++n )
-  {
+}
 
-    pResultVals->push_back( m_layers.back( )[ n ].getOutputVal( ) );
 
-  }
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::setWeights
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param layerNum
+/// \param weights
+/// \param keepMomentum
+////////////////////////////////////////////////////////////////////
+void
+ConnectedNet::setWeights(
+                         unsigned                     layerNum,
+                         const std::vector< double > &weights,
+                         bool                         keepMomentum
+                         )
+{
+
+  netImpl_->setWeights( layerNum, weights, keepMomentum );
 
 }
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief NetImpl::getAverageError
-/// \return - smoothed current average error for neural net
+/// \brief ConnectedNet::setLearningParams
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param params
 ////////////////////////////////////////////////////////////////////
-double
-NetImpl::getAverageError( )
+void
+ConnectedNet::setLearningParams( const LearningParams &params )
 {
 
-  return m_recentAverageError;
+  netImpl_->setLearningParams( params );
 
 }
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief ConnectedNet::ConnectedNet
+/// \brief ConnectedNet::getStateBytes
 ///
 ///        Simple API wrapper around actual implementation class
 ///
+/// \return
 ////////////////////////////////////////////////////////////////////
-ConnectedNet::ConnectedNet(
-                           const std::vector< unsigned > &topology,
-                           double                         errorSmoothing
-                           )
-  : netImpl_( new NetImpl( topology, errorSmoothing ) )
-{}
+size_t
+ConnectedNet::getStateBytes( ) const
+{
+
+  return netImpl_->getArena( ).getUsed( );
+
+}
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief ConnectedNet::feedForward
+/// \brief ConnectedNet::hasHugePages
 ///
 ///        Simple API wrapper around actual implementation class
 ///
-/// \param inputVals
+/// \return
+////////////////////////////////////////////////////////////////////
+bool
+ConnectedNet::hasHugePages( ) const
+{
+
+  return netImpl_->getArena( ).hasHugePages( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::setPrecision
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param precision
 ////////////////////////////////////////////////////////////////////
 void
-ConnectedNet::feedForward( const std::vector< double > &inputVals )
+ConnectedNet::setPrecision( Precision precision )
 {
 
-  netImpl_->feedForward( inputVals );
+  netImpl_->setPrecision( precision );
 
-} // ConnectedNet::feedForward
+}
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief ConnectedNet::backProp
+/// \brief ConnectedNet::getPrecision
 ///
 ///        Simple API wrapper around actual implementation class
 ///
-/// \param targetVals
+/// \return
+////////////////////////////////////////////////////////////////////
+Precision
+ConnectedNet::getPrecision( ) const
+{
+
+  return netImpl_->getPrecision( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::setOutputHead
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param outputHead
 ////////////////////////////////////////////////////////////////////
 void
-ConnectedNet::backProp( const std::vector< double > &targetVals )
+ConnectedNet::setOutputHead( OutputHead outputHead )
 {
 
-  netImpl_->backProp( targetVals );
+  netImpl_->setOutputHead( outputHead );
 
-} // ConnectedNet::backProp
+}
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief ConnectedNet::getResults
+/// \brief ConnectedNet::getOutputHead
 ///
 ///        Simple API wrapper around actual implementation class
 ///
-/// \param pResultVals
+/// \return
+////////////////////////////////////////////////////////////////////
+OutputHead
+ConnectedNet::getOutputHead( ) const
+{
+
+  return netImpl_->getOutputHead( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::setPerfCounters
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \param enabled
 ////////////////////////////////////////////////////////////////////
 void
-ConnectedNet::getResults( std::vector< double > *pResultVals ) const
+ConnectedNet::setPerfCounters( bool enabled )
 {
 
-  netImpl_->getResults( pResultVals );
+  netImpl_->setPerfCounters( enabled );
 
 }
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief ConnectedNet::getAverageError
+/// \brief ConnectedNet::getPerfReport
 ///
 ///        Simple API wrapper around actual implementation class
 ///
 /// \return
 ////////////////////////////////////////////////////////////////////
-double
-ConnectedNet::getAverageError( )
+PerfReport
+ConnectedNet::getPerfReport( ) const
 {
 
-  return netImpl_->getAverageError( );
+  return netImpl_->getPerfReport( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConnectedNet::getLearningParams
+///
+///        Simple API wrapper around actual implementation class
+///
+/// \return
+////////////////////////////////////////////////////////////////////
+const LearningParams &
+ConnectedNet::getLearningParams( ) const
+{
+
+  return netImpl_->getLearningParams( );
 
 }
 
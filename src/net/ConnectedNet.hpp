@@ -1,12 +1,17 @@
 #pragma once
 
 #include "Net.hpp"
+#include "CommonStructs.hpp"
+#include "PerfCounters.hpp"
 #include <memory>
+#include <string>
 
 
 namespace net
 {
 
+class NetImpl;
+
 
 ////////////////////////////////////////////////////////////////////
 /// \brief The ConnectedNet class
@@ -19,12 +24,25 @@ public:
   ////////////////////////////////////////////////////////////////////
   /// \brief ConnectedNet
   /// \param topology
+  /// \param errorSmoothing
+  /// \param hugePages - back the net's state with huge pages when
+  ///                    the system allows it
   ////////////////////////////////////////////////////////////////////
   ConnectedNet(
                const std::vector< unsigned > &topology,
-               double                         errorSmoothing = 0.9
+               double                         errorSmoothing = 0.9,
+               bool                           hugePages      = false
                );
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief ConnectedNet
+  /// \param other - net to deep copy
+  ////////////////////////////////////////////////////////////////////
+  ConnectedNet( const ConnectedNet &other );
+
+  virtual
+  ~ConnectedNet( );
+
   ////////////////////////////////////////////////////////////////////
   /// \brief feedForward
   /// \param inputVals
@@ -32,6 +50,56 @@ public:
   virtual
   void feedForward ( const std::vector< double > &inputVals ) final;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForwardSparse
+  ///
+  ///        Same as feedForward with every input not listed set to
+  ///        zero. Only the first layer weights of the listed inputs
+  ///        are read, and the following backProp only updates those
+  ///        weights (the momentum of the others is applied lazily).
+  ///
+  /// \param inputVals - ( index, value ) pairs of nonzero inputs
+  ////////////////////////////////////////////////////////////////////
+  void feedForwardSparse ( const SparseVals &inputVals );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForwardSparse
+  /// \param activeInputs - indices of inputs equal to 1.0
+  ///                       (all others are 0.0)
+  ////////////////////////////////////////////////////////////////////
+  void feedForwardSparse ( const std::vector< unsigned > &activeInputs );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForwardBatch
+  ///
+  ///        Inference only: evaluates many samples at once without
+  ///        touching the state used by getResults or backProp. The
+  ///        samples are split into tiles run on worker threads.
+  ///        Only reads the net, so calls may run on several threads
+  ///        at once (while nothing trains or changes it). Packs the
+  ///        weights for every call unless prepareBatch packed them
+  ///        since they last changed.
+  ///
+  /// \param inputVals - numSamples x numInputs values (sample major)
+  /// \param pResultVals - filled with numSamples x numOutputs values
+  /// \param numThreads - worker threads (0 uses every core)
+  ////////////////////////////////////////////////////////////////////
+  void feedForwardBatch (
+                         const std::vector< double > &inputVals,
+                         std::vector< double >       *pResultVals,
+                         unsigned                     numThreads = 0
+                         ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief prepareBatch
+  ///
+  ///        Packs the current weights once for the feedForwardBatch
+  ///        calls that follow, until training or setWeights changes
+  ///        them (call it before handing the net to several threads)
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void prepareBatch ( );
+
   ////////////////////////////////////////////////////////////////////
   /// \brief backProp
   /// \param targetVals
@@ -53,12 +121,179 @@ public:
   virtual
   double getAverageError ( ) final;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief clone
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  std::unique_ptr< Net > clone ( ) const final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief seedWeights
+  ///
+  ///        Reseeds the generator used for the initial weights of
+  ///        every ConnectedNet constructed afterwards (seeded from
+  ///        the clock by default)
+  ///
+  /// \param seed
+  ////////////////////////////////////////////////////////////////////
+  static void seedWeights ( unsigned seed );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief save
+  ///
+  ///        Writes the topology, output head and weights (not the
+  ///        momentum or training state) to a binary model file
+  ///
+  /// \param path
+  ////////////////////////////////////////////////////////////////////
+  void save ( const std::string &path ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief load
+  /// \param path - model file written by save
+  /// \return the saved net (throws if the file can't be read, has a
+  ///         layer size of 0 or above 2^20, or holds more or fewer
+  ///         weights than its topology needs)
+  ////////////////////////////////////////////////////////////////////
+  static std::unique_ptr< ConnectedNet > load ( const std::string &path );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getTopology
+  /// \return number of neurons per layer (biases and padding excluded)
+  ////////////////////////////////////////////////////////////////////
+  std::vector< unsigned > getTopology ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getWeights
+  ///
+  ///        Row-major matrix of the weights feeding 'layerNum'.
+  ///        Row r holds the input weights of neuron r and column c
+  ///        the weight from neuron c of the previous layer, with
+  ///        the neuron's bias as the last column.
+  ///
+  /// \param layerNum - layer in [1, numLayers)
+  /// \param pWeights - filled with topology[ layerNum ] *
+  ///                   ( topology[ layerNum - 1 ] + 1 ) weights
+  ////////////////////////////////////////////////////////////////////
+  void getWeights (
+                   unsigned               layerNum,
+                   std::vector< double > *pWeights
+                   ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setWeights
+  ///
+  ///        Inverse of getWeights. Clears the momentum of every
+  ///        connection that is set, unless keepMomentum (to carry
+  ///        on training from weights that were changed elsewhere,
+  ///        e.g. by a parameter server).
+  ///
+  /// \param layerNum - layer in [1, numLayers)
+  /// \param weights - matrix in the getWeights layout
+  /// \param keepMomentum
+  ////////////////////////////////////////////////////////////////////
+  void setWeights (
+                   unsigned                     layerNum,
+                   const std::vector< double > &weights,
+                   bool                         keepMomentum = false
+                   );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setLearningParams
+  ///
+  ///        Training rate and momentum used by later backProp
+  ///        calls (defaults to net::eta and net::alpha)
+  ///
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  void setLearningParams ( const LearningParams &params );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getLearningParams
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  const LearningParams &getLearningParams ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getStateBytes
+  /// \return size of the single block holding the net's neurons,
+  ///         weights and momentum
+  ////////////////////////////////////////////////////////////////////
+  size_t getStateBytes ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief hasHugePages
+  /// \return true if that block is backed by huge pages
+  ////////////////////////////////////////////////////////////////////
+  bool hasHugePages ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setPrecision
+  ///
+  ///        Precision::BFloat16 and Precision::Half train the dense
+  ///        path (feedForward and backProp) on 16 bit weights with
+  ///        fp32 arithmetic and fp32 master weights, converting with
+  ///        AVX512-BF16 or F16C when the CPU has them. Sparse input
+  ///        and setWeights keep using double weights, which are
+  ///        synced from the master weights when needed;
+  ///        feedForwardBatch and getWeights read the master weights
+  ///        while the double weights are behind.
+  ///
+  /// \param precision - Precision::Double by default
+  ////////////////////////////////////////////////////////////////////
+  void setPrecision ( Precision precision );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getPrecision
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  Precision getPrecision ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setOutputHead
+  ///
+  ///        OutputHead::Softmax turns the output layer into class
+  ///        probabilities (softmax of the output sums) trained on
+  ///        cross entropy. Targets are then class probabilities
+  ///        summing to one (one hot labels) and getAverageError
+  ///        reports the smoothed cross entropy, so trainNet's
+  ///        acceptable error is a loss in nats.
+  ///
+  /// \param outputHead - OutputHead::Tanh by default
+  ////////////////////////////////////////////////////////////////////
+  void setOutputHead ( OutputHead outputHead );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getOutputHead
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  OutputHead getOutputHead ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setPerfCounters
+  ///
+  ///        Counts cycles, instructions, cache and branch misses of
+  ///        the forward, backward and update phases of feedForward
+  ///        and backProp on the calling thread (see PerfCounters).
+  ///        Enabling starts from zero; copies don't count.
+  ///
+  /// \param enabled - off by default
+  ////////////////////////////////////////////////////////////////////
+  void setPerfCounters ( bool enabled );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getPerfReport
+  /// \return counts since setPerfCounters( true ) (empty when off)
+  ////////////////////////////////////////////////////////////////////
+  PerfReport getPerfReport ( ) const;
+
 
 protected:
 
 private:
 
-  std::unique_ptr< Net > netImpl_;
+  std::unique_ptr< NetImpl > netImpl_;
 
 };
 
@@ -0,0 +1,596 @@
+#include "ConvNet.hpp"
+
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+
+#include "CommonStructs.hpp"
+#include "Gemm.hpp"
+
+
+namespace net
+{
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::ConvNet
+////////////////////////////////////////////////////////////////////
+ConvNet::ConvNet(
+                 const std::vector< LayerDesc > &topology,
+                 unsigned                        seed,
+                 const LearningParams           &params,
+                 double                          errorSmoothing
+                 )
+  : m_error( 0.0 )
+  , m_recentAverageError( 1.0 )
+  , m_recentAverageSmoothingFactor( errorSmoothing )
+  , m_params( params )
+{
+
+  std::default_random_engine               generator( seed );
+  std::uniform_real_distribution< double > distribution( -1.0, 1.0 );
+
+  if ( topology.size( ) < 2 )
+  {
+
+    throw std::runtime_error( "Must provide a topology with at least 2 layers" );
+
+  }
+
+  if ( topology.front( ).type != LayerDesc::Type::Input )
+  {
+
+    throw std::runtime_error( "First layer of a conv net topology must be an input layer" );
+
+  }
+
+  unsigned width    = topology.front( ).width;
+  unsigned height   = topology.front( ).height;
+  unsigned channels = topology.front( ).channels;
+
+  m_outputs.push_back( std::vector< double >( width * height * channels, 0.0 ) );
+  m_gradients.push_back( std::vector< double >( ) ); // input gradients are never needed
+
+  for ( unsigned layerNum = 1; layerNum < topology.size( ); ++layerNum )
+  {
+
+    const LayerDesc &desc = topology[ layerNum ];
+
+    WeightLayer layer;
+    layer.type       = desc.type;
+    layer.inWidth    = width;
+    layer.inHeight   = height;
+    layer.inChannels = channels;
+    layer.kernel     = desc.kernel;
+    layer.stride     = std::max( desc.stride, 1u );
+    layer.padding    = desc.padding;
+
+    switch ( desc.type )
+    {
+
+    case LayerDesc::Type::Conv:
+
+      if ( desc.kernel == 0 || desc.kernel > width + 2 * desc.padding || desc.kernel > height + 2 * desc.padding )
+      {
+
+        throw std::runtime_error( "Conv kernel does not fit the layer input" );
+
+      }
+
+      layer.outWidth     = ( width  + 2 * layer.padding - layer.kernel ) / layer.stride + 1;
+      layer.outHeight    = ( height + 2 * layer.padding - layer.kernel ) / layer.stride + 1;
+      layer.outChannels  = desc.channels;
+      layer.numRows      = desc.channels;
+      layer.numCols      = layer.kernel * layer.kernel * channels;
+      layer.numPositions = layer.outWidth * layer.outHeight;
+      layer.columns.resize( layer.numCols * layer.numPositions );
+      break;
+
+    case LayerDesc::Type::Dense:
+
+      layer.outWidth     = desc.width;
+      layer.outHeight    = 1;
+      layer.outChannels  = 1;
+      layer.numRows      = desc.width;
+      layer.numCols      = width * height * channels;
+      layer.numPositions = 1;
+      break;
+
+    default:
+      throw std::runtime_error( "Only the first layer of a conv net topology can be an input layer" );
+
+    } // switch
+
+    if ( layer.numRows == 0 )
+    {
+
+      throw std::runtime_error( "Layers must have at least one neuron or channel" );
+
+    }
+
+    layer.columnGrads.resize( layer.numCols * layer.numPositions );
+    layer.weightGrads.resize( layer.numRows * layer.numCols );
+
+    //
+    // zero-centered weights scaled by fan-in so wide kernels
+    // don't start out saturating tanh
+    //
+    double scale = 1.0 / std::sqrt( static_cast< double >( layer.numCols + 1 ) );
+
+    for ( unsigned i = 0; i < layer.numRows * layer.numCols; ++i )
+    {
+
+      layer.weights.push_back( distribution( generator ) * scale );
+
+    }
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      layer.biases.push_back( distribution( generator ) * scale );
+
+    }
+
+    layer.deltaWeights.assign( layer.weights.size( ), 0.0 );
+    layer.deltaBiases.assign ( layer.biases.size( ),  0.0 );
+
+    width    = layer.outWidth;
+    height   = layer.outHeight;
+    channels = layer.outChannels;
+
+    m_outputs.push_back  ( std::vector< double >( layer.numRows * layer.numPositions, 0.0 ) );
+    m_gradients.push_back( std::vector< double >( layer.numRows * layer.numPositions, 0.0 ) );
+
+    m_weightLayers.push_back( std::move( layer ) );
+
+  }
+
+} // ConvNet::ConvNet
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::_im2col
+///
+///        Unrolls every kernel window of the input into one
+///        column so the convolution becomes a matrix product
+///
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::_im2col(
+                 WeightLayer                 &layer,
+                 const std::vector< double > &input
+                 )
+{
+
+  for ( unsigned c = 0; c < layer.inChannels; ++c )
+  {
+
+    for ( unsigned ky = 0; ky < layer.kernel; ++ky )
+    {
+
+      for ( unsigned kx = 0; kx < layer.kernel; ++kx )
+      {
+
+        unsigned row = ( c * layer.kernel + ky ) * layer.kernel + kx;
+        double  *col = &layer.columns[ row * layer.numPositions ];
+
+        for ( unsigned oy = 0; oy < layer.outHeight; ++oy )
+        {
+
+          int y = static_cast< int >( oy * layer.stride + ky ) - static_cast< int >( layer.padding );
+
+          for ( unsigned ox = 0; ox < layer.outWidth; ++ox )
+          {
+
+            int x = static_cast< int >( ox * layer.stride + kx ) - static_cast< int >( layer.padding );
+
+            bool inside = ( y >= 0 && y < static_cast< int >( layer.inHeight )
+                            && x >= 0 && x < static_cast< int >( layer.inWidth ) );
+
+            *col++ = ( inside ? input[ ( c * layer.inHeight + static_cast< unsigned >( y ) ) * layer.inWidth + static_cast< unsigned >( x ) ] : 0.0 );
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+} // ConvNet::_im2col
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::_col2im
+///
+///        Adjoint of _im2col: accumulates column gradients back
+///        onto the input pixels they were copied from
+///
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::_col2im(
+                 const WeightLayer     &layer,
+                 std::vector< double > *pInputGrads
+                 )
+{
+
+  std::vector< double > &inputGrads = *pInputGrads;
+  std::fill( inputGrads.begin( ), inputGrads.end( ), 0.0 );
+
+  for ( unsigned c = 0; c < layer.inChannels; ++c )
+  {
+
+    for ( unsigned ky = 0; ky < layer.kernel; ++ky )
+    {
+
+      for ( unsigned kx = 0; kx < layer.kernel; ++kx )
+      {
+
+        unsigned      row = ( c * layer.kernel + ky ) * layer.kernel + kx;
+        const double *col = &layer.columnGrads[ row * layer.numPositions ];
+
+        for ( unsigned oy = 0; oy < layer.outHeight; ++oy )
+        {
+
+          int y = static_cast< int >( oy * layer.stride + ky ) - static_cast< int >( layer.padding );
+
+          for ( unsigned ox = 0; ox < layer.outWidth; ++ox, ++col )
+          {
+
+            int x = static_cast< int >( ox * layer.stride + kx ) - static_cast< int >( layer.padding );
+
+            if ( y >= 0 && y < static_cast< int >( layer.inHeight )
+                 && x >= 0 && x < static_cast< int >( layer.inWidth ) )
+            {
+
+              inputGrads[ ( c * layer.inHeight + static_cast< unsigned >( y ) ) * layer.inWidth + static_cast< unsigned >( x ) ] += *col;
+
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+} // ConvNet::_col2im
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::feedForward
+/// \param inputVals
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::feedForward( const std::vector< double > &inputVals )
+{
+
+  assert( inputVals.size( ) == m_outputs[ 0 ].size( ) );
+
+  std::copy( inputVals.begin( ), inputVals.end( ), m_outputs[ 0 ].begin( ) );
+
+  for ( unsigned l = 0; l < m_weightLayers.size( ); ++l )
+  {
+
+    WeightLayer           &layer  = m_weightLayers[ l ];
+    std::vector< double > &output = m_outputs[ l + 1 ];
+
+    // dense layers use the (flattened) input directly as their single column
+    const double *columns = m_outputs[ l ].data( );
+
+    if ( layer.type == LayerDesc::Type::Conv )
+    {
+
+      _im2col( layer, m_outputs[ l ] );
+      columns = layer.columns.data( );
+
+    }
+
+    unsigned numPositions = layer.numPositions;
+
+    //
+    // output[ r ][ p ] = bias[ r ] + sum_c weights[ r ][ c ] * columns[ c ][ p ]
+    //
+    Gemm::multiply(
+                   layer.numRows,
+                   numPositions,
+                   layer.numCols,
+                   { layer.weights.data( ), layer.numCols, 1 },
+                   { columns, numPositions, 1 },
+                   output.data( ),
+                   numPositions
+                   );
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      double *out = &output[ r * numPositions ];
+
+      for ( unsigned p = 0; p < numPositions; ++p )
+      {
+
+        out[ p ] = std::tanh( out[ p ] + layer.biases[ r ] );
+
+      }
+
+    }
+
+  }
+
+} // ConvNet::feedForward
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::backProp
+/// \param targetVals
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::backProp( const std::vector< double > &targetVals )
+{
+
+  const std::vector< double > &outputs   = m_outputs.back( );
+  std::vector< double >       &gradients = m_gradients.back( );
+
+  assert( targetVals.size( ) == outputs.size( ) );
+
+  //
+  // same RMS error measure and output gradients as ConnectedNet
+  //
+  m_error = 0.0;
+
+  for ( size_t n = 0; n < outputs.size( ); ++n )
+  {
+
+    double delta   = targetVals[ n ] - outputs[ n ];
+    m_error       += delta * delta;
+    gradients[ n ] = delta * ( 1.0 - outputs[ n ] * outputs[ n ] );
+
+  }
+
+  m_error /= outputs.size( );
+  m_error  = std::sqrt( m_error );
+
+  m_recentAverageError = ( m_recentAverageError * m_recentAverageSmoothingFactor )
+                         + ( m_error * ( 1.0 - m_recentAverageSmoothingFactor ) );
+
+  //
+  // walk back through the layers. Each layer's input gradient is
+  // computed with its weights before they are updated.
+  //
+  for ( size_t l = m_weightLayers.size( ); l-- > 0; )
+  {
+
+    WeightLayer                 &layer        = m_weightLayers[ l ];
+    const std::vector< double > &gradient     = m_gradients[ l + 1 ];
+    unsigned                     numPositions = layer.numPositions;
+
+    const double *columns = ( layer.type == LayerDesc::Type::Conv
+                              ? layer.columns.data( )
+                              : m_outputs[ l ].data( ) );
+
+    //
+    // column gradients: weights^T * gradient
+    //
+    if ( l > 0 )
+    {
+
+      Gemm::multiply(
+                     layer.numCols,
+                     numPositions,
+                     layer.numRows,
+                     { layer.weights.data( ), 1, layer.numCols },
+                     { gradient.data( ), numPositions, 1 },
+                     layer.columnGrads.data( ),
+                     numPositions
+                     );
+
+      std::vector< double >       &prevGradient = m_gradients[ l ];
+      const std::vector< double > &prevOutput   = m_outputs[ l ];
+
+      if ( layer.type == LayerDesc::Type::Conv )
+      {
+
+        _col2im( layer, &prevGradient );
+
+      }
+      else
+      {
+
+        std::copy( layer.columnGrads.begin( ), layer.columnGrads.end( ), prevGradient.begin( ) );
+
+      }
+
+      for ( size_t n = 0; n < prevGradient.size( ); ++n )
+      {
+
+        prevGradient[ n ] *= 1.0 - prevOutput[ n ] * prevOutput[ n ];
+
+      }
+
+    }
+
+    //
+    // shared weight update: each weight's input * gradient averaged
+    // over every position it was applied at (a plain sum scales
+    // the step with the image size and diverges at eta = 0.15).
+    // weightGrads = gradient * columns^T
+    //
+    Gemm::multiply(
+                   layer.numRows,
+                   layer.numCols,
+                   numPositions,
+                   { gradient.data( ), numPositions, 1 },
+                   { columns, 1, numPositions },
+                   layer.weightGrads.data( ),
+                   layer.numCols
+                   );
+
+    const double rate = m_params.eta / numPositions;
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      const double *grad        = &gradient[ r * numPositions ];
+      const double *weightGrad  = &layer.weightGrads[ r * layer.numCols ];
+      double       *weight      = &layer.weights[ r * layer.numCols ];
+      double       *deltaWeight = &layer.deltaWeights[ r * layer.numCols ];
+
+      double gradSum = 0.0;
+
+      for ( unsigned p = 0; p < numPositions; ++p )
+      {
+
+        gradSum += grad[ p ];
+
+      }
+
+      for ( unsigned c = 0; c < layer.numCols; ++c )
+      {
+
+        deltaWeight[ c ] = rate * weightGrad[ c ] + m_params.alpha * deltaWeight[ c ];
+        weight[ c ]     += deltaWeight[ c ];
+
+      }
+
+      layer.deltaBiases[ r ] = rate * gradSum + m_params.alpha * layer.deltaBiases[ r ];
+      layer.biases[ r ]     += layer.deltaBiases[ r ];
+
+    }
+
+  }
+
+} // ConvNet::backProp
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::getResults
+/// \param pResultVals
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::getResults( std::vector< double > *pResultVals ) const
+{
+
+  *pResultVals = m_outputs.back( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::getAverageError
+/// \return
+////////////////////////////////////////////////////////////////////
+double
+ConvNet::getAverageError( )
+{
+
+  return m_recentAverageError;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::clone
+/// \return
+////////////////////////////////////////////////////////////////////
+std::unique_ptr< Net >
+ConvNet::clone( ) const
+{
+
+  return std::unique_ptr< Net >( new ConvNet( *this ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::getNumWeights
+/// \return
+////////////////////////////////////////////////////////////////////
+size_t
+ConvNet::getNumWeights( ) const
+{
+
+  size_t numWeights = 0;
+
+  for ( const WeightLayer &layer : m_weightLayers )
+  {
+
+    numWeights += layer.weights.size( ) + layer.biases.size( );
+
+  }
+
+  return numWeights;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::getWeights
+/// \param layerNum
+/// \param pWeights
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::getWeights(
+                    unsigned               layerNum,
+                    std::vector< double > *pWeights
+                    ) const
+{
+
+  if ( layerNum == 0 || layerNum > m_weightLayers.size( ) )
+  {
+
+    throw std::runtime_error( "Weight layer must be in [1, numLayers)" );
+
+  }
+
+  const WeightLayer &layer = m_weightLayers[ layerNum - 1 ];
+
+  pWeights->clear( );
+
+  for ( unsigned r = 0; r < layer.numRows; ++r )
+  {
+
+    pWeights->insert(
+                     pWeights->end( ),
+                     layer.weights.begin( ) + r * layer.numCols,
+                     layer.weights.begin( ) + ( r + 1 ) * layer.numCols
+                     );
+    pWeights->push_back( layer.biases[ r ] );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ConvNet::setLearningParams
+/// \param params
+////////////////////////////////////////////////////////////////////
+void
+ConvNet::setLearningParams( const LearningParams &params )
+{
+
+  m_params = params;
+
+}
+
+
+
+} // namespace net
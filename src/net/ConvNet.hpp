@@ -0,0 +1,225 @@
+#pragma once
+
+#include "Net.hpp"
+#include "CommonStructs.hpp"
+#include <vector>
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The LayerDesc struct
+///
+///        One entry of a ConvNet topology. The first entry must
+///        describe the input (input or image), every following
+///        entry is a dense or convolution layer. Image data is
+///        laid out channel by channel, row by row (CHW).
+///
+////////////////////////////////////////////////////////////////////
+struct LayerDesc
+{
+
+  enum class Type
+  {
+    Input,
+    Dense,
+    Conv
+  };
+
+  Type     type;
+  unsigned width;    ///< input: image width, dense: number of neurons
+  unsigned height;   ///< input: image height
+  unsigned channels; ///< input: image channels, conv: output channels
+  unsigned kernel;   ///< conv: square kernel size
+  unsigned stride;   ///< conv: step between kernel applications
+  unsigned padding;  ///< conv: zero padding added to every image border
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief input - flat input vector
+  ////////////////////////////////////////////////////////////////////
+  static LayerDesc input ( unsigned size ) { return { Type::Input, size, 1, 1, 0, 1, 0 }; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief image - CHW image input
+  ////////////////////////////////////////////////////////////////////
+  static LayerDesc image (
+                          unsigned width,
+                          unsigned height,
+                          unsigned channels = 1
+                          ) { return { Type::Input, width, height, channels, 0, 1, 0 }; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief dense - fully-connected layer (input is flattened)
+  ////////////////////////////////////////////////////////////////////
+  static LayerDesc dense ( unsigned size ) { return { Type::Dense, size, 1, 1, 0, 1, 0 }; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief conv - 2D convolution layer with shared weights
+  ////////////////////////////////////////////////////////////////////
+  static LayerDesc conv (
+                         unsigned channels,
+                         unsigned kernel,
+                         unsigned stride  = 1,
+                         unsigned padding = 0
+                         ) { return { Type::Conv, 0, 0, channels, kernel, stride, padding }; }
+
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The ConvNet class
+///
+///        Net mixing convolution and dense layers. Convolutions
+///        are computed as im2col followed by a Gemm::multiply
+///        with the kernel weights shared across the image (as are
+///        the input and weight gradients). Uses the same tanh
+///        transfer function, RMS error and momentum update as
+///        ConnectedNet (with shared weight gradients averaged over
+///        the positions they apply to).
+///
+////////////////////////////////////////////////////////////////////
+class ConvNet : public Net
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief ConvNet
+  /// \param topology
+  /// \param seed - seeds the initial weights
+  /// \param params - training rate and momentum
+  /// \param errorSmoothing
+  ////////////////////////////////////////////////////////////////////
+  ConvNet(
+          const std::vector< LayerDesc > &topology,
+          unsigned                        seed,
+          const LearningParams           &params         = LearningParams( ),
+          double                          errorSmoothing = 0.9
+          );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForward
+  /// \param inputVals
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  void feedForward ( const std::vector< double > &inputVals ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief backProp
+  /// \param targetVals
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  void backProp ( const std::vector< double > &targetVals ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getResults
+  /// \param pResultVals
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  void getResults ( std::vector< double > *pResultVals ) const final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getAverageError
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  double getAverageError ( ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief clone
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  std::unique_ptr< Net > clone ( ) const final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getNumWeights
+  /// \return number of trainable parameters (including biases)
+  ////////////////////////////////////////////////////////////////////
+  size_t getNumWeights ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getWeights
+  /// \param layerNum - layer fed by the weights (1 or more)
+  /// \param pWeights - one row per output channel (conv) or neuron
+  ///        (dense): the kernel in channel, row, column order (or
+  ///        the input weights) followed by the bias
+  ////////////////////////////////////////////////////////////////////
+  void getWeights (
+                   unsigned               layerNum,
+                   std::vector< double > *pWeights
+                   ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setLearningParams
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  void setLearningParams ( const LearningParams &params );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getLearningParams
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  const LearningParams &getLearningParams ( ) const { return m_params; }
+
+
+private:
+
+  /// \brief weights and scratch space feeding one layer
+  struct WeightLayer
+  {
+
+    LayerDesc::Type type;
+
+    unsigned inWidth, inHeight, inChannels;
+    unsigned outWidth, outHeight, outChannels;
+    unsigned kernel, stride, padding;
+
+    unsigned numRows;      // output channels (conv) or neurons (dense)
+    unsigned numCols;      // kernel * kernel * inChannels (conv) or input size (dense)
+    unsigned numPositions; // output pixels per channel (1 for dense)
+
+    std::vector< double > weights;      // numRows x numCols
+    std::vector< double > deltaWeights;
+    std::vector< double > biases;       // numRows
+    std::vector< double > deltaBiases;
+
+    std::vector< double > columns;      // im2col buffer, numCols x numPositions
+    std::vector< double > columnGrads;
+    std::vector< double > weightGrads;  // numRows x numCols
+
+  };
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _im2col
+  ////////////////////////////////////////////////////////////////////
+  static void _im2col (
+                       WeightLayer                 &layer,
+                       const std::vector< double > &input
+                       );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _col2im
+  ////////////////////////////////////////////////////////////////////
+  static void _col2im (
+                       const WeightLayer     &layer,
+                       std::vector< double > *pInputGrads
+                       );
+
+  std::vector< WeightLayer > m_weightLayers; // m_weightLayers[ l ] feeds m_outputs[ l + 1 ]
+
+  std::vector< std::vector< double > > m_outputs;
+  std::vector< std::vector< double > > m_gradients;
+
+  double m_error;
+  double m_recentAverageError;
+  double m_recentAverageSmoothingFactor;
+
+  LearningParams m_params;
+
+};
+
+
+} // namespace net
@@ -0,0 +1,977 @@
+#include "Gemm.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined( __linux__ )
+#include <unistd.h>
+#endif
+
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define NET_GEMM_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr unsigned maxTile        = 8 * 16; // largest register tile of any kernel
+constexpr size_t   vectorColBlock = 1024;   // output columns kept in L1 by multiplyVector
+
+
+typedef void ( *KernelFun )(
+                            size_t        kc,
+                            const double *a,
+                            const double *b,
+                            double       *c,
+                            size_t        ldc
+                            );
+
+/// \brief Kernel - microkernel computing an mr x nr tile of C
+///        from a packed A panel ( kc x mr ) and B panel ( kc x nr )
+struct Kernel
+{
+
+  unsigned    mr;
+  unsigned    nr;
+  KernelFun   run;
+  const char *name;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief genericKernel - portable fallback
+////////////////////////////////////////////////////////////////////
+template< unsigned MR, unsigned NR >
+void
+genericKernel(
+              size_t        kc,
+              const double *a,
+              const double *b,
+              double       *c,
+              size_t        ldc
+              )
+{
+
+  double acc[ MR ][ NR ] = { };
+
+  for ( size_t p = 0; p < kc; ++p, a += MR, b += NR )
+  {
+
+    for ( unsigned i = 0; i < MR; ++i )
+    {
+
+      for ( unsigned j = 0; j < NR; ++j )
+      {
+
+        acc[ i ][ j ] += a[ i ] * b[ j ];
+
+      }
+
+    }
+
+  }
+
+  for ( unsigned i = 0; i < MR; ++i )
+  {
+
+    for ( unsigned j = 0; j < NR; ++j )
+    {
+
+      c[ i * ldc + j ] += acc[ i ][ j ];
+
+    }
+
+  }
+
+}
+
+
+
+#if defined( NET_GEMM_X86 )
+
+////////////////////////////////////////////////////////////////////
+/// \brief avx2Kernel - 6 x 8 tile, 12 ymm accumulators
+////////////////////////////////////////////////////////////////////
+__attribute__( ( target( "avx2,fma" ) ) )
+void
+avx2Kernel(
+           size_t        kc,
+           const double *a,
+           const double *b,
+           double       *c,
+           size_t        ldc
+           )
+{
+
+  constexpr unsigned MR = 6;
+
+  __m256d acc[ MR ][ 2 ];
+
+#pragma GCC unroll 8
+  for ( unsigned i = 0; i < MR; ++i )
+  {
+
+    acc[ i ][ 0 ] = _mm256_setzero_pd( );
+    acc[ i ][ 1 ] = _mm256_setzero_pd( );
+
+  }
+
+  for ( size_t p = 0; p < kc; ++p, a += MR, b += 8 )
+  {
+
+    __m256d b0 = _mm256_loadu_pd( b );
+    __m256d b1 = _mm256_loadu_pd( b + 4 );
+
+#pragma GCC unroll 8
+    for ( unsigned i = 0; i < MR; ++i )
+    {
+
+      __m256d ai = _mm256_broadcast_sd( a + i );
+
+      acc[ i ][ 0 ] = _mm256_fmadd_pd( ai, b0, acc[ i ][ 0 ] );
+      acc[ i ][ 1 ] = _mm256_fmadd_pd( ai, b1, acc[ i ][ 1 ] );
+
+    }
+
+  }
+
+#pragma GCC unroll 8
+  for ( unsigned i = 0; i < MR; ++i )
+  {
+
+    double *row = c + i * ldc;
+
+    _mm256_storeu_pd( row,     _mm256_add_pd( _mm256_loadu_pd( row ),     acc[ i ][ 0 ] ) );
+    _mm256_storeu_pd( row + 4, _mm256_add_pd( _mm256_loadu_pd( row + 4 ), acc[ i ][ 1 ] ) );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief avx512Kernel - 8 x 16 tile, 16 zmm accumulators
+////////////////////////////////////////////////////////////////////
+__attribute__( ( target( "avx512f" ) ) )
+void
+avx512Kernel(
+             size_t        kc,
+             const double *a,
+             const double *b,
+             double       *c,
+             size_t        ldc
+             )
+{
+
+  constexpr unsigned MR = 8;
+
+  __m512d acc[ MR ][ 2 ];
+
+#pragma GCC unroll 8
+  for ( unsigned i = 0; i < MR; ++i )
+  {
+
+    acc[ i ][ 0 ] = _mm512_setzero_pd( );
+    acc[ i ][ 1 ] = _mm512_setzero_pd( );
+
+  }
+
+  for ( size_t p = 0; p < kc; ++p, a += MR, b += 16 )
+  {
+
+    __m512d b0 = _mm512_loadu_pd( b );
+    __m512d b1 = _mm512_loadu_pd( b + 8 );
+
+#pragma GCC unroll 8
+    for ( unsigned i = 0; i < MR; ++i )
+    {
+
+      __m512d ai = _mm512_set1_pd( a[ i ] );
+
+      acc[ i ][ 0 ] = _mm512_fmadd_pd( ai, b0, acc[ i ][ 0 ] );
+      acc[ i ][ 1 ] = _mm512_fmadd_pd( ai, b1, acc[ i ][ 1 ] );
+
+    }
+
+  }
+
+#pragma GCC unroll 8
+  for ( unsigned i = 0; i < MR; ++i )
+  {
+
+    double *row = c + i * ldc;
+
+    _mm512_storeu_pd( row,     _mm512_add_pd( _mm512_loadu_pd( row ),     acc[ i ][ 0 ] ) );
+    _mm512_storeu_pd( row + 8, _mm512_add_pd( _mm512_loadu_pd( row + 8 ), acc[ i ][ 1 ] ) );
+
+  }
+
+}
+
+#endif
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief selectKernel - widest kernel the CPU runs
+////////////////////////////////////////////////////////////////////
+Kernel
+selectKernel( )
+{
+
+#if defined( NET_GEMM_X86 )
+
+  __builtin_cpu_init( );
+
+  if ( __builtin_cpu_supports( "avx512f" ) )
+  {
+
+    return Kernel{ 8, 16, &avx512Kernel, "avx512 8x16" };
+
+  }
+
+  if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) )
+  {
+
+    return Kernel{ 6, 8, &avx2Kernel, "avx2 6x8" };
+
+  }
+
+#endif
+
+  return Kernel{ 4, 4, &genericKernel< 4, 4 >, "generic 4x4" };
+
+}
+
+
+
+const Kernel &
+kernel( )
+{
+
+  static const Kernel selected = selectKernel( );
+
+  return selected;
+
+}
+
+
+
+#if defined( _SC_LEVEL1_DCACHE_SIZE ) && defined( _SC_LEVEL2_CACHE_SIZE ) && defined( _SC_LEVEL3_CACHE_SIZE )
+
+////////////////////////////////////////////////////////////////////
+/// \brief cacheSize - bytes of a cache level (sysconf name)
+////////////////////////////////////////////////////////////////////
+size_t
+cacheSize(
+          int    name,
+          size_t fallback
+          )
+{
+
+  long bytes = sysconf( name );
+
+  return ( bytes > 0 ? static_cast< size_t >( bytes ) : fallback );
+
+}
+
+#endif
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief roundBlockSizes - multiples of the register tile
+////////////////////////////////////////////////////////////////////
+BlockSizes
+roundBlockSizes( BlockSizes sizes )
+{
+
+  const Kernel &k = kernel( );
+
+  sizes.kc = std::max< size_t >( sizes.kc / 8 * 8, 8 );
+  sizes.mc = std::max< size_t >( sizes.mc / k.mr * k.mr, k.mr );
+  sizes.nc = std::max< size_t >( sizes.nc / k.nr * k.nr, k.nr );
+
+  return sizes;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief cacheBlockSizes - block sizes derived from the caches
+////////////////////////////////////////////////////////////////////
+BlockSizes
+cacheBlockSizes( )
+{
+
+#if defined( _SC_LEVEL1_DCACHE_SIZE ) && defined( _SC_LEVEL2_CACHE_SIZE ) && defined( _SC_LEVEL3_CACHE_SIZE )
+  size_t l1 = cacheSize( _SC_LEVEL1_DCACHE_SIZE, 32 << 10 );
+  size_t l2 = cacheSize( _SC_LEVEL2_CACHE_SIZE,  256 << 10 );
+  size_t l3 = cacheSize( _SC_LEVEL3_CACHE_SIZE,  8 << 20 );
+#else
+  size_t l1 = 32 << 10;
+  size_t l2 = 256 << 10;
+  size_t l3 = 8 << 20;
+#endif
+
+  const Kernel &k = kernel( );
+
+  BlockSizes sizes;
+
+  // the B micro panel takes half of L1, the A micro panel and C tile the rest
+  sizes.kc = std::min< size_t >( std::max< size_t >( l1 / 2 / ( k.nr * sizeof( double ) ), 64 ), 512 );
+
+  // the packed A block takes half of L2
+  sizes.mc = std::min< size_t >( std::max< size_t >( l2 / 2 / ( sizes.kc * sizeof( double ) ), k.mr ), 1024 );
+
+  // the packed B block takes a quarter of the (shared) last level
+  sizes.nc = std::min< size_t >( std::max< size_t >( l3 / 4 / ( sizes.kc * sizeof( double ) ), k.nr ), 4096 );
+
+  return roundBlockSizes( sizes );
+
+}
+
+
+
+BlockSizes &
+blockSizes( )
+{
+
+  static BlockSizes sizes = cacheBlockSizes( );
+
+  return sizes;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief packA - rows [ ic, ic + m ) and columns [ pc, pc + kc )
+///        of A as zero padded panels of mr rows, column by column
+////////////////////////////////////////////////////////////////////
+void
+packA(
+      const MatrixView &a,
+      size_t            ic,
+      size_t            pc,
+      size_t            m,
+      size_t            kc,
+      unsigned          mr,
+      double           *out
+      )
+{
+
+  for ( size_t ir = 0; ir < m; ir += mr, out += kc * mr )
+  {
+
+    size_t rows = std::min< size_t >( mr, m - ir );
+
+    if ( rows < mr )
+    {
+
+      std::fill( out, out + kc * mr, 0.0 );
+
+    }
+
+    for ( size_t i = 0; i < rows; ++i )
+    {
+
+      for ( size_t p = 0; p < kc; ++p )
+      {
+
+        out[ p * mr + i ] = a( ic + ir + i, pc + p );
+
+      }
+
+    }
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief packB - rows [ pc, pc + kc ) and columns [ jc, jc + n )
+///        of B as zero padded panels of nr columns, row by row
+////////////////////////////////////////////////////////////////////
+void
+packB(
+      const MatrixView &b,
+      size_t            pc,
+      size_t            jc,
+      size_t            kc,
+      size_t            n,
+      unsigned          nr,
+      size_t            panelStride,
+      double           *out
+      )
+{
+
+  for ( size_t jr = 0; jr < n; jr += nr, out += panelStride )
+  {
+
+    size_t cols = std::min< size_t >( nr, n - jr );
+
+    for ( size_t p = 0; p < kc; ++p )
+    {
+
+      double *row = out + p * nr;
+
+      for ( size_t j = 0; j < cols; ++j )
+      {
+
+        row[ j ] = b( pc + p, jc + jr + j );
+
+      }
+
+      std::fill( row + cols, row + nr, 0.0 );
+
+    }
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief clear - zeroes an m x n block of C
+////////////////////////////////////////////////////////////////////
+void
+clear(
+      size_t  m,
+      size_t  n,
+      double *c,
+      size_t  ldc
+      )
+{
+
+  for ( size_t i = 0; i < m; ++i )
+  {
+
+    std::fill( c + i * ldc, c + i * ldc + n, 0.0 );
+
+  }
+
+}
+
+} // namespace
+
+
+
+constexpr size_t Gemm::vectorLanes;
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PackedMatrix::PackedMatrix
+////////////////////////////////////////////////////////////////////
+PackedMatrix::PackedMatrix( )
+  : numRows_   ( 0 )
+  , numCols_   ( 0 )
+  , panelWidth_( kernel( ).nr )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PackedMatrix::PackedMatrix
+////////////////////////////////////////////////////////////////////
+PackedMatrix::PackedMatrix(
+                           size_t            numRows,
+                           size_t            numCols,
+                           const MatrixView &source
+                           )
+  : numRows_   ( numRows )
+  , numCols_   ( numCols )
+  , panelWidth_( kernel( ).nr )
+{
+
+  size_t numPanels   = ( numCols + panelWidth_ - 1 ) / panelWidth_;
+  size_t panelStride = numRows * panelWidth_;
+
+  data_.resize( numPanels * panelStride );
+
+  packB( source, 0, 0, numRows, numCols, panelWidth_, panelStride, data_.data( ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::_multiplyBlock
+///
+///        Packs A block by block (mc rows) and runs the microkernel
+///        over every tile, B panel by B panel so each B micro panel
+///        stays in L1 while the packed A block streams from L2
+///
+////////////////////////////////////////////////////////////////////
+void
+Gemm::_multiplyBlock(
+                     size_t            m,
+                     size_t            n,
+                     size_t            kc,
+                     const MatrixView &a,
+                     size_t            pc,
+                     const double     *bPanels,
+                     size_t            bPanelStride,
+                     double           *c,
+                     size_t            ldc
+                     )
+{
+
+  const Kernel     &k     = kernel( );
+  const BlockSizes &sizes = blockSizes( );
+
+  thread_local std::vector< double > aPacked;
+
+  for ( size_t ic = 0; ic < m; ic += sizes.mc )
+  {
+
+    size_t mc = std::min( sizes.mc, m - ic );
+
+    aPacked.resize( ( mc + k.mr - 1 ) / k.mr * k.mr * kc );
+
+    packA( a, ic, pc, mc, kc, k.mr, aPacked.data( ) );
+
+    for ( size_t jr = 0; jr < n; jr += k.nr )
+    {
+
+      size_t        cols = std::min< size_t >( k.nr, n - jr );
+      const double *bp   = bPanels + ( jr / k.nr ) * bPanelStride;
+
+      for ( size_t ir = 0; ir < mc; ir += k.mr )
+      {
+
+        size_t        rows = std::min< size_t >( k.mr, mc - ir );
+        const double *ap   = aPacked.data( ) + ir * kc;
+        double       *cp   = c + ( ic + ir ) * ldc + jr;
+
+        if ( rows == k.mr && cols == k.nr )
+        {
+
+          k.run( kc, ap, bp, cp, ldc );
+
+        }
+        else
+        {
+
+          //
+          // partial tile through a full size scratch tile
+          //
+          double edge[ maxTile ] = { };
+
+          k.run( kc, ap, bp, edge, k.nr );
+
+          for ( size_t i = 0; i < rows; ++i )
+          {
+
+            for ( size_t j = 0; j < cols; ++j )
+            {
+
+              cp[ i * ldc + j ] += edge[ i * k.nr + j ];
+
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+} // Gemm::_multiplyBlock
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::multiply
+////////////////////////////////////////////////////////////////////
+void
+Gemm::multiply(
+               size_t            m,
+               size_t            n,
+               size_t            k,
+               const MatrixView &a,
+               const MatrixView &b,
+               double           *c,
+               size_t            ldc,
+               bool              accumulate
+               )
+{
+
+  if ( !accumulate )
+  {
+
+    clear( m, n, c, ldc );
+
+  }
+
+  if ( m == 0 || n == 0 || k == 0 )
+  {
+
+    return;
+
+  }
+
+  const unsigned    nr    = kernel( ).nr;
+  const BlockSizes &sizes = blockSizes( );
+
+  thread_local std::vector< double > bPacked;
+
+  for ( size_t jc = 0; jc < n; jc += sizes.nc )
+  {
+
+    size_t nc = std::min( sizes.nc, n - jc );
+
+    for ( size_t pc = 0; pc < k; pc += sizes.kc )
+    {
+
+      size_t kc          = std::min( sizes.kc, k - pc );
+      size_t panelStride = kc * nr;
+
+      bPacked.resize( ( nc + nr - 1 ) / nr * panelStride );
+
+      packB( b, pc, jc, kc, nc, nr, panelStride, bPacked.data( ) );
+
+      _multiplyBlock( m, nc, kc, a, pc, bPacked.data( ), panelStride, c + jc, ldc );
+
+    }
+
+  }
+
+} // Gemm::multiply
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::multiply
+////////////////////////////////////////////////////////////////////
+void
+Gemm::multiply(
+               size_t              m,
+               const MatrixView   &a,
+               const PackedMatrix &b,
+               double             *c,
+               size_t              ldc,
+               bool                accumulate
+               )
+{
+
+  size_t n = b.numCols_;
+  size_t k = b.numRows_;
+
+  if ( !accumulate )
+  {
+
+    clear( m, n, c, ldc );
+
+  }
+
+  if ( m == 0 || n == 0 || k == 0 )
+  {
+
+    return;
+
+  }
+
+  const unsigned    nr    = kernel( ).nr;
+  const BlockSizes &sizes = blockSizes( );
+
+  assert( b.panelWidth_ == nr );
+
+  //
+  // the rows [ pc, pc + kc ) of a packed panel are contiguous
+  //
+  size_t panelStride = k * nr;
+
+  for ( size_t jc = 0; jc < n; jc += sizes.nc )
+  {
+
+    size_t nc = std::min( sizes.nc, n - jc );
+
+    for ( size_t pc = 0; pc < k; pc += sizes.kc )
+    {
+
+      size_t        kc      = std::min( sizes.kc, k - pc );
+      const double *bPanels = b.data_.data( ) + ( jc / nr ) * panelStride + pc * nr;
+
+      _multiplyBlock( m, nc, kc, a, pc, bPanels, panelStride, c + jc, ldc );
+
+    }
+
+  }
+
+} // Gemm::multiply
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::multiplyVector
+///
+///        Four rows per sweep over an L1 sized block of y, each
+///        y[ c ] still summed in row order
+///
+////////////////////////////////////////////////////////////////////
+void
+Gemm::multiplyVector(
+                     size_t            numRows,
+                     size_t            numCols,
+                     const double     *x,
+                     const Connection *weights,
+                     const Connection *biases,
+                     double           *y
+                     )
+{
+
+  assert( numRows % vectorLanes == 0 && numCols % vectorLanes == 0 );
+
+  std::fill( y, y + numCols, 0.0 );
+
+  for ( size_t cb = 0; cb < numCols; cb += vectorColBlock )
+  {
+
+    size_t ce = std::min( cb + vectorColBlock, numCols );
+
+    for ( size_t r = 0; r < numRows; r += 4 )
+    {
+
+      const Connection *w0 = weights + r * numCols;
+      const Connection *w1 = w0 + numCols;
+      const Connection *w2 = w1 + numCols;
+      const Connection *w3 = w2 + numCols;
+
+      const double x0 = x[ r ];
+      const double x1 = x[ r + 1 ];
+      const double x2 = x[ r + 2 ];
+      const double x3 = x[ r + 3 ];
+
+      for ( size_t c = cb; c < ce; c += vectorLanes )
+      {
+
+        for ( size_t j = c; j < c + vectorLanes; ++j )
+        {
+
+          y[ j ] = ( ( ( y[ j ] + x0 * w0[ j ].weight ) + x1 * w1[ j ].weight ) + x2 * w2[ j ].weight ) + x3 * w3[ j ].weight;
+
+        }
+
+      }
+
+    }
+
+  }
+
+  for ( size_t c = 0; c < numCols; ++c )
+  {
+
+    y[ c ] += biases[ c ].weight;
+
+  }
+
+} // Gemm::multiplyVector
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::updateWeights
+////////////////////////////////////////////////////////////////////
+void
+Gemm::updateWeights(
+                    size_t                numRows,
+                    size_t                numCols,
+                    const double         *x,
+                    const double         *g,
+                    Connection           *weights,
+                    const LearningParams &params
+                    )
+{
+
+  assert( numCols % vectorLanes == 0 );
+
+  const double momentum = params.alpha;
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    Connection   *w    = weights + r * numCols;
+    const double  etaX = params.eta * x[ r ];
+
+    for ( size_t c = 0; c < numCols; c += vectorLanes )
+    {
+
+      for ( size_t j = c; j < c + vectorLanes; ++j )
+      {
+
+        double newDeltaWeight =
+          // individual input magnified by the gradient and train rate
+          etaX * g[ j ]
+          // momentum - a fraction of the previous delta weight
+          + momentum * w[ j ].deltaWeight;
+
+        w[ j ].deltaWeight = newDeltaWeight;
+        w[ j ].weight     += newDeltaWeight;
+
+      }
+
+    }
+
+  }
+
+} // Gemm::updateWeights
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::updateWeightsAndPropagate
+///
+///        Four rows at a time share each load of g and give four
+///        independent sums in flight; each connection is read
+///        once and written once
+///
+////////////////////////////////////////////////////////////////////
+void
+Gemm::updateWeightsAndPropagate(
+                                size_t                numRows,
+                                size_t                numCols,
+                                const double         *x,
+                                const double         *g,
+                                Connection           *weights,
+                                const LearningParams &params,
+                                double               *y
+                                )
+{
+
+  assert( numRows % vectorLanes == 0 && numCols % vectorLanes == 0 );
+
+  const double momentum = params.alpha;
+
+  //
+  // sum with the old weight, then apply the momentum update
+  //
+  auto step = [ momentum ]( Connection &connection, double etaX, double gc, double &sum )
+  {
+
+    sum += connection.weight * gc;
+
+    double newDeltaWeight = etaX * gc + momentum * connection.deltaWeight;
+
+    connection.deltaWeight = newDeltaWeight;
+    connection.weight     += newDeltaWeight;
+
+  };
+
+  for ( size_t r = 0; r < numRows; r += 4 )
+  {
+
+    Connection *w0 = weights + r * numCols;
+    Connection *w1 = w0 + numCols;
+    Connection *w2 = w1 + numCols;
+    Connection *w3 = w2 + numCols;
+
+    const double etaX0 = params.eta * x[ r ];
+    const double etaX1 = params.eta * x[ r + 1 ];
+    const double etaX2 = params.eta * x[ r + 2 ];
+    const double etaX3 = params.eta * x[ r + 3 ];
+
+    double s0 = 0.0;
+    double s1 = 0.0;
+    double s2 = 0.0;
+    double s3 = 0.0;
+
+    for ( size_t c = 0; c < numCols; ++c )
+    {
+
+      const double gc = g[ c ];
+
+      step( w0[ c ], etaX0, gc, s0 );
+      step( w1[ c ], etaX1, gc, s1 );
+      step( w2[ c ], etaX2, gc, s2 );
+      step( w3[ c ], etaX3, gc, s3 );
+
+    }
+
+    y[ r     ] = s0;
+    y[ r + 1 ] = s1;
+    y[ r + 2 ] = s2;
+    y[ r + 3 ] = s3;
+
+  }
+
+} // Gemm::updateWeightsAndPropagate
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::updateBiases
+////////////////////////////////////////////////////////////////////
+void
+Gemm::updateBiases(
+                   size_t                numCols,
+                   const double         *g,
+                   Connection           *biases,
+                   const LearningParams &params
+                   )
+{
+
+  const double one = 1.0;
+
+  updateWeights( 1, numCols, &one, g, biases, params );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::getBlockSizes
+////////////////////////////////////////////////////////////////////
+BlockSizes
+Gemm::getBlockSizes( )
+{
+
+  return blockSizes( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::setBlockSizes
+////////////////////////////////////////////////////////////////////
+void
+Gemm::setBlockSizes( const BlockSizes &sizes )
+{
+
+  blockSizes( ) = roundBlockSizes( sizes );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Gemm::getKernelName
+////////////////////////////////////////////////////////////////////
+const char *
+Gemm::getKernelName( )
+{
+
+  return kernel( ).name;
+
+}
+
+
+} // namespace net
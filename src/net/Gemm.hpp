@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "CommonStructs.hpp"
+
+
+namespace net
+{
+
+
+/// \brief MatrixView - read only strided view of a matrix,
+///        element ( r, c ) is data[ r * rowStride + c * colStride ]
+struct MatrixView
+{
+
+  const double *data;
+  size_t        rowStride;
+  size_t        colStride;
+
+  double operator() ( size_t r, size_t c ) const { return data[ r * rowStride + c * colStride ]; }
+
+};
+
+
+/// \brief BlockSizes - cache blocking used by Gemm::multiply
+struct BlockSizes
+{
+
+  size_t kc; ///< depth of the packed panels (a panel pair fits in L1)
+  size_t mc; ///< rows of a packed left hand block (fits in L2)
+  size_t nc; ///< right hand columns per pass (fits in the last level cache)
+
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The PackedMatrix class
+///
+///        Right hand operand of Gemm::multiply packed once into
+///        zero padded column panels as wide as the microkernel,
+///        for matrices that are multiplied many times (weights)
+///
+////////////////////////////////////////////////////////////////////
+class PackedMatrix
+{
+
+public:
+
+  PackedMatrix( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief PackedMatrix
+  /// \param numRows
+  /// \param numCols
+  /// \param source - matrix to pack
+  ////////////////////////////////////////////////////////////////////
+  PackedMatrix(
+               size_t            numRows,
+               size_t            numCols,
+               const MatrixView &source
+               );
+
+  size_t getNumRows ( ) const { return numRows_; }
+  size_t getNumCols ( ) const { return numCols_; }
+
+
+private:
+
+  friend class Gemm;
+
+  size_t                numRows_;
+  size_t                numCols_;
+  size_t                panelWidth_;
+  std::vector< double > data_; // panel p holds columns [ p * panelWidth_, ( p + 1 ) * panelWidth_ )
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The Gemm class
+///
+///        Dense kernels behind ConnectedNet.
+///
+///        multiply is a packed, cache blocked matrix product with
+///        a register tiled microkernel picked at startup for the
+///        widest instruction set the CPU supports (AVX-512, AVX2
+///        with FMA, or portable C++). Block sizes are derived from
+///        the cache sizes on first use and can be set explicitly.
+///
+///        The single sample kernels walk the weight rows front to
+///        back and add in the same order as a plain per neuron
+///        loop, so their results are bit for bit those of the
+///        straightforward implementation. They take layers padded
+///        with zeroed neurons to a multiple of vectorLanes (see
+///        padLanes), so they have no remainder loops.
+///
+////////////////////////////////////////////////////////////////////
+class Gemm
+{
+
+public:
+
+  static constexpr size_t vectorLanes = 8; ///< doubles per 64 byte vector
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief padLanes
+  /// \return count rounded up to a multiple of vectorLanes
+  ////////////////////////////////////////////////////////////////////
+  static size_t padLanes ( size_t count ) { return ( count + vectorLanes - 1 ) / vectorLanes * vectorLanes; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief multiply - C = A * B (or C += A * B)
+  /// \param m - rows of A and C
+  /// \param n - columns of B and C
+  /// \param k - columns of A, rows of B
+  /// \param a
+  /// \param b
+  /// \param c - row major output
+  /// \param ldc - row stride of C
+  /// \param accumulate - add to C instead of overwriting it
+  ////////////////////////////////////////////////////////////////////
+  static void multiply (
+                        size_t            m,
+                        size_t            n,
+                        size_t            k,
+                        const MatrixView &a,
+                        const MatrixView &b,
+                        double           *c,
+                        size_t            ldc,
+                        bool              accumulate = false
+                        );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief multiply - C = A * B (or C += A * B) with prepacked B
+  ////////////////////////////////////////////////////////////////////
+  static void multiply (
+                        size_t              m,
+                        const MatrixView   &a,
+                        const PackedMatrix &b,
+                        double             *c,
+                        size_t              ldc,
+                        bool                accumulate = false
+                        );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief multiplyVector - y = x * W + b
+  ///
+  ///        Forward pass of one sample. W is numRows rows of
+  ///        numCols connections and the biases are added last (in
+  ///        place of a row of ones times a bias row).
+  ///
+  /// \param numRows - multiple of vectorLanes
+  /// \param numCols - multiple of vectorLanes
+  /// \param x
+  /// \param weights
+  /// \param biases - numCols connections
+  /// \param y
+  ////////////////////////////////////////////////////////////////////
+  static void multiplyVector (
+                              size_t            numRows,
+                              size_t            numCols,
+                              const double     *x,
+                              const Connection *weights,
+                              const Connection *biases,
+                              double           *y
+                              );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief updateWeights
+  ///
+  ///        Momentum update of one sample's weight gradient, the
+  ///        outer product of the row inputs x and column gradients g
+  ///        (numCols a multiple of vectorLanes)
+  ///
+  ////////////////////////////////////////////////////////////////////
+  static void updateWeights (
+                             size_t                numRows,
+                             size_t                numCols,
+                             const double         *x,
+                             const double         *g,
+                             Connection           *weights,
+                             const LearningParams &params
+                             );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief updateWeightsAndPropagate
+  ///
+  ///        Backward pass of one sample, y = W * g (each row's sum
+  ///        of weighted downstream gradients), and updateWeights
+  ///        in a single pass over W: each weight is added to y
+  ///        before it is updated, so W is read and written only
+  ///        once (numRows and numCols multiples of vectorLanes)
+  ///
+  ////////////////////////////////////////////////////////////////////
+  static void updateWeightsAndPropagate (
+                                         size_t                numRows,
+                                         size_t                numCols,
+                                         const double         *x,
+                                         const double         *g,
+                                         Connection           *weights,
+                                         const LearningParams &params,
+                                         double               *y
+                                         );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief updateBiases
+  ///
+  ///        updateWeights for the biases of a layer (a row whose
+  ///        input is always one)
+  ///
+  /// \param numCols - multiple of vectorLanes
+  /// \param g - column gradients
+  /// \param biases
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  static void updateBiases (
+                            size_t                numCols,
+                            const double         *g,
+                            Connection           *biases,
+                            const LearningParams &params
+                            );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getBlockSizes
+  /// \return block sizes used by multiply
+  ////////////////////////////////////////////////////////////////////
+  static BlockSizes getBlockSizes ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setBlockSizes
+  ///
+  ///        Not safe while another thread is multiplying
+  ///
+  /// \param sizes - rounded to what the microkernel needs
+  ////////////////////////////////////////////////////////////////////
+  static void setBlockSizes ( const BlockSizes &sizes );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getKernelName
+  /// \return instruction set and register tile of the microkernel
+  ////////////////////////////////////////////////////////////////////
+  static const char *getKernelName ( );
+
+
+private:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _multiplyBlock - C += A * B for one packed panel of B
+  ////////////////////////////////////////////////////////////////////
+  static void _multiplyBlock (
+                              size_t            m,
+                              size_t            n,
+                              size_t            kc,
+                              const MatrixView &a,
+                              size_t            pc,
+                              const double     *bPanels,
+                              size_t            bPanelStride,
+                              double           *c,
+                              size_t            ldc
+                              );
+
+};
+
+
+} // namespace net
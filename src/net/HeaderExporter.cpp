@@ -0,0 +1,420 @@
+#include "HeaderExporter.hpp"
+#include "ConnectedNet.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+
+namespace net
+{
+
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////
+/// \brief literal - a double that reads back to exactly the same value
+////////////////////////////////////////////////////////////////////
+std::string
+literal( double value )
+{
+
+  if ( !std::isfinite( value ) )
+  {
+
+    throw std::runtime_error( "Can't export a net with non-finite weights" );
+
+  }
+
+  std::ostringstream stream;
+
+  stream << std::setprecision( 17 ) << value;
+
+  std::string text = stream.str( );
+
+  // keep it a double literal
+  if ( text.find_first_of( ".e" ) == std::string::npos )
+  {
+
+    text += ".0";
+
+  }
+
+  return text;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief isKeyword - C++ keywords and alternative tokens (up to
+///        C++20, so the header keeps compiling with newer standards)
+////////////////////////////////////////////////////////////////////
+bool
+isKeyword( const std::string &name )
+{
+
+  static const std::unordered_set< std::string > keywords = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+    "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept",
+    "const", "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await",
+    "co_return", "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+    "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+    "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local",
+    "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+  };
+
+  return keywords.count( name ) > 0;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief isIdentifier
+////////////////////////////////////////////////////////////////////
+bool
+isIdentifier( const std::string &name )
+{
+
+  if ( name.empty( ) || std::isdigit( static_cast< unsigned char >( name[ 0 ] ) ) || isKeyword( name ) )
+  {
+
+    return false;
+
+  }
+
+  for ( char c : name )
+  {
+
+    if ( !std::isalnum( static_cast< unsigned char >( c ) ) && c != '_' )
+    {
+
+      return false;
+
+    }
+
+  }
+
+  return true;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief writeArrays - weights and biases of one layer
+////////////////////////////////////////////////////////////////////
+void
+writeArrays(
+            std::ostream                &out,
+            unsigned                     layerNum,
+            unsigned                     numRows,
+            unsigned                     numCols,
+            const std::vector< double > &weights
+            )
+{
+
+  out << "alignas( 64 ) static constexpr double layer" << layerNum
+      << "Weights[ " << numRows << " ][ " << numCols << " ] =\n{\n";
+
+  for ( unsigned r = 0; r < numRows; ++r )
+  {
+
+    out << "  {";
+
+    for ( unsigned c = 0; c < numCols; ++c )
+    {
+
+      out << ( c % 4 == 0 ? "\n    " : " " )
+          << literal( weights[ r * ( numCols + 1 ) + c ] ) << ",";
+
+    }
+
+    out << "\n  },\n";
+
+  }
+
+  out << "};\n\n";
+
+  out << "alignas( 64 ) static constexpr double layer" << layerNum
+      << "Biases[ " << numRows << " ] =\n{";
+
+  for ( unsigned r = 0; r < numRows; ++r )
+  {
+
+    out << ( r % 4 == 0 ? "\n  " : " " )
+        << literal( weights[ r * ( numCols + 1 ) + numCols ] ) << ",";
+
+  }
+
+  out << "\n};\n\n\n";
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief writeLayer - the inference statements of one layer
+/// \param out
+/// \param layerNum
+/// \param numRows
+/// \param numCols
+/// \param in - name of the input array
+/// \param result - name of the output array
+/// \param activate - wrap the sums in tanh
+////////////////////////////////////////////////////////////////////
+void
+writeLayer(
+           std::ostream      &out,
+           unsigned           layerNum,
+           unsigned           numRows,
+           unsigned           numCols,
+           const std::string &in,
+           const std::string &result,
+           bool               activate
+           )
+{
+
+  std::string weights = "layer" + std::to_string( layerNum ) + "Weights";
+  std::string biases  = "layer" + std::to_string( layerNum ) + "Biases";
+
+  const char *open  = activate ? "std::tanh( " : "";
+  const char *close = activate ? " )" : "";
+
+  out << "  // layer " << layerNum << ": " << numCols << " -> " << numRows << "\n";
+
+  if ( static_cast< size_t >( numRows ) * numCols <= HeaderExporter::unrollLimit )
+  {
+
+    for ( unsigned r = 0; r < numRows; ++r )
+    {
+
+      out << "  " << result << "[ " << r << " ] = " << open << biases << "[ " << r << " ]";
+
+      for ( unsigned c = 0; c < numCols; ++c )
+      {
+
+        out << "\n    + " << weights << "[ " << r << " ][ " << c << " ] * " << in << "[ " << c << " ]";
+
+      }
+
+      out << close << ";\n";
+
+    }
+
+  }
+  else
+  {
+
+    out << "  for ( unsigned r = 0; r < " << numRows << "; ++r )\n"
+        << "  {\n\n"
+        << "    double sum = " << biases << "[ r ];\n\n"
+        << "    for ( unsigned c = 0; c < " << numCols << "; ++c )\n"
+        << "    {\n\n"
+        << "      sum += " << weights << "[ r ][ c ] * " << in << "[ c ];\n\n"
+        << "    }\n\n"
+        << "    " << result << "[ r ] = " << open << "sum" << close << ";\n\n"
+        << "  }\n";
+
+  }
+
+  out << "\n";
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief HeaderExporter::write
+////////////////////////////////////////////////////////////////////
+void
+HeaderExporter::write(
+                      const ConnectedNet &net,
+                      const std::string  &name,
+                      std::ostream       &out
+                      )
+{
+
+  if ( !isIdentifier( name ) )
+  {
+
+    throw std::runtime_error( "'" + name + "' is not a valid namespace name" );
+
+  }
+
+  std::vector< unsigned > topology = net.getTopology( );
+
+  unsigned numLayers  = static_cast< unsigned >( topology.size( ) );
+  unsigned numInputs  = topology.front( );
+  unsigned numOutputs = topology.back( );
+  bool     softmax    = net.getOutputHead( ) == OutputHead::Softmax;
+
+  out << "// Generated by net::HeaderExporter -- do not edit\n"
+      << "//\n"
+      << "// topology:";
+
+  for ( unsigned size : topology )
+  {
+
+    out << " " << size;
+
+  }
+
+  out << ", " << ( softmax ? "softmax" : "tanh" ) << " outputs\n"
+      << "//\n"
+      << "#pragma once\n\n"
+      << "#include <cmath>\n\n\n"
+      << "namespace " << name << "\n{\n\n\n"
+      << "constexpr unsigned numInputs  = " << numInputs << ";\n"
+      << "constexpr unsigned numOutputs = " << numOutputs << ";\n\n\n";
+
+  std::vector< double > weights;
+
+  for ( unsigned layerNum = 1; layerNum < numLayers; ++layerNum )
+  {
+
+    net.getWeights( layerNum, &weights );
+    writeArrays( out, layerNum, topology[ layerNum ], topology[ layerNum - 1 ], weights );
+
+  }
+
+  out << "////////////////////////////////////////////////////////////////////\n"
+      << "/// \\brief evaluate\n"
+      << "/// \\param inputs - numInputs values\n"
+      << "/// \\param outputs - numOutputs values\n"
+      << "////////////////////////////////////////////////////////////////////\n"
+      << "inline void\n"
+      << "evaluate(\n"
+      << "         const double *inputs,\n"
+      << "         double       *outputs\n"
+      << "         )\n"
+      << "{\n\n";
+
+  std::string in = "inputs";
+
+  for ( unsigned layerNum = 1; layerNum < numLayers; ++layerNum )
+  {
+
+    bool        last   = layerNum + 1 == numLayers;
+    std::string result = last ? "outputs" : "layer" + std::to_string( layerNum );
+
+    if ( !last )
+    {
+
+      out << "  alignas( 64 ) double " << result << "[ " << topology[ layerNum ] << " ];\n\n";
+
+    }
+
+    writeLayer( out, layerNum, topology[ layerNum ], topology[ layerNum - 1 ], in, result, !( last && softmax ) );
+
+    in = result;
+
+  }
+
+  if ( softmax )
+  {
+
+    out << "  // softmax\n"
+        << "  double maxLogit = outputs[ 0 ];\n\n"
+        << "  for ( unsigned i = 1; i < numOutputs; ++i )\n"
+        << "  {\n\n"
+        << "    maxLogit = outputs[ i ] > maxLogit ? outputs[ i ] : maxLogit;\n\n"
+        << "  }\n\n"
+        << "  double sum = 0.0;\n\n"
+        << "  for ( unsigned i = 0; i < numOutputs; ++i )\n"
+        << "  {\n\n"
+        << "    outputs[ i ] = std::exp( outputs[ i ] - maxLogit );\n"
+        << "    sum         += outputs[ i ];\n\n"
+        << "  }\n\n"
+        << "  for ( unsigned i = 0; i < numOutputs; ++i )\n"
+        << "  {\n\n"
+        << "    outputs[ i ] /= sum;\n\n"
+        << "  }\n\n";
+
+  }
+
+  out << "} // evaluate\n\n\n"
+      << "} // namespace " << name << "\n";
+
+} // HeaderExporter::write
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief HeaderExporter::writeFile
+////////////////////////////////////////////////////////////////////
+void
+HeaderExporter::writeFile(
+                          const ConnectedNet &net,
+                          const std::string  &path
+                          )
+{
+
+  // namespace from the file name: directories and extension dropped,
+  // anything else that isn't allowed in an identifier replaced
+  std::string name = path.substr( path.find_last_of( "/\\" ) + 1 );
+
+  name = name.substr( 0, name.find( '.' ) );
+
+  for ( char &c : name )
+  {
+
+    if ( !std::isalnum( static_cast< unsigned char >( c ) ) )
+    {
+
+      c = '_';
+
+    }
+
+  }
+
+  if ( !name.empty( ) && std::isdigit( static_cast< unsigned char >( name[ 0 ] ) ) )
+  {
+
+    name = "net_" + name;
+
+  }
+
+  // 'int.hpp' can't be namespace int
+  if ( isKeyword( name ) )
+  {
+
+    name += "_net";
+
+  }
+
+  std::ofstream out( path );
+
+  if ( !out )
+  {
+
+    throw std::runtime_error( "Could not open '" + path + "' for writing" );
+
+  }
+
+  write( net, name, out );
+
+  if ( !out )
+  {
+
+    throw std::runtime_error( "Could not write '" + path + "'" );
+
+  }
+
+} // HeaderExporter::writeFile
+
+
+} // namespace net
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+
+namespace net
+{
+
+
+class ConnectedNet;
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The HeaderExporter class
+///
+///        Writes a trained ConnectedNet as a self-contained C++
+///        header: the weights become alignas( 64 ) static constexpr
+///        arrays and inference an inline function written out for
+///        that exact topology and output head. Code including the
+///        header needs neither this library nor a model file, and
+///        the compiler sees every weight and loop bound.
+///
+///        Layers up to unrollLimit weights are written as straight
+///        line code (one expression per neuron); larger layers use
+///        loops with constant bounds, which the compiler unrolls
+///        and vectorizes as it sees fit without the header growing
+///        with the square of the layer width.
+///
+////////////////////////////////////////////////////////////////////
+class HeaderExporter
+{
+
+public:
+
+  static constexpr size_t unrollLimit = 1024; ///< weights per fully unrolled layer
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief write
+  /// \param net
+  /// \param name - namespace holding the generated code (a C++
+  ///               identifier, not a keyword)
+  /// \param out
+  ////////////////////////////////////////////////////////////////////
+  static void write (
+                     const ConnectedNet &net,
+                     const std::string  &name,
+                     std::ostream       &out
+                     );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief writeFile
+  ///
+  ///        write to 'path', named after the file ( 'xor_net.hpp'
+  ///        becomes namespace xor_net, a keyword gets a suffix:
+  ///        'new.hpp' becomes new_net )
+  ///
+  /// \param net
+  /// \param path
+  ////////////////////////////////////////////////////////////////////
+  static void writeFile (
+                         const ConnectedNet &net,
+                         const std::string  &path
+                         );
+
+};
+
+
+} // namespace net
@@ -0,0 +1,255 @@
+#include "HyperSearch.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "MultiTrainer.hpp"
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief HyperSearch::HyperSearch
+////////////////////////////////////////////////////////////////////
+HyperSearch::HyperSearch( const SearchOptions &options )
+  : options_( options )
+{
+
+  if ( !( options_.keepFraction > 0.0 && options_.keepFraction < 1.0 ) )
+  {
+
+    throw std::runtime_error( "Search keep fraction must be between 0 and 1" );
+
+  }
+
+  if ( options_.minBudget == 0 )
+  {
+
+    throw std::runtime_error( "Search budget must be positive" );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief HyperSearch::addCandidate
+/// \param config
+////////////////////////////////////////////////////////////////////
+void
+HyperSearch::addCandidate( const HyperConfig &config )
+{
+
+  // net doesn't make sense without at least input and output layers
+  if ( config.topology.size( ) < 2 )
+  {
+
+    throw std::runtime_error( "Must provide a topology with at least 2 layers" );
+
+  }
+
+  candidates_.push_back( config );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief HyperSearch::addRandomCandidates
+////////////////////////////////////////////////////////////////////
+void
+HyperSearch::addRandomCandidates(
+                                 unsigned           count,
+                                 const SearchSpace &space,
+                                 unsigned           seed
+                                 )
+{
+
+  if ( space.topologies.empty( ) )
+  {
+
+    throw std::runtime_error( "Search space has no topologies" );
+
+  }
+
+  std::default_random_engine generator( seed );
+
+  std::uniform_int_distribution< size_t >  topologyDist( 0, space.topologies.size( ) - 1 );
+  std::uniform_real_distribution< double > logEtaDist  ( std::log( space.minEta ), std::log( space.maxEta ) );
+  std::uniform_real_distribution< double > alphaDist   ( space.minAlpha, space.maxAlpha );
+  std::uniform_int_distribution< unsigned > seedDist;
+
+  for ( unsigned i = 0; i < count; ++i )
+  {
+
+    HyperConfig config;
+
+    config.topology     = space.topologies[ topologyDist( generator ) ];
+    config.params.eta   = std::exp( logEtaDist( generator ) );
+    config.params.alpha = alphaDist( generator );
+    config.seed         = seedDist( generator );
+
+    addCandidate( config );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief HyperSearch::run
+////////////////////////////////////////////////////////////////////
+SearchResult
+HyperSearch::run(
+                 TrainFun inputFun,
+                 TrainFun targetFun
+                 )
+{
+
+  if ( candidates_.empty( ) )
+  {
+
+    throw std::runtime_error( "No search candidates" );
+
+  }
+
+  //
+  // held-out samples, packed for feedForwardBatch
+  //
+  std::vector< double > validationInputs;
+  std::vector< double > validationTargets;
+
+  for ( unsigned s = 0; s < options_.validationSize; ++s )
+  {
+
+    std::vector< double > input  = inputFun( );
+    std::vector< double > target = targetFun( );
+
+    validationInputs.insert ( validationInputs.end( ),  input.begin( ),  input.end( )  );
+    validationTargets.insert( validationTargets.end( ), target.begin( ), target.end( ) );
+
+  }
+
+  //
+  // candidate nets
+  //
+  std::vector< std::unique_ptr< ConnectedNet > > nets;
+  std::vector< unsigned long >                   iterations( candidates_.size( ), 0 );
+  std::vector< double >                          errors( candidates_.size( ) );
+
+  for ( const HyperConfig &config : candidates_ )
+  {
+
+    ConnectedNet::seedWeights( config.seed );
+
+    nets.emplace_back( new ConnectedNet( config.topology, options_.errorSmoothing ) );
+    nets.back( )->setLearningParams( config.params );
+    nets.back( )->setOutputHead( options_.outputHead );
+
+  }
+
+  std::vector< size_t > alive( candidates_.size( ) );
+  std::iota( alive.begin( ), alive.end( ), 0 );
+
+  unsigned long budget    = options_.minBudget;
+  unsigned      numRounds = 0;
+  std::vector< double > results;
+  std::vector< size_t > roundSizes;
+
+  for ( ;; )
+  {
+
+    ++numRounds;
+    roundSizes.push_back( alive.size( ) );
+
+    //
+    // train the survivors on a shared stream
+    //
+    MultiTrainer trainer( options_.numThreads, options_.batchSize );
+
+    for ( size_t c : alive )
+    {
+
+      trainer.addNet( nets[ c ].get( ) );
+
+    }
+
+    // (an acceptable error of zero never stops a candidate early)
+    std::vector< unsigned long > trained = trainer.trainNets( inputFun, targetFun, 0.0, budget );
+
+    //
+    // rank on the validation samples (diverged nets rank last)
+    //
+    for ( size_t i = 0; i < alive.size( ); ++i )
+    {
+
+      size_t c = alive[ i ];
+
+      iterations[ c ] += trained[ i ];
+
+      nets[ c ]->feedForwardBatch( validationInputs, &results, options_.numThreads );
+
+      double sumSquares = 0.0;
+
+      for ( size_t k = 0; k < results.size( ); ++k )
+      {
+
+        double delta = validationTargets[ k ] - results[ k ];
+        sumSquares  += delta * delta;
+
+      }
+
+      double error = std::sqrt( sumSquares / std::max< size_t >( results.size( ), 1 ) );
+
+      errors[ c ] = ( std::isfinite( error ) ? error : std::numeric_limits< double >::infinity( ) );
+
+    }
+
+    std::stable_sort( alive.begin( ), alive.end( ), [ &errors ]( size_t a, size_t b )
+    {
+      return errors[ a ] < errors[ b ];
+    } );
+
+    if ( alive.size( ) == 1 )
+    {
+
+      break;
+
+    }
+
+    //
+    // keep the best, give them a longer budget next round
+    //
+    size_t numKeep = static_cast< size_t >( alive.size( ) * options_.keepFraction );
+
+    alive.resize( std::max< size_t >( numKeep, 1 ) );
+
+    budget = static_cast< unsigned long >( budget / options_.keepFraction );
+
+  }
+
+  size_t best = alive.front( );
+
+  SearchResult result;
+
+  result.config          = candidates_[ best ];
+  result.upNet           = std::move( nets[ best ] );
+  result.validationError = errors[ best ];
+  result.iterations      = iterations[ best ];
+  result.numRounds       = numRounds;
+  result.roundSizes      = std::move( roundSizes );
+
+  return result;
+
+} // HyperSearch::run
+
+
+} // namespace net
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "Net.hpp"
+#include "CommonStructs.hpp"
+#include "ConnectedNet.hpp"
+
+
+namespace net
+{
+
+
+/// \brief HyperConfig - one candidate of a hyperparameter search
+struct HyperConfig
+{
+
+  std::vector< unsigned > topology; ///< neurons per layer
+  LearningParams          params;   ///< training rate and momentum
+  unsigned                seed;     ///< seed for the initial weights
+
+};
+
+
+/// \brief SearchSpace - ranges random candidates are drawn from
+struct SearchSpace
+{
+
+  std::vector< std::vector< unsigned > > topologies; ///< picked uniformly
+
+  double minEta   = 0.01; ///< training rate, drawn log-uniformly
+  double maxEta   = 0.5;
+  double minAlpha = 0.0;  ///< momentum, drawn uniformly
+  double maxAlpha = 0.9;
+
+};
+
+
+/// \brief SearchOptions
+struct SearchOptions
+{
+
+  unsigned long minBudget      = 2000; ///< training iterations per candidate in the first round
+  double        keepFraction   = 0.5;  ///< fraction of candidates kept after each round (0.0, 1.0)
+  unsigned      validationSize = 1000; ///< held-out samples used to rank candidates
+  unsigned      numThreads     = 0;    ///< training and evaluation threads (0 for one per core)
+  unsigned      batchSize      = 256;  ///< shared sample batch size (see MultiTrainer)
+  double        errorSmoothing = 0.9;  ///< passed to every candidate net
+  OutputHead    outputHead     = OutputHead::Tanh; ///< passed to every candidate net
+
+};
+
+
+/// \brief SearchResult - best candidate and its trained net
+struct SearchResult
+{
+
+  HyperConfig                     config;
+  std::unique_ptr< ConnectedNet > upNet;
+  double                          validationError; ///< RMS error over the validation samples
+  unsigned long                   iterations;      ///< training iterations the winner received
+  unsigned                        numRounds;
+  std::vector< size_t >           roundSizes;      ///< candidates trained in each round
+
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The HyperSearch class
+///
+///        Successive halving over training rate, momentum and
+///        topology. All live candidates train together on one
+///        shared sample stream (MultiTrainer) for a round's
+///        budget, are ranked on a fixed validation set and the
+///        worst are dropped. Every round the budget grows by the
+///        inverse of the keep fraction, so each round costs about
+///        the same while the survivors train for longer.
+///
+////////////////////////////////////////////////////////////////////
+class HyperSearch
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief HyperSearch
+  /// \param options
+  ////////////////////////////////////////////////////////////////////
+  explicit
+  HyperSearch( const SearchOptions &options = SearchOptions( ) );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief addCandidate
+  /// \param config
+  ////////////////////////////////////////////////////////////////////
+  void addCandidate ( const HyperConfig &config );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief addRandomCandidates
+  /// \param count - number of candidates to draw
+  /// \param space - ranges to draw from
+  /// \param seed - seed for drawing (and for the candidates' weights)
+  ////////////////////////////////////////////////////////////////////
+  void addRandomCandidates (
+                            unsigned           count,
+                            const SearchSpace &space,
+                            unsigned           seed
+                            );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getNumCandidates
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  size_t getNumCandidates ( ) const { return candidates_.size( ); }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief run
+  ///
+  ///        Runs the search. The validation samples are drawn from
+  ///        the start of the stream. Candidate weights are seeded
+  ///        through ConnectedNet::seedWeights.
+  ///
+  /// \param inputFun - function to produce input values
+  /// \param targetFun - function to produce target values
+  /// \return best configuration with its trained net
+  ////////////////////////////////////////////////////////////////////
+  SearchResult run (
+                    TrainFun inputFun,
+                    TrainFun targetFun
+                    );
+
+
+private:
+
+  SearchOptions              options_;
+  std::vector< HyperConfig > candidates_;
+
+};
+
+
+} // namespace net
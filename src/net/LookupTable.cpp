@@ -0,0 +1,499 @@
+#include "LookupTable.hpp"
+#include "ConnectedNet.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr size_t compileBatch = 1 << 16; // table points evaluated per feedForwardBatch call
+
+constexpr double tanhLimit   = 1.0 - 1.0e-12; // saturated tanh outputs stored as atanh of this
+constexpr double minSoftmax  = 1.0e-300;      // smallest probability whose log is stored
+constexpr double gridSpacing = 1.0e-9;        // how far (in grid spans) a grid value may be off its spot
+
+} // namespace
+
+
+constexpr size_t   LookupTable::maxValues;
+constexpr unsigned LookupTable::maxInterpolated;
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief TableAxis::grid
+////////////////////////////////////////////////////////////////////
+TableAxis
+TableAxis::grid(
+                double   min,
+                double   max,
+                unsigned points
+                )
+{
+
+  if ( points == 0 || ( points > 1 && !( max > min ) ) )
+  {
+
+    throw std::runtime_error( "A table grid needs at least one point and max > min" );
+
+  }
+
+  TableAxis axis;
+
+  // (a single point pins the input)
+  axis.interpolate = points > 1;
+
+  for ( unsigned i = 0; i < points; ++i )
+  {
+
+    axis.values.push_back( points > 1 ? min + ( max - min ) * i / ( points - 1 ) : min );
+
+  }
+
+  return axis;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief TableAxis::discrete
+////////////////////////////////////////////////////////////////////
+TableAxis
+TableAxis::discrete( std::vector< double > values )
+{
+
+  if ( values.empty( ) )
+  {
+
+    throw std::runtime_error( "A discrete table axis needs at least one value" );
+
+  }
+
+  TableAxis axis;
+
+  std::sort( values.begin( ), values.end( ) );
+  values.erase( std::unique( values.begin( ), values.end( ) ), values.end( ) );
+
+  axis.values = std::move( values );
+
+  return axis;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LookupTable::compileToTable
+////////////////////////////////////////////////////////////////////
+LookupTable
+LookupTable::compileToTable(
+                            const ConnectedNet             &net,
+                            const std::vector< TableAxis > &axes,
+                            unsigned                        numThreads
+                            )
+{
+
+  std::vector< unsigned > topology = net.getTopology( );
+
+  if ( axes.size( ) != topology.front( ) )
+  {
+
+    throw std::runtime_error( "A lookup table needs one axis per net input ("
+                              + std::to_string( topology.front( ) ) + ")" );
+
+  }
+
+  LookupTable table;
+
+  table.m_numOutputs = topology.back( );
+  table.m_outputHead = net.getOutputHead( );
+
+  //
+  // strides, the last axis fastest
+  //
+  size_t   numPoints       = 1;
+  unsigned numInterpolated = 0;
+
+  table.m_axes.resize( axes.size( ) );
+
+  for ( size_t a = axes.size( ); a-- > 0; )
+  {
+
+    const TableAxis &axis = axes[ a ];
+
+    if ( axis.values.empty( ) )
+    {
+
+      throw std::runtime_error( "Lookup table axis " + std::to_string( a ) + " has no values" );
+
+    }
+
+    //
+    // lookups rely on ascending values, and an interpolated axis
+    // on even spacing (the step comes from its ends alone)
+    //
+    const std::vector< double > &values = axis.values;
+
+    for ( size_t i = 0; i < values.size( ); ++i )
+    {
+
+      if ( !std::isfinite( values[ i ] ) || ( i > 0 && !( values[ i ] > values[ i - 1 ] ) ) )
+      {
+
+        throw std::runtime_error( "Lookup table axis " + std::to_string( a ) + " values must be finite and ascending" );
+
+      }
+
+      if ( axis.interpolate
+          && std::abs( values[ i ] - ( values.front( ) + ( values.back( ) - values.front( ) ) * i / ( values.size( ) - 1 ) ) )
+             > gridSpacing * ( values.back( ) - values.front( ) ) )
+      {
+
+        throw std::runtime_error( "Interpolated lookup table axis " + std::to_string( a ) + " is not evenly spaced" );
+
+      }
+
+    }
+
+    Axis &tableAxis = table.m_axes[ a ];
+
+    tableAxis.axis    = axis;
+    tableAxis.stride  = numPoints;
+    tableAxis.invStep = 0.0;
+
+    if ( axis.interpolate && axis.values.size( ) > 1 )
+    {
+
+      tableAxis.invStep = ( axis.values.size( ) - 1 ) / ( axis.values.back( ) - axis.values.front( ) );
+      ++numInterpolated;
+
+    }
+    else
+    {
+
+      tableAxis.axis.interpolate = false;
+
+    }
+
+    if ( axis.values.size( ) > maxValues / numPoints / table.m_numOutputs )
+    {
+
+      throw std::runtime_error( "Lookup table would hold more than " + std::to_string( maxValues ) + " values" );
+
+    }
+
+    numPoints *= axis.values.size( );
+
+  }
+
+  if ( numInterpolated > maxInterpolated )
+  {
+
+    throw std::runtime_error( "Lookup tables interpolate at most " + std::to_string( maxInterpolated ) + " inputs" );
+
+  }
+
+  //
+  // evaluate every point, a batch at a time
+  //
+  const size_t numInputs = axes.size( );
+
+  table.m_values.resize( numPoints * table.m_numOutputs );
+
+  std::vector< double > inputs;
+  std::vector< double > results;
+
+  for ( size_t first = 0; first < numPoints; first += compileBatch )
+  {
+
+    size_t count = std::min( compileBatch, numPoints - first );
+
+    inputs.resize( count * numInputs );
+
+    for ( size_t p = 0; p < count; ++p )
+    {
+
+      for ( size_t a = 0; a < numInputs; ++a )
+      {
+
+        const Axis &axis  = table.m_axes[ a ];
+        size_t      index = ( first + p ) / axis.stride % axis.axis.values.size( );
+
+        inputs[ p * numInputs + a ] = axis.axis.values[ index ];
+
+      }
+
+    }
+
+    net.feedForwardBatch( inputs, &results, numThreads );
+
+    //
+    // store what the output activation was applied to (up to a
+    // constant for softmax): much smoother than the outputs of a
+    // sharp, well trained net, so interpolation keeps its edges
+    //
+    for ( double &result : results )
+    {
+
+      result = ( table.m_outputHead == OutputHead::Softmax
+                 ? std::log( std::max( result, minSoftmax ) )
+                 : std::atanh( std::min( std::max( result, -tanhLimit ), tanhLimit ) ) );
+
+    }
+
+    std::copy( results.begin( ), results.end( ),
+               table.m_values.begin( ) + static_cast< long >( first * table.m_numOutputs ) );
+
+  }
+
+  return table;
+
+} // LookupTable::compileToTable
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LookupTable::lookup
+////////////////////////////////////////////////////////////////////
+void
+LookupTable::lookup(
+                    const double *inputs,
+                    double       *outputs
+                    ) const
+{
+
+  size_t   base            = 0;
+  unsigned numInterpolated = 0;
+  size_t   cornerStrides[ maxInterpolated ];
+  double   fractions    [ maxInterpolated ];
+
+  for ( size_t a = 0; a < m_axes.size( ); ++a )
+  {
+
+    // a NaN input has no place on an axis (and would reach the cast
+    // to an index below): the outputs are NaN, as the net's would be
+    if ( std::isnan( inputs[ a ] ) )
+    {
+
+      std::fill( outputs, outputs + m_numOutputs, std::numeric_limits< double >::quiet_NaN( ) );
+      return;
+
+    }
+
+    const Axis                  &axis   = m_axes[ a ];
+    const std::vector< double > &values = axis.axis.values;
+
+    size_t index;
+
+    if ( axis.axis.interpolate )
+    {
+
+      // cell below the input (the last cell for the upper end)
+      double position = ( inputs[ a ] - values.front( ) ) * axis.invStep;
+
+      position = std::min( std::max( position, 0.0 ), static_cast< double >( values.size( ) - 1 ) );
+      index    = std::min( static_cast< size_t >( position ), values.size( ) - 2 );
+
+      cornerStrides[ numInterpolated ] = axis.stride;
+      fractions    [ numInterpolated ] = position - static_cast< double >( index );
+      ++numInterpolated;
+
+    }
+    else
+    {
+
+      // nearest value
+      auto upper = std::lower_bound( values.begin( ), values.end( ), inputs[ a ] );
+
+      if ( upper == values.end( ) || ( upper != values.begin( ) && inputs[ a ] - *( upper - 1 ) < *upper - inputs[ a ] ) )
+      {
+
+        --upper;
+
+      }
+
+      index = static_cast< size_t >( upper - values.begin( ) );
+
+    }
+
+    base += index * axis.stride;
+
+  }
+
+  std::fill( outputs, outputs + m_numOutputs, 0.0 );
+
+  //
+  // weighted sum over the cell's corners (a single point without
+  // interpolated axes)
+  //
+  const unsigned numCorners = 1u << numInterpolated;
+
+  for ( unsigned corner = 0; corner < numCorners; ++corner )
+  {
+
+    size_t point  = base;
+    double weight = 1.0;
+
+    for ( unsigned i = 0; i < numInterpolated; ++i )
+    {
+
+      if ( corner & ( 1u << i ) )
+      {
+
+        point  += cornerStrides[ i ];
+        weight *= fractions[ i ];
+
+      }
+      else
+      {
+
+        weight *= 1.0 - fractions[ i ];
+
+      }
+
+    }
+
+    const double *values = &m_values[ point * m_numOutputs ];
+
+    for ( unsigned o = 0; o < m_numOutputs; ++o )
+    {
+
+      outputs[ o ] += weight * values[ o ];
+
+    }
+
+  }
+
+  //
+  // the output activation on the interpolated values
+  //
+  if ( m_outputHead == OutputHead::Softmax )
+  {
+
+    double largest = *std::max_element( outputs, outputs + m_numOutputs );
+    double sum     = 0.0;
+
+    for ( unsigned o = 0; o < m_numOutputs; ++o )
+    {
+
+      outputs[ o ] = std::exp( outputs[ o ] - largest );
+      sum         += outputs[ o ];
+
+    }
+
+    for ( unsigned o = 0; o < m_numOutputs; ++o )
+    {
+
+      outputs[ o ] /= sum;
+
+    }
+
+  }
+  else
+  {
+
+    for ( unsigned o = 0; o < m_numOutputs; ++o )
+    {
+
+      outputs[ o ] = std::tanh( outputs[ o ] );
+
+    }
+
+  }
+
+} // LookupTable::lookup
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LookupTable::lookupBatch
+////////////////////////////////////////////////////////////////////
+void
+LookupTable::lookupBatch(
+                         const std::vector< double > &inputVals,
+                         std::vector< double >       *pResultVals
+                         ) const
+{
+
+  const size_t numInputs  = m_axes.size( );
+  const size_t numSamples = inputVals.size( ) / numInputs;
+
+  if ( numSamples * numInputs != inputVals.size( ) )
+  {
+
+    throw std::runtime_error( "Lookup table inputs are not a whole number of samples" );
+
+  }
+
+  pResultVals->resize( numSamples * m_numOutputs );
+
+  for ( size_t s = 0; s < numSamples; ++s )
+  {
+
+    lookup( &inputVals[ s * numInputs ], &( *pResultVals )[ s * m_numOutputs ] );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LookupTable::measureError
+////////////////////////////////////////////////////////////////////
+TableError
+LookupTable::measureError(
+                          const ConnectedNet          &net,
+                          const std::vector< double > &inputVals,
+                          unsigned                     numThreads
+                          ) const
+{
+
+  std::vector< double > exact;
+  std::vector< double > looked;
+
+  net.feedForwardBatch( inputVals, &exact, numThreads );
+  lookupBatch( inputVals, &looked );
+
+  TableError error;
+
+  error.samples = inputVals.size( ) / m_axes.size( );
+
+  double sum        = 0.0;
+  double sumSquares = 0.0;
+
+  for ( size_t i = 0; i < exact.size( ); ++i )
+  {
+
+    double delta = std::abs( looked[ i ] - exact[ i ] );
+
+    error.maxError = std::max( error.maxError, delta );
+    sum           += delta;
+    sumSquares    += delta * delta;
+
+  }
+
+  if ( !exact.empty( ) )
+  {
+
+    error.meanError = sum / exact.size( );
+    error.rmsError  = std::sqrt( sumSquares / exact.size( ) );
+
+  }
+
+  return error;
+
+} // LookupTable::measureError
+
+
+} // namespace net
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "CommonStructs.hpp"
+
+
+namespace net
+{
+
+
+class ConnectedNet;
+
+
+/// \brief TableAxis - the values one input of a LookupTable covers
+struct TableAxis
+{
+
+  std::vector< double > values;              ///< finite and strictly ascending
+  bool                  interpolate = false; ///< evenly spaced grid, linear in between (else nearest value)
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief grid - 'points' evenly spaced values from min to max,
+  ///        interpolated (inputs outside are clamped)
+  ////////////////////////////////////////////////////////////////////
+  static TableAxis grid (
+                         double   min,
+                         double   max,
+                         unsigned points
+                         );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief discrete - every value the input takes; lookups use
+  ///        the nearest one
+  ////////////////////////////////////////////////////////////////////
+  static TableAxis discrete ( std::vector< double > values );
+
+};
+
+
+/// \brief TableError - a LookupTable's outputs compared with the net's
+struct TableError
+{
+
+  size_t samples   = 0;
+  double maxError  = 0.0; ///< largest absolute difference of any output
+  double meanError = 0.0; ///< mean absolute difference
+  double rmsError  = 0.0;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The LookupTable class
+///
+///        A trained net evaluated ahead of time at every point of
+///        its input domain, for nets with few inputs. Each input
+///        gets an axis: either the discrete values it takes (XOR's
+///        and Addition's 0/1 inputs, where the table reproduces the
+///        net to rounding) or a regular grid, interpolated
+///        multilinearly between the 2^d corners of the cell around
+///        the input. Inference is then index arithmetic, a few
+///        loads and the output activation, independent of the
+///        net's size.
+///
+///        The table holds what the output activation is applied to
+///        (atanh of tanh outputs, log of softmax outputs) and
+///        applies the activation after interpolating. A well trained
+///        classifier's outputs are close to a step; its activation
+///        inputs are smooth, so the edge stays where the net puts it.
+///
+///        Memory is the product of the axis sizes times the number
+///        of outputs (doubles), so grids suit up to three or four
+///        inputs; use measureError for the interpolation error
+///        against the net on the inputs that matter.
+///
+////////////////////////////////////////////////////////////////////
+class LookupTable
+{
+
+public:
+
+  static constexpr size_t   maxValues       = size_t( 1 ) << 27; ///< largest table (1 GiB of doubles)
+  static constexpr unsigned maxInterpolated = 8;                 ///< grid axes per table (2^8 corners)
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief compileToTable
+  ///
+  ///        Evaluates the net at every point of the axes' product
+  ///        through feedForwardBatch. Throws for axes whose values
+  ///        aren't finite and strictly ascending, or interpolated
+  ///        axes that aren't evenly spaced.
+  ///
+  /// \param net
+  /// \param axes - one per input
+  /// \param numThreads - feedForwardBatch threads (0 uses every core)
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  static LookupTable compileToTable (
+                                     const ConnectedNet             &net,
+                                     const std::vector< TableAxis > &axes,
+                                     unsigned                        numThreads = 0
+                                     );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief lookup
+  /// \param inputs - getNumInputs( ) values (clamped to the grids,
+  ///                 NaN in any gives NaN outputs)
+  /// \param outputs - filled with getNumOutputs( ) values
+  ////////////////////////////////////////////////////////////////////
+  void lookup (
+               const double *inputs,
+               double       *outputs
+               ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief lookupBatch
+  /// \param inputVals - numSamples x numInputs values (sample major)
+  /// \param pResultVals - filled with numSamples x numOutputs values
+  ////////////////////////////////////////////////////////////////////
+  void lookupBatch (
+                    const std::vector< double > &inputVals,
+                    std::vector< double >       *pResultVals
+                    ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief measureError
+  /// \param net - the net the table was compiled from
+  /// \param inputVals - samples to compare on (sample major)
+  /// \param numThreads - feedForwardBatch threads (0 uses every core)
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  TableError measureError (
+                           const ConnectedNet          &net,
+                           const std::vector< double > &inputVals,
+                           unsigned                     numThreads = 0
+                           ) const;
+
+  unsigned getNumInputs  ( ) const { return static_cast< unsigned >( m_axes.size( ) ); }
+  unsigned getNumOutputs ( ) const { return m_numOutputs; }
+  size_t   getNumPoints  ( ) const { return m_values.size( ) / m_numOutputs; }
+  size_t   getBytes      ( ) const { return m_values.size( ) * sizeof( double ); }
+
+
+private:
+
+  LookupTable( ) = default;
+
+  /// \brief Axis - a TableAxis with what lookups need precomputed
+  struct Axis
+  {
+
+    TableAxis axis;
+    size_t    stride;  // table points between neighbours on this axis
+    double    invStep; // 1 / grid spacing (interpolated axes)
+
+  };
+
+  std::vector< Axis >   m_axes;
+  unsigned              m_numOutputs = 0;
+  OutputHead            m_outputHead = OutputHead::Tanh;
+  std::vector< double > m_values;     // output activation inputs at every point, the last axis fastest
+
+};
+
+
+} // namespace net
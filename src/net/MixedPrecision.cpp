@@ -0,0 +1,897 @@
+#include "MixedPrecision.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define NET_MIXED_X86 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+// (the AVX512-BF16 intrinsics and their cpu check need a recent compiler)
+#if defined( NET_MIXED_X86 ) \
+  && ( ( defined( __clang__ ) && __clang_major__ >= 12 ) || ( !defined( __clang__ ) && __GNUC__ >= 11 ) )
+#define NET_MIXED_BF16 1
+#endif
+
+// (the wrappers flatten the kernels and conversion helpers into
+// themselves, so the helpers share the wrappers' targets)
+#define NET_AVX2_TARGET   "avx2,fma,f16c"
+#define NET_AVX512_TARGET "avx512f,avx512bw,avx512vl,avx512bf16,fma"
+
+#if defined( __GNUC__ )
+#define NET_ALWAYS_INLINE inline __attribute__( ( always_inline ) )
+#define NET_FLATTEN       __attribute__( ( flatten ) )
+#else
+#define NET_ALWAYS_INLINE inline
+#define NET_FLATTEN
+#endif
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr size_t block = MixedPrecision::vectorLanes; // values converted at a time
+
+
+NET_ALWAYS_INLINE uint32_t
+floatBits( float value )
+{
+
+  uint32_t bits;
+  std::memcpy( &bits, &value, sizeof( bits ) );
+  return bits;
+
+}
+
+
+
+NET_ALWAYS_INLINE float
+bitsFloat( uint32_t bits )
+{
+
+  float value;
+  std::memcpy( &value, &bits, sizeof( value ) );
+  return value;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The BFloat16Soft struct - portable bfloat16 conversions
+///
+///        bfloat16 is the upper half of a float, so widening is a
+///        shift and narrowing rounds the dropped half to even
+///        (NaNs stay quiet NaNs)
+///
+////////////////////////////////////////////////////////////////////
+struct BFloat16Soft
+{
+
+  static NET_ALWAYS_INLINE float
+  toFloat( uint16_t value )
+  {
+
+    return bitsFloat( static_cast< uint32_t >( value ) << 16 );
+
+  }
+
+
+  static NET_ALWAYS_INLINE uint16_t
+  fromFloat( float value )
+  {
+
+    uint32_t bits    = floatBits( value );
+    uint32_t rounded = ( bits + 0x7FFFu + ( ( bits >> 16 ) & 1u ) ) >> 16;
+    uint32_t nan     = ( bits >> 16 ) | 0x40u;
+
+    return static_cast< uint16_t >( ( bits & 0x7FFFFFFFu ) > 0x7F800000u ? nan : rounded );
+
+  }
+
+
+  static NET_ALWAYS_INLINE void
+  load( const uint16_t *in, float *out )
+  {
+
+    for ( size_t j = 0; j < block; ++j )
+    {
+
+      out[ j ] = toFloat( in[ j ] );
+
+    }
+
+  }
+
+
+  static NET_ALWAYS_INLINE void
+  store( const float *in, uint16_t *out )
+  {
+
+    for ( size_t j = 0; j < block; ++j )
+    {
+
+      out[ j ] = fromFloat( in[ j ] );
+
+    }
+
+  }
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The HalfSoft struct - portable IEEE half conversions
+////////////////////////////////////////////////////////////////////
+struct HalfSoft
+{
+
+  static NET_ALWAYS_INLINE float
+  toFloat( uint16_t value )
+  {
+
+    uint32_t sign     = static_cast< uint32_t >( value & 0x8000u ) << 16;
+    uint32_t exponent = ( value >> 10 ) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    if ( exponent == 0x1Fu )
+    {
+
+      // infinity or NaN
+      return bitsFloat( sign | 0x7F800000u | ( mantissa << 13 ) );
+
+    }
+
+    if ( exponent == 0 )
+    {
+
+      // zero or subnormal ( mantissa * 2^-24 is exact )
+      float magnitude = static_cast< float >( mantissa ) * 5.9604644775390625e-8f;
+      return bitsFloat( sign | floatBits( magnitude ) );
+
+    }
+
+    return bitsFloat( sign | ( ( exponent + 112u ) << 23 ) | ( mantissa << 13 ) );
+
+  }
+
+
+  static NET_ALWAYS_INLINE uint16_t
+  fromFloat( float value )
+  {
+
+    uint32_t bits      = floatBits( value );
+    uint32_t sign      = ( bits >> 16 ) & 0x8000u;
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    if ( magnitude >= 0x7F800000u )
+    {
+
+      // infinity or (quiet) NaN
+      return static_cast< uint16_t >( sign | ( magnitude > 0x7F800000u ? 0x7E00u : 0x7C00u ) );
+
+    }
+
+    if ( magnitude < 0x38800000u )
+    {
+
+      // below the smallest normal half: subnormal or zero
+      if ( magnitude < 0x33000000u )
+      {
+
+        return static_cast< uint16_t >( sign );
+
+      }
+
+      uint32_t mantissa = ( magnitude & 0x7FFFFFu ) | 0x800000u;
+      uint32_t shift    = 126u - ( magnitude >> 23 );
+      uint32_t result   = mantissa >> shift;
+      uint32_t rest     = mantissa & ( ( 1u << shift ) - 1u );
+      uint32_t half     = 1u << ( shift - 1u );
+
+      result += ( rest > half || ( rest == half && ( result & 1u ) ) ) ? 1u : 0u;
+
+      return static_cast< uint16_t >( sign | result );
+
+    }
+
+    // rebias the exponent and round the dropped 13 bits to even
+    // (a carry out of the mantissa correctly bumps the exponent,
+    // up to infinity)
+    uint32_t result = ( magnitude - 0x38000000u ) >> 13;
+    uint32_t rest   = magnitude & 0x1FFFu;
+
+    result += ( rest > 0x1000u || ( rest == 0x1000u && ( result & 1u ) ) ) ? 1u : 0u;
+
+    return static_cast< uint16_t >( sign | std::min( result, 0x7C00u ) );
+
+  }
+
+
+  static NET_ALWAYS_INLINE void
+  load( const uint16_t *in, float *out )
+  {
+
+    for ( size_t j = 0; j < block; ++j )
+    {
+
+      out[ j ] = toFloat( in[ j ] );
+
+    }
+
+  }
+
+
+  static NET_ALWAYS_INLINE void
+  store( const float *in, uint16_t *out )
+  {
+
+    for ( size_t j = 0; j < block; ++j )
+    {
+
+      out[ j ] = fromFloat( in[ j ] );
+
+    }
+
+  }
+
+};
+
+
+
+#if defined( NET_MIXED_X86 )
+
+////////////////////////////////////////////////////////////////////
+/// \brief The HalfF16C struct - half conversions with F16C
+////////////////////////////////////////////////////////////////////
+struct HalfF16C
+{
+
+  static inline __attribute__( ( target( NET_AVX2_TARGET ) ) ) float
+  toFloat( uint16_t value )
+  {
+
+    return _cvtsh_ss( value );
+
+  }
+
+
+  static inline __attribute__( ( target( NET_AVX2_TARGET ) ) ) uint16_t
+  fromFloat( float value )
+  {
+
+    return static_cast< uint16_t >( _cvtss_sh( value, _MM_FROUND_TO_NEAREST_INT ) );
+
+  }
+
+
+  static inline __attribute__( ( target( NET_AVX2_TARGET ) ) ) void
+  load( const uint16_t *in, float *out )
+  {
+
+    const __m128i *src = reinterpret_cast< const __m128i* >( in );
+
+    _mm256_storeu_ps( out,     _mm256_cvtph_ps( _mm_loadu_si128( src ) ) );
+    _mm256_storeu_ps( out + 8, _mm256_cvtph_ps( _mm_loadu_si128( src + 1 ) ) );
+
+  }
+
+
+  static inline __attribute__( ( target( NET_AVX2_TARGET ) ) ) void
+  store( const float *in, uint16_t *out )
+  {
+
+    __m128i *dst = reinterpret_cast< __m128i* >( out );
+
+    _mm_storeu_si128( dst,     _mm256_cvtps_ph( _mm256_loadu_ps( in ),     _MM_FROUND_TO_NEAREST_INT ) );
+    _mm_storeu_si128( dst + 1, _mm256_cvtps_ph( _mm256_loadu_ps( in + 8 ), _MM_FROUND_TO_NEAREST_INT ) );
+
+  }
+
+};
+
+#endif
+
+
+
+#if defined( NET_MIXED_BF16 )
+
+////////////////////////////////////////////////////////////////////
+/// \brief The BFloat16Avx512 struct - narrowing with AVX512-BF16
+///
+///        (vcvtneps2bf16 rounds to nearest even like BFloat16Soft
+///        but flushes subnormals to zero)
+///
+////////////////////////////////////////////////////////////////////
+struct BFloat16Avx512
+{
+
+  static NET_ALWAYS_INLINE float
+  toFloat( uint16_t value )
+  {
+
+    return BFloat16Soft::toFloat( value );
+
+  }
+
+
+  static NET_ALWAYS_INLINE uint16_t
+  fromFloat( float value )
+  {
+
+    return BFloat16Soft::fromFloat( value );
+
+  }
+
+
+  static inline __attribute__( ( target( NET_AVX512_TARGET ) ) ) void
+  load( const uint16_t *in, float *out )
+  {
+
+    // (the zero masked forms avoid a spurious -Wmaybe-uninitialized
+    // from the unmasked intrinsics in some GCC headers)
+    const __mmask16 all    = 0xFFFF;
+    __m256i         halves = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( in ) );
+    __m512i         bits   = _mm512_maskz_slli_epi32( all, _mm512_maskz_cvtepu16_epi32( all, halves ), 16 );
+
+    _mm512_storeu_ps( out, _mm512_castsi512_ps( bits ) );
+
+  }
+
+
+  static inline __attribute__( ( target( NET_AVX512_TARGET ) ) ) void
+  store( const float *in, uint16_t *out )
+  {
+
+    __m256bh narrowed = _mm512_cvtneps_pbh( _mm512_loadu_ps( in ) );
+
+    _mm256_storeu_si256( reinterpret_cast< __m256i* >( out ), reinterpret_cast< __m256i& >( narrowed ) );
+
+  }
+
+};
+
+#endif
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief convertKernel
+////////////////////////////////////////////////////////////////////
+template< typename Convert >
+inline void
+convertKernel(
+              size_t       count,
+              const float *in,
+              uint16_t    *out
+              )
+{
+
+  size_t i = 0;
+
+  for ( ; i + block <= count; i += block )
+  {
+
+    Convert::store( in + i, out + i );
+
+  }
+
+  for ( ; i < count; ++i )
+  {
+
+    out[ i ] = Convert::fromFloat( in[ i ] );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief forwardKernel - y = x * W row by row
+////////////////////////////////////////////////////////////////////
+template< typename Convert >
+inline void
+forwardKernel(
+              size_t                     numRows,
+              size_t                     numCols,
+              const float    *__restrict x,
+              const uint16_t *__restrict weights,
+              const float    *__restrict biases,
+              float          *__restrict y
+              )
+{
+
+  std::fill( y, y + numCols, 0.0f );
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    const float     xr  = x[ r ];
+    const uint16_t *row = weights + r * numCols;
+
+    for ( size_t c = 0; c < numCols; c += block )
+    {
+
+      float vals[ block ];
+
+      Convert::load( row + c, vals );
+
+      for ( size_t j = 0; j < block; ++j )
+      {
+
+        y[ c + j ] += xr * vals[ j ];
+
+      }
+
+    }
+
+  }
+
+  for ( size_t c = 0; c < numCols; ++c )
+  {
+
+    y[ c ] += biases[ c ];
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief updateKernel - momentum update of the master weights,
+///        optionally summing W * g from the old weights
+////////////////////////////////////////////////////////////////////
+template< typename Convert, bool Propagate >
+inline void
+updateKernel(
+             size_t                  numRows,
+             size_t                  numCols,
+             const float *__restrict x,
+             const float *__restrict g,
+             float       *__restrict weights,
+             float       *__restrict deltas,
+             uint16_t    *__restrict lowWeights,
+             float                   eta,
+             float                   alpha,
+             float       *__restrict y
+             )
+{
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    float    *w    = weights    + r * numCols;
+    float    *d    = deltas     + r * numCols;
+    uint16_t *low  = lowWeights + r * numCols;
+    float     etaX = eta * x[ r ];
+
+    // one partial sum per lane
+    float sums[ block ] = { };
+
+    for ( size_t c = 0; c < numCols; c += block )
+    {
+
+      float vals[ block ];
+
+      for ( size_t j = 0; j < block; ++j )
+      {
+
+        float gc = g[ c + j ];
+        float wc = w[ c + j ];
+
+        if ( Propagate )
+        {
+
+          sums[ j ] += wc * gc;
+
+        }
+
+        float newDelta = etaX * gc + alpha * d[ c + j ];
+
+        d[ c + j ] = newDelta;
+        vals[ j ]  = wc + newDelta;
+        w[ c + j ] = vals[ j ];
+
+      }
+
+      Convert::store( vals, low + c );
+
+    }
+
+    float sum = 0.0f;
+
+    for ( size_t j = 0; j < block; ++j )
+    {
+
+      sum += sums[ j ];
+
+    }
+
+    if ( Propagate )
+    {
+
+      y[ r ] = sum;
+
+    }
+
+  }
+
+}
+
+
+
+typedef void ( *ConvertFun )( size_t, const float*, uint16_t* );
+typedef void ( *ForwardFun )( size_t, size_t, const float*, const uint16_t*, const float*, float* );
+typedef void ( *UpdateFun  )( size_t, size_t, const float*, const float*, float*, float*, uint16_t*, float, float, float* );
+
+
+//
+// one set of wrappers per instruction set, instantiated for each
+// conversion (the kernels and conversion helpers are flattened
+// into the wrappers, so they are compiled for the wrapper's target)
+//
+#define NET_MIXED_WRAPPERS( PREFIX, TARGET )                                \
+                                                                            \
+  template< typename Convert >                                              \
+  TARGET NET_FLATTEN void                                                   \
+  PREFIX ## Convert(                                                        \
+                    size_t       count,                                     \
+                    const float *in,                                        \
+                    uint16_t    *out                                        \
+                    )                                                       \
+  {                                                                         \
+                                                                            \
+    convertKernel< Convert >( count, in, out );                             \
+                                                                            \
+  }                                                                         \
+                                                                            \
+  template< typename Convert >                                              \
+  TARGET NET_FLATTEN void                                                   \
+  PREFIX ## Forward(                                                        \
+                    size_t          numRows,                                \
+                    size_t          numCols,                                \
+                    const float    *x,                                      \
+                    const uint16_t *w,                                      \
+                    const float    *b,                                      \
+                    float          *y                                       \
+                    )                                                       \
+  {                                                                         \
+                                                                            \
+    forwardKernel< Convert >( numRows, numCols, x, w, b, y );               \
+                                                                            \
+  }                                                                         \
+                                                                            \
+  template< typename Convert >                                              \
+  TARGET NET_FLATTEN void                                                   \
+  PREFIX ## Update(                                                         \
+                   size_t       numRows,                                    \
+                   size_t       numCols,                                    \
+                   const float *x,                                          \
+                   const float *g,                                          \
+                   float       *w,                                          \
+                   float       *d,                                          \
+                   uint16_t    *low,                                        \
+                   float        eta,                                        \
+                   float        alpha,                                      \
+                   float       *y                                           \
+                   )                                                        \
+  {                                                                         \
+                                                                            \
+    if ( y )                                                                \
+    {                                                                       \
+                                                                            \
+      updateKernel< Convert, true >( numRows, numCols, x, g, w, d, low,     \
+                                     eta, alpha, y );                       \
+                                                                            \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+                                                                            \
+      updateKernel< Convert, false >( numRows, numCols, x, g, w, d, low,    \
+                                      eta, alpha, y );                      \
+                                                                            \
+    }                                                                       \
+                                                                            \
+  }
+
+
+NET_MIXED_WRAPPERS( generic, )
+
+#if defined( NET_MIXED_X86 )
+NET_MIXED_WRAPPERS( avx2, __attribute__( ( target( NET_AVX2_TARGET ) ) ) )
+#endif
+
+#if defined( NET_MIXED_BF16 )
+NET_MIXED_WRAPPERS( avx512, __attribute__( ( target( NET_AVX512_TARGET ) ) ) )
+#endif
+
+#undef NET_MIXED_WRAPPERS
+
+
+/// \brief Kernels - the kernels used for one precision
+struct Kernels
+{
+
+  ConvertFun  convert;
+  ForwardFun  forward;
+  UpdateFun   update;
+  const char *name;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief selectKernels - fastest kernels the CPU runs
+////////////////////////////////////////////////////////////////////
+Kernels
+selectKernels( Precision precision )
+{
+
+#if defined( NET_MIXED_X86 )
+
+  __builtin_cpu_init( );
+
+  unsigned eax, ebx, ecx, edx;
+
+  bool avx2 = __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+  bool f16c = __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) && ( ecx & bit_F16C );
+
+#if defined( NET_MIXED_BF16 )
+
+  if ( precision == Precision::BFloat16 && __builtin_cpu_supports( "avx512bf16" ) )
+  {
+
+    return Kernels{
+      &avx512Convert< BFloat16Avx512 >,
+      &avx512Forward< BFloat16Avx512 >,
+      &avx512Update < BFloat16Avx512 >,
+      "bf16 avx512-bf16"
+    };
+
+  }
+
+#endif
+
+  if ( avx2 && f16c )
+  {
+
+    if ( precision == Precision::BFloat16 )
+    {
+
+      return Kernels{
+        &avx2Convert< BFloat16Soft >,
+        &avx2Forward< BFloat16Soft >,
+        &avx2Update < BFloat16Soft >,
+        "bf16 avx2"
+      };
+
+    }
+
+    return Kernels{
+      &avx2Convert< HalfF16C >,
+      &avx2Forward< HalfF16C >,
+      &avx2Update < HalfF16C >,
+      "fp16 f16c"
+    };
+
+  }
+
+#endif
+
+  if ( precision == Precision::BFloat16 )
+  {
+
+    return Kernels{
+      &genericConvert< BFloat16Soft >,
+      &genericForward< BFloat16Soft >,
+      &genericUpdate < BFloat16Soft >,
+      "bf16 generic"
+    };
+
+  }
+
+  return Kernels{
+    &genericConvert< HalfSoft >,
+    &genericForward< HalfSoft >,
+    &genericUpdate < HalfSoft >,
+    "fp16 generic"
+  };
+
+}
+
+
+
+const Kernels &
+kernels( Precision precision )
+{
+
+  static const Kernels bfloat16 = selectKernels( Precision::BFloat16 );
+  static const Kernels half     = selectKernels( Precision::Half );
+
+  switch ( precision )
+  {
+
+  case Precision::BFloat16:
+    return bfloat16;
+
+  case Precision::Half:
+    return half;
+
+  default:
+    throw std::runtime_error( "Mixed precision kernels need BFloat16 or Half" );
+
+  }
+
+}
+
+} // namespace
+
+
+
+constexpr size_t MixedPrecision::vectorLanes;
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::toFloat
+////////////////////////////////////////////////////////////////////
+float
+MixedPrecision::toFloat(
+                        uint16_t  value,
+                        Precision precision
+                        )
+{
+
+  return ( precision == Precision::BFloat16 ? BFloat16Soft::toFloat( value ) : HalfSoft::toFloat( value ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::fromFloat
+////////////////////////////////////////////////////////////////////
+uint16_t
+MixedPrecision::fromFloat(
+                          float     value,
+                          Precision precision
+                          )
+{
+
+  return ( precision == Precision::BFloat16 ? BFloat16Soft::fromFloat( value ) : HalfSoft::fromFloat( value ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::convert
+////////////////////////////////////////////////////////////////////
+void
+MixedPrecision::convert(
+                        Precision    precision,
+                        size_t       count,
+                        const float *in,
+                        uint16_t    *out
+                        )
+{
+
+  kernels( precision ).convert( count, in, out );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::multiplyVector
+////////////////////////////////////////////////////////////////////
+void
+MixedPrecision::multiplyVector(
+                               Precision       precision,
+                               size_t          numRows,
+                               size_t          numCols,
+                               const float    *x,
+                               const uint16_t *weights,
+                               const float    *biases,
+                               float          *y
+                               )
+{
+
+  assert( numCols % vectorLanes == 0 );
+
+  kernels( precision ).forward( numRows, numCols, x, weights, biases, y );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::updateWeights
+////////////////////////////////////////////////////////////////////
+void
+MixedPrecision::updateWeights(
+                              Precision             precision,
+                              size_t                numRows,
+                              size_t                numCols,
+                              const float          *x,
+                              const float          *g,
+                              float                *weights,
+                              float                *deltas,
+                              uint16_t             *lowWeights,
+                              const LearningParams &params,
+                              float                *y
+                              )
+{
+
+  assert( numCols % vectorLanes == 0 );
+
+  kernels( precision ).update(
+                              numRows,
+                              numCols,
+                              x,
+                              g,
+                              weights,
+                              deltas,
+                              lowWeights,
+                              static_cast< float >( params.eta ),
+                              static_cast< float >( params.alpha ),
+                              y
+                              );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::updateBiases
+////////////////////////////////////////////////////////////////////
+void
+MixedPrecision::updateBiases(
+                             size_t                numCols,
+                             const float          *g,
+                             float                *biases,
+                             float                *deltas,
+                             const LearningParams &params
+                             )
+{
+
+  const float rate     = static_cast< float >( params.eta );
+  const float momentum = static_cast< float >( params.alpha );
+
+  for ( size_t c = 0; c < numCols; ++c )
+  {
+
+    deltas[ c ]  = rate * g[ c ] + momentum * deltas[ c ];
+    biases[ c ] += deltas[ c ];
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MixedPrecision::getKernelName
+////////////////////////////////////////////////////////////////////
+const char *
+MixedPrecision::getKernelName( Precision precision )
+{
+
+  return kernels( precision ).name;
+
+}
+
+
+} // namespace net
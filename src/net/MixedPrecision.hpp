@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CommonStructs.hpp"
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The MixedPrecision class
+///
+///        Kernels for training with 16 bit weights (Precision::
+///        BFloat16 or Precision::Half). A weight matrix is kept as
+///        fp32 master weights and momentum plus a 16 bit copy;
+///        the forward pass reads only the 16 bit copy, the update
+///        works on the master weights and rewrites the copy, and
+///        all arithmetic is fp32.
+///
+///        Conversions use AVX512-BF16 (bfloat16) or F16C (half)
+///        when the CPU has them, with portable round to nearest
+///        even code otherwise.
+///
+///        Matrix rows are padded with zeros to a multiple of
+///        vectorLanes columns. Biases are few, so they stay fp32
+///        only.
+///
+////////////////////////////////////////////////////////////////////
+class MixedPrecision
+{
+
+public:
+
+  static constexpr size_t vectorLanes = 16; ///< floats per 64 byte vector
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief padLanes
+  /// \return count rounded up to a multiple of vectorLanes
+  ////////////////////////////////////////////////////////////////////
+  static size_t padLanes ( size_t count ) { return ( count + vectorLanes - 1 ) / vectorLanes * vectorLanes; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief toFloat
+  /// \param value - 16 bit value
+  /// \param precision - BFloat16 or Half
+  ////////////////////////////////////////////////////////////////////
+  static float toFloat (
+                        uint16_t  value,
+                        Precision precision
+                        );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief fromFloat - rounds to nearest even
+  /// \param value
+  /// \param precision - BFloat16 or Half
+  ////////////////////////////////////////////////////////////////////
+  static uint16_t fromFloat (
+                             float     value,
+                             Precision precision
+                             );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief convert - 16 bit copies of count fp32 values
+  ////////////////////////////////////////////////////////////////////
+  static void convert (
+                       Precision    precision,
+                       size_t       count,
+                       const float *in,
+                       uint16_t    *out
+                       );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief multiplyVector - y = x * W + b
+  ///
+  ///        Forward pass of one sample. W is numRows rows of
+  ///        numCols 16 bit weights (numCols a multiple of
+  ///        vectorLanes).
+  ///
+  ////////////////////////////////////////////////////////////////////
+  static void multiplyVector (
+                              Precision       precision,
+                              size_t          numRows,
+                              size_t          numCols,
+                              const float    *x,
+                              const uint16_t *weights,
+                              const float    *biases,
+                              float          *y
+                              );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief updateWeights
+  ///
+  ///        Momentum update of the master weights from the outer
+  ///        product of the row inputs x and column gradients g,
+  ///        rewriting the 16 bit copy. When y is not null it also
+  ///        receives W * g summed from the master weights before
+  ///        their update (as Gemm::updateWeightsAndPropagate).
+  ///        numCols is a multiple of vectorLanes.
+  ///
+  /// \param weights - fp32 master weights
+  /// \param deltas - fp32 momentum, same layout
+  /// \param lowWeights - 16 bit copy of the weights, same layout
+  ////////////////////////////////////////////////////////////////////
+  static void updateWeights (
+                             Precision             precision,
+                             size_t                numRows,
+                             size_t                numCols,
+                             const float          *x,
+                             const float          *g,
+                             float                *weights,
+                             float                *deltas,
+                             uint16_t             *lowWeights,
+                             const LearningParams &params,
+                             float                *y = nullptr
+                             );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief updateBiases - updateWeights for a layer's fp32 biases
+  /// \param numCols
+  /// \param g - column gradients
+  /// \param biases
+  /// \param deltas - momentum of the biases
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  static void updateBiases (
+                            size_t                numCols,
+                            const float          *g,
+                            float                *biases,
+                            float                *deltas,
+                            const LearningParams &params
+                            );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getKernelName
+  /// \return instruction set used for a precision
+  ////////////////////////////////////////////////////////////////////
+  static const char *getKernelName ( Precision precision );
+
+};
+
+
+} // namespace net
@@ -0,0 +1,450 @@
+#include "MultiTrainer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The MultiTrainer::Pool class
+///
+///        Fixed set of workers, each with its own task deque.
+///        Workers take their newest task first and steal the
+///        oldest task of another worker when their own deque is
+///        empty.
+///
+////////////////////////////////////////////////////////////////////
+class MultiTrainer::Pool
+{
+
+public:
+
+  typedef std::function< void( ) > Task;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief Pool
+  /// \param numThreads
+  ////////////////////////////////////////////////////////////////////
+  explicit
+  Pool( unsigned numThreads )
+    : queued_ ( 0 )
+    , pending_( 0 )
+    , stop_   ( false )
+  {
+
+    for ( unsigned t = 0; t < numThreads; ++t )
+    {
+
+      queues_.emplace_back( new Queue );
+
+    }
+
+    for ( unsigned t = 0; t < numThreads; ++t )
+    {
+
+      threads_.emplace_back( &Pool::_work, this, t );
+
+    }
+
+  }
+
+  ~Pool( )
+  {
+
+    {
+      std::lock_guard< std::mutex > lock( mutex_ );
+      stop_ = true;
+    }
+
+    wake_.notify_all( );
+
+    for ( std::thread &thread : threads_ )
+    {
+
+      thread.join( );
+
+    }
+
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief submit - deals the tasks out round robin and returns
+  ////////////////////////////////////////////////////////////////////
+  void submit ( std::vector< Task > tasks )
+  {
+
+    // counted before pushing so a worker can never take a task
+    // that is not counted yet
+    {
+      std::lock_guard< std::mutex > lock( mutex_ );
+      pending_ += tasks.size( );
+      queued_  += tasks.size( );
+    }
+
+    for ( size_t i = 0; i < tasks.size( ); ++i )
+    {
+
+      Queue &queue = *queues_[ i % queues_.size( ) ];
+
+      std::lock_guard< std::mutex > lock( queue.mutex );
+      queue.tasks.push_back( std::move( tasks[ i ] ) );
+
+    }
+
+    wake_.notify_all( );
+
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief wait - blocks until every submitted task has finished
+  ///        and rethrows the first exception thrown by a task
+  ////////////////////////////////////////////////////////////////////
+  void wait ( )
+  {
+
+    std::unique_lock< std::mutex > lock( mutex_ );
+    done_.wait( lock, [ this ]{ return pending_ == 0; } );
+
+    if ( error_ )
+    {
+
+      std::exception_ptr error = error_;
+      error_ = nullptr;
+      std::rethrow_exception( error );
+
+    }
+
+  }
+
+
+private:
+
+  struct Queue
+  {
+
+    std::mutex         mutex;
+    std::deque< Task > tasks;
+
+  };
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _pop - own newest task, otherwise the oldest task of
+  ///        the next non-empty worker
+  ////////////////////////////////////////////////////////////////////
+  bool _pop (
+             unsigned worker,
+             Task    *pTask
+             )
+  {
+
+    for ( size_t i = 0; i < queues_.size( ); ++i )
+    {
+
+      Queue &queue = *queues_[ ( worker + i ) % queues_.size( ) ];
+
+      std::lock_guard< std::mutex > lock( queue.mutex );
+
+      if ( queue.tasks.empty( ) )
+      {
+
+        continue;
+
+      }
+
+      if ( i == 0 )
+      {
+
+        *pTask = std::move( queue.tasks.back( ) );
+        queue.tasks.pop_back( );
+
+      }
+      else
+      {
+
+        *pTask = std::move( queue.tasks.front( ) );
+        queue.tasks.pop_front( );
+
+      }
+
+      --queued_;
+      return true;
+
+    }
+
+    return false;
+
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _work - worker thread loop
+  ////////////////////////////////////////////////////////////////////
+  void _work ( unsigned worker )
+  {
+
+    Task task;
+
+    for ( ;; )
+    {
+
+      if ( _pop( worker, &task ) )
+      {
+
+        std::exception_ptr error;
+
+        try
+        {
+
+          task( );
+
+        }
+        catch ( ... )
+        {
+
+          error = std::current_exception( );
+
+        }
+
+        task = nullptr;
+
+        std::lock_guard< std::mutex > lock( mutex_ );
+
+        if ( error && !error_ )
+        {
+
+          error_ = error;
+
+        }
+
+        if ( --pending_ == 0 )
+        {
+
+          done_.notify_all( );
+
+        }
+
+        continue;
+
+      }
+
+      std::unique_lock< std::mutex > lock( mutex_ );
+      wake_.wait( lock, [ this ]{ return stop_ || queued_ > 0; } );
+
+      if ( stop_ && queued_ == 0 )
+      {
+
+        return;
+
+      }
+
+      // tasks may be counted but still on their way into a deque
+      lock.unlock( );
+      std::this_thread::yield( );
+
+    }
+
+  }
+
+  std::vector< std::unique_ptr< Queue > > queues_;
+  std::vector< std::thread >              threads_;
+
+  std::mutex              mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+
+  std::atomic< size_t > queued_;  // tasks sitting in a deque
+  size_t                pending_; // tasks not finished yet
+  bool                  stop_;
+  std::exception_ptr    error_;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MultiTrainer::MultiTrainer
+////////////////////////////////////////////////////////////////////
+MultiTrainer::MultiTrainer(
+                           unsigned numThreads,
+                           unsigned batchSize
+                           )
+  : batchSize_( std::max( batchSize, 1u ) )
+{
+
+  if ( numThreads == 0 )
+  {
+
+    numThreads = std::max( std::thread::hardware_concurrency( ), 1u );
+
+  }
+
+  upPool_.reset( new Pool( numThreads ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MultiTrainer::~MultiTrainer
+////////////////////////////////////////////////////////////////////
+MultiTrainer::~MultiTrainer( )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MultiTrainer::addNet
+/// \param pNet
+////////////////////////////////////////////////////////////////////
+void
+MultiTrainer::addNet( Net *pNet )
+{
+
+  if ( !pNet )
+  {
+
+    throw std::runtime_error( "Cannot train a null net" );
+
+  }
+
+  nets_.push_back( pNet );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief MultiTrainer::trainNets
+////////////////////////////////////////////////////////////////////
+std::vector< unsigned long >
+MultiTrainer::trainNets(
+                        TrainFun            inputFun,
+                        TrainFun            targetFun,
+                        const double        acceptableError,
+                        const unsigned long maxIterations
+                        )
+{
+
+  struct Batch
+  {
+
+    std::vector< std::vector< double > > inputs;
+    std::vector< std::vector< double > > targets;
+
+  };
+
+  Batch batches[ 2 ];
+
+  auto generate = [ & ]( Batch *pBatch )
+  {
+
+    pBatch->inputs.resize ( batchSize_ );
+    pBatch->targets.resize( batchSize_ );
+
+    // same call order as trainNet (targets may depend on the input)
+    for ( unsigned s = 0; s < batchSize_; ++s )
+    {
+
+      pBatch->inputs [ s ] = inputFun( );
+      pBatch->targets[ s ] = targetFun( );
+
+    }
+
+  };
+
+  auto isDone = [ & ]( Net &net, unsigned long iterations )
+  {
+
+    return net.getAverageError( ) <= acceptableError
+           || ( maxIterations > 0 && iterations >= maxIterations );
+
+  };
+
+  std::vector< unsigned long > iterations( nets_.size( ), 0 );
+
+  generate( &batches[ 0 ] );
+
+  for ( unsigned current = 0; ; current ^= 1 )
+  {
+
+    const Batch &batch = batches[ current ];
+
+    //
+    // one task per unfinished net, each touching only its own net
+    // and iteration count
+    //
+    std::vector< Pool::Task > tasks;
+
+    for ( size_t n = 0; n < nets_.size( ); ++n )
+    {
+
+      if ( isDone( *nets_[ n ], iterations[ n ] ) )
+      {
+
+        continue;
+
+      }
+
+      tasks.push_back( [ &, n ]( )
+      {
+
+        Net &net = *nets_[ n ];
+
+        for ( size_t s = 0; s < batch.inputs.size( ) && !isDone( net, iterations[ n ] ); ++s )
+        {
+
+          net.feedForward( batch.inputs [ s ] );
+          net.backProp   ( batch.targets[ s ] );
+
+          ++iterations[ n ];
+
+        }
+
+      } );
+
+    }
+
+    if ( tasks.empty( ) )
+    {
+
+      break;
+
+    }
+
+    upPool_->submit( std::move( tasks ) );
+
+    // overlap generating the next batch with training
+    try
+    {
+
+      generate( &batches[ current ^ 1 ] );
+
+    }
+    catch ( ... )
+    {
+
+      // tasks still reference the current batch
+      upPool_->wait( );
+      throw;
+
+    }
+
+    upPool_->wait( );
+
+  }
+
+  return iterations;
+
+} // MultiTrainer::trainNets
+
+
+} // namespace net
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "Net.hpp"
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The MultiTrainer class
+///
+///        Trains several nets on one shared stream of samples.
+///        Samples are generated once per batch on the calling
+///        thread and every net trains on the whole batch in the
+///        same order it would see them through trainNet. One
+///        task per net per batch is queued on a work-stealing
+///        thread pool, so idle workers pick up the remaining
+///        nets when the models differ in size. The next batch
+///        is generated while the current one trains.
+///
+////////////////////////////////////////////////////////////////////
+class MultiTrainer
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief MultiTrainer
+  /// \param numThreads - worker threads (0 uses one per core)
+  /// \param batchSize - samples generated per batch
+  ////////////////////////////////////////////////////////////////////
+  MultiTrainer(
+               unsigned numThreads = 0,
+               unsigned batchSize  = 256
+               );
+
+  ~MultiTrainer( );
+
+  MultiTrainer( const MultiTrainer& ) = delete;
+  MultiTrainer &operator= ( const MultiTrainer& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief addNet
+  /// \param pNet - net to train (not owned, must outlive training)
+  ////////////////////////////////////////////////////////////////////
+  void addNet ( Net *pNet );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getNumNets
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  size_t getNumNets ( ) const { return nets_.size( ); }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief trainNets
+  ///
+  ///        Trains every net until its own average error is
+  ///        acceptable or it reaches the iteration limit (same
+  ///        stopping rule as Net::trainNet)
+  ///
+  /// \param inputFun - function to produce input values
+  /// \param targetFun - function to produce target values
+  /// \param acceptableError - lowest acceptable error value
+  /// \param maxIterations - iteration limit per net (0 for none)
+  /// \return number of training iterations run per net
+  ////////////////////////////////////////////////////////////////////
+  std::vector< unsigned long > trainNets (
+                                          TrainFun            inputFun,
+                                          TrainFun            targetFun,
+                                          const double        acceptableError = 1.0e-4,
+                                          const unsigned long maxIterations   = 0
+                                          );
+
+
+private:
+
+  class Pool;
+
+  std::vector< Net* > nets_;
+
+  unsigned batchSize_;
+
+  std::unique_ptr< Pool > upPool_;
+
+};
+
+
+} // namespace net
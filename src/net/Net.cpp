@@ -1,4 +1,5 @@
 #include "Net.hpp"
+#include "Validator.hpp"
 #include <iostream>
 
 
@@ -14,23 +15,50 @@ namespace net
 ///        target values
 ///
 ////////////////////////////////////////////////////////////////////
-void
+unsigned long
 Net::trainNet(
-              TrainFun       inputFun,        ///< function to produce input values
-              TrainFun       targetFun,       ///< function to produce target values
-              const double   acceptableError, ///< lowest acceptable error value (defaults to 1.0e-4)
-              const unsigned printFrequency   ///< number of iterations between informative print statements (defaults to -1 [no printing])
+              TrainFun            inputFun,        ///< function to produce input values
+              TrainFun            targetFun,       ///< function to produce target values
+              const double        acceptableError, ///< lowest acceptable error value (defaults to 1.0e-4)
+              const unsigned      printFrequency,  ///< number of iterations between informative print statements (defaults to -1 [no printing])
+              Validator          *pValidator,      ///< optional background validation (defaults to nullptr [no validation])
+              const unsigned long maxIterations    ///< iteration limit (defaults to 0 [no limit])
               )
 {
 
-  unsigned counter = printFrequency;
+  unsigned      counter    = printFrequency;
+  unsigned long iterations = 0;
 
-  while ( getAverageError( ) > acceptableError )
+  if ( pValidator )
+  {
+
+    pValidator->start( );
+
+  }
+
+  while ( getAverageError( ) > acceptableError
+         && ( maxIterations == 0 || iterations < maxIterations ) )
   {
 
     feedForward( inputFun( ) );
     backProp   ( targetFun( ) );
 
+    ++iterations;
+
+    if ( pValidator )
+    {
+
+      pValidator->onIteration( *this );
+
+      if ( pValidator->shouldStop( ) )
+      {
+
+        break;
+
+      }
+
+    }
+
     if ( printFrequency > 0 && ++counter >= printFrequency )
     {
 
@@ -41,6 +69,8 @@ Net::trainNet(
 
   }
 
+  return iterations;
+
 } // Net::trainNet
 
 
@@ -2,13 +2,20 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
+#include <utility>
 
 namespace net
 {
 
+class Validator;
+
 /// \brief TrainFun
 typedef std::function< std::vector< double >( ) > TrainFun;
 
+/// \brief SparseVals - ( input index, value ) pairs of the nonzero inputs
+typedef std::vector< std::pair< unsigned, double > > SparseVals;
+
 
 ////////////////////////////////////////////////////////////////////
 /// \brief The Net class
@@ -33,13 +40,22 @@ public:
   /// \param acceptableError - lowest acceptable error value
   /// \param printFrequency - number of iterations between
   ///                         informative print statements
+  /// \param pValidator - optional held-out set evaluated in the
+  ///                     background (restarted for this run);
+  ///                     training also stops once its validation
+  ///                     error is acceptable
+  /// \param maxIterations - stop after this many iterations even
+  ///                        if the error is not acceptable yet
+  /// \return number of training iterations run
   ////////////////////////////////////////////////////////////////////
-  void trainNet (
-                 TrainFun       inputFun,                 ///< function to produce input values
-                 TrainFun       targetFun,                ///< function to produce target values
-                 const double   acceptableError = 1.0e-4, ///< lowest acceptable error value (defaults to 1.0e-4)
-                 const unsigned printFrequency = 0        ///< number of iterations between informative print statements (defaults to 0 [no printing])
-                 );
+  unsigned long trainNet (
+                          TrainFun            inputFun,                 ///< function to produce input values
+                          TrainFun            targetFun,                ///< function to produce target values
+                          const double        acceptableError = 1.0e-4, ///< lowest acceptable error value (defaults to 1.0e-4)
+                          const unsigned      printFrequency = 0,       ///< number of iterations between informative print statements (defaults to 0 [no printing])
+                          Validator          *pValidator = nullptr,     ///< optional background validation (defaults to nullptr [no validation])
+                          const unsigned long maxIterations = 0         ///< iteration limit (defaults to 0 [no limit])
+                          );
 
 
   ////////////////////////////////////////////////////////////////////
@@ -70,6 +86,13 @@ public:
   virtual
   double getAverageError ( ) = 0;
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief clone
+  /// \return deep copy of the net (weights and all)
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  std::unique_ptr< Net > clone ( ) const = 0;
+
 };
 
 
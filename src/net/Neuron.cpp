@@ -1,6 +1,7 @@
 #include "Neuron.hpp"
-#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 
 
 namespace net
@@ -12,9 +13,6 @@ namespace net
 namespace
 {
 
-constexpr double eta   = 0.15; // overall net training rate [0.0, 1.0]
-constexpr double alpha = 0.5;  // momentum - multiplier of last weight change [0.0, n]
-
 auto seed = std::chrono::high_resolution_clock::now( ).time_since_epoch( ).count( );
 std::default_random_engine generator( static_cast< unsigned >( seed ) );
 std::uniform_real_distribution< double > distribution( 0.0, 1.0 );
@@ -27,18 +25,22 @@ std::uniform_real_distribution< double > distribution( 0.0, 1.0 );
 /// \brief Neuron::Neuron
 ////////////////////////////////////////////////////////////////////
 Neuron::Neuron(
-               unsigned numOutputs,
-               unsigned myIndex
+               Connection *outputWeights,
+               unsigned    numOutputs,
+               unsigned    myIndex
                )
-  : myIndex_( myIndex )
+  : myIndex_      ( myIndex )
+  , numOutputs_   ( numOutputs )
+  , outputVal_    ( 0.0 )
+  , gradient_     ( 0.0 )
+  , outputWeights_( outputWeights )
 {
 
   for ( unsigned c = 0; c < numOutputs; ++c )
   {
 
-    outputWeights_.push_back( Connection( ) );
-
-    outputWeights_.back( ).weight = Neuron::randomWeight( );
+    outputWeights_[ c ].weight      = Neuron::randomWeight( );
+    outputWeights_[ c ].deltaWeight = 0.0;
 
   }
 
@@ -47,118 +49,206 @@ Neuron::Neuron(
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief feedForward
-/// \param prevLayer
+/// \brief Neuron::relocate
+/// \param oldBase
+/// \param newBase
 ////////////////////////////////////////////////////////////////////
 void
-Neuron::feedForward( const Layer &prevLayer )
+Neuron::relocate(
+                 const char *oldBase,
+                 char       *newBase
+                 )
 {
 
-  double sum = 0.0;
+  if ( outputWeights_ )
+  {
 
-  std::for_each (
-                 std::begin( prevLayer ),
-                 std::end( prevLayer ),
-                 [ this, &sum ]( const Neuron &neuron )
-    {
+    std::ptrdiff_t offset = reinterpret_cast< const char* >( outputWeights_ ) - oldBase;
+    outputWeights_ = reinterpret_cast< Connection* >( newBase + offset );
 
-      sum += neuron.getOutputVal( ) * neuron.outputWeights_[ myIndex_ ].weight;
+  }
 
-    } );
+}
 
-  outputVal_ = Neuron::transferFunction( sum );
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Neuron::calcOutputGradients
+/// \param targetVal
+////////////////////////////////////////////////////////////////////
+void
+Neuron::calcOutputGradients( double targetVal )
+{
+
+  double delta = targetVal - outputVal_;
+
+  gradient_ = delta * Neuron::transferFunctionDerivative( outputVal_ );
 
 }
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief Neuron::_sumDOW
-/// \param nextLayer
-/// \return
+/// \brief Neuron::calcHiddenGradients
+/// \param sumDOW
 ////////////////////////////////////////////////////////////////////
-double
-Neuron::_sumDOW( const Layer &nextLayer ) const
+void
+Neuron::calcHiddenGradients( double sumDOW )
 {
 
-  double sum = 0.0;
+  gradient_ = sumDOW * Neuron::transferFunctionDerivative( outputVal_ );
 
-  for ( unsigned n = 0; n < nextLayer.size( ) - 1; ++n )
-  {
+}
 
-    sum += outputWeights_[ n ].weight * nextLayer[ n ].gradient_;
 
-  }
 
-  return sum;
+////////////////////////////////////////////////////////////////////
+/// \brief Neuron::activate
+/// \param sum
+////////////////////////////////////////////////////////////////////
+void
+Neuron::activate( double sum )
+{
 
-} // Neuron::sumDOW
+  outputVal_ = Neuron::transferFunction( sum );
+
+}
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief Neuron::calcOutputGradients
-/// \param targetVal
+/// \brief Neuron::accumulateOutputs
+/// \param scale
+/// \param pSums
 ////////////////////////////////////////////////////////////////////
 void
-Neuron::calcOutputGradients( double targetVal )
+Neuron::accumulateOutputs(
+                          double                 scale,
+                          std::vector< double > *pSums
+                          ) const
 {
 
-  double delta = targetVal - outputVal_;
+  std::vector< double > &sums = *pSums;
 
-  gradient_ = delta * Neuron::transferFunctionDerivative( outputVal_ );
+  for ( unsigned n = 0; n < sums.size( ); ++n )
+  {
+
+    sums[ n ] += scale * outputWeights_[ n ].weight;
+
+  }
 
 }
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief Neuron::calcHiddenGradients
+/// \brief Neuron::updateOutputWeights
 /// \param nextLayer
+/// \param params
 ////////////////////////////////////////////////////////////////////
 void
-Neuron::calcHiddenGradients( const Layer &nextLayer )
+Neuron::updateOutputWeights(
+                            const Layer          &nextLayer,
+                            const LearningParams &params
+                            )
 {
 
-  double dow = _sumDOW( nextLayer );
+  for ( unsigned n = 0; n < numOutputs_; ++n )
+  {
 
-  gradient_ = dow * Neuron::transferFunctionDerivative( outputVal_ );
+    Connection &connection = outputWeights_[ n ];
 
-}
+    double newDeltaWeight =
+      params.eta
+      * outputVal_
+      * nextLayer[ n ].gradient_
+      + params.alpha
+      * connection.deltaWeight;
+
+    connection.deltaWeight = newDeltaWeight;
+    connection.weight     += newDeltaWeight;
+
+  }
+
+} // Neuron::updateOutputWeights
 
 
 
 ////////////////////////////////////////////////////////////////////
-/// \brief Neuron::updateInputWeights
-/// \param prevLayer
+/// \brief Neuron::catchUpMomentum
+/// \param idleSteps
+/// \param params
 ////////////////////////////////////////////////////////////////////
 void
-Neuron::updateInputWeights( Layer &prevLayer )
+Neuron::catchUpMomentum(
+                        unsigned long long    idleSteps,
+                        const LearningParams &params
+                        )
 {
 
-  std::for_each(
-                std::begin( prevLayer ),
-                std::end( prevLayer ),
-                [ this ]( Neuron &neuron )
+  if ( idleSteps == 0 )
   {
 
-    double oldDeltaWeight = neuron.outputWeights_[ myIndex_ ].deltaWeight;
+    return;
 
-    double newDeltaWeight =
-      // individual input magnified by the gradient and train rate
-      eta
-      * neuron.getOutputVal( )
-      * gradient_
-      // momentum - a fraction of the previous delta weight
-      + alpha
-      * oldDeltaWeight;
+  }
 
-    neuron.outputWeights_[ myIndex_ ].deltaWeight = newDeltaWeight;
-    neuron.outputWeights_[ myIndex_ ].weight     += newDeltaWeight;
+  double alphaK  = std::pow( params.alpha, static_cast< double >( idleSteps ) );
+  double geomSum = idleMomentumSum( idleSteps, params );
 
-  } );
+  for ( unsigned n = 0; n < numOutputs_; ++n )
+  {
+
+    Connection &connection = outputWeights_[ n ];
+
+    connection.weight      += connection.deltaWeight * geomSum;
+    connection.deltaWeight *= alphaK;
+
+  }
 
-} // Neuron::updateInputWeights
+} // Neuron::catchUpMomentum
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Neuron::idleMomentumSum
+/// \param idleSteps
+/// \param params
+/// \return
+////////////////////////////////////////////////////////////////////
+double
+Neuron::idleMomentumSum(
+                        unsigned long long    idleSteps,
+                        const LearningParams &params
+                        )
+{
+
+  //
+  // with a zero output each step is d *= a, w += d so after
+  // k steps w += d * ( a + ... + a^k ) and d *= a^k
+  //
+  const double a = params.alpha;
+
+  double aK = std::pow( a, static_cast< double >( idleSteps ) );
+
+  return ( a == 1.0 ? idleSteps * 1.0 : a * ( 1.0 - aK ) / ( 1.0 - a ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Neuron::seedRandomWeights
+/// \param weightSeed
+////////////////////////////////////////////////////////////////////
+void
+Neuron::seedRandomWeights( unsigned weightSeed )
+{
+
+  generator.seed( weightSeed );
+  distribution.reset( );
+
+}
 
 
 
@@ -20,13 +20,34 @@ public:
 
   ////////////////////////////////////////////////////////////////////
   /// \brief Neuron
+  ///
+  ///        Initializes the (externally owned) outgoing connections
+  ///        with random weights
+  ///
+  /// \param outputWeights - storage for numOutputs connections
   /// \param numOutputs
+  /// \param myIndex
   ////////////////////////////////////////////////////////////////////
   Neuron(
-         unsigned numOutputs,
-         unsigned myIndex
+         Connection *outputWeights,
+         unsigned    numOutputs,
+         unsigned    myIndex
          );
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief relocate
+  ///
+  ///        Points the neuron at the same connections inside a copy
+  ///        of the block of memory they live in
+  ///
+  /// \param oldBase - start of the original block
+  /// \param newBase - start of the copy
+  ////////////////////////////////////////////////////////////////////
+  void relocate (
+                 const char *oldBase,
+                 char       *newBase
+                 );
+
   ////////////////////////////////////////////////////////////////////
   /// \brief setOutputVal
   /// \param val
@@ -45,13 +66,36 @@ public:
   /// \brief getNumOutputWeights
   ////////////////////////////////////////////////////////////////////
   unsigned
-  getNumOutputWeights( ) const { return outputWeights_.size( ); }
+  getNumOutputWeights( ) const { return numOutputs_; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getOutputWeight
+  /// \param n - index of the neuron in the next layer
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  double
+  getOutputWeight( unsigned n ) const { return outputWeights_[ n ].weight; }
 
   ////////////////////////////////////////////////////////////////////
-  /// \brief feedForward
-  /// \param prevLayer
+  /// \brief setOutputWeight
+  ///
+  ///        Also clears the connection's momentum unless
+  ///        keepMomentum
+  ///
+  /// \param n - index of the neuron in the next layer
+  /// \param weight
+  /// \param keepMomentum
   ////////////////////////////////////////////////////////////////////
-  void feedForward ( const Layer &prevLayer );
+  void
+  setOutputWeight(
+                  unsigned n,
+                  double   weight,
+                  bool     keepMomentum = false
+                  )
+  {
+    outputWeights_[ n ].weight      = weight;
+    outputWeights_[ n ].deltaWeight = ( keepMomentum ? outputWeights_[ n ].deltaWeight : 0.0 );
+  }
 
   ////////////////////////////////////////////////////////////////////
   /// \brief calcOutputGradients
@@ -61,39 +105,123 @@ public:
 
   ////////////////////////////////////////////////////////////////////
   /// \brief calcHiddenGradients
-  /// \param nextLayer
+  ///
+  ///        Sets the gradient from an already accumulated sum of
+  ///        the next layer's gradients weighted by this neuron's
+  ///        outgoing connections
+  ///
+  /// \param sumDOW
   ////////////////////////////////////////////////////////////////////
-  void calcHiddenGradients ( const Layer &nextLayer );
+  void calcHiddenGradients ( double sumDOW );
 
   ////////////////////////////////////////////////////////////////////
-  /// \brief updateInputWeights
-  /// \param prevLayer
+  /// \brief getGradient
+  /// \return
   ////////////////////////////////////////////////////////////////////
-  void updateInputWeights ( Layer &prevLayer );
+  double
+  getGradient( ) const { return gradient_; }
 
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setGradient
+  /// \param gradient - output gradient computed by the net's head
+  ////////////////////////////////////////////////////////////////////
+  void
+  setGradient( const double gradient ) { gradient_ = gradient; }
 
-protected:
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getOutputWeights
+  /// \return row of outgoing connections
+  ////////////////////////////////////////////////////////////////////
+  Connection *
+  getOutputWeights( ) const { return outputWeights_; }
 
-private:
+  ////////////////////////////////////////////////////////////////////
+  /// \brief activate
+  ///
+  ///        Sets the output value from an already accumulated
+  ///        weighted input sum
+  ///
+  /// \param sum
+  ////////////////////////////////////////////////////////////////////
+  void activate ( double sum );
 
   ////////////////////////////////////////////////////////////////////
-  /// \brief _sumDOW
+  /// \brief accumulateOutputs
+  ///
+  ///        Adds this neuron's outgoing weights scaled by 'scale'
+  ///        to the running sums of the next layer (used for
+  ///        sparse inputs)
+  ///
+  /// \param scale
+  /// \param pSums
+  ////////////////////////////////////////////////////////////////////
+  void accumulateOutputs (
+                          double                 scale,
+                          std::vector< double > *pSums
+                          ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief updateOutputWeights
+  ///
+  ///        Updates the numOutputs outgoing connections of this
+  ///        neuron
+  ///
   /// \param nextLayer
-  /// \return
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  void updateOutputWeights (
+                            const Layer          &nextLayer,
+                            const LearningParams &params
+                            );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief catchUpMomentum
+  ///
+  ///        Applies 'idleSteps' weight updates with a zero output
+  ///        value in closed form (only the momentum term is left)
+  ///
+  /// \param idleSteps
+  /// \param params
+  ////////////////////////////////////////////////////////////////////
+  void catchUpMomentum (
+                        unsigned long long    idleSteps,
+                        const LearningParams &params
+                        );
+
   ////////////////////////////////////////////////////////////////////
-  double _sumDOW ( const Layer &nextLayer ) const;
+  /// \brief idleMomentumSum
+  /// \return what catchUpMomentum adds to a weight per unit of
+  ///         momentum after 'idleSteps' steps (for reading caught
+  ///         up weights without writing them)
+  ////////////////////////////////////////////////////////////////////
+  static double idleMomentumSum (
+                                 unsigned long long    idleSteps,
+                                 const LearningParams &params
+                                 );
 
-  unsigned myIndex_;
-  double outputVal_;
-  std::vector< Connection > outputWeights_;
-  double gradient_;
+  ////////////////////////////////////////////////////////////////////
+  /// \brief seedRandomWeights
+  /// \param weightSeed - seed for the generator behind randomWeight
+  ////////////////////////////////////////////////////////////////////
+  static void seedRandomWeights ( unsigned weightSeed );
 
   ////////////////////////////////////////////////////////////////////
   /// \brief randomWeight
-  /// \return
+  /// \return next initial weight (biases are drawn from it too)
   ////////////////////////////////////////////////////////////////////
   static double randomWeight ( );
 
+
+protected:
+
+private:
+
+  unsigned    myIndex_;
+  unsigned    numOutputs_;
+  double      outputVal_;
+  double      gradient_;
+  Connection *outputWeights_; // row of the net's weight matrix (not owned)
+
   ////////////////////////////////////////////////////////////////////
   /// \brief transferFunction
   /// \param x
@@ -0,0 +1,334 @@
+#include "PerfCounters.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#if defined( __linux__ )
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define NET_PERF_EVENTS 1
+#endif
+
+
+namespace net
+{
+
+
+namespace
+{
+
+#if defined( NET_PERF_EVENTS )
+
+/// \brief EventConfig - perf_event_attr type and config of a PerfEvent
+struct EventConfig
+{
+
+  uint32_t type;
+  uint64_t config;
+
+};
+
+
+constexpr uint64_t cacheReadMiss( uint64_t cache )
+{
+
+  return cache
+         | ( static_cast< uint64_t >( PERF_COUNT_HW_CACHE_OP_READ ) << 8 )
+         | ( static_cast< uint64_t >( PERF_COUNT_HW_CACHE_RESULT_MISS ) << 16 );
+
+}
+
+
+// indexed by PerfEvent
+const EventConfig eventConfigs[ NumPerfEvents ] =
+{
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES       },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS     },
+  { PERF_TYPE_HW_CACHE, cacheReadMiss( PERF_COUNT_HW_CACHE_L1D ) },
+  { PERF_TYPE_HW_CACHE, cacheReadMiss( PERF_COUNT_HW_CACHE_LL  ) },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES    },
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief openEvent - one counter of the calling thread, any CPU
+////////////////////////////////////////////////////////////////////
+int
+openEvent(
+          const EventConfig &event,
+          int                groupFd
+          )
+{
+
+  perf_event_attr attr;
+
+  std::memset( &attr, 0, sizeof( attr ) );
+
+  attr.size           = sizeof( attr );
+  attr.type           = event.type;
+  attr.config         = event.config;
+  attr.disabled       = ( groupFd < 0 ? 1u : 0u ); // the leader starts the group
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  attr.read_format    = PERF_FORMAT_GROUP
+                        | PERF_FORMAT_TOTAL_TIME_ENABLED
+                        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return static_cast< int >( ::syscall( SYS_perf_event_open, &attr, 0, -1, groupFd, 0 ) );
+
+}
+
+#endif
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief perfPhaseName
+////////////////////////////////////////////////////////////////////
+const char *
+perfPhaseName( PerfPhase phase )
+{
+
+  switch ( phase )
+  {
+
+  case PerfPhase::Forward:  return "forward";
+  case PerfPhase::Backward: return "backward";
+  case PerfPhase::Update:   return "update";
+  default:                  return "unknown";
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief perfEventName
+////////////////////////////////////////////////////////////////////
+const char *
+perfEventName( PerfEvent event )
+{
+
+  switch ( event )
+  {
+
+  case Cycles:        return "cycles";
+  case Instructions:  return "instructions";
+  case L1dMisses:     return "l1d_misses";
+  case LlcMisses:     return "llc_misses";
+  case BranchMisses:  return "branch_misses";
+  case NumPerfEvents:
+  default:            return "unknown";
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PerfCounters::PerfCounters
+////////////////////////////////////////////////////////////////////
+PerfCounters::PerfCounters( )
+  : leader_  ( -1 )
+  , lastTime_( Clock::now( ) )
+{
+
+#if defined( NET_PERF_EVENTS )
+
+  std::string missing;
+  int         firstError = 0;
+
+  for ( int event = 0; event < NumPerfEvents; ++event )
+  {
+
+    int fd = openEvent( eventConfigs[ event ], leader_ );
+
+    if ( fd < 0 )
+    {
+
+      firstError = ( firstError ? firstError : errno );
+      missing   += ( missing.empty( ) ? "" : ", " );
+      missing   += perfEventName( static_cast< PerfEvent >( event ) );
+      continue;
+
+    }
+
+    if ( leader_ < 0 )
+    {
+
+      leader_ = fd;
+
+    }
+
+    fds_.push_back( fd );
+    events_.push_back( event );
+    report_.counted[ event ] = true;
+
+  }
+
+  if ( leader_ >= 0 )
+  {
+
+    ::ioctl( leader_, PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP );
+    ::ioctl( leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+
+  }
+
+  if ( missing.empty( ) )
+  {
+
+    report_.status = "ok";
+
+  }
+  else
+  {
+
+    // ENOENT: the CPU (or hypervisor) has no such event,
+    // EACCES/EPERM: kernel.perf_event_paranoid or a seccomp filter
+    report_.status = ( fds_.empty( ) ? "unavailable" : "partial" );
+    report_.detail = std::string( std::strerror( firstError ) ) + ": " + missing;
+
+  }
+
+#else
+
+  report_.status = "unavailable";
+  report_.detail = "no perf_event_open on this platform";
+
+#endif
+
+  last_.values.resize( fds_.size( ) );
+  current_.values.resize( fds_.size( ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PerfCounters::~PerfCounters
+////////////////////////////////////////////////////////////////////
+PerfCounters::~PerfCounters( )
+{
+
+#if defined( NET_PERF_EVENTS )
+
+  for ( int fd : fds_ )
+  {
+
+    ::close( fd );
+
+  }
+
+#endif
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PerfCounters::begin
+////////////////////////////////////////////////////////////////////
+void
+PerfCounters::begin( )
+{
+
+  _read( &last_ );
+  lastTime_ = Clock::now( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PerfCounters::end
+////////////////////////////////////////////////////////////////////
+void
+PerfCounters::end( PerfPhase phase )
+{
+
+  Clock::time_point now = Clock::now( );
+
+  _read( &current_ );
+
+  PhaseCounters &counters = report_.phases[ static_cast< unsigned >( phase ) ];
+
+  ++counters.samples;
+  counters.seconds += std::chrono::duration< double >( now - lastTime_ ).count( );
+
+  //
+  // scale up for the part of the interval the group wasn't on the
+  // PMU (the kernel multiplexes when there are too few counters)
+  //
+  double enabled = static_cast< double >( current_.enabled - last_.enabled );
+  double running = static_cast< double >( current_.running - last_.running );
+  double scale   = ( running > 0.0 && running < enabled ? enabled / running : 1.0 );
+
+  for ( size_t i = 0; i < fds_.size( ); ++i )
+  {
+
+    counters.counts[ events_[ i ] ] += ( current_.values[ i ] - last_.values[ i ] ) * scale;
+
+  }
+
+  std::swap( last_, current_ );
+  lastTime_ = now;
+
+} // PerfCounters::end
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief PerfCounters::_read
+////////////////////////////////////////////////////////////////////
+void
+PerfCounters::_read( Snapshot *pSnapshot )
+{
+
+#if defined( NET_PERF_EVENTS )
+
+  if ( leader_ < 0 )
+  {
+
+    return;
+
+  }
+
+  // nr, time enabled, time running, one value per event
+  uint64_t buffer[ 3 + NumPerfEvents ];
+
+  ssize_t bytes = ::read( leader_, buffer, sizeof( buffer ) );
+
+  if ( bytes < static_cast< ssize_t >( 3 * sizeof( uint64_t ) ) || buffer[ 0 ] != fds_.size( ) )
+  {
+
+    return; // keep the previous values (the phase adds nothing)
+
+  }
+
+  pSnapshot->enabled = buffer[ 1 ];
+  pSnapshot->running = buffer[ 2 ];
+
+  for ( size_t i = 0; i < fds_.size( ); ++i )
+  {
+
+    pSnapshot->values[ i ] = static_cast< double >( buffer[ 3 + i ] );
+
+  }
+
+#else
+
+  static_cast< void >( pSnapshot );
+
+#endif
+
+} // PerfCounters::_read
+
+
+} // namespace net
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+namespace net
+{
+
+
+/// \brief PerfPhase - training phases counted separately
+enum class PerfPhase
+{
+
+  Forward,  ///< feedForward (dense, sparse or mixed precision)
+  Backward, ///< output error and output gradients
+  Update,   ///< weight sweep, which also propagates the hidden gradients
+
+};
+
+constexpr unsigned numPerfPhases = 3;
+
+
+/// \brief PerfEvent - hardware events counted per phase
+enum PerfEvent
+{
+
+  Cycles,
+  Instructions,
+  L1dMisses,    ///< L1 data cache read misses
+  LlcMisses,    ///< last level cache read misses
+  BranchMisses,
+  NumPerfEvents
+
+};
+
+
+
+/// \brief PhaseCounters - totals of one phase
+struct PhaseCounters
+{
+
+  unsigned long long samples                 = 0; ///< phase executions (one per sample)
+  double             seconds                 = 0.0;
+  double             counts[ NumPerfEvents ] = { };
+
+  double ipc ( ) const { return counts[ Cycles ] > 0.0 ? counts[ Instructions ] / counts[ Cycles ] : 0.0; }
+
+  double perSample ( PerfEvent event ) const { return samples > 0 ? counts[ event ] / samples : 0.0; }
+
+};
+
+
+
+/// \brief PerfReport - per phase counters of a net
+struct PerfReport
+{
+
+  std::string   status;                         ///< "ok", "partial" or "unavailable"
+  std::string   detail;                         ///< why some or all counters are missing (empty when ok)
+  bool          counted[ NumPerfEvents ] = { }; ///< events the CPU and kernel let us count
+  PhaseCounters phases[ numPerfPhases ];
+
+  const PhaseCounters &operator[] ( PerfPhase phase ) const { return phases[ static_cast< unsigned >( phase ) ]; }
+
+};
+
+
+const char *perfPhaseName ( PerfPhase phase );
+const char *perfEventName ( PerfEvent event );
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The PerfCounters class
+///
+///        Hardware counters of the calling thread opened with
+///        Linux perf_event_open as one group (user space only, so
+///        perf_event_paranoid up to 2 is fine). Events the CPU or
+///        a virtual machine don't offer are left out; when none
+///        can be opened the counters report only phase times and
+///        the reason in PerfReport::status. Other platforms get
+///        times only.
+///
+///        Each phase boundary costs one read system call, which
+///        is large next to the phases of a tiny net, so counting
+///        is off unless asked for. The kernel scales counts for
+///        time the group was multiplexed off the PMU.
+///
+////////////////////////////////////////////////////////////////////
+class PerfCounters
+{
+
+public:
+
+  PerfCounters( );
+
+  ~PerfCounters( );
+
+  PerfCounters( const PerfCounters& ) = delete;
+  PerfCounters &operator= ( const PerfCounters& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief begin - starts counting a phase
+  ////////////////////////////////////////////////////////////////////
+  void begin ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief end
+  ///
+  ///        Adds everything since begin (or the previous end) to
+  ///        'phase', so back to back phases need one call each
+  ///
+  /// \param phase
+  ////////////////////////////////////////////////////////////////////
+  void end ( PerfPhase phase );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getReport
+  ////////////////////////////////////////////////////////////////////
+  PerfReport getReport ( ) const { return report_; }
+
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  /// \brief Snapshot - group read (enabled and running times, then
+  ///        one value per open event)
+  struct Snapshot
+  {
+
+    unsigned long long    enabled = 0;
+    unsigned long long    running = 0;
+    std::vector< double > values;
+
+  };
+
+  void _read ( Snapshot *pSnapshot );
+
+  int                  leader_;  // group leader descriptor (-1 when nothing is open)
+  std::vector< int >   fds_;
+  std::vector< int >   events_;  // PerfEvent of each descriptor
+
+  Snapshot          last_;
+  Snapshot          current_;
+  Clock::time_point lastTime_;
+
+  PerfReport report_;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The PerfScope class - counts a phase (or a run of phases)
+///        of optional counters
+////////////////////////////////////////////////////////////////////
+class PerfScope
+{
+
+public:
+
+  PerfScope(
+            PerfCounters *pCounters,
+            PerfPhase     phase
+            )
+    : pCounters_( pCounters )
+    , phase_    ( phase )
+  {
+
+    if ( pCounters_ )
+    {
+
+      pCounters_->begin( );
+
+    }
+
+  }
+
+  ~PerfScope( )
+  {
+
+    if ( pCounters_ )
+    {
+
+      pCounters_->end( phase_ );
+
+    }
+
+  }
+
+  PerfScope( const PerfScope& ) = delete;
+  PerfScope &operator= ( const PerfScope& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief next - ends the current phase and starts 'phase'
+  ////////////////////////////////////////////////////////////////////
+  void next ( PerfPhase phase )
+  {
+
+    if ( pCounters_ )
+    {
+
+      pCounters_->end( phase_ );
+
+    }
+
+    phase_ = phase;
+
+  }
+
+
+private:
+
+  PerfCounters *pCounters_;
+  PerfPhase     phase_;
+
+};
+
+
+} // namespace net
@@ -0,0 +1,184 @@
+#include "SamplePipeline.hpp"
+
+#include <stdexcept>
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::SamplePipeline
+////////////////////////////////////////////////////////////////////
+SamplePipeline::SamplePipeline(
+                               TrainFun inputFun,
+                               TrainFun targetFun,
+                               size_t   capacity
+                               )
+  : inputFun_    ( inputFun )
+  , targetFun_   ( targetFun )
+  , firstInputs_ ( inputFun_( ) )
+  , firstTargets_( targetFun_( ) )
+  , queue_       ( capacity, firstInputs_.size( ), firstTargets_.size( ) )
+{
+
+  queue_.push( firstInputs_.data( ), firstTargets_.data( ) );
+
+  generator_ = std::thread( &SamplePipeline::_generate, this );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::~SamplePipeline
+////////////////////////////////////////////////////////////////////
+SamplePipeline::~SamplePipeline( )
+{
+
+  stop( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::stop
+////////////////////////////////////////////////////////////////////
+void
+SamplePipeline::stop( )
+{
+
+  queue_.close( );
+
+  if ( generator_.joinable( ) )
+  {
+
+    generator_.join( );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::_generate
+////////////////////////////////////////////////////////////////////
+void
+SamplePipeline::_generate( )
+{
+
+  try
+  {
+
+    for ( ;; )
+    {
+
+      std::vector< double > inputs  = inputFun_( );
+      std::vector< double > targets = targetFun_( );
+
+      if ( inputs.size( ) != queue_.getNumInputs( ) || targets.size( ) != queue_.getNumTargets( ) )
+      {
+
+        throw std::runtime_error( "Sample generator changed the number of inputs or targets" );
+
+      }
+
+      if ( !queue_.push( inputs.data( ), targets.data( ) ) )
+      {
+
+        return; // stopped
+
+      }
+
+    }
+
+  }
+  catch ( ... )
+  {
+
+    // handed to the consumer once it drains the queue
+    generatorError_ = std::current_exception( );
+    queue_.close( );
+
+  }
+
+} // SamplePipeline::_generate
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::_front
+////////////////////////////////////////////////////////////////////
+const double *
+SamplePipeline::_front( )
+{
+
+  const double *sample = queue_.front( );
+
+  if ( !sample )
+  {
+
+    // (the close that ended the queue orders the error before it)
+    if ( generatorError_ )
+    {
+
+      std::rethrow_exception( generatorError_ );
+
+    }
+
+    throw std::runtime_error( "Sample pipeline was stopped" );
+
+  }
+
+  return sample;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::getInputFun
+////////////////////////////////////////////////////////////////////
+TrainFun
+SamplePipeline::getInputFun( )
+{
+
+  return [ this ]( )
+         {
+
+           const double *sample = _front( );
+
+           return std::vector< double >( sample, sample + queue_.getNumInputs( ) );
+
+         };
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SamplePipeline::getTargetFun
+////////////////////////////////////////////////////////////////////
+TrainFun
+SamplePipeline::getTargetFun( )
+{
+
+  return [ this ]( )
+         {
+
+           const double *targets = _front( ) + queue_.getNumInputs( );
+
+           std::vector< double > result( targets, targets + queue_.getNumTargets( ) );
+
+           queue_.pop( );
+
+           return result;
+
+         };
+
+}
+
+
+} // namespace net
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Net.hpp"
+#include "SampleQueue.hpp"
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The SamplePipeline class
+///
+///        Runs a sample generator on a thread of its own, feeding
+///        a SampleQueue that training drains on another, so
+///        expensive generators and training overlap on different
+///        cores. The generator stays ahead by up to the queue's
+///        capacity and waits when the queue is full.
+///
+///        getInputFun and getTargetFun drop into Net::trainNet (or
+///        anything else calling inputs then targets once per
+///        sample) in place of the generator's own functions;
+///        samples arrive in the order they were generated.
+///
+////////////////////////////////////////////////////////////////////
+class SamplePipeline
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief SamplePipeline
+  ///
+  ///        Generates the first sample on the calling thread (to
+  ///        size the queue's slots) and starts the generator thread
+  ///
+  /// \param inputFun - function to produce input values
+  /// \param targetFun - function to produce target values (called
+  ///                    right after inputFun for each sample)
+  /// \param capacity - samples the generator may run ahead
+  ////////////////////////////////////////////////////////////////////
+  SamplePipeline(
+                 TrainFun inputFun,
+                 TrainFun targetFun,
+                 size_t   capacity = 1024
+                 );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief ~SamplePipeline - stops the generator
+  ////////////////////////////////////////////////////////////////////
+  ~SamplePipeline( );
+
+  SamplePipeline( const SamplePipeline& ) = delete;
+  SamplePipeline &operator= ( const SamplePipeline& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getInputFun
+  /// \return consumer side function returning the next sample's
+  ///         inputs
+  ////////////////////////////////////////////////////////////////////
+  TrainFun getInputFun ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getTargetFun
+  /// \return consumer side function returning the targets of the
+  ///         sample whose inputs were returned last
+  ////////////////////////////////////////////////////////////////////
+  TrainFun getTargetFun ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief stop
+  ///
+  ///        Stops and joins the generator thread. Samples it queued
+  ///        but nobody consumed are dropped (the generator has run
+  ///        that many samples ahead).
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void stop ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getStats
+  /// \return queue depth and waiting counters so far
+  ////////////////////////////////////////////////////////////////////
+  QueueStats getStats ( ) const { return queue_.getStats( ); }
+
+
+private:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _generate - generator thread loop
+  ////////////////////////////////////////////////////////////////////
+  void _generate ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _front - next sample, rethrowing a generator failure
+  ////////////////////////////////////////////////////////////////////
+  const double *_front ( );
+
+  TrainFun inputFun_;
+  TrainFun targetFun_;
+
+  std::vector< double > firstInputs_;
+  std::vector< double > firstTargets_;
+
+  SampleQueue queue_;
+
+  std::exception_ptr generatorError_; // set by the generator thread before it closes the queue
+
+  std::thread generator_;
+
+};
+
+
+} // namespace net
@@ -0,0 +1,362 @@
+#include "SampleQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr unsigned maxSpins       = 64; // pause instructions before waiting sides start yielding
+constexpr unsigned depthSampleGap = 16; // pops between queue depth samples
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief backOff - one wait step: spin first, then yield the core
+////////////////////////////////////////////////////////////////////
+inline void
+backOff( unsigned *pSpins )
+{
+
+  if ( *pSpins < maxSpins )
+  {
+
+    ++*pSpins;
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+    __builtin_ia32_pause( );
+#endif
+
+  }
+  else
+  {
+
+    std::this_thread::yield( );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief add - increments a counter only its own thread writes
+////////////////////////////////////////////////////////////////////
+template< typename T >
+inline void
+add(
+    std::atomic< T > *pCounter,
+    T                 amount
+    )
+{
+
+  pCounter->store( pCounter->load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief slotCount - capacity rounded up to a power of two
+////////////////////////////////////////////////////////////////////
+size_t
+slotCount( size_t capacity )
+{
+
+  if ( capacity == 0 )
+  {
+
+    throw std::runtime_error( "Sample queue needs at least one slot" );
+
+  }
+
+  size_t count = 1;
+
+  while ( count < capacity )
+  {
+
+    count *= 2;
+
+  }
+
+  return count;
+
+}
+
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+inline unsigned long long
+nanosSince( Clock::time_point start )
+{
+
+  return static_cast< unsigned long long >(
+    std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now( ) - start ).count( ) );
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SampleQueue::SampleQueue
+////////////////////////////////////////////////////////////////////
+SampleQueue::SampleQueue(
+                         size_t capacity,
+                         size_t numInputs,
+                         size_t numTargets
+                         )
+  : capacity_         ( slotCount( capacity ) )
+  , mask_             ( capacity_ - 1 )
+  , numInputs_        ( numInputs )
+  , numTargets_       ( numTargets )
+  , slotStride_       ( Arena::padded( ( numInputs + numTargets ) * sizeof( double ) ) / sizeof( double ) )
+  , arena_            ( capacity_ * slotStride_ * sizeof( double ) )
+  , slots_            ( arena_.allocate< double >( capacity_ * slotStride_ ) )
+  , closed_           ( false )
+  , tail_             ( 0 )
+  , cachedHead_       ( 0 )
+  , producerStalls_   ( 0 )
+  , producerWaitNanos_( 0 )
+  , head_             ( 0 )
+  , cachedTail_       ( 0 )
+  , consumerStalls_   ( 0 )
+  , consumerWaitNanos_( 0 )
+  , depthSamples_     ( 0 )
+  , depthSum_         ( 0 )
+  , maxDepth_         ( 0 )
+{
+
+  if ( numInputs + numTargets == 0 )
+  {
+
+    throw std::runtime_error( "Sample queue needs at least one value per sample" );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SampleQueue::push
+////////////////////////////////////////////////////////////////////
+bool
+SampleQueue::push(
+                  const double *inputs,
+                  const double *targets
+                  )
+{
+
+  if ( closed_.load( std::memory_order_relaxed ) )
+  {
+
+    return false;
+
+  }
+
+  size_t tail = tail_.load( std::memory_order_relaxed );
+
+  //
+  // only look at the consumer's index when the cached one says
+  // the queue is full
+  //
+  if ( tail - cachedHead_ == capacity_ )
+  {
+
+    cachedHead_ = head_.load( std::memory_order_acquire );
+
+    if ( tail - cachedHead_ == capacity_ )
+    {
+
+      Clock::time_point start = Clock::now( );
+      unsigned          spins = 0;
+
+      add( &producerStalls_, 1ull );
+
+      while ( tail - cachedHead_ == capacity_ )
+      {
+
+        if ( closed_.load( std::memory_order_acquire ) )
+        {
+
+          add( &producerWaitNanos_, nanosSince( start ) );
+          return false;
+
+        }
+
+        backOff( &spins );
+        cachedHead_ = head_.load( std::memory_order_acquire );
+
+      }
+
+      add( &producerWaitNanos_, nanosSince( start ) );
+
+    }
+
+  }
+
+  double *slot = _slot( tail );
+
+  std::copy( inputs,  inputs  + numInputs_,  slot );
+  std::copy( targets, targets + numTargets_, slot + numInputs_ );
+
+  tail_.store( tail + 1, std::memory_order_release );
+
+  return true;
+
+} // SampleQueue::push
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SampleQueue::front
+////////////////////////////////////////////////////////////////////
+const double *
+SampleQueue::front( )
+{
+
+  size_t head = head_.load( std::memory_order_relaxed );
+
+  if ( head == cachedTail_ )
+  {
+
+    cachedTail_ = tail_.load( std::memory_order_acquire );
+
+    if ( head == cachedTail_ )
+    {
+
+      Clock::time_point start = Clock::now( );
+      unsigned          spins = 0;
+
+      add( &consumerStalls_, 1ull );
+
+      while ( head == cachedTail_ )
+      {
+
+        if ( closed_.load( std::memory_order_acquire ) )
+        {
+
+          // a last look for samples pushed before the close
+          cachedTail_ = tail_.load( std::memory_order_acquire );
+
+          if ( head == cachedTail_ )
+          {
+
+            add( &consumerWaitNanos_, nanosSince( start ) );
+            return nullptr;
+
+          }
+
+          break;
+
+        }
+
+        backOff( &spins );
+        cachedTail_ = tail_.load( std::memory_order_acquire );
+
+      }
+
+      add( &consumerWaitNanos_, nanosSince( start ) );
+
+    }
+
+  }
+
+  return _slot( head );
+
+} // SampleQueue::front
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SampleQueue::pop
+////////////////////////////////////////////////////////////////////
+void
+SampleQueue::pop( )
+{
+
+  size_t head = head_.load( std::memory_order_relaxed );
+
+  //
+  // sample the depth now and then (a fresh look at the producer's
+  // index costs a cache miss)
+  //
+  if ( head % depthSampleGap == 0 )
+  {
+
+    size_t depth = tail_.load( std::memory_order_relaxed ) - head;
+
+    add( &depthSamples_, 1ull );
+    add( &depthSum_, static_cast< unsigned long long >( depth ) );
+
+    if ( depth > maxDepth_.load( std::memory_order_relaxed ) )
+    {
+
+      maxDepth_.store( depth, std::memory_order_relaxed );
+
+    }
+
+  }
+
+  head_.store( head + 1, std::memory_order_release );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SampleQueue::close
+////////////////////////////////////////////////////////////////////
+void
+SampleQueue::close( )
+{
+
+  closed_.store( true, std::memory_order_release );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SampleQueue::getStats
+////////////////////////////////////////////////////////////////////
+QueueStats
+SampleQueue::getStats( ) const
+{
+
+  QueueStats stats;
+
+  stats.capacity            = capacity_;
+  stats.pushed              = tail_.load( std::memory_order_relaxed );
+  stats.popped              = head_.load( std::memory_order_relaxed );
+  stats.producerStalls      = producerStalls_.load( std::memory_order_relaxed );
+  stats.consumerStalls      = consumerStalls_.load( std::memory_order_relaxed );
+  stats.producerWaitSeconds = producerWaitNanos_.load( std::memory_order_relaxed ) * 1.0e-9;
+  stats.consumerWaitSeconds = consumerWaitNanos_.load( std::memory_order_relaxed ) * 1.0e-9;
+  stats.maxDepth            = maxDepth_.load( std::memory_order_relaxed );
+
+  unsigned long long samples = depthSamples_.load( std::memory_order_relaxed );
+
+  if ( samples > 0 )
+  {
+
+    stats.meanDepth = static_cast< double >( depthSum_.load( std::memory_order_relaxed ) ) / samples;
+
+  }
+
+  return stats;
+
+} // SampleQueue::getStats
+
+
+} // namespace net
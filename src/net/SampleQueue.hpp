@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "Arena.hpp"
+
+
+namespace net
+{
+
+
+/// \brief QueueStats - snapshot of a SampleQueue's counters
+struct QueueStats
+{
+
+  size_t             capacity            = 0;
+  unsigned long long pushed              = 0;
+  unsigned long long popped              = 0;
+  unsigned long long producerStalls      = 0;   ///< pushes that found the queue full (the consumer is the bottleneck)
+  unsigned long long consumerStalls      = 0;   ///< pops that found it empty (the producer is the bottleneck)
+  double             producerWaitSeconds = 0.0; ///< time the producer spent waiting for a free slot
+  double             consumerWaitSeconds = 0.0; ///< time the consumer spent waiting for a sample
+  double             meanDepth           = 0.0; ///< average number of queued samples (sampled by the consumer)
+  size_t             maxDepth            = 0;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The SampleQueue class
+///
+///        Bounded lock-free ring of preallocated sample slots for
+///        exactly one producer thread and one consumer thread.
+///        Each slot holds one sample's inputs followed by its
+///        targets; samples are copied in and read in place.
+///
+///        A full queue makes the producer wait (backpressure) and
+///        an empty one makes the consumer wait, spinning briefly
+///        before yielding. Either side keeps its own counters,
+///        so getStats shows which side waits on the other.
+///
+////////////////////////////////////////////////////////////////////
+class SampleQueue
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief SampleQueue
+  /// \param capacity - slots (rounded up to a power of two)
+  /// \param numInputs - values per input vector
+  /// \param numTargets - values per target vector
+  ////////////////////////////////////////////////////////////////////
+  SampleQueue(
+              size_t capacity,
+              size_t numInputs,
+              size_t numTargets
+              );
+
+  SampleQueue( const SampleQueue& ) = delete;
+  SampleQueue &operator= ( const SampleQueue& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief push - producer side
+  ///
+  ///        Copies one sample into the next free slot, waiting
+  ///        while the queue is full
+  ///
+  /// \param inputs - numInputs values
+  /// \param targets - numTargets values
+  /// \return false if the queue was closed (nothing is pushed)
+  ////////////////////////////////////////////////////////////////////
+  bool push (
+             const double *inputs,
+             const double *targets
+             );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief front - consumer side
+  ///
+  ///        Oldest sample, waiting while the queue is empty. Stays
+  ///        valid until pop.
+  ///
+  /// \return numInputs inputs followed by numTargets targets, or
+  ///         nullptr once the queue is closed and drained
+  ////////////////////////////////////////////////////////////////////
+  const double *front ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief pop - consumer side, releases the slot returned by front
+  ////////////////////////////////////////////////////////////////////
+  void pop ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief close
+  ///
+  ///        Wakes both sides: push fails from now on and front
+  ///        returns nullptr once the queued samples are consumed
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void close ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getStats
+  /// \return counters so far (safe to call from any thread)
+  ////////////////////////////////////////////////////////////////////
+  QueueStats getStats ( ) const;
+
+  size_t getCapacity   ( ) const { return capacity_; }
+  size_t getNumInputs  ( ) const { return numInputs_; }
+  size_t getNumTargets ( ) const { return numTargets_; }
+
+
+private:
+
+  static constexpr size_t cacheLine = 64;
+
+  double *_slot ( size_t index ) { return slots_ + ( index & mask_ ) * slotStride_; }
+
+  //
+  // read only after construction
+  //
+  size_t  capacity_;
+  size_t  mask_;
+  size_t  numInputs_;
+  size_t  numTargets_;
+  size_t  slotStride_; // doubles per slot (padded to whole cache lines)
+  Arena   arena_;
+  double *slots_;
+
+  std::atomic< bool > closed_;
+
+  //
+  // producer side (written by the producer only), kept on cache
+  // lines of its own so the two threads don't share any
+  //
+  char                              producerPad_[ cacheLine ];
+  std::atomic< size_t >             tail_;       // next slot to fill
+  size_t                            cachedHead_; // producer's last look at head_
+  std::atomic< unsigned long long > producerStalls_;
+  std::atomic< unsigned long long > producerWaitNanos_;
+
+  //
+  // consumer side (written by the consumer only)
+  //
+  char                              consumerPad_[ cacheLine ];
+  std::atomic< size_t >             head_;       // next slot to read
+  size_t                            cachedTail_; // consumer's last look at tail_
+  std::atomic< unsigned long long > consumerStalls_;
+  std::atomic< unsigned long long > consumerWaitNanos_;
+  std::atomic< unsigned long long > depthSamples_;
+  std::atomic< unsigned long long > depthSum_;
+  std::atomic< size_t >             maxDepth_;
+
+  char                              endPad_[ cacheLine ];
+
+};
+
+
+} // namespace net
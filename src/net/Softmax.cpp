@@ -0,0 +1,446 @@
+#include "Softmax.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define NET_SOFTMAX_X86 1
+#endif
+
+#if defined( __GNUC__ )
+#define NET_ALWAYS_INLINE inline __attribute__( ( always_inline ) )
+#define NET_FLATTEN       __attribute__( ( flatten ) )
+#else
+#define NET_ALWAYS_INLINE inline
+#define NET_FLATTEN
+#endif
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr size_t lanes = 8; // independent partial results per pass
+
+constexpr double log2e      = 1.4426950408889634074;
+constexpr double ln2Hi      = 6.93147180369123816490e-01; // ln( 2 ) split so n * ln2Hi is exact
+constexpr double ln2Lo      = 1.90821492927058770002e-10;
+constexpr double roundShift = 6755399441055744.0;         // 1.5 * 2^52, rounds to an integer
+constexpr double minExp     = -708.0;                     // e^x stays a normal double
+constexpr double maxExp     = 709.0;
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief exponential - e^x within an ulp or two of std::exp
+///
+///        e^x = 2^n * e^r with n = round( x / ln 2 ) and a degree
+///        13 Taylor polynomial for e^r, |r| <= ln( 2 ) / 2. No
+///        branches or calls, so loops around it vectorize.
+///
+////////////////////////////////////////////////////////////////////
+NET_ALWAYS_INLINE double
+exponential( double x )
+{
+
+  x = std::min( std::max( x, minExp ), maxExp );
+
+  // n lands in the low bits of the shifted value
+  double shifted = x * log2e + roundShift;
+  double n       = shifted - roundShift;
+  double r       = ( x - n * ln2Hi ) - n * ln2Lo;
+
+  double p = 1.0 / 6227020800.0;
+
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  // 2^n from the biased exponent ( n + 1023 fits in 11 bits )
+  uint64_t bits;
+  std::memcpy( &bits, &shifted, sizeof( bits ) );
+
+  bits = ( bits + 1023 ) << 52;
+
+  double scale;
+  std::memcpy( &scale, &bits, sizeof( scale ) );
+
+  return p * scale;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief forwardKernel
+////////////////////////////////////////////////////////////////////
+inline double
+forwardKernel(
+              size_t        count,
+              const double *logits,
+              double       *probs
+              )
+{
+
+  //
+  // largest logit
+  //
+  double maxes[ lanes ];
+
+  std::fill( maxes, maxes + lanes, -std::numeric_limits< double >::infinity( ) );
+
+  size_t i = 0;
+
+  for ( ; i + lanes <= count; i += lanes )
+  {
+
+    for ( size_t j = 0; j < lanes; ++j )
+    {
+
+      maxes[ j ] = std::max( maxes[ j ], logits[ i + j ] );
+
+    }
+
+  }
+
+  for ( ; i < count; ++i )
+  {
+
+    maxes[ 0 ] = std::max( maxes[ 0 ], logits[ i ] );
+
+  }
+
+  double maxLogit = *std::max_element( maxes, maxes + lanes );
+
+  //
+  // shifted exponentials and their sum
+  //
+  double sums[ lanes ] = { };
+
+  for ( i = 0; i + lanes <= count; i += lanes )
+  {
+
+    for ( size_t j = 0; j < lanes; ++j )
+    {
+
+      double e = exponential( logits[ i + j ] - maxLogit );
+
+      probs[ i + j ] = e;
+      sums[ j ]     += e;
+
+    }
+
+  }
+
+  for ( ; i < count; ++i )
+  {
+
+    probs[ i ] = exponential( logits[ i ] - maxLogit );
+    sums[ 0 ] += probs[ i ];
+
+  }
+
+  double sum = 0.0;
+
+  for ( size_t j = 0; j < lanes; ++j )
+  {
+
+    sum += sums[ j ];
+
+  }
+
+  double scale = 1.0 / sum;
+
+  for ( i = 0; i < count; ++i )
+  {
+
+    probs[ i ] *= scale;
+
+  }
+
+  return maxLogit + std::log( sum );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief crossEntropyKernel
+////////////////////////////////////////////////////////////////////
+inline double
+crossEntropyKernel(
+                   size_t                   count,
+                   const double *__restrict logits,
+                   double                   logSumExp,
+                   const double *__restrict probs,
+                   const double *__restrict targets,
+                   double       *__restrict gradients
+                   )
+{
+
+  // log( probs[ i ] ) = logits[ i ] - logSumExp
+  double losses[ lanes ] = { };
+
+  size_t i = 0;
+
+  for ( ; i + lanes <= count; i += lanes )
+  {
+
+    for ( size_t j = 0; j < lanes; ++j )
+    {
+
+      losses[ j ]       += targets[ i + j ] * ( logSumExp - logits[ i + j ] );
+      gradients[ i + j ] = targets[ i + j ] - probs[ i + j ];
+
+    }
+
+  }
+
+  for ( ; i < count; ++i )
+  {
+
+    losses[ 0 ]   += targets[ i ] * ( logSumExp - logits[ i ] );
+    gradients[ i ] = targets[ i ] - probs[ i ];
+
+  }
+
+  double loss = 0.0;
+
+  for ( size_t j = 0; j < lanes; ++j )
+  {
+
+    loss += losses[ j ];
+
+  }
+
+  return loss;
+
+}
+
+
+
+typedef double ( *ForwardFun      )( size_t, const double*, double* );
+typedef double ( *CrossEntropyFun )( size_t, const double*, double, const double*, const double*, double* );
+
+
+NET_FLATTEN double
+genericForward(
+               size_t        count,
+               const double *logits,
+               double       *probs
+               )
+{
+
+  return forwardKernel( count, logits, probs );
+
+}
+
+
+NET_FLATTEN double
+genericCrossEntropy(
+                    size_t        count,
+                    const double *logits,
+                    double        logSumExp,
+                    const double *probs,
+                    const double *targets,
+                    double       *gradients
+                    )
+{
+
+  return crossEntropyKernel( count, logits, logSumExp, probs, targets, gradients );
+
+}
+
+
+#if defined( NET_SOFTMAX_X86 )
+
+//
+// the same kernels flattened into functions compiled for wider
+// vectors
+//
+__attribute__( ( target( "avx2,fma" ) ) ) NET_FLATTEN double
+avx2Forward(
+            size_t        count,
+            const double *logits,
+            double       *probs
+            )
+{
+
+  return forwardKernel( count, logits, probs );
+
+}
+
+
+__attribute__( ( target( "avx2,fma" ) ) ) NET_FLATTEN double
+avx2CrossEntropy(
+                 size_t        count,
+                 const double *logits,
+                 double        logSumExp,
+                 const double *probs,
+                 const double *targets,
+                 double       *gradients
+                 )
+{
+
+  return crossEntropyKernel( count, logits, logSumExp, probs, targets, gradients );
+
+}
+
+
+__attribute__( ( target( "avx512f" ) ) ) NET_FLATTEN double
+avx512Forward(
+              size_t        count,
+              const double *logits,
+              double       *probs
+              )
+{
+
+  return forwardKernel( count, logits, probs );
+
+}
+
+
+__attribute__( ( target( "avx512f" ) ) ) NET_FLATTEN double
+avx512CrossEntropy(
+                   size_t        count,
+                   const double *logits,
+                   double        logSumExp,
+                   const double *probs,
+                   const double *targets,
+                   double       *gradients
+                   )
+{
+
+  return crossEntropyKernel( count, logits, logSumExp, probs, targets, gradients );
+
+}
+
+#endif
+
+
+
+/// \brief Kernels - forward and loss kernels for one instruction set
+struct Kernels
+{
+
+  ForwardFun      forward;
+  CrossEntropyFun crossEntropy;
+  const char     *name;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief selectKernels - widest kernels the CPU runs
+////////////////////////////////////////////////////////////////////
+Kernels
+selectKernels( )
+{
+
+#if defined( NET_SOFTMAX_X86 )
+
+  __builtin_cpu_init( );
+
+  if ( __builtin_cpu_supports( "avx512f" ) )
+  {
+
+    return Kernels{ &avx512Forward, &avx512CrossEntropy, "avx512" };
+
+  }
+
+  if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) )
+  {
+
+    return Kernels{ &avx2Forward, &avx2CrossEntropy, "avx2" };
+
+  }
+
+#endif
+
+  return Kernels{ &genericForward, &genericCrossEntropy, "generic" };
+
+}
+
+
+
+const Kernels &
+kernels( )
+{
+
+  static const Kernels selected = selectKernels( );
+
+  return selected;
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Softmax::forward
+////////////////////////////////////////////////////////////////////
+double
+Softmax::forward(
+                 size_t        count,
+                 const double *logits,
+                 double       *probs
+                 )
+{
+
+  return kernels( ).forward( count, logits, probs );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Softmax::crossEntropy
+////////////////////////////////////////////////////////////////////
+double
+Softmax::crossEntropy(
+                      size_t        count,
+                      const double *logits,
+                      double        logSumExp,
+                      const double *probs,
+                      const double *targets,
+                      double       *gradients
+                      )
+{
+
+  return kernels( ).crossEntropy( count, logits, logSumExp, probs, targets, gradients );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Softmax::getKernelName
+////////////////////////////////////////////////////////////////////
+const char *
+Softmax::getKernelName( )
+{
+
+  return kernels( ).name;
+
+}
+
+
+} // namespace net
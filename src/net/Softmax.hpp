@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The Softmax class
+///
+///        Kernels behind the softmax / cross entropy output head
+///        (OutputHead::Softmax). Exponentials come from a branch
+///        free polynomial so every pass vectorizes; the kernels
+///        are picked at startup for the widest instruction set
+///        the CPU supports, as for Gemm.
+///
+////////////////////////////////////////////////////////////////////
+class Softmax
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief forward
+  ///
+  ///        probs = softmax( logits ), shifted by the largest logit
+  ///        so no exponential overflows
+  ///
+  /// \param count
+  /// \param logits
+  /// \param probs - may be logits (computed in place)
+  /// \return log-sum-exp of the logits
+  ////////////////////////////////////////////////////////////////////
+  static double forward (
+                         size_t        count,
+                         const double *logits,
+                         double       *probs
+                         );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief crossEntropy
+  ///
+  ///        Loss and output gradients in a single pass. The loss
+  ///        is taken from the logits and their log-sum-exp rather
+  ///        than from log( probs ), so it stays finite however
+  ///        small a probability gets.
+  ///
+  /// \param count
+  /// \param logits
+  /// \param logSumExp - returned by forward for the same logits
+  /// \param probs - returned by forward for the same logits
+  /// \param targets - class probabilities summing to one (usually
+  ///                  one hot class labels)
+  /// \param gradients - filled with targets - probs (the negated
+  ///                    derivative of the loss with respect to the
+  ///                    logits, the sign the net's gradients use)
+  /// \return cross entropy, - sum( targets * log( probs ) )
+  ////////////////////////////////////////////////////////////////////
+  static double crossEntropy (
+                              size_t        count,
+                              const double *logits,
+                              double        logSumExp,
+                              const double *probs,
+                              const double *targets,
+                              double       *gradients
+                              );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getKernelName
+  /// \return instruction set of the kernels
+  ////////////////////////////////////////////////////////////////////
+  static const char *getKernelName ( );
+
+};
+
+
+} // namespace net
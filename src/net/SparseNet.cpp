@@ -0,0 +1,505 @@
+#include "SparseNet.hpp"
+
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+
+#include "CommonStructs.hpp"
+#include "ConnectedNet.hpp"
+#include "Softmax.hpp"
+
+
+namespace net
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief pruneNet
+////////////////////////////////////////////////////////////////////
+std::vector< double >
+pruneNet(
+         ConnectedNet       *pNet,
+         const PruneOptions &options
+         )
+{
+
+  std::vector< unsigned > topology = pNet->getTopology( );
+  std::vector< double >   sparsities;
+  std::vector< double >   weights;
+  std::vector< double >   magnitudes;
+
+  for ( unsigned layerNum = 1; layerNum < topology.size( ); ++layerNum )
+  {
+
+    pNet->getWeights( layerNum, &weights );
+
+    unsigned numRows = topology[ layerNum ];
+    unsigned numCols = topology[ layerNum - 1 ] + 1;
+
+    double threshold = options.threshold;
+
+    //
+    // per layer threshold giving the requested sparsity
+    //
+    if ( options.targetSparsity >= 0.0 )
+    {
+
+      magnitudes.clear( );
+
+      for ( unsigned r = 0; r < numRows; ++r )
+      {
+
+        for ( unsigned c = 0; c < numCols - 1; ++c )
+        {
+
+          magnitudes.push_back( std::abs( weights[ r * numCols + c ] ) );
+
+        }
+
+      }
+
+      size_t numPruned = static_cast< size_t >( std::min( options.targetSparsity, 1.0 ) * magnitudes.size( ) );
+
+      if ( numPruned == 0 )
+      {
+
+        threshold = 0.0;
+
+      }
+      else if ( numPruned >= magnitudes.size( ) )
+      {
+
+        threshold = std::numeric_limits< double >::infinity( );
+
+      }
+      else
+      {
+
+        std::nth_element( magnitudes.begin( ), magnitudes.begin( ) + static_cast< long >( numPruned ), magnitudes.end( ) );
+        threshold = magnitudes[ numPruned ];
+
+      }
+
+    }
+
+    unsigned numZero = 0;
+
+    for ( unsigned r = 0; r < numRows; ++r )
+    {
+
+      // last column is the bias weight
+      for ( unsigned c = 0; c < numCols - 1; ++c )
+      {
+
+        double &weight = weights[ r * numCols + c ];
+
+        if ( std::abs( weight ) < threshold )
+        {
+
+          weight = 0.0;
+
+        }
+
+        numZero += ( weight == 0.0 ? 1u : 0u );
+
+      }
+
+    }
+
+    // momentum is kept, so the dense net can go on training
+    pNet->setWeights( layerNum, weights, true );
+
+    sparsities.push_back( numZero * 1.0 / ( numRows * ( numCols - 1 ) ) );
+
+  }
+
+  return sparsities;
+
+} // pruneNet
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::SparseNet
+////////////////////////////////////////////////////////////////////
+SparseNet::SparseNet(
+                     const ConnectedNet &net,
+                     double              errorSmoothing
+                     )
+  : m_outputHead( net.getOutputHead( ) )
+  , m_logSumExp( 0.0 )
+  , m_error( 0.0 )
+  , m_recentAverageError( 1.0 )
+  , m_recentAverageSmoothingFactor( errorSmoothing )
+  , m_params( net.getLearningParams( ) )
+{
+
+  std::vector< unsigned > topology = net.getTopology( );
+  std::vector< double >   weights;
+
+  m_logits.resize( topology.back( ) );
+
+  for ( unsigned layerNum = 0; layerNum < topology.size( ); ++layerNum )
+  {
+
+    m_outputs.push_back( std::vector< double >( topology[ layerNum ] + 1, 1.0 ) );
+    m_gradients.push_back( std::vector< double >( topology[ layerNum ] + 1, 0.0 ) );
+
+  }
+
+  for ( unsigned layerNum = 1; layerNum < topology.size( ); ++layerNum )
+  {
+
+    net.getWeights( layerNum, &weights );
+
+    SparseLayer layer;
+    layer.numRows = topology[ layerNum ];
+    layer.numCols = topology[ layerNum - 1 ] + 1;
+
+    layer.rowStarts.push_back( 0 );
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      for ( unsigned c = 0; c < layer.numCols; ++c )
+      {
+
+        double weight = weights[ r * layer.numCols + c ];
+
+        // biases are stored even at 0.0, so they can train again
+        if ( weight != 0.0 || c == layer.numCols - 1 )
+        {
+
+          layer.cols.push_back( c );
+          layer.weights.push_back( weight );
+
+        }
+
+      }
+
+      layer.rowStarts.push_back( static_cast< unsigned >( layer.cols.size( ) ) );
+
+    }
+
+    layer.deltaWeights.assign( layer.weights.size( ), 0.0 );
+
+    m_weightLayers.push_back( std::move( layer ) );
+
+  }
+
+} // SparseNet::SparseNet
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::feedForward
+/// \param inputVals
+////////////////////////////////////////////////////////////////////
+void
+SparseNet::feedForward( const std::vector< double > &inputVals )
+{
+
+  assert( inputVals.size( ) == m_outputs[ 0 ].size( ) - 1 );
+
+  std::copy( inputVals.begin( ), inputVals.end( ), m_outputs[ 0 ].begin( ) );
+
+  //
+  // CSR mat-vec per layer
+  //
+  for ( unsigned l = 0; l < m_weightLayers.size( ); ++l )
+  {
+
+    const SparseLayer           &layer  = m_weightLayers[ l ];
+    const std::vector< double > &input  = m_outputs[ l ];
+    std::vector< double >       &output = m_outputs[ l + 1 ];
+
+    bool softmax = ( l + 1 == m_weightLayers.size( ) && m_outputHead == OutputHead::Softmax );
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      double sum = 0.0;
+
+      for ( unsigned k = layer.rowStarts[ r ]; k < layer.rowStarts[ r + 1 ]; ++k )
+      {
+
+        sum += layer.weights[ k ] * input[ layer.cols[ k ] ];
+
+      }
+
+      if ( softmax )
+      {
+
+        m_logits[ r ] = sum;
+
+      }
+      else
+      {
+
+        output[ r ] = std::tanh( sum );
+
+      }
+
+    }
+
+    if ( softmax )
+    {
+
+      // (the trailing bias value of the output layer is left alone)
+      m_logSumExp = Softmax::forward( m_logits.size( ), m_logits.data( ), output.data( ) );
+
+    }
+
+  }
+
+} // SparseNet::feedForward
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::backProp
+/// \param targetVals
+////////////////////////////////////////////////////////////////////
+void
+SparseNet::backProp( const std::vector< double > &targetVals )
+{
+
+  std::vector< double > &outputs   = m_outputs.back( );
+  std::vector< double > &gradients = m_gradients.back( );
+  size_t                 numOutput = outputs.size( ) - 1;
+
+  assert( targetVals.size( ) == numOutput );
+
+  //
+  // same loss and output gradients as NetImpl
+  //
+  if ( m_outputHead == OutputHead::Softmax )
+  {
+
+    m_error = Softmax::crossEntropy(
+                                    numOutput,
+                                    m_logits.data( ),
+                                    m_logSumExp,
+                                    outputs.data( ),
+                                    targetVals.data( ),
+                                    gradients.data( )
+                                    );
+
+  }
+  else
+  {
+
+    m_error = 0.0;
+
+    for ( size_t n = 0; n < numOutput; ++n )
+    {
+
+      double delta   = targetVals[ n ] - outputs[ n ];
+      m_error       += delta * delta;
+      gradients[ n ] = delta * ( 1.0 - outputs[ n ] * outputs[ n ] );
+
+    }
+
+    m_error /= numOutput;
+    m_error  = std::sqrt( m_error );
+
+  }
+
+  m_recentAverageError = ( m_recentAverageError * m_recentAverageSmoothingFactor )
+                         + ( m_error * ( 1.0 - m_recentAverageSmoothingFactor ) );
+
+  //
+  // hidden gradients (transposed CSR product scattered into the
+  // previous layer) computed with the weights before any update
+  //
+  for ( size_t l = m_weightLayers.size( ) - 1; l > 0; --l )
+  {
+
+    const SparseLayer           &layer        = m_weightLayers[ l ];
+    const std::vector< double > &nextGradient = m_gradients[ l + 1 ];
+    std::vector< double >       &gradient     = m_gradients[ l ];
+    const std::vector< double > &output       = m_outputs[ l ];
+
+    std::fill( gradient.begin( ), gradient.end( ), 0.0 );
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      for ( unsigned k = layer.rowStarts[ r ]; k < layer.rowStarts[ r + 1 ]; ++k )
+      {
+
+        gradient[ layer.cols[ k ] ] += layer.weights[ k ] * nextGradient[ r ];
+
+      }
+
+    }
+
+    for ( size_t n = 0; n < gradient.size( ) - 1; ++n )
+    {
+
+      gradient[ n ] *= 1.0 - output[ n ] * output[ n ];
+
+    }
+
+  }
+
+  //
+  // update stored weights only
+  //
+  for ( size_t l = 0; l < m_weightLayers.size( ); ++l )
+  {
+
+    SparseLayer                 &layer    = m_weightLayers[ l ];
+    const std::vector< double > &input    = m_outputs[ l ];
+    const std::vector< double > &gradient = m_gradients[ l + 1 ];
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      for ( unsigned k = layer.rowStarts[ r ]; k < layer.rowStarts[ r + 1 ]; ++k )
+      {
+
+        double newDeltaWeight = m_params.eta * input[ layer.cols[ k ] ] * gradient[ r ]
+                                + m_params.alpha * layer.deltaWeights[ k ];
+
+        layer.deltaWeights[ k ] = newDeltaWeight;
+        layer.weights[ k ]     += newDeltaWeight;
+
+      }
+
+    }
+
+  }
+
+} // SparseNet::backProp
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::getResults
+/// \param pResultVals
+////////////////////////////////////////////////////////////////////
+void
+SparseNet::getResults( std::vector< double > *pResultVals ) const
+{
+
+  pResultVals->assign( m_outputs.back( ).begin( ), m_outputs.back( ).end( ) - 1 );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::getAverageError
+/// \return
+////////////////////////////////////////////////////////////////////
+double
+SparseNet::getAverageError( )
+{
+
+  return m_recentAverageError;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::clone
+/// \return
+////////////////////////////////////////////////////////////////////
+std::unique_ptr< Net >
+SparseNet::clone( ) const
+{
+
+  return std::unique_ptr< Net >( new SparseNet( *this ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::getNumWeights
+/// \return
+////////////////////////////////////////////////////////////////////
+size_t
+SparseNet::getNumWeights( ) const
+{
+
+  size_t numWeights = 0;
+
+  for ( const SparseLayer &layer : m_weightLayers )
+  {
+
+    numWeights += layer.weights.size( );
+
+  }
+
+  return numWeights;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief SparseNet::copyWeightsTo
+/// \param pNet
+////////////////////////////////////////////////////////////////////
+void
+SparseNet::copyWeightsTo( ConnectedNet *pNet ) const
+{
+
+  std::vector< unsigned > topology = pNet->getTopology( );
+
+  if ( topology.size( ) != m_outputs.size( ) )
+  {
+
+    throw std::runtime_error( "Net topology does not match sparse net" );
+
+  }
+
+  if ( pNet->getOutputHead( ) != m_outputHead )
+  {
+
+    throw std::runtime_error( "Net output head does not match sparse net" );
+
+  }
+
+  std::vector< double > weights;
+
+  for ( unsigned l = 0; l < m_weightLayers.size( ); ++l )
+  {
+
+    const SparseLayer &layer = m_weightLayers[ l ];
+
+    if ( topology[ l + 1 ] != layer.numRows || topology[ l ] + 1 != layer.numCols )
+    {
+
+      throw std::runtime_error( "Net topology does not match sparse net" );
+
+    }
+
+    weights.assign( layer.numRows * layer.numCols, 0.0 );
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      for ( unsigned k = layer.rowStarts[ r ]; k < layer.rowStarts[ r + 1 ]; ++k )
+      {
+
+        weights[ r * layer.numCols + layer.cols[ k ] ] = layer.weights[ k ];
+
+      }
+
+    }
+
+    pNet->setWeights( l + 1, weights );
+
+  }
+
+} // SparseNet::copyWeightsTo
+
+
+
+} // namespace net
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Net.hpp"
+#include "CommonStructs.hpp"
+#include <vector>
+
+
+namespace net
+{
+
+class ConnectedNet;
+
+
+/// \brief PruneOptions
+struct PruneOptions
+{
+
+  double threshold      = 0.0;  ///< weights with magnitude below this are zeroed
+  double targetSparsity = -1.0; ///< if in [0.0, 1.0], fraction of each layer's weights to zero instead
+
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief pruneNet
+///
+///        Zeroes small magnitude weights of a trained net in
+///        place. Bias weights are never pruned. Momentum is
+///        kept (pruned weights included), so training the dense
+///        net can carry on; a SparseNet built from it starts
+///        without momentum.
+///
+/// \param pNet - net to prune
+/// \param options
+/// \return fraction of (non-bias) weights zeroed per weight layer
+////////////////////////////////////////////////////////////////////
+std::vector< double > pruneNet (
+                                ConnectedNet       *pNet,
+                                const PruneOptions &options
+                                );
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The SparseNet class
+///
+///        Net with each weight layer stored in CSR format. Only
+///        the nonzero weights of the source net (and every bias)
+///        are kept so feeding forward costs one multiply-add per
+///        remaining weight. Back propagation only ever updates stored
+///        weights, so fine-tuning keeps the sparsity pattern.
+///        The source net's output head (tanh or softmax with
+///        cross entropy) is kept too.
+///
+////////////////////////////////////////////////////////////////////
+class SparseNet : public Net
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief SparseNet
+  /// \param net - (pruned) net whose nonzero weights and biases
+  ///              are kept
+  /// \param errorSmoothing
+  ////////////////////////////////////////////////////////////////////
+  SparseNet(
+            const ConnectedNet &net,
+            double              errorSmoothing = 0.9
+            );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief feedForward
+  /// \param inputVals
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  void feedForward ( const std::vector< double > &inputVals ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief backProp
+  /// \param targetVals
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  void backProp ( const std::vector< double > &targetVals ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getResults
+  /// \param pResultVals
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  void getResults ( std::vector< double > *pResultVals ) const final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getAverageError
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  double getAverageError ( ) final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief clone
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  virtual
+  std::unique_ptr< Net > clone ( ) const final;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getNumWeights
+  /// \return number of stored weights (the nonzero ones and every
+  ///         bias)
+  ////////////////////////////////////////////////////////////////////
+  size_t getNumWeights ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief copyWeightsTo
+  ///
+  ///        Writes the (fine-tuned) weights back into a dense net
+  ///        of the same topology and output head. Pruned weights
+  ///        are written as 0.
+  ///
+  /// \param pNet
+  ////////////////////////////////////////////////////////////////////
+  void copyWeightsTo ( ConnectedNet *pNet ) const;
+
+
+private:
+
+  /// \brief CSR matrix of the weights feeding one layer
+  struct SparseLayer
+  {
+
+    unsigned numRows; // neurons in this layer
+    unsigned numCols; // neurons in previous layer plus bias
+
+    std::vector< unsigned > rowStarts;    // numRows + 1 offsets into cols/weights
+    std::vector< unsigned > cols;
+    std::vector< double >   weights;
+    std::vector< double >   deltaWeights;
+
+  };
+
+  std::vector< SparseLayer > m_weightLayers; // m_weightLayers[ l ] feeds layer l + 1
+
+  // m_outputs[ l ] holds layer l outputs with a trailing 1.0 bias value
+  std::vector< std::vector< double > > m_outputs;
+  std::vector< std::vector< double > > m_gradients;
+
+  // output head (OutputHead::Softmax keeps the latest logits and
+  // their log-sum-exp for the loss)
+  OutputHead            m_outputHead;
+  std::vector< double > m_logits;
+  double                m_logSumExp;
+
+  double m_error;
+  double m_recentAverageError;
+  double m_recentAverageSmoothingFactor;
+
+  LearningParams m_params; // taken from the dense net
+
+};
+
+
+} // namespace net
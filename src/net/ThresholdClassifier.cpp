@@ -0,0 +1,553 @@
+#include "ThresholdClassifier.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "ConnectedNet.hpp"
+
+
+namespace net
+{
+
+
+namespace
+{
+
+constexpr size_t tileSize      = 128;  // samples per batch tile
+constexpr double relativeSlack = 1e-9; // of the largest possible output sum
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ThresholdStats::add
+////////////////////////////////////////////////////////////////////
+void
+ThresholdStats::add( const ThresholdStats &other )
+{
+
+  samples         += other.samples;
+  decidedEarly    += other.decidedEarly;
+  neuronsComputed += other.neuronsComputed;
+  neuronsTotal    += other.neuronsTotal;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ThresholdClassifier::ThresholdClassifier
+////////////////////////////////////////////////////////////////////
+ThresholdClassifier::ThresholdClassifier(
+                                         const ConnectedNet &net,
+                                         unsigned            outputNum,
+                                         double              threshold,
+                                         unsigned            probeNeurons
+                                         )
+  : m_numInputs    ( 0 )
+  , m_numLastHidden( 0 )
+  , m_numProbe     ( 0 )
+  , m_width        ( 0 )
+  , m_outBias      ( 0.0 )
+  , m_slack        ( 0.0 )
+{
+
+  std::vector< unsigned > topology  = net.getTopology( );
+  size_t                  numLayers = topology.size( );
+
+  if ( net.getOutputHead( ) != OutputHead::Tanh )
+  {
+
+    throw std::runtime_error( "Threshold classification needs the tanh output head" );
+
+  }
+
+  if ( outputNum >= topology.back( ) )
+  {
+
+    throw std::runtime_error( "Output to classify is out of range" );
+
+  }
+
+  if ( !( threshold > -1.0 && threshold < 1.0 ) )
+  {
+
+    throw std::runtime_error( "Classification threshold must be in (-1, 1)" );
+
+  }
+
+  m_numInputs = topology.front( );
+
+  std::vector< double > weights;
+
+  //
+  // every hidden layer but the last is evaluated in full
+  //
+  for ( unsigned layerNum = 1; layerNum + 2 < numLayers; ++layerNum )
+  {
+
+    net.getWeights( layerNum, &weights );
+
+    DenseLayer layer;
+
+    layer.numRows = topology[ layerNum ];
+    layer.numCols = topology[ layerNum - 1 ];
+
+    for ( unsigned r = 0; r < layer.numRows; ++r )
+    {
+
+      const double *row = &weights[ r * ( layer.numCols + 1 ) ];
+
+      layer.weights.insert( layer.weights.end( ), row, row + layer.numCols );
+      layer.biases.push_back( row[ layer.numCols ] );
+
+    }
+
+    // B( input, neuron ) of x * B
+    layer.packed = PackedMatrix( layer.numCols, layer.numRows, MatrixView{ layer.weights.data( ), 1, layer.numCols } );
+
+    m_denseLayers.push_back( std::move( layer ) );
+
+  }
+
+  m_width = ( numLayers > 2 ? topology[ numLayers - 3 ] : m_numInputs );
+
+  //
+  // output neuron: weights from the last hidden layer (or the
+  // inputs) and its bias, shifted so the decision is sum > 0
+  //
+  net.getWeights( static_cast< unsigned >( numLayers - 1 ), &weights );
+
+  unsigned              numOut = topology[ numLayers - 2 ];
+  const double         *outRow = &weights[ outputNum * ( numOut + 1 ) ];
+  std::vector< double > outWeights( outRow, outRow + numOut );
+
+  m_outBias = outRow[ numOut ] - std::atanh( threshold );
+
+  if ( numLayers == 2 )
+  {
+
+    // no hidden layer to skip: the output is a plain dot product
+    m_outWeights = outWeights;
+    return;
+
+  }
+
+  m_numLastHidden = numOut;
+
+  net.getWeights( static_cast< unsigned >( numLayers - 2 ), &weights );
+
+  //
+  // most a neuron's output can move the output sum: |weight| times
+  // a bound on the neuron's output, tighter than 1 when its inputs
+  // come from a hidden layer (themselves in [-1, 1])
+  //
+  std::vector< double > reach( m_numLastHidden );
+
+  for ( unsigned n = 0; n < m_numLastHidden; ++n )
+  {
+
+    double bound = 1.0;
+
+    if ( numLayers > 3 )
+    {
+
+      const double *row   = &weights[ n * ( m_width + 1 ) ];
+      double        limit = std::abs( row[ m_width ] );
+
+      for ( unsigned i = 0; i < m_width; ++i )
+      {
+
+        limit += std::abs( row[ i ] );
+
+      }
+
+      bound = std::tanh( limit );
+
+    }
+
+    reach[ n ] = std::abs( outWeights[ n ] ) * bound;
+
+  }
+
+  std::vector< unsigned > order( m_numLastHidden );
+
+  std::iota( order.begin( ), order.end( ), 0u );
+  std::stable_sort( order.begin( ), order.end( ), [ &reach ]( unsigned a, unsigned b ) { return reach[ a ] > reach[ b ]; } );
+
+  m_remaining.assign( m_numLastHidden + 1, 0.0 );
+
+  for ( unsigned k = 0; k < m_numLastHidden; ++k )
+  {
+
+    const double *row = &weights[ order[ k ] * ( m_width + 1 ) ];
+
+    m_hiddenWeights.insert( m_hiddenWeights.end( ), row, row + m_width );
+    m_hiddenBiases.push_back( row[ m_width ] );
+    m_outWeights.push_back( outWeights[ order[ k ] ] );
+
+  }
+
+  for ( unsigned k = m_numLastHidden; k > 0; --k )
+  {
+
+    m_remaining[ k - 1 ] = m_remaining[ k ] + reach[ order[ k - 1 ] ];
+
+  }
+
+  m_slack = relativeSlack * ( std::abs( m_outBias ) + m_remaining[ 0 ] );
+
+  //
+  // probe: by default the fewest neurons that leave at most half
+  // of the output weight undecided
+  //
+  if ( probeNeurons == 0 )
+  {
+
+    m_numProbe = 1;
+
+    while ( m_numProbe < m_numLastHidden && m_remaining[ m_numProbe ] > 0.5 * m_remaining[ 0 ] )
+    {
+
+      ++m_numProbe;
+
+    }
+
+  }
+  else
+  {
+
+    m_numProbe = std::min( probeNeurons, m_numLastHidden );
+
+  }
+
+  unsigned numRest = m_numLastHidden - m_numProbe;
+
+  m_probePacked = PackedMatrix( m_width, m_numProbe, MatrixView{ m_hiddenWeights.data( ), 1, m_width } );
+
+  if ( numRest > 0 )
+  {
+
+    m_restPacked = PackedMatrix( m_width, numRest, MatrixView{ &m_hiddenWeights[ m_numProbe * m_width ], 1, m_width } );
+
+  }
+
+} // ThresholdClassifier::ThresholdClassifier
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ThresholdClassifier::_forwardDense
+////////////////////////////////////////////////////////////////////
+const double *
+ThresholdClassifier::_forwardDense(
+                                   const double          *inputs,
+                                   size_t                 count,
+                                   std::vector< double > *pScratchA,
+                                   std::vector< double > *pScratchB
+                                   ) const
+{
+
+  const double *in    = inputs;
+  size_t        width = m_numInputs;
+
+  for ( const DenseLayer &layer : m_denseLayers )
+  {
+
+    std::vector< double > &scratch = *pScratchA;
+
+    scratch.resize( count * layer.numRows );
+
+    double *out = scratch.data( );
+
+    for ( size_t s = 0; s < count; ++s )
+    {
+
+      std::copy( layer.biases.begin( ), layer.biases.end( ), out + s * layer.numRows );
+
+    }
+
+    Gemm::multiply( count, MatrixView{ in, width, 1 }, layer.packed, out, layer.numRows, true );
+
+    for ( size_t i = 0; i < count * layer.numRows; ++i )
+    {
+
+      out[ i ] = std::tanh( out[ i ] );
+
+    }
+
+    in    = out;
+    width = layer.numRows;
+
+    std::swap( pScratchA, pScratchB );
+
+  }
+
+  return in;
+
+} // ThresholdClassifier::_forwardDense
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ThresholdClassifier::_hiddenValue
+////////////////////////////////////////////////////////////////////
+double
+ThresholdClassifier::_hiddenValue(
+                                  unsigned      k,
+                                  const double *x
+                                  ) const
+{
+
+  const double *row = &m_hiddenWeights[ k * m_width ];
+
+  double sum = m_hiddenBiases[ k ];
+
+  for ( unsigned i = 0; i < m_width; ++i )
+  {
+
+    sum += row[ i ] * x[ i ];
+
+  }
+
+  return std::tanh( sum );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ThresholdClassifier::classify
+////////////////////////////////////////////////////////////////////
+bool
+ThresholdClassifier::classify(
+                              const std::vector< double > &inputVals,
+                              ThresholdStats              *pStats
+                              ) const
+{
+
+  assert( inputVals.size( ) == m_numInputs );
+
+  std::vector< double > scratchA;
+  std::vector< double > scratchB;
+
+  const double *x = _forwardDense( inputVals.data( ), 1, &scratchA, &scratchB );
+
+  double   sum = m_outBias;
+  unsigned k   = 0;
+
+  if ( m_numLastHidden == 0 )
+  {
+
+    for ( unsigned i = 0; i < m_width; ++i )
+    {
+
+      sum += m_outWeights[ i ] * x[ i ];
+
+    }
+
+  }
+  else
+  {
+
+    // one neuron at a time until the rest can't flip the answer
+    while ( k < m_numLastHidden && !_isDecided( sum, k ) )
+    {
+
+      sum += m_outWeights[ k ] * _hiddenValue( k, x );
+      ++k;
+
+    }
+
+  }
+
+  if ( pStats )
+  {
+
+    ThresholdStats stats;
+
+    stats.samples         = 1;
+    stats.decidedEarly    = ( k < m_numLastHidden ? 1 : 0 );
+    stats.neuronsComputed = k;
+    stats.neuronsTotal    = m_numLastHidden;
+
+    pStats->add( stats );
+
+  }
+
+  return sum > 0.0;
+
+} // ThresholdClassifier::classify
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ThresholdClassifier::classifyBatch
+///
+///        Per tile of samples: the dense layers and the probe
+///        neurons for every sample, then the remaining neurons for
+///        the undecided samples, gathered into a contiguous block
+///
+////////////////////////////////////////////////////////////////////
+void
+ThresholdClassifier::classifyBatch(
+                                   const std::vector< double > &inputVals,
+                                   std::vector< char >         *pAbove,
+                                   ThresholdStats              *pStats
+                                   ) const
+{
+
+  size_t numSamples = inputVals.size( ) / m_numInputs;
+
+  assert( inputVals.size( ) == numSamples * m_numInputs );
+
+  std::vector< char > &above = *pAbove;
+
+  above.assign( numSamples, 0 );
+
+  const unsigned numRest = m_numLastHidden - m_numProbe;
+
+  ThresholdStats stats;
+
+  stats.samples      = numSamples;
+  stats.neuronsTotal = numSamples * m_numLastHidden;
+
+  std::vector< double > scratchA;
+  std::vector< double > scratchB;
+  std::vector< double > probeSums  ( tileSize * m_numProbe );
+  std::vector< double > restSums   ( tileSize * numRest );
+  std::vector< double > pendingVals( tileSize * m_width );
+  std::vector< double > pendingSums( tileSize );
+  std::vector< size_t > pendingIndex( tileSize );
+
+  for ( size_t begin = 0; begin < numSamples; begin += tileSize )
+  {
+
+    size_t        count = std::min( tileSize, numSamples - begin );
+    const double *x     = _forwardDense( &inputVals[ begin * m_numInputs ], count, &scratchA, &scratchB );
+
+    if ( m_numLastHidden == 0 )
+    {
+
+      for ( size_t s = 0; s < count; ++s )
+      {
+
+        double sum = m_outBias;
+
+        for ( unsigned i = 0; i < m_width; ++i )
+        {
+
+          sum += m_outWeights[ i ] * x[ s * m_width + i ];
+
+        }
+
+        above[ begin + s ] = ( sum > 0.0 ? 1 : 0 );
+
+      }
+
+      continue;
+
+    }
+
+    //
+    // probe neurons for the whole tile
+    //
+    for ( size_t s = 0; s < count; ++s )
+    {
+
+      std::copy( m_hiddenBiases.data( ), m_hiddenBiases.data( ) + m_numProbe, &probeSums[ s * m_numProbe ] );
+
+    }
+
+    Gemm::multiply( count, MatrixView{ x, m_width, 1 }, m_probePacked, probeSums.data( ), m_numProbe, true );
+
+    size_t numPending = 0;
+
+    for ( size_t s = 0; s < count; ++s )
+    {
+
+      double sum = m_outBias;
+
+      for ( unsigned k = 0; k < m_numProbe; ++k )
+      {
+
+        sum += m_outWeights[ k ] * std::tanh( probeSums[ s * m_numProbe + k ] );
+
+      }
+
+      if ( numRest == 0 || _isDecided( sum, m_numProbe ) )
+      {
+
+        above[ begin + s ]  = ( sum > 0.0 ? 1 : 0 );
+        stats.decidedEarly += ( numRest > 0 ? 1 : 0 );
+
+      }
+      else
+      {
+
+        // compact the undecided samples
+        std::copy( x + s * m_width, x + ( s + 1 ) * m_width, &pendingVals[ numPending * m_width ] );
+
+        pendingSums [ numPending ] = sum;
+        pendingIndex[ numPending ] = begin + s;
+
+        ++numPending;
+
+      }
+
+    }
+
+    stats.neuronsComputed += count * m_numProbe + numPending * numRest;
+
+    if ( numPending == 0 )
+    {
+
+      continue;
+
+    }
+
+    //
+    // the rest of the layer for the undecided samples only
+    //
+    for ( size_t p = 0; p < numPending; ++p )
+    {
+
+      std::copy( m_hiddenBiases.data( ) + m_numProbe, m_hiddenBiases.data( ) + m_numLastHidden, &restSums[ p * numRest ] );
+
+    }
+
+    Gemm::multiply( numPending, MatrixView{ pendingVals.data( ), m_width, 1 }, m_restPacked, restSums.data( ), numRest, true );
+
+    for ( size_t p = 0; p < numPending; ++p )
+    {
+
+      double sum = pendingSums[ p ];
+
+      for ( unsigned j = 0; j < numRest; ++j )
+      {
+
+        sum += m_outWeights[ m_numProbe + j ] * std::tanh( restSums[ p * numRest + j ] );
+
+      }
+
+      above[ pendingIndex[ p ] ] = ( sum > 0.0 ? 1 : 0 );
+
+    }
+
+  }
+
+  if ( pStats )
+  {
+
+    pStats->add( stats );
+
+  }
+
+} // ThresholdClassifier::classifyBatch
+
+
+} // namespace net
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Gemm.hpp"
+
+
+namespace net
+{
+
+
+class ConnectedNet;
+
+
+/// \brief ThresholdStats - how much of the last hidden layer classification needed
+struct ThresholdStats
+{
+
+  size_t samples         = 0;
+  size_t decidedEarly    = 0; ///< samples decided before the whole last hidden layer was evaluated
+  size_t neuronsComputed = 0; ///< last hidden layer neurons evaluated over all samples
+  size_t neuronsTotal    = 0; ///< the same for full forward passes
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief add - accumulates another set of counters
+  ////////////////////////////////////////////////////////////////////
+  void add ( const ThresholdStats &other );
+
+  double earlyFraction  ( ) const { return samples > 0 ? decidedEarly * 1.0 / samples : 0.0; }
+  double neuronFraction ( ) const { return neuronsTotal > 0 ? neuronsComputed * 1.0 / neuronsTotal : 0.0; }
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The ThresholdClassifier class
+///
+///        Answers only whether one output of a trained tanh net is
+///        above a threshold, stopping as soon as that is decided.
+///
+///        The neurons of the last hidden layer are evaluated
+///        strongest outgoing weight first. Every neuron still to
+///        come adds at most |weight| to the output's input sum
+///        (its output lies in [-1, 1]), so once the partial sum is
+///        further from the threshold's sum than what is left, the
+///        answer can't change and the rest of the layer is skipped.
+///        Samples far from the decision boundary need only a few
+///        neurons.
+///
+///        Batches run the strongest neurons (the probe) for every
+///        sample through Gemm, then compact the undecided samples
+///        and finish them through the remaining neurons together.
+///
+///        Decisions match thresholding the net's own outputs except
+///        for sums within rounding of the threshold. The weights
+///        are copied at construction; build a new classifier after
+///        training further.
+///
+////////////////////////////////////////////////////////////////////
+class ThresholdClassifier
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief ThresholdClassifier
+  /// \param net - trained net with the tanh output head
+  /// \param outputNum - output to classify
+  /// \param threshold - decision value in ( -1, 1 ) (0.0 tests the
+  ///                    output's sign)
+  /// \param probeNeurons - last hidden layer neurons every sample
+  ///                       of a batch gets before compaction (0
+  ///                       picks the fewest carrying half of the
+  ///                       output weight)
+  ////////////////////////////////////////////////////////////////////
+  ThresholdClassifier(
+                      const ConnectedNet &net,
+                      unsigned            outputNum    = 0,
+                      double              threshold    = 0.0,
+                      unsigned            probeNeurons = 0
+                      );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief classify
+  /// \param inputVals - one sample
+  /// \param pStats - counters to add to (optional)
+  /// \return true if the output is above the threshold
+  ////////////////////////////////////////////////////////////////////
+  bool classify (
+                 const std::vector< double > &inputVals,
+                 ThresholdStats              *pStats = nullptr
+                 ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief classifyBatch
+  /// \param inputVals - numSamples x numInputs values (sample major)
+  /// \param pAbove - filled with numSamples values, 1 where the
+  ///                 output is above the threshold
+  /// \param pStats - counters to add to (optional)
+  ////////////////////////////////////////////////////////////////////
+  void classifyBatch (
+                      const std::vector< double > &inputVals,
+                      std::vector< char >         *pAbove,
+                      ThresholdStats              *pStats = nullptr
+                      ) const;
+
+  unsigned getNumInputs       ( ) const { return m_numInputs; }
+  unsigned getNumLastHidden   ( ) const { return m_numLastHidden; }
+  unsigned getNumProbeNeurons ( ) const { return m_numProbe; }
+
+
+private:
+
+  /// \brief weights feeding a fully evaluated hidden layer
+  struct DenseLayer
+  {
+
+    unsigned              numRows; // neurons
+    unsigned              numCols; // neurons of the previous layer
+    std::vector< double > weights; // numRows x numCols (row per neuron)
+    std::vector< double > biases;
+    PackedMatrix          packed;  // weights as the right hand side of Gemm::multiply
+
+  };
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _forwardDense
+  ///
+  ///        Runs 'count' samples through the fully evaluated layers
+  ///
+  /// \return activations feeding the last hidden layer (in one of
+  ///         the two scratch buffers)
+  ////////////////////////////////////////////////////////////////////
+  const double *_forwardDense (
+                               const double          *inputs,
+                               size_t                 count,
+                               std::vector< double > *pScratchA,
+                               std::vector< double > *pScratchB
+                               ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _hiddenValue
+  /// \return output of last hidden layer neuron k (decision order)
+  ////////////////////////////////////////////////////////////////////
+  double _hiddenValue (
+                       unsigned      k,
+                       const double *x
+                       ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _isDecided
+  /// \return true if the partial sum after k neurons can't cross
+  ///         the threshold any more
+  ////////////////////////////////////////////////////////////////////
+  bool _isDecided (
+                   double   sum,
+                   unsigned k
+                   ) const { return sum > m_remaining[ k ] + m_slack || sum < -m_remaining[ k ] - m_slack; }
+
+  unsigned m_numInputs;
+  unsigned m_numLastHidden; // neurons in the last hidden layer (0 without hidden layers)
+  unsigned m_numProbe;
+  unsigned m_width;         // values feeding the last hidden layer
+
+  std::vector< DenseLayer > m_denseLayers; // every hidden layer but the last
+
+  //
+  // last hidden layer in decision order (strongest outgoing weight
+  // first): input weights, biases and outgoing weights
+  //
+  std::vector< double > m_hiddenWeights; // m_numLastHidden x m_width
+  std::vector< double > m_hiddenBiases;
+  std::vector< double > m_outWeights;
+  PackedMatrix          m_probePacked;   // first m_numProbe neurons for Gemm::multiply
+  PackedMatrix          m_restPacked;    // the others
+
+  double                m_outBias;       // output bias minus the threshold's input sum
+  std::vector< double > m_remaining;     // m_remaining[ k ] - sum of |m_outWeights| from k on
+  double                m_slack;         // allowance for rounding differences
+
+};
+
+
+} // namespace net
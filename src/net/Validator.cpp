@@ -0,0 +1,442 @@
+#include "Validator.hpp"
+#include "ConnectedNet.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+
+namespace net
+{
+
+
+namespace
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief defaultClassify
+///
+///        argmax agreement for multiple outputs, agreement within
+///        0.5 (the rounding the example apps use) for one output
+///
+////////////////////////////////////////////////////////////////////
+bool
+defaultClassify(
+                const std::vector< double > &results,
+                const std::vector< double > &targets
+                )
+{
+
+  if ( results.size( ) == 1 )
+  {
+
+    return std::abs( results[ 0 ] - targets[ 0 ] ) < 0.5;
+
+  }
+
+  auto resultMax = std::max_element( results.begin( ), results.end( ) );
+  auto targetMax = std::max_element( targets.begin( ), targets.end( ) );
+
+  return ( resultMax - results.begin( ) ) == ( targetMax - targets.begin( ) );
+
+}
+
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::Validator
+////////////////////////////////////////////////////////////////////
+Validator::Validator(
+                     std::vector< std::vector< double > > inputs,
+                     std::vector< std::vector< double > > targets,
+                     unsigned                             frequency,
+                     unsigned                             numThreads
+                     )
+  : inputs_      ( std::move( inputs ) )
+  , targets_     ( std::move( targets ) )
+  , frequency_   ( std::max( frequency, 1u ) )
+  , numThreads_  ( numThreads )
+  , stopError_   ( -1.0 )
+  , stopAccuracy_( -1.0 )
+  , classifyFun_ ( defaultClassify )
+  , iteration_   ( 0 )
+  , busy_        ( false )
+  , stop_        ( false )
+  , latestReport_( ValidationReport{ 0, 0.0, 0.0 } )
+  , hasReport_   ( false )
+{
+
+  if ( inputs_.size( ) != targets_.size( ) || inputs_.empty( ) )
+  {
+
+    throw std::runtime_error( "Validation set needs the same (non-zero) number of inputs and targets" );
+
+  }
+
+  for ( const std::vector< double > &input : inputs_ )
+  {
+
+    batchInputs_.insert( batchInputs_.end( ), input.begin( ), input.end( ) );
+
+  }
+
+  if ( numThreads_ == 0 )
+  {
+
+    // leave one core for the training thread
+    unsigned cores = std::thread::hardware_concurrency( );
+    numThreads_ = ( cores > 1 ? cores - 1 : 1 );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::~Validator
+////////////////////////////////////////////////////////////////////
+Validator::~Validator( )
+{
+
+  // never throws: a stored exception nobody waited for is dropped
+  if ( thread_.joinable( ) )
+  {
+
+    thread_.join( );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::setClassifyFunction
+////////////////////////////////////////////////////////////////////
+void
+Validator::setClassifyFunction( ClassifyFun classifyFun )
+{
+
+  classifyFun_ = std::move( classifyFun );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::setReportFunction
+////////////////////////////////////////////////////////////////////
+void
+Validator::setReportFunction( ReportFun reportFun )
+{
+
+  reportFun_ = std::move( reportFun );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::setStopError
+////////////////////////////////////////////////////////////////////
+void
+Validator::setStopError( double stopError )
+{
+
+  stopError_ = stopError;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::setStopAccuracy
+////////////////////////////////////////////////////////////////////
+void
+Validator::setStopAccuracy( double stopAccuracy )
+{
+
+  stopAccuracy_ = stopAccuracy;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::start
+////////////////////////////////////////////////////////////////////
+void
+Validator::start( )
+{
+
+  _join( );
+
+  iteration_ = 0;
+  stop_      = false;
+
+  std::lock_guard< std::mutex > lock( reportMutex_ );
+  hasReport_ = false;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::onIteration
+/// \param net
+////////////////////////////////////////////////////////////////////
+void
+Validator::onIteration( const Net &net )
+{
+
+  if ( ++iteration_ % frequency_ != 0 || busy_ )
+  {
+
+    return;
+
+  }
+
+  // previous evaluation is done but its thread may not be joined yet
+  _join( );
+
+  busy_ = true;
+
+  //
+  // the snapshot is the only work done on the training thread
+  //
+  std::shared_ptr< Net > snapshot( net.clone( ) );
+  unsigned long long     iteration = iteration_;
+
+  thread_ = std::thread( [ this, snapshot, iteration ]
+    {
+
+      // an exception must not escape the thread (std::terminate);
+      // it is rethrown from the next join and stops training
+      try
+      {
+
+        // the snapshot is private, so its weights can be packed here
+        ConnectedNet *pConnected = dynamic_cast< ConnectedNet* >( snapshot.get( ) );
+
+        if ( pConnected )
+        {
+
+          pConnected->prepareBatch( );
+
+        }
+
+        ValidationReport report = evaluate( *snapshot );
+        report.iteration = iteration;
+
+        {
+          std::lock_guard< std::mutex > lock( reportMutex_ );
+          latestReport_ = report;
+          hasReport_    = true;
+        }
+
+        if ( ( stopError_    >= 0.0 && report.rmsError <= stopError_ )
+            || ( stopAccuracy_ >= 0.0 && report.accuracy >= stopAccuracy_ ) )
+        {
+
+          stop_ = true;
+
+        }
+
+        if ( reportFun_ )
+        {
+
+          reportFun_( report );
+
+        }
+
+      }
+      catch ( ... )
+      {
+
+        error_ = std::current_exception( );
+        stop_  = true;
+
+      }
+
+      busy_ = false;
+
+    } );
+
+} // Validator::onIteration
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::evaluate
+/// \param net
+/// \return
+////////////////////////////////////////////////////////////////////
+ValidationReport
+Validator::evaluate( const Net &net ) const
+{
+
+  size_t numSamples = inputs_.size( );
+  size_t numOutputs = targets_.front( ).size( );
+
+  std::vector< double > allResults; // numSamples x numOutputs
+
+  const ConnectedNet *pConnected = dynamic_cast< const ConnectedNet* >( &net );
+
+  if ( pConnected )
+  {
+
+    // only reads the net, so every thread shares the one snapshot
+    pConnected->feedForwardBatch( batchInputs_, &allResults, numThreads_ );
+
+  }
+  else
+  {
+
+    // feedForward writes neuron outputs, so other nets run on a copy
+    std::unique_ptr< Net > upCopy = net.clone( );
+    std::vector< double >  results;
+
+    for ( const std::vector< double > &input : inputs_ )
+    {
+
+      upCopy->feedForward( input );
+      upCopy->getResults( &results );
+
+      allResults.insert( allResults.end( ), results.begin( ), results.end( ) );
+
+    }
+
+  }
+
+  double   errorSum   = 0.0;
+  unsigned numCorrect = 0;
+
+  std::vector< double > results( numOutputs );
+
+  for ( size_t s = 0; s < numSamples; ++s )
+  {
+
+    const std::vector< double > &targets = targets_[ s ];
+
+    std::copy( allResults.begin( ) + static_cast< long >( s * numOutputs ),
+               allResults.begin( ) + static_cast< long >( ( s + 1 ) * numOutputs ),
+               results.begin( ) );
+
+    // same per-sample RMS measure as NetImpl::backProp
+    double error = 0.0;
+
+    for ( size_t n = 0; n < numOutputs; ++n )
+    {
+
+      double delta = targets[ n ] - results[ n ];
+      error += delta * delta;
+
+    }
+
+    errorSum += std::sqrt( error / numOutputs );
+
+    if ( classifyFun_( results, targets ) )
+    {
+
+      ++numCorrect;
+
+    }
+
+  }
+
+  ValidationReport report;
+  report.iteration = 0; // filled in by onIteration for snapshots
+  report.rmsError  = errorSum / numSamples;
+  report.accuracy  = numCorrect * 1.0 / numSamples;
+
+  return report;
+
+} // Validator::evaluate
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::shouldStop
+/// \return
+////////////////////////////////////////////////////////////////////
+bool
+Validator::shouldStop( ) const
+{
+
+  return stop_;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::getLatestReport
+/// \param pReport
+/// \return
+////////////////////////////////////////////////////////////////////
+bool
+Validator::getLatestReport( ValidationReport *pReport ) const
+{
+
+  std::lock_guard< std::mutex > lock( reportMutex_ );
+
+  if ( hasReport_ )
+  {
+
+    *pReport = latestReport_;
+
+  }
+
+  return hasReport_;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::wait
+////////////////////////////////////////////////////////////////////
+void
+Validator::wait( )
+{
+
+  _join( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief Validator::_join
+////////////////////////////////////////////////////////////////////
+void
+Validator::_join( )
+{
+
+  if ( thread_.joinable( ) )
+  {
+
+    thread_.join( );
+
+  }
+
+  if ( error_ )
+  {
+
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+
+    std::rethrow_exception( error );
+
+  }
+
+}
+
+
+
+} // namespace net
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+#include "Net.hpp"
+
+
+namespace net
+{
+
+
+/// \brief ValidationReport
+struct ValidationReport
+{
+
+  unsigned long long iteration; ///< training iteration the snapshot was taken at
+  double rmsError;              ///< mean per-sample RMS error over the validation set
+  double accuracy;              ///< fraction of samples classified correctly [0.0, 1.0]
+
+};
+
+/// \brief ClassifyFun - true if the result counts as a correct classification of the target
+typedef std::function< bool( const std::vector< double >&, const std::vector< double >& ) > ClassifyFun;
+
+/// \brief ReportFun - called from the validation thread whenever a report is finished
+typedef std::function< void( const ValidationReport& ) > ReportFun;
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The Validator class
+///
+///        Evaluates a held-out validation set against snapshots
+///        of a net while it continues training. Each evaluation
+///        runs on a background thread against one snapshot: a
+///        ConnectedNet's weights are packed once and the samples
+///        go through feedForwardBatch on the spare cores, other
+///        nets run the samples one by one.
+///
+////////////////////////////////////////////////////////////////////
+class Validator
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief Validator
+  /// \param inputs - validation input samples
+  /// \param targets - validation target samples
+  /// \param frequency - number of training iterations between snapshots
+  /// \param numThreads - evaluation threads (0 uses all spare cores)
+  ////////////////////////////////////////////////////////////////////
+  Validator(
+            std::vector< std::vector< double > > inputs,
+            std::vector< std::vector< double > > targets,
+            unsigned                             frequency  = 10000,
+            unsigned                             numThreads = 0
+            );
+
+  ~Validator( );
+
+  Validator( const Validator& ) = delete;
+  Validator &operator= ( const Validator& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setClassifyFunction
+  ///
+  ///        Defaults to argmax agreement for multiple outputs and
+  ///        to agreement within 0.5 for a single output
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void setClassifyFunction ( ClassifyFun classifyFun );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setReportFunction
+  ////////////////////////////////////////////////////////////////////
+  void setReportFunction ( ReportFun reportFun );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setStopError
+  /// \param stopError - validation error at which training should stop
+  ///                    (negative never stops, the default)
+  ////////////////////////////////////////////////////////////////////
+  void setStopError ( double stopError );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief setStopAccuracy
+  /// \param stopAccuracy - validation accuracy at which training
+  ///                       should stop (negative never stops, the
+  ///                       default; either criterion stops it)
+  ////////////////////////////////////////////////////////////////////
+  void setStopAccuracy ( double stopAccuracy );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief start
+  ///
+  ///        Begins a new training run: waits for any evaluation
+  ///        still in flight, then clears the stop flag, the
+  ///        iteration count and the latest report. trainNet calls
+  ///        it, so one Validator can watch several runs.
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void start ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief onIteration
+  ///
+  ///        Called once per training iteration. Every 'frequency'
+  ///        iterations a snapshot of the net is handed to the
+  ///        background thread unless it is still busy with the
+  ///        previous one, in which case the snapshot is skipped.
+  ///
+  /// \param net - net being trained
+  ////////////////////////////////////////////////////////////////////
+  void onIteration ( const Net &net );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief evaluate
+  ///
+  ///        Synchronously evaluates the validation set (with
+  ///        feedForwardBatch's worker threads for a ConnectedNet,
+  ///        which is faster once prepareBatch packed its weights)
+  ///
+  /// \param net - net to evaluate (left untouched)
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  ValidationReport evaluate ( const Net &net ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief shouldStop
+  /// \return true once a finished report reached the stop error or
+  ///         the stop accuracy, or an evaluation threw (wait
+  ///         rethrows the exception)
+  ////////////////////////////////////////////////////////////////////
+  bool shouldStop ( ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getLatestReport
+  /// \param pReport - filled with the most recent report
+  /// \return false if no report has finished yet
+  ////////////////////////////////////////////////////////////////////
+  bool getLatestReport ( ValidationReport *pReport ) const;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief wait
+  ///
+  ///        Blocks until any in-flight evaluation has finished.
+  ///        An exception thrown by the evaluation (or the report
+  ///        function) on the background thread is rethrown here.
+  ///
+  ////////////////////////////////////////////////////////////////////
+  void wait ( );
+
+
+private:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _join - joins the background thread and rethrows what
+  ///        it stored
+  ////////////////////////////////////////////////////////////////////
+  void _join ( );
+
+  std::vector< std::vector< double > > inputs_;
+  std::vector< std::vector< double > > targets_;
+  std::vector< double >                batchInputs_; // inputs_ sample major, for feedForwardBatch
+
+  unsigned frequency_;
+  unsigned numThreads_;
+  double   stopError_;
+  double   stopAccuracy_;
+
+  ClassifyFun classifyFun_;
+  ReportFun   reportFun_;
+
+  unsigned long long iteration_;
+
+  std::thread        thread_;
+  std::atomic< bool > busy_;
+  std::atomic< bool > stop_;
+  std::exception_ptr  error_; // thrown on the background thread, read after joining
+
+  mutable std::mutex reportMutex_;
+  ValidationReport   latestReport_;
+  bool               hasReport_;
+
+};
+
+
+} // namespace net
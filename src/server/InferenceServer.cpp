@@ -0,0 +1,615 @@
+#include "InferenceServer.hpp"
+#include "Protocol.hpp"
+#include "Socket.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace server
+{
+
+
+namespace
+{
+
+constexpr int acceptPollMs = 200; // how often run checks its stop flag
+
+
+double
+microsBetween(
+              std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end
+              )
+{
+
+  return std::chrono::duration< double, std::micro >( end - start ).count( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief discard - reads and drops size bytes through a fixed
+///        buffer
+/// \return false if the peer closed the connection first
+////////////////////////////////////////////////////////////////////
+bool
+discard(
+        int    fd,
+        size_t size
+        )
+{
+
+  char scratch[ 4096 ];
+
+  while ( size > 0 )
+  {
+
+    size_t chunk = std::min( size, sizeof( scratch ) );
+
+    if ( !readAll( fd, scratch, chunk ) )
+    {
+
+      return false;
+
+    }
+
+    size -= chunk;
+
+  }
+
+  return true;
+
+}
+
+} // namespace
+
+
+
+/// \brief Connection - one client socket, closed with the last reference
+struct InferenceServer::Connection
+{
+
+  explicit Connection( int fd_ ) : fd( fd_ ), alive( true ), done( false ) { }
+
+  ~Connection( ) { ::close( fd ); }
+
+  int                 fd;
+  std::atomic< bool > alive; // false once a read or write failed
+  std::atomic< bool > done;  // reader thread finished
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::InferenceServer
+////////////////////////////////////////////////////////////////////
+InferenceServer::InferenceServer(
+                                 std::unique_ptr< net::ConnectedNet > upNet,
+                                 ServerOptions                        options
+                                 )
+  : upNet_     ( std::move( upNet ) )
+  , options_   ( options )
+  , numInputs_ ( 0 )
+  , numOutputs_( 0 )
+  , stopping_  ( false )
+  , batches_   ( 0 )
+  , allBatches_( 0 )
+{
+
+  if ( !upNet_ )
+  {
+
+    throw std::runtime_error( "InferenceServer needs a net" );
+
+  }
+
+  if ( options_.maxBatch == 0 )
+  {
+
+    throw std::runtime_error( "Max batch size must be at least 1" );
+
+  }
+
+  std::vector< unsigned > topology = upNet_->getTopology( );
+
+  numInputs_  = topology.front( );
+  numOutputs_ = topology.back( );
+
+  // the net never changes while serving, so its weights are packed once
+  upNet_->prepareBatch( );
+
+  start_         = Clock::now( );
+  intervalStart_ = start_;
+
+  batcher_ = std::thread( &InferenceServer::_batch, this );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::~InferenceServer
+////////////////////////////////////////////////////////////////////
+InferenceServer::~InferenceServer( )
+{
+
+  {
+    std::lock_guard< std::mutex > lock( queueMutex_ );
+    stopping_ = true;
+  }
+
+  queueReady_.notify_all( );
+
+  for ( auto &reader : readers_ )
+  {
+
+    ::shutdown( reader.first->fd, SHUT_RDWR ); // unblocks the reader
+    reader.second.join( );
+
+  }
+
+  if ( batcher_.joinable( ) )
+  {
+
+    batcher_.join( );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::run
+////////////////////////////////////////////////////////////////////
+void
+InferenceServer::run( const volatile std::sig_atomic_t *pStop )
+{
+
+  int listenFd = listenUnix( options_.socketPath );
+
+  std::cout << "Serving " << numInputs_ << " -> " << numOutputs_
+            << " model on " << options_.socketPath
+            << " (max batch " << options_.maxBatch
+            << ", max latency " << options_.maxLatencyUs << " us)" << std::endl;
+
+  while ( !*pStop )
+  {
+
+    pollfd listening = { listenFd, POLLIN, 0 };
+
+    int ready = ::poll( &listening, 1, acceptPollMs );
+
+    if ( ready <= 0 )
+    {
+
+      continue; // timeout or EINTR: look at the stop flag again
+
+    }
+
+    int fd = ::accept( listenFd, nullptr, nullptr );
+
+    if ( fd < 0 )
+    {
+
+      continue;
+
+    }
+
+    //
+    // forget readers of closed connections
+    //
+    for ( size_t i = 0; i < readers_.size( ); )
+    {
+
+      if ( readers_[ i ].first->done )
+      {
+
+        readers_[ i ].second.join( );
+        readers_[ i ] = std::move( readers_.back( ) );
+        readers_.pop_back( );
+
+      }
+      else
+      {
+
+        ++i;
+
+      }
+
+    }
+
+    auto connection = std::make_shared< Connection >( fd );
+
+    readers_.emplace_back( connection, std::thread( &InferenceServer::_read, this, connection ) );
+
+  }
+
+  ::close( listenFd );
+  ::unlink( options_.socketPath.c_str( ) );
+
+  {
+    std::lock_guard< std::mutex > lock( queueMutex_ );
+    stopping_ = true;
+  }
+
+  queueReady_.notify_all( );
+
+  for ( auto &reader : readers_ )
+  {
+
+    ::shutdown( reader.first->fd, SHUT_RDWR );
+    reader.second.join( );
+
+  }
+
+  readers_.clear( );
+
+  batcher_.join( );
+
+  _report( true );
+
+} // InferenceServer::run
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::_read - connection thread
+////////////////////////////////////////////////////////////////////
+void
+InferenceServer::_read( std::shared_ptr< Connection > connection )
+{
+
+  Hello hello = { helloMagic, protocolVersion, numInputs_, numOutputs_ };
+
+  if ( writeAll( connection->fd, &hello, sizeof( hello ) ) )
+  {
+
+    try
+    {
+
+      RequestHeader header;
+
+      while ( readAll( connection->fd, &header, sizeof( header ) ) )
+      {
+
+        Request request;
+
+        request.connection = connection;
+        request.id         = header.id;
+        request.status     = header.numInputs == numInputs_ ? Ok : BadRequest;
+
+        //
+        // only a matching request gets an input buffer, so a header
+        // can't make the server allocate; the inputs of a bad one
+        // are skipped (or the connection dropped if there are too
+        // many to bother)
+        //
+        if ( request.status == Ok )
+        {
+
+          request.inputs.resize( numInputs_ );
+
+          if ( !readAll( connection->fd, request.inputs.data( ), numInputs_ * sizeof( double ) ) )
+          {
+
+            break;
+
+          }
+
+        }
+        else if ( header.numInputs > maxBadRequestInputs )
+        {
+
+          // the client sees the connection close right away
+          ::shutdown( connection->fd, SHUT_RDWR );
+          break;
+
+        }
+        else if ( !discard( connection->fd, header.numInputs * sizeof( double ) ) )
+        {
+
+          break;
+
+        }
+
+        request.arrival = Clock::now( );
+
+        bool wake;
+
+        {
+          std::lock_guard< std::mutex > lock( queueMutex_ );
+
+          if ( stopping_ )
+          {
+
+            break;
+
+          }
+
+          queue_.push_back( std::move( request ) );
+
+          // only a full batch or the first request changes what the batcher waits for
+          wake = queue_.size( ) == 1 || queue_.size( ) == options_.maxBatch;
+        }
+
+        if ( wake )
+        {
+
+          queueReady_.notify_one( );
+
+        }
+
+      }
+
+    }
+    catch ( const std::exception &e )
+    {
+
+      std::cerr << "Connection error: " << e.what( ) << std::endl;
+
+    }
+
+  }
+
+  connection->alive = false;
+  connection->done  = true;
+
+} // InferenceServer::_read
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::_batch - batcher thread
+////////////////////////////////////////////////////////////////////
+void
+InferenceServer::_batch( )
+{
+
+  std::vector< Request > batch;
+
+  for ( ;; )
+  {
+
+    {
+      std::unique_lock< std::mutex > lock( queueMutex_ );
+
+      queueReady_.wait( lock, [ this ]{ return stopping_ || !queue_.empty( ); } );
+
+      if ( stopping_ )
+      {
+
+        return;
+
+      }
+
+      //
+      // give the batch until the oldest request's deadline to fill
+      //
+      Clock::time_point deadline = queue_.front( ).arrival
+                                   + std::chrono::microseconds( options_.maxLatencyUs );
+
+      queueReady_.wait_until( lock, deadline, [ this ]
+                                              {
+                                                return stopping_ || queue_.size( ) >= options_.maxBatch;
+                                              } );
+
+      if ( stopping_ )
+      {
+
+        return;
+
+      }
+
+      size_t count = std::min< size_t >( queue_.size( ), options_.maxBatch );
+
+      batch.assign( std::make_move_iterator( queue_.begin( ) ),
+                    std::make_move_iterator( queue_.begin( ) + static_cast< long >( count ) ) );
+
+      queue_.erase( queue_.begin( ), queue_.begin( ) + static_cast< long >( count ) );
+    }
+
+    _respond( &batch );
+    _reportIfDue( );
+
+  }
+
+} // InferenceServer::_batch
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::_respond
+///
+///        Runs the valid requests of a batch through one
+///        feedForwardBatch call and writes every response, one
+///        write per connection
+///
+////////////////////////////////////////////////////////////////////
+void
+InferenceServer::_respond( std::vector< Request > *pBatch )
+{
+
+  std::vector< double > inputs;
+  std::vector< double > outputs;
+
+  inputs.reserve( pBatch->size( ) * numInputs_ );
+
+  for ( const Request &request : *pBatch )
+  {
+
+    if ( request.status == Ok )
+    {
+
+      inputs.insert( inputs.end( ), request.inputs.begin( ), request.inputs.end( ) );
+
+    }
+
+  }
+
+  if ( !inputs.empty( ) )
+  {
+
+    upNet_->feedForwardBatch( inputs, &outputs, options_.threads );
+
+  }
+
+  //
+  // gather the responses per connection (in request order)
+  //
+  std::unordered_map< Connection*, std::vector< char > > replies;
+
+  const double *result = outputs.data( );
+
+  for ( const Request &request : *pBatch )
+  {
+
+    ResponseHeader header = { request.id, request.status, 0 };
+
+    std::vector< char > &reply = replies[ request.connection.get( ) ];
+
+    if ( request.status == Ok )
+    {
+
+      header.numOutputs = numOutputs_;
+
+    }
+
+    const char *headerBytes = reinterpret_cast< const char* >( &header );
+
+    reply.insert( reply.end( ), headerBytes, headerBytes + sizeof( header ) );
+
+    if ( request.status == Ok )
+    {
+
+      const char *resultBytes = reinterpret_cast< const char* >( result );
+
+      reply.insert( reply.end( ), resultBytes, resultBytes + numOutputs_ * sizeof( double ) );
+      result += numOutputs_;
+
+    }
+
+  }
+
+  for ( auto &reply : replies )
+  {
+
+    Connection *connection = reply.first;
+
+    //
+    // a client that vanished (or a socket error) only drops that
+    // client: the batcher thread must keep serving the others
+    //
+    try
+    {
+
+      if ( connection->alive && !writeAll( connection->fd, reply.second.data( ), reply.second.size( ) ) )
+      {
+
+        connection->alive = false;
+
+      }
+
+    }
+    catch ( const std::exception &e )
+    {
+
+      std::cerr << "Connection error: " << e.what( ) << std::endl;
+
+      // also ends the connection's reader thread
+      connection->alive = false;
+      ::shutdown( connection->fd, SHUT_RDWR );
+
+    }
+
+  }
+
+  Clock::time_point done = Clock::now( );
+
+  std::lock_guard< std::mutex > lock( statsMutex_ );
+
+  for ( const Request &request : *pBatch )
+  {
+
+    latencies_.add( microsBetween( request.arrival, done ) );
+
+  }
+
+  ++batches_;
+
+  pBatch->clear( );
+
+} // InferenceServer::_respond
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::_reportIfDue
+////////////////////////////////////////////////////////////////////
+void
+InferenceServer::_reportIfDue( )
+{
+
+  if ( options_.reportInterval > 0.0
+      && microsBetween( intervalStart_, Clock::now( ) ) >= options_.reportInterval * 1.0e6 )
+  {
+
+    _report( false );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief InferenceServer::_report
+///
+///        Prints the requests served since the last report (or
+///        all of them for the final one) and starts a new interval
+///
+////////////////////////////////////////////////////////////////////
+void
+InferenceServer::_report( bool final )
+{
+
+  std::lock_guard< std::mutex > lock( statsMutex_ );
+
+  Clock::time_point now = Clock::now( );
+
+  allLatencies_.merge( latencies_ );
+  allBatches_ += batches_;
+
+  double             seconds = microsBetween( final ? start_ : intervalStart_, now ) * 1.0e-6;
+  unsigned long long batches = final ? allBatches_ : batches_;
+
+  LatencySummary summary = ( final ? allLatencies_ : latencies_ ).summarize( );
+
+  std::cout << std::fixed << std::setprecision( 1 )
+            << ( final ? "Total:    " : "Interval: " )
+            << summary.count << " requests in " << seconds << " s, "
+            << ( seconds > 0.0 ? summary.count / seconds : 0.0 ) << " req/s, "
+            << "mean batch " << ( batches > 0 ? static_cast< double >( summary.count ) / batches : 0.0 ) << ", "
+            << "latency us p50 " << summary.p50
+            << " p99 " << summary.p99
+            << " max " << summary.max
+            << std::defaultfloat << std::endl;
+
+  latencies_.clear( );
+  batches_       = 0;
+  intervalStart_ = now;
+
+} // InferenceServer::_report
+
+
+} // namespace server
@@ -0,0 +1,145 @@
+// InferenceServer.hpp
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "Latency.hpp"
+
+
+namespace server
+{
+
+
+/// \brief ServerOptions - netServer settings
+struct ServerOptions
+{
+
+  std::string socketPath     = "/tmp/net.sock";
+  unsigned    maxBatch       = 64;   ///< samples per feedForwardBatch call
+  unsigned    maxLatencyUs   = 1000; ///< longest a request waits for its batch to fill
+  unsigned    threads        = 0;    ///< feedForwardBatch worker threads (0 for one per core)
+  double      reportInterval = 5.0;  ///< seconds between reports (0 for only the final one)
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The InferenceServer class
+///
+///        Serves a ConnectedNet over a Unix socket (see
+///        Protocol.hpp). One thread per connection reads requests
+///        into a shared queue; a single batcher thread takes up to
+///        maxBatch of them at a time, waiting at most maxLatencyUs
+///        past the oldest request's arrival for a batch to fill,
+///        runs them through feedForwardBatch and writes the
+///        responses back.
+///
+///        Latency (arrival to response written), batch sizes and
+///        throughput are printed every reportInterval seconds and
+///        when the server stops.
+///
+////////////////////////////////////////////////////////////////////
+class InferenceServer
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief InferenceServer
+  /// \param upNet - the model to serve
+  /// \param options
+  ////////////////////////////////////////////////////////////////////
+  InferenceServer(
+                  std::unique_ptr< net::ConnectedNet > upNet,
+                  ServerOptions                        options
+                  );
+
+  ~InferenceServer( );
+
+  InferenceServer( const InferenceServer& ) = delete;
+  InferenceServer &operator= ( const InferenceServer& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief run
+  ///
+  ///        Accepts connections until pStop becomes true (checked a
+  ///        few times a second, e.g. set from a signal handler),
+  ///        then closes every connection and prints a final report
+  ///
+  /// \param pStop
+  ////////////////////////////////////////////////////////////////////
+  void run ( const volatile std::sig_atomic_t *pStop );
+
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  struct Connection;
+
+  /// \brief Request - one queued sample
+  struct Request
+  {
+
+    std::shared_ptr< Connection > connection;
+    uint64_t                      id;
+    uint32_t                      status;
+    std::vector< double >         inputs;
+    Clock::time_point             arrival;
+
+  };
+
+  void _read  ( std::shared_ptr< Connection > connection );
+  void _batch ( );
+
+  void _respond ( std::vector< Request > *pBatch );
+
+  void _report ( bool final );
+
+  void _reportIfDue ( );
+
+  std::unique_ptr< net::ConnectedNet > upNet_;
+  ServerOptions                        options_;
+  unsigned                             numInputs_;
+  unsigned                             numOutputs_;
+
+  //
+  // request queue (readers push, the batcher pops)
+  //
+  std::mutex              queueMutex_;
+  std::condition_variable queueReady_;
+  std::deque< Request >   queue_;
+  bool                    stopping_;
+
+  std::vector< std::pair< std::shared_ptr< Connection >, std::thread > > readers_;
+
+  std::thread batcher_;
+
+  //
+  // stats since the last report (batcher thread only, guarded for
+  // the report)
+  //
+  std::mutex         statsMutex_;
+  LatencyHistogram   latencies_;    // microseconds, since the last report
+  LatencyHistogram   allLatencies_; // everything reported so far
+  unsigned long long batches_;
+  unsigned long long allBatches_;
+  Clock::time_point  intervalStart_;
+  Clock::time_point  start_;
+
+};
+
+
+} // namespace server
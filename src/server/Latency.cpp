@@ -0,0 +1,228 @@
+#include "Latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+
+namespace server
+{
+
+
+namespace
+{
+
+constexpr double bucketGrowth = 1.01; // upper bound / lower bound of a bucket
+constexpr size_t numBuckets   = 2400; // [ 1, 1.01^2399 ) is about [ 1, 2e10 )
+
+
+size_t
+bucketIndex( double value )
+{
+
+  if ( !( value >= 1.0 ) )
+  {
+
+    return 0;
+
+  }
+
+  double index = 1.0 + std::floor( std::log( value ) / std::log( bucketGrowth ) );
+
+  return static_cast< size_t >( std::min( index, numBuckets - 1.0 ) );
+
+}
+
+
+
+// geometric middle of a bucket
+double
+bucketValue( size_t index )
+{
+
+  return index == 0 ? 0.5 : std::pow( bucketGrowth, index - 0.5 );
+
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief percentile - nearest rank value, partially sorting
+////////////////////////////////////////////////////////////////////
+double
+percentile(
+           std::vector< double > *pValues,
+           double                 fraction
+           )
+{
+
+  size_t rank = static_cast< size_t >( std::ceil( fraction * pValues->size( ) ) );
+
+  rank = std::min( std::max< size_t >( rank, 1 ), pValues->size( ) ) - 1;
+
+  std::nth_element( pValues->begin( ), pValues->begin( ) + static_cast< long >( rank ), pValues->end( ) );
+
+  return ( *pValues )[ rank ];
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief summarize
+////////////////////////////////////////////////////////////////////
+LatencySummary
+summarize( std::vector< double > *pLatencies )
+{
+
+  LatencySummary summary;
+
+  if ( pLatencies->empty( ) )
+  {
+
+    return summary;
+
+  }
+
+  summary.count = pLatencies->size( );
+  summary.mean  = std::accumulate( pLatencies->begin( ), pLatencies->end( ), 0.0 ) / summary.count;
+  summary.max   = *std::max_element( pLatencies->begin( ), pLatencies->end( ) );
+  summary.p50   = percentile( pLatencies, 0.50 );
+  summary.p99   = percentile( pLatencies, 0.99 );
+
+  return summary;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LatencyHistogram::LatencyHistogram
+////////////////////////////////////////////////////////////////////
+LatencyHistogram::LatencyHistogram( )
+  : counts_( numBuckets, 0 )
+  , count_ ( 0 )
+  , sum_   ( 0.0 )
+  , min_   ( 0.0 )
+  , max_   ( 0.0 )
+{}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LatencyHistogram::add
+////////////////////////////////////////////////////////////////////
+void
+LatencyHistogram::add( double latency )
+{
+
+  ++counts_[ bucketIndex( latency ) ];
+
+  min_  = ( count_ == 0 ? latency : std::min( min_, latency ) );
+  max_  = ( count_ == 0 ? latency : std::max( max_, latency ) );
+  sum_ += latency;
+
+  ++count_;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LatencyHistogram::merge
+////////////////////////////////////////////////////////////////////
+void
+LatencyHistogram::merge( const LatencyHistogram &other )
+{
+
+  if ( other.count_ == 0 )
+  {
+
+    return;
+
+  }
+
+  for ( size_t i = 0; i < numBuckets; ++i )
+  {
+
+    counts_[ i ] += other.counts_[ i ];
+
+  }
+
+  min_    = ( count_ == 0 ? other.min_ : std::min( min_, other.min_ ) );
+  max_    = ( count_ == 0 ? other.max_ : std::max( max_, other.max_ ) );
+  sum_   += other.sum_;
+  count_ += other.count_;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LatencyHistogram::clear
+////////////////////////////////////////////////////////////////////
+void
+LatencyHistogram::clear( )
+{
+
+  std::fill( counts_.begin( ), counts_.end( ), 0 );
+
+  count_ = 0;
+  sum_   = 0.0;
+  min_   = 0.0;
+  max_   = 0.0;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief LatencyHistogram::summarize
+////////////////////////////////////////////////////////////////////
+LatencySummary
+LatencyHistogram::summarize( ) const
+{
+
+  LatencySummary summary;
+
+  if ( count_ == 0 )
+  {
+
+    return summary;
+
+  }
+
+  //
+  // nearest rank bucket, its middle kept inside the seen range
+  //
+  auto percentile = [ this ]( double fraction )
+  {
+
+    size_t             rank  = std::max< size_t >( static_cast< size_t >( std::ceil( fraction * count_ ) ), 1 );
+    unsigned long long total = 0;
+    size_t             i     = 0;
+
+    while ( ( total += counts_[ i ] ) < rank )
+    {
+
+      ++i;
+
+    }
+
+    return std::min( std::max( bucketValue( i ), min_ ), max_ );
+
+  };
+
+  summary.count = count_;
+  summary.mean  = sum_ / count_;
+  summary.max   = max_;
+  summary.p50   = percentile( 0.50 );
+  summary.p99   = percentile( 0.99 );
+
+  return summary;
+
+}
+
+
+} // namespace server
@@ -0,0 +1,86 @@
+// Latency.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+namespace server
+{
+
+
+/// \brief LatencySummary - percentiles of a set of latencies
+struct LatencySummary
+{
+
+  size_t count = 0;
+  double mean  = 0.0;
+  double p50   = 0.0;
+  double p99   = 0.0;
+  double max   = 0.0;
+
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief summarize
+/// \param pLatencies - latencies in any unit (reordered)
+/// \return nearest rank percentiles in the same unit
+////////////////////////////////////////////////////////////////////
+LatencySummary summarize ( std::vector< double > *pLatencies );
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The LatencyHistogram class
+///
+///        Latencies (any unit) counted in fixed log spaced buckets
+///        1% wide, so memory stays the same however many are
+///        added. Percentiles come within 1% of the nearest rank
+///        value (values below 1 share the first bucket); count,
+///        mean and max are exact.
+///
+////////////////////////////////////////////////////////////////////
+class LatencyHistogram
+{
+
+public:
+
+  LatencyHistogram( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief add
+  /// \param latency
+  ////////////////////////////////////////////////////////////////////
+  void add ( double latency );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief merge - adds every latency counted by other
+  /// \param other
+  ////////////////////////////////////////////////////////////////////
+  void merge ( const LatencyHistogram &other );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief clear
+  ////////////////////////////////////////////////////////////////////
+  void clear ( );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief summarize
+  /// \return percentiles in the unit of the added latencies
+  ////////////////////////////////////////////////////////////////////
+  LatencySummary summarize ( ) const;
+
+
+private:
+
+  std::vector< unsigned long long > counts_;
+  size_t                            count_;
+  double                            sum_;
+  double                            min_;
+  double                            max_;
+
+};
+
+
+} // namespace server
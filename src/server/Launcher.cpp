@@ -0,0 +1,381 @@
+// Launcher.cpp
+//
+// netLaunch: starts an example as a parameter server plus N worker
+// processes on this machine, waits for the training to finish and
+// reports the wall time. Several worker counts make a scaling run,
+// one after another.
+//
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+
+/// \brief LaunchOptions - netLaunch settings
+struct LaunchOptions
+{
+
+  std::vector< unsigned >    workerCounts;
+  std::string                address;     ///< empty for a Unix socket named after the launcher's pid
+  std::vector< std::string > exampleArgs; ///< example executable and its options
+
+};
+
+
+
+const char *
+usage( )
+{
+
+  return "usage: netLaunch [options] -- <example> [example options]\n"
+         "  --workers <n[,n...]>  worker processes, one run per count (default 2)\n"
+         "  --tcp <port>          connect over TCP on localhost (default: a Unix socket)\n"
+         "  --socket <path>       Unix socket path (default /tmp/net-ps-<pid>.sock)\n"
+         "  --help                show this message\n"
+         "\n"
+         "The example gets --ps-serve (plus --ps-workers) or --ps-worker added\n"
+         "to its options; e.g. netLaunch --workers 1,2,4 -- ./runXOR --benchmark\n";
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief spawn - runs the example with 'extraArgs' appended
+/// \return child pid
+////////////////////////////////////////////////////////////////////
+pid_t
+spawn(
+      const std::vector< std::string > &exampleArgs,
+      const std::vector< std::string > &extraArgs
+      )
+{
+
+  std::vector< std::string > args = exampleArgs;
+
+  args.insert( args.end( ), extraArgs.begin( ), extraArgs.end( ) );
+
+  std::vector< char* > argv;
+
+  for ( std::string &arg : args )
+  {
+
+    argv.push_back( &arg[ 0 ] );
+
+  }
+
+  argv.push_back( nullptr );
+
+  pid_t pid = ::fork( );
+
+  if ( pid < 0 )
+  {
+
+    throw std::runtime_error( std::string( "fork: " ) + std::strerror( errno ) );
+
+  }
+
+  if ( pid == 0 )
+  {
+
+    ::execvp( argv[ 0 ], argv.data( ) );
+
+    std::cerr << "Could not run '" << args[ 0 ] << "': " << std::strerror( errno ) << std::endl;
+    ::_exit( 127 );
+
+  }
+
+  return pid;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief runOnce - one server and numWorkers workers
+/// \return wall seconds until every process finished (throws if
+///         one of them failed, after stopping the others)
+////////////////////////////////////////////////////////////////////
+double
+runOnce(
+        const LaunchOptions &options,
+        unsigned             numWorkers
+        )
+{
+
+  std::string address = options.address;
+
+  if ( address.empty( ) )
+  {
+
+    address = "/tmp/net-ps-" + std::to_string( ::getpid( ) ) + ".sock";
+
+  }
+
+  Clock::time_point start = Clock::now( );
+
+  std::vector< pid_t > running;
+
+  running.push_back( spawn( options.exampleArgs, { "--ps-serve", address,
+                                                   "--ps-workers", std::to_string( numWorkers ) } ) );
+
+  // (workers retry until the server listens)
+  for ( unsigned w = 0; w < numWorkers; ++w )
+  {
+
+    running.push_back( spawn( options.exampleArgs, { "--ps-worker", address } ) );
+
+  }
+
+  std::string failure;
+
+  while ( !running.empty( ) )
+  {
+
+    int   status;
+    pid_t pid = ::waitpid( -1, &status, 0 );
+
+    if ( pid < 0 )
+    {
+
+      if ( errno == EINTR )
+      {
+
+        continue;
+
+      }
+
+      throw std::runtime_error( std::string( "waitpid: " ) + std::strerror( errno ) );
+
+    }
+
+    for ( size_t i = 0; i < running.size( ); ++i )
+    {
+
+      if ( running[ i ] == pid )
+      {
+
+        running.erase( running.begin( ) + static_cast< long >( i ) );
+        break;
+
+      }
+
+    }
+
+    if ( failure.empty( ) && !( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 ) )
+    {
+
+      std::ostringstream what;
+
+      what << "process " << pid;
+
+      if ( WIFEXITED( status ) )
+      {
+
+        what << " exited with status " << WEXITSTATUS( status );
+
+      }
+      else
+      {
+
+        what << " was killed by signal " << WTERMSIG( status );
+
+      }
+
+      failure = what.str( );
+
+      // the others would wait for it forever
+      for ( pid_t other : running )
+      {
+
+        ::kill( other, SIGTERM );
+
+      }
+
+    }
+
+  }
+
+  if ( !failure.empty( ) )
+  {
+
+    throw std::runtime_error( "Run with " + std::to_string( numWorkers ) + " workers failed: " + failure );
+
+  }
+
+  return std::chrono::duration< double >( Clock::now( ) - start ).count( );
+
+} // runOnce
+
+} // namespace
+
+
+
+int
+main(
+     int    argc,
+     char **argv
+     )
+{
+
+  try
+  {
+
+    LaunchOptions options;
+
+    int i = 1;
+
+    for ( ; i < argc; ++i )
+    {
+
+      std::string arg = argv[ i ];
+
+      auto value = [ & ]( )
+      {
+
+        if ( i + 1 >= argc )
+        {
+
+          throw std::runtime_error( "Missing value for " + arg + "\n" + usage( ) );
+
+        }
+
+        return std::string( argv[ ++i ] );
+
+      };
+
+      if ( arg == "--" )
+      {
+
+        ++i;
+        break;
+
+      }
+      else if ( arg == "--help" || arg == "-h" )
+      {
+
+        std::cout << usage( );
+        return EXIT_SUCCESS;
+
+      }
+      else if ( arg == "--workers" )
+      {
+
+        std::istringstream counts( value( ) );
+        std::string        count;
+
+        while ( std::getline( counts, count, ',' ) )
+        {
+
+          options.workerCounts.push_back( static_cast< unsigned >( std::stoul( count ) ) );
+
+        }
+
+      }
+      else if ( arg == "--tcp" )
+      {
+
+        options.address = "tcp:localhost:" + value( );
+
+      }
+      else if ( arg == "--socket" )
+      {
+
+        options.address = value( );
+
+      }
+      else
+      {
+
+        throw std::runtime_error( "Unknown option '" + arg + "'\n" + usage( ) );
+
+      }
+
+    }
+
+    options.exampleArgs.assign( argv + i, argv + argc );
+
+    if ( options.exampleArgs.empty( ) )
+    {
+
+      throw std::runtime_error( std::string( "No example to launch\n" ) + usage( ) );
+
+    }
+
+    if ( options.workerCounts.empty( ) )
+    {
+
+      options.workerCounts.push_back( 2 );
+
+    }
+
+    std::vector< double > seconds;
+
+    for ( unsigned numWorkers : options.workerCounts )
+    {
+
+      if ( numWorkers == 0 )
+      {
+
+        throw std::runtime_error( "Need at least one worker" );
+
+      }
+
+      seconds.push_back( runOnce( options, numWorkers ) );
+
+    }
+
+    //
+    // scaling summary (speedup relative to the first count)
+    //
+    std::cout << std::fixed << std::setprecision( 3 ) << "workers  seconds  speedup\n";
+
+    for ( size_t r = 0; r < seconds.size( ); ++r )
+    {
+
+      std::cout << std::setw( 7 ) << options.workerCounts[ r ]
+                << std::setw( 9 ) << seconds[ r ]
+                << std::setw( 9 ) << seconds.front( ) / seconds[ r ] << "\n";
+
+    }
+
+    std::cout << std::flush;
+
+  }
+  catch ( const std::logic_error & )
+  {
+
+    // std::stoul
+    std::cerr << "Program failed: invalid worker count\n" << usage( );
+    return EXIT_FAILURE;
+
+  }
+  catch ( const std::exception &e )
+  {
+
+    std::cerr << "Program failed: " << e.what( ) << std::endl;
+    return EXIT_FAILURE;
+
+  }
+
+  return EXIT_SUCCESS;
+
+} // main
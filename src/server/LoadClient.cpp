@@ -0,0 +1,352 @@
+// LoadClient.cpp
+//
+// netLoad: load generator for netServer. Each connection keeps a
+// fixed number of requests with random inputs in flight and
+// measures the time from sending a request to reading its response.
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "Latency.hpp"
+#include "Protocol.hpp"
+#include "Socket.hpp"
+
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+
+/// \brief LoadOptions - netLoad settings
+struct LoadOptions
+{
+
+  std::string   socketPath  = "/tmp/net.sock";
+  unsigned      connections = 4;
+  unsigned      outstanding = 8;     ///< requests in flight per connection
+  unsigned long requests    = 20000; ///< requests per connection
+  unsigned      seed        = 0;
+
+};
+
+
+
+const char *
+usage( )
+{
+
+  return "usage: netLoad [options]\n"
+         "  --socket <path>       netServer socket (default /tmp/net.sock)\n"
+         "  --connections <n>     concurrent client connections (default 4)\n"
+         "  --outstanding <n>     requests in flight per connection (default 8)\n"
+         "  --requests <n>        requests sent per connection (default 20000)\n"
+         "  --seed <n>            seed for the random inputs\n"
+         "  --help                show this message\n";
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief runConnection - one client connection's request loop
+/// \param options
+/// \param seed
+/// \param pLatencies - round trip times in microseconds
+////////////////////////////////////////////////////////////////////
+void
+runConnection(
+              const LoadOptions     &options,
+              unsigned               seed,
+              std::vector< double > *pLatencies
+              )
+{
+
+  int fd = server::connectUnix( options.socketPath );
+
+  try
+  {
+
+    server::Hello hello;
+
+    if ( !server::readAll( fd, &hello, sizeof( hello ) )
+        || hello.magic != server::helloMagic
+        || hello.version != server::protocolVersion )
+    {
+
+      throw std::runtime_error( "Not a netServer socket" );
+
+    }
+
+    std::mt19937                             gen( seed );
+    std::uniform_real_distribution< double > dist( -1.0, 1.0 );
+
+    std::vector< Clock::time_point > sent( options.requests );
+    std::vector< char >              request( sizeof( server::RequestHeader ) + hello.numInputs * sizeof( double ) );
+    std::vector< double >            outputs( hello.numOutputs );
+
+    unsigned long numSent     = 0;
+    unsigned long numReceived = 0;
+
+    auto send = [ & ]( )
+    {
+
+      server::RequestHeader header = { numSent, hello.numInputs, 0 };
+
+      std::vector< double > inputs( hello.numInputs );
+
+      for ( double &input : inputs )
+      {
+
+        input = dist( gen );
+
+      }
+
+      std::copy( reinterpret_cast< const char* >( &header ),
+                 reinterpret_cast< const char* >( &header ) + sizeof( header ),
+                 request.begin( ) );
+      std::copy( reinterpret_cast< const char* >( inputs.data( ) ),
+                 reinterpret_cast< const char* >( inputs.data( ) + inputs.size( ) ),
+                 request.begin( ) + sizeof( header ) );
+
+      sent[ numSent++ ] = Clock::now( );
+
+      if ( !server::writeAll( fd, request.data( ), request.size( ) ) )
+      {
+
+        throw std::runtime_error( "Server closed the connection" );
+
+      }
+
+    };
+
+    while ( numSent < options.requests && numSent < options.outstanding )
+    {
+
+      send( );
+
+    }
+
+    while ( numReceived < numSent )
+    {
+
+      server::ResponseHeader header;
+
+      if ( !server::readAll( fd, &header, sizeof( header ) )
+          || header.status != server::Ok
+          || header.numOutputs != hello.numOutputs
+          || header.id != numReceived
+          || !server::readAll( fd, outputs.data( ), outputs.size( ) * sizeof( double ) ) )
+      {
+
+        throw std::runtime_error( "Bad response from server" );
+
+      }
+
+      pLatencies->push_back(
+        std::chrono::duration< double, std::micro >( Clock::now( ) - sent[ numReceived ] ).count( ) );
+
+      ++numReceived;
+
+      if ( numSent < options.requests )
+      {
+
+        send( );
+
+      }
+
+    }
+
+  }
+  catch ( ... )
+  {
+
+    ::close( fd );
+    throw;
+
+  }
+
+  ::close( fd );
+
+} // runConnection
+
+} // namespace
+
+
+
+int
+main(
+     int    argc,
+     char **argv
+     )
+{
+
+  try
+  {
+
+    LoadOptions options;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+
+      std::string arg = argv[ i ];
+
+      auto value = [ & ]( )
+      {
+
+        if ( i + 1 >= argc )
+        {
+
+          throw std::runtime_error( "Missing value for " + arg + "\n" + usage( ) );
+
+        }
+
+        return std::string( argv[ ++i ] );
+
+      };
+
+      if ( arg == "--help" || arg == "-h" )
+      {
+
+        std::cout << usage( );
+        return EXIT_SUCCESS;
+
+      }
+      else if ( arg == "--socket" )
+      {
+
+        options.socketPath = value( );
+
+      }
+      else if ( arg == "--connections" )
+      {
+
+        options.connections = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--outstanding" )
+      {
+
+        options.outstanding = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--requests" )
+      {
+
+        options.requests = std::stoul( value( ) );
+
+      }
+      else if ( arg == "--seed" )
+      {
+
+        options.seed = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else
+      {
+
+        throw std::runtime_error( "Unknown option '" + arg + "'\n" + usage( ) );
+
+      }
+
+    }
+
+    if ( options.connections == 0 || options.outstanding == 0 )
+    {
+
+      throw std::runtime_error( std::string( "Need at least one connection and request in flight\n" ) + usage( ) );
+
+    }
+
+    std::vector< std::vector< double > > latencies( options.connections );
+    std::vector< std::exception_ptr >    errors( options.connections );
+    std::vector< std::thread >           threads;
+
+    Clock::time_point start = Clock::now( );
+
+    for ( unsigned c = 0; c < options.connections; ++c )
+    {
+
+      threads.emplace_back( [ &, c ]( )
+                            {
+
+                              try
+                              {
+
+                                runConnection( options, options.seed + c, &latencies[ c ] );
+
+                              }
+                              catch ( ... )
+                              {
+
+                                errors[ c ] = std::current_exception( );
+
+                              }
+
+                            } );
+
+    }
+
+    for ( std::thread &thread : threads )
+    {
+
+      thread.join( );
+
+    }
+
+    double seconds = std::chrono::duration< double >( Clock::now( ) - start ).count( );
+
+    for ( std::exception_ptr &error : errors )
+    {
+
+      if ( error )
+      {
+
+        std::rethrow_exception( error );
+
+      }
+
+    }
+
+    std::vector< double > all;
+
+    for ( const std::vector< double > &connectionLatencies : latencies )
+    {
+
+      all.insert( all.end( ), connectionLatencies.begin( ), connectionLatencies.end( ) );
+
+    }
+
+    server::LatencySummary summary = server::summarize( &all );
+
+    std::cout << std::fixed << std::setprecision( 1 )
+              << "Requests:    " << summary.count
+              << " (" << options.connections << " connections x " << options.outstanding << " in flight)\n"
+              << "Throughput:  " << summary.count / seconds << " req/s\n"
+              << "Latency us:  mean " << summary.mean
+              << " p50 " << summary.p50
+              << " p99 " << summary.p99
+              << " max " << summary.max << std::endl;
+
+  }
+  catch ( const std::exception &e )
+  {
+
+    std::cerr << "Program failed: " << e.what( ) << std::endl;
+    return EXIT_FAILURE;
+
+  }
+
+  return EXIT_SUCCESS;
+
+} // main
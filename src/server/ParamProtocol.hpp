@@ -0,0 +1,88 @@
+// ParamProtocol.hpp
+//
+// Binary protocol between a parameter server (an example started
+// with --ps-serve) and its workers (--ps-worker) over a Unix or TCP
+// socket. Every value is sent in host byte order (all processes
+// run the same build on machines of the same kind):
+//
+//   server -> worker, once per connection:  ParamHello
+//   worker -> server, first request:        ParamHeader{ Pull }
+//   worker -> server, then per round:       ParamHeader{ Push, numLayers, base version },
+//                                           PushStats, numLayers float scales,
+//                                           numValues int8 steps
+//   server -> worker, per request:          ParamHeader{ Weights | Accepted | Stale,
+//                                           numValues, version }, numValues doubles
+//                                           or ParamHeader{ Done } (then the server
+//                                           closes the connection)
+//
+// Weights travel as doubles in the layer by layer getWeights layout
+// (bias last in every row), so workers continue from exactly the
+// server's weights. A push carries the change the worker made since
+// the weights it pulled, quantized to int8 steps of one scale per
+// layer: change = step * scale.
+//
+#pragma once
+
+#include <cstdint>
+
+
+namespace server
+{
+
+
+constexpr uint32_t paramMagic   = 0x5350454E; // "NEPS"
+constexpr uint32_t paramVersion = 2;
+
+
+/// \brief ParamHello - describes the model trained on this connection
+struct ParamHello
+{
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t numValues; ///< weights and biases of the whole net
+  uint32_t rank;      ///< workers are numbered in the order they connect
+
+};
+
+
+enum ParamMessage : uint32_t
+{
+
+  Pull     = 1,
+  Push     = 2,
+  Weights  = 3, ///< reply to Pull
+  Accepted = 4, ///< reply to Push: applied, the current weights follow
+  Stale    = 5, ///< reply to Push: dropped as too stale, the current weights follow
+  Done     = 6, ///< training is over
+
+};
+
+
+/// \brief ParamHeader - starts every message
+struct ParamHeader
+{
+
+  uint32_t type;    ///< a ParamMessage
+  uint32_t count;   ///< scales (Push) or weights (replies) that follow
+  uint64_t version; ///< weights the push was computed from, or the weights sent
+
+};
+
+
+/// \brief PushStats - the worker's progress, sent with every push
+struct PushStats
+{
+
+  uint64_t samples; ///< samples trained since the previous push
+  double   error;   ///< the worker net's recent average error
+
+};
+
+
+static_assert( sizeof( ParamHello )  == 16, "Protocol structs must not be padded" );
+static_assert( sizeof( ParamHeader ) == 16, "Protocol structs must not be padded" );
+static_assert( sizeof( PushStats )   == 16, "Protocol structs must not be padded" );
+
+
+} // namespace server
@@ -0,0 +1,815 @@
+#include "ParameterServer.hpp"
+#include "ParamProtocol.hpp"
+#include "Socket.hpp"
+
+#include "ConnectedNet.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace server
+{
+
+
+namespace
+{
+
+constexpr unsigned connectAttempts = 100; // a worker gives up after about five seconds
+constexpr unsigned connectRetryMs  = 50;
+
+constexpr double maxStep = 127.0; // largest int8 step of a push
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+double
+secondsSince( Clock::time_point start )
+{
+
+  return std::chrono::duration< double >( Clock::now( ) - start ).count( );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief append - adds raw values to a message
+////////////////////////////////////////////////////////////////////
+template< typename T >
+void
+append(
+       std::vector< char > *pMessage,
+       const T             *values,
+       size_t               count
+       )
+{
+
+  const char *bytes = reinterpret_cast< const char* >( values );
+
+  pMessage->insert( pMessage->end( ), bytes, bytes + count * sizeof( T ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief layerSizes
+/// \return weights and biases feeding each layer (in the
+///         getWeights layout) of a net with 'topology'
+////////////////////////////////////////////////////////////////////
+std::vector< unsigned >
+layerSizes( const std::vector< unsigned > &topology )
+{
+
+  std::vector< unsigned > sizes;
+
+  for ( size_t l = 1; l < topology.size( ); ++l )
+  {
+
+    sizes.push_back( topology[ l ] * ( topology[ l - 1 ] + 1 ) );
+
+  }
+
+  return sizes;
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterServer::ParameterServer
+////////////////////////////////////////////////////////////////////
+ParameterServer::ParameterServer( ParamOptions options )
+  : options_       ( options )
+  , version_       ( 0 )
+  , done_          ( false )
+  , error_         ( 1.0 )
+  , totalStaleness_( 0.0 )
+{
+
+  if ( options_.numWorkers == 0 )
+  {
+
+    throw std::runtime_error( "The parameter server needs at least one worker" );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterServer::train
+////////////////////////////////////////////////////////////////////
+ParamStats
+ParameterServer::train( net::ConnectedNet *pNet )
+{
+
+  std::vector< unsigned > topology = pNet->getTopology( );
+
+  layerSizes_ = layerSizes( topology );
+
+  //
+  // master weights start from the server's net
+  //
+  weights_.clear( );
+
+  std::vector< double > layerWeights;
+
+  for ( unsigned l = 1; l < topology.size( ); ++l )
+  {
+
+    pNet->getWeights( l, &layerWeights );
+    weights_.insert( weights_.end( ), layerWeights.begin( ), layerWeights.end( ) );
+
+  }
+
+  stats_          = ParamStats( );
+  version_        = 0;
+  done_           = false;
+  error_          = 1.0;
+  totalStaleness_ = 0.0;
+
+  int listenFd = listenAddress( options_.address );
+
+  Clock::time_point start    = Clock::now( );
+  Clock::time_point lastJoin = start;
+
+  try
+  {
+
+    std::vector< pollfd > pollFds;
+
+    for ( ;; )
+    {
+
+      bool everyoneJoined = stats_.numWorkers >= options_.numWorkers;
+      int  timeoutMs      = -1;
+
+      if ( !everyoneJoined && options_.acceptTimeout > 0.0 )
+      {
+
+        double left = options_.acceptTimeout - secondsSince( lastJoin );
+
+        if ( left > 0.0 )
+        {
+
+          timeoutMs = static_cast< int >( std::ceil( left * 1000.0 ) );
+
+        }
+        else if ( !done_ )
+        {
+
+          throw std::runtime_error( "Only " + std::to_string( stats_.numWorkers ) + " of "
+                                   + std::to_string( options_.numWorkers ) + " workers connected" );
+
+        }
+        else
+        {
+
+          // nothing left to train: stop waiting for the missing ones
+          everyoneJoined = true;
+
+        }
+
+      }
+
+      if ( everyoneJoined && workers_.empty( ) )
+      {
+
+        if ( !done_ )
+        {
+
+          throw std::runtime_error( "Every worker left before training finished" );
+
+        }
+
+        break;
+
+      }
+
+      pollFds.assign( 1, pollfd{ listenFd, POLLIN, 0 } );
+
+      for ( const Worker &worker : workers_ )
+      {
+
+        pollFds.push_back( pollfd{ worker.fd, POLLIN, 0 } );
+
+      }
+
+      if ( ::poll( pollFds.data( ), pollFds.size( ), timeoutMs ) < 0 )
+      {
+
+        if ( errno == EINTR )
+        {
+
+          continue;
+
+        }
+
+        throw std::runtime_error( std::string( "poll: " ) + std::strerror( errno ) );
+
+      }
+
+      //
+      // requests of the workers polled (new ones wait for the next round)
+      //
+      size_t numPolled = workers_.size( );
+
+      if ( pollFds[ 0 ].revents & POLLIN )
+      {
+
+        int fd = ::accept( listenFd, nullptr, nullptr );
+
+        if ( fd >= 0 )
+        {
+
+          Worker     worker = { fd, stats_.numWorkers };
+          ParamHello hello  = { paramMagic, paramVersion, static_cast< uint32_t >( weights_.size( ) ), worker.rank };
+
+          if ( writeAll( fd, &hello, sizeof( hello ) ) )
+          {
+
+            stats_.bytesSent += sizeof( hello );
+            ++stats_.numWorkers;
+            lastJoin = Clock::now( );
+
+            workers_.push_back( worker );
+
+          }
+          else
+          {
+
+            ::close( fd );
+
+          }
+
+        }
+
+      }
+
+      //
+      // serve every polled worker with a request waiting (backwards,
+      // so removing one keeps the indices of those still to come)
+      //
+      for ( size_t i = numPolled; i-- > 0; )
+      {
+
+        if ( pollFds[ i + 1 ].revents == 0 )
+        {
+
+          continue;
+
+        }
+
+        bool connected;
+
+        try
+        {
+
+          connected = _serve( workers_[ i ] );
+
+        }
+        catch ( const std::exception &e )
+        {
+
+          std::cerr << "Worker " << workers_[ i ].rank << ": " << e.what( ) << std::endl;
+          connected = false;
+
+        }
+
+        if ( !connected )
+        {
+
+          ::close( workers_[ i ].fd );
+          workers_.erase( workers_.begin( ) + static_cast< long >( i ) );
+
+        }
+
+      }
+
+    }
+
+  }
+  catch ( ... )
+  {
+
+    for ( const Worker &worker : workers_ )
+    {
+
+      ::close( worker.fd );
+
+    }
+
+    workers_.clear( );
+
+    ::close( listenFd );
+    unlinkAddress( options_.address );
+
+    throw;
+
+  }
+
+  ::close( listenFd );
+  unlinkAddress( options_.address );
+
+  //
+  // hand the final weights back
+  //
+  size_t offset = 0;
+
+  for ( unsigned l = 1; l < topology.size( ); ++l )
+  {
+
+    layerWeights.assign( weights_.begin( ) + static_cast< long >( offset ),
+                         weights_.begin( ) + static_cast< long >( offset + layerSizes_[ l - 1 ] ) );
+
+    pNet->setWeights( l, layerWeights );
+
+    offset += layerSizes_[ l - 1 ];
+
+  }
+
+  stats_.meanStaleness = ( stats_.pushes > 0 ? totalStaleness_ / stats_.pushes : 0.0 );
+  stats_.error         = error_;
+  stats_.seconds       = secondsSince( start );
+
+  return stats_;
+
+} // ParameterServer::train
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterServer::_serve
+////////////////////////////////////////////////////////////////////
+bool
+ParameterServer::_serve( const Worker &worker )
+{
+
+  ParamHeader header;
+
+  if ( !readAll( worker.fd, &header, sizeof( header ) ) )
+  {
+
+    return false;
+
+  }
+
+  stats_.bytesReceived += sizeof( header );
+
+  if ( header.type == Pull )
+  {
+
+    return _reply( worker, Weights );
+
+  }
+
+  if ( header.type != Push )
+  {
+
+    throw std::runtime_error( "Unknown message " + std::to_string( header.type ) );
+
+  }
+
+  if ( header.count != layerSizes_.size( ) )
+  {
+
+    throw std::runtime_error( "Push for a net with a different number of layers" );
+
+  }
+
+  PushStats pushStats;
+
+  scales_.resize( header.count );
+  steps_ .resize( weights_.size( ) );
+
+  if ( !readAll( worker.fd, &pushStats, sizeof( pushStats ) )
+      || !readAll( worker.fd, scales_.data( ), scales_.size( ) * sizeof( float ) )
+      || !readAll( worker.fd, steps_.data( ), steps_.size( ) ) )
+  {
+
+    return false;
+
+  }
+
+  stats_.bytesReceived += sizeof( pushStats ) + scales_.size( ) * sizeof( float ) + steps_.size( );
+  stats_.samples       += pushStats.samples;
+
+  if ( done_ )
+  {
+
+    return _reply( worker, Done );
+
+  }
+
+  uint64_t staleness = version_ - header.version;
+
+  uint32_t reply = Accepted;
+
+  if ( header.version > version_ || staleness > options_.maxStaleness )
+  {
+
+    ++stats_.stalePushes;
+    reply = Stale;
+
+  }
+  else
+  {
+
+    //
+    // add the worker's change, divided by sqrt( 1 + staleness ).
+    // With n workers taking turns a push is about n - 1 versions
+    // old. Adding n changes in full overshoots once they all make
+    // the same correction; dividing by 1 + staleness (averaging
+    // them) gains nothing from the extra workers.
+    //
+    double damping = std::sqrt( 1.0 + static_cast< double >( staleness ) );
+    size_t offset  = 0;
+
+    for ( size_t l = 0; l < layerSizes_.size( ); ++l )
+    {
+
+      double scale = scales_[ l ] / damping;
+
+      for ( size_t i = offset; i < offset + layerSizes_[ l ]; ++i )
+      {
+
+        weights_[ i ] += steps_[ i ] * scale;
+
+      }
+
+      offset += layerSizes_[ l ];
+
+    }
+
+    ++version_;
+    ++stats_.pushes;
+    totalStaleness_ += static_cast< double >( staleness );
+
+    // (a dropped push's error describes weights the server never
+    // got, so only applied pushes may end training)
+    error_ = pushStats.error;
+
+  }
+
+  // (like a local run, stop on the latest recent error: waiting
+  // for the mean over workers holds every worker to a stricter
+  // target the more workers there are)
+  done_ = ( options_.maxSamples > 0 && stats_.samples >= options_.maxSamples )
+          || error_ <= options_.targetError;
+
+  // (Done instead of the weights if this push finished training)
+  return _reply( worker, reply );
+
+} // ParameterServer::_serve
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterServer::_reply
+////////////////////////////////////////////////////////////////////
+bool
+ParameterServer::_reply(
+                        const Worker &worker,
+                        uint32_t      type
+                        )
+{
+
+  if ( done_ )
+  {
+
+    type = Done;
+
+  }
+
+  ParamHeader header = { type, 0, version_ };
+
+  message_.clear( );
+
+  if ( type != Done )
+  {
+
+    header.count = static_cast< uint32_t >( weights_.size( ) );
+
+  }
+
+  append( &message_, &header, 1 );
+
+  if ( type != Done )
+  {
+
+    append( &message_, weights_.data( ), weights_.size( ) );
+
+  }
+
+  if ( !writeAll( worker.fd, message_.data( ), message_.size( ) ) )
+  {
+
+    return false;
+
+  }
+
+  stats_.bytesSent += message_.size( );
+
+  return type != Done;
+
+} // ParameterServer::_reply
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterWorker::ParameterWorker
+////////////////////////////////////////////////////////////////////
+ParameterWorker::ParameterWorker( ParamOptions options )
+  : options_( options )
+  , fd_     ( -1 )
+  , rank_   ( 0 )
+  , version_( 0 )
+{
+
+  for ( unsigned attempt = 1; fd_ < 0; ++attempt )
+  {
+
+    try
+    {
+
+      fd_ = connectAddress( options_.address );
+
+    }
+    catch ( const std::runtime_error & )
+    {
+
+      if ( attempt >= connectAttempts )
+      {
+
+        throw;
+
+      }
+
+      std::this_thread::sleep_for( std::chrono::milliseconds( connectRetryMs ) );
+
+    }
+
+  }
+
+  ParamHello hello;
+
+  if ( !readAll( fd_, &hello, sizeof( hello ) )
+      || hello.magic != paramMagic
+      || hello.version != paramVersion )
+  {
+
+    ::close( fd_ );
+    throw std::runtime_error( "No parameter server at '" + options_.address + "'" );
+
+  }
+
+  rank_ = hello.rank;
+  weights_.resize( hello.numValues );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterWorker::~ParameterWorker
+////////////////////////////////////////////////////////////////////
+ParameterWorker::~ParameterWorker( )
+{
+
+  ::close( fd_ );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterWorker::train
+////////////////////////////////////////////////////////////////////
+ParamStats
+ParameterWorker::train(
+                       net::ConnectedNet *pNet,
+                       net::TrainFun      inputFun,
+                       net::TrainFun      targetFun
+                       )
+{
+
+  std::vector< unsigned > topology = pNet->getTopology( );
+  std::vector< unsigned > sizes    = layerSizes( topology );
+
+  size_t numValues = 0;
+
+  for ( unsigned size : sizes )
+  {
+
+    numValues += size;
+
+  }
+
+  if ( numValues != weights_.size( ) )
+  {
+
+    throw std::runtime_error( "The parameter server trains a net of a different size" );
+
+  }
+
+  ParamStats        stats;
+  Clock::time_point start = Clock::now( );
+
+  ParamHeader pull = { Pull, 0, 0 };
+
+  if ( !writeAll( fd_, &pull, sizeof( pull ) ) )
+  {
+
+    throw std::runtime_error( "Parameter server closed the connection" );
+
+  }
+
+  stats.bytesSent += sizeof( pull );
+
+  std::vector< double > layerWeights;
+  std::vector< double > residual( numValues, 0.0 ); // change not sent yet
+  std::vector< float >  scales( sizes.size( ) );
+  std::vector< int8_t > steps( numValues );
+  std::vector< char >   message;
+
+  for ( uint32_t reply = _receiveWeights( &stats ); reply != Done; reply = _receiveWeights( &stats ) )
+  {
+
+    if ( reply == Stale )
+    {
+
+      // the server dropped the change, rounding leftovers included
+      std::fill( residual.begin( ), residual.end( ), 0.0 );
+      ++stats.stalePushes;
+
+    }
+    else if ( reply == Accepted )
+    {
+
+      ++stats.pushes;
+
+    }
+
+    uint64_t baseVersion = version_;
+
+    //
+    // continue from the server's weights, keeping the local
+    // momentum (clearing it every localSteps samples slows
+    // training down a lot)
+    //
+    size_t offset = 0;
+
+    for ( unsigned l = 1; l < topology.size( ); ++l )
+    {
+
+      layerWeights.assign( weights_.begin( ) + static_cast< long >( offset ),
+                           weights_.begin( ) + static_cast< long >( offset + sizes[ l - 1 ] ) );
+
+      pNet->setWeights( l, layerWeights, true );
+
+      offset += sizes[ l - 1 ];
+
+    }
+
+    for ( unsigned s = 0; s < options_.localSteps; ++s )
+    {
+
+      pNet->feedForward( inputFun( ) );
+      pNet->backProp   ( targetFun( ) );
+
+    }
+
+    stats.samples += options_.localSteps;
+
+    //
+    // quantize the change since the pull (plus what earlier pushes
+    // rounded away) to steps of a per-layer scale
+    //
+    offset = 0;
+
+    for ( unsigned l = 1; l < topology.size( ); ++l )
+    {
+
+      pNet->getWeights( l, &layerWeights );
+
+      double largest = 0.0;
+
+      for ( size_t i = 0; i < layerWeights.size( ); ++i )
+      {
+
+        double change = layerWeights[ i ] - weights_[ offset + i ] + residual[ offset + i ];
+
+        residual[ offset + i ] = change;
+        largest                = std::max( largest, std::abs( change ) );
+
+      }
+
+      float scale = static_cast< float >( largest / maxStep );
+
+      scales[ l - 1 ] = scale;
+
+      for ( size_t i = offset; i < offset + layerWeights.size( ); ++i )
+      {
+
+        double step = ( scale > 0.0f ? std::round( residual[ i ] / scale ) : 0.0 );
+
+        step = std::min( std::max( step, -maxStep ), maxStep );
+
+        steps[ i ]     = static_cast< int8_t >( step );
+        residual[ i ] -= step * scale;
+
+      }
+
+      offset += layerWeights.size( );
+
+    }
+
+    ParamHeader header    = { Push, static_cast< uint32_t >( scales.size( ) ), baseVersion };
+    PushStats   pushStats = { options_.localSteps, pNet->getAverageError( ) };
+
+    message.clear( );
+
+    append( &message, &header,      1 );
+    append( &message, &pushStats,   1 );
+    append( &message, scales.data( ), scales.size( ) );
+    append( &message, steps.data( ),  steps.size( ) );
+
+    if ( !writeAll( fd_, message.data( ), message.size( ) ) )
+    {
+
+      throw std::runtime_error( "Parameter server closed the connection" );
+
+    }
+
+    stats.bytesSent += message.size( );
+
+  }
+
+  stats.error         = pNet->getAverageError( );
+  stats.seconds       = secondsSince( start );
+
+  return stats;
+
+} // ParameterWorker::train
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief ParameterWorker::_receiveWeights
+////////////////////////////////////////////////////////////////////
+uint32_t
+ParameterWorker::_receiveWeights( ParamStats *pStats )
+{
+
+  ParamHeader header;
+
+  if ( !readAll( fd_, &header, sizeof( header ) ) )
+  {
+
+    throw std::runtime_error( "Parameter server closed the connection" );
+
+  }
+
+  pStats->bytesReceived += sizeof( header );
+
+  if ( header.type == Done )
+  {
+
+    return Done;
+
+  }
+
+  if ( header.count != weights_.size( )
+      || !readAll( fd_, weights_.data( ), weights_.size( ) * sizeof( double ) ) )
+  {
+
+    throw std::runtime_error( "Bad reply from the parameter server" );
+
+  }
+
+  pStats->bytesReceived += weights_.size( ) * sizeof( double );
+
+  version_ = header.version;
+
+  return header.type;
+
+} // ParameterWorker::_receiveWeights
+
+
+} // namespace server
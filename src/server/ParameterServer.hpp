@@ -0,0 +1,234 @@
+// ParameterServer.hpp
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Net.hpp"
+
+
+namespace net
+{
+
+class ConnectedNet;
+
+}
+
+
+namespace server
+{
+
+
+/// \brief ParamOptions - parameter server and worker settings
+struct ParamOptions
+{
+
+  std::string   address       = "/tmp/net-ps.sock"; ///< "tcp:<host>:<port>", "unix:<path>" or a socket path
+  unsigned      numWorkers    = 1;      ///< workers the server waits for before it finishes
+  unsigned      maxStaleness  = 4;      ///< most pushes applied between a worker's pull and its push
+  unsigned      localSteps    = 32;     ///< samples a worker trains between pushes
+  double        targetError   = 1.0e-4; ///< training stops once a worker pushes a recent error below this
+  unsigned long maxSamples    = 0;      ///< training stops after this many samples over all workers (0 for no limit)
+  double        acceptTimeout = 60.0;   ///< seconds the server waits for the next worker to connect (0 waits forever)
+
+};
+
+
+/// \brief ParamStats - what a server or worker did
+struct ParamStats
+{
+
+  unsigned long long samples       = 0; ///< samples trained (server: over every worker)
+  unsigned long long pushes        = 0; ///< pushes applied
+  unsigned long long stalePushes   = 0; ///< pushes dropped as too stale
+  unsigned long long bytesSent     = 0;
+  unsigned long long bytesReceived = 0;
+  unsigned           numWorkers    = 0; ///< workers that connected (server only)
+  double             meanStaleness = 0.0; ///< pushes between pull and push, over applied pushes
+  double             error         = 1.0; ///< recent error of the last push when training stopped
+  double             seconds       = 0.0;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The ParameterServer class
+///
+///        Holds the master copy of a net's weights for workers in
+///        other processes (see ParameterWorker and
+///        ParamProtocol.hpp). Workers pull the weights, train a
+///        few samples on their own shard, and push back the change
+///        they made, int8 quantized. The server adds each push to
+///        the master weights as it arrives and answers with the
+///        current weights, so workers never wait for each other.
+///
+///        Staleness is bounded: every applied push bumps the
+///        weights' version, a push computed from weights s versions
+///        old is scaled by 1 / sqrt( 1 + s ), and one more than
+///        maxStaleness versions old is dropped (the worker carries
+///        on from the current weights). A dropped push's error
+///        doesn't count towards stopping either.
+///
+///        Requests are served one at a time on the calling
+///        thread, which keeps the updates free of races.
+///
+////////////////////////////////////////////////////////////////////
+class ParameterServer
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief ParameterServer
+  /// \param options
+  ////////////////////////////////////////////////////////////////////
+  explicit
+  ParameterServer( ParamOptions options );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief train
+  ///
+  ///        Serves pNet's weights until a worker pushes an
+  ///        acceptable error (or maxSamples were trained) and every
+  ///        one of numWorkers workers has connected and been told
+  ///        to stop, then writes the final weights back to pNet.
+  ///        Throws if all the workers leave before that, or if
+  ///        training isn't over and no worker connects for
+  ///        acceptTimeout seconds while some are still missing
+  ///        (once it is over, it stops waiting for them instead).
+  ///
+  /// \param pNet
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  ParamStats train ( net::ConnectedNet *pNet );
+
+
+private:
+
+  /// \brief Worker - a connected worker (the server closes its socket)
+  struct Worker
+  {
+
+    int      fd;
+    unsigned rank;
+
+  };
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _serve - answers one request
+  /// \return false once the worker is gone or told to stop
+  ////////////////////////////////////////////////////////////////////
+  bool _serve ( const Worker &worker );
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _reply - header and the current weights, or Done once
+  ///        training is over
+  /// \return false once the worker is gone or told to stop
+  ////////////////////////////////////////////////////////////////////
+  bool _reply (
+               const Worker &worker,
+               uint32_t      type
+               );
+
+  ParamOptions options_;
+
+  std::vector< unsigned > layerSizes_; // weights and biases feeding each layer
+  std::vector< double >   weights_;    // master copy, layer by layer
+  uint64_t                version_;    // pushes applied so far
+  bool                    done_;
+  double                  error_;      // recent error of the latest push
+
+  std::vector< Worker > workers_;
+
+  //
+  // message buffers
+  //
+  std::vector< char >   message_;
+  std::vector< float >  scales_;
+  std::vector< int8_t > steps_;
+
+  ParamStats stats_;
+  double     totalStaleness_;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The ParameterWorker class
+///
+///        Trains one shard for a ParameterServer: pulls the
+///        weights into a local net, runs localSteps samples of
+///        feedForward/backProp, pushes the change and continues
+///        from the weights the server answers with (keeping its
+///        momentum), until the server says training is over.
+///
+///        Each push sends one byte per weight: the change is
+///        divided into 255 steps of a per-layer scale, and what
+///        rounding leaves out is kept and added to the next push
+///        (error feedback), so small updates aren't lost.
+///
+////////////////////////////////////////////////////////////////////
+class ParameterWorker
+{
+
+public:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief ParameterWorker
+  ///
+  ///        Connects to the server, retrying for a few seconds so
+  ///        workers may start alongside it
+  ///
+  /// \param options - address and localSteps are used
+  ////////////////////////////////////////////////////////////////////
+  explicit
+  ParameterWorker( ParamOptions options );
+
+  ~ParameterWorker( );
+
+  ParameterWorker( const ParameterWorker& ) = delete;
+  ParameterWorker &operator= ( const ParameterWorker& ) = delete;
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief getRank
+  /// \return this worker's number, e.g. to pick its shard
+  ////////////////////////////////////////////////////////////////////
+  unsigned getRank ( ) const { return rank_; }
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief train
+  /// \param pNet - local net (same topology as the server's; its
+  ///               weights are replaced)
+  /// \param inputFun - this worker's shard
+  /// \param targetFun
+  /// \return
+  ////////////////////////////////////////////////////////////////////
+  ParamStats train (
+                    net::ConnectedNet *pNet,
+                    net::TrainFun      inputFun,
+                    net::TrainFun      targetFun
+                    );
+
+
+private:
+
+  ////////////////////////////////////////////////////////////////////
+  /// \brief _receiveWeights
+  /// \return the reply's type (Done without weights)
+  ////////////////////////////////////////////////////////////////////
+  uint32_t _receiveWeights ( ParamStats *pStats );
+
+  ParamOptions options_;
+  int          fd_;
+  unsigned     rank_;
+
+  std::vector< double > weights_; // as last received
+  uint64_t              version_;
+
+};
+
+
+} // namespace server
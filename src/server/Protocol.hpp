@@ -0,0 +1,82 @@
+// Protocol.hpp
+//
+// Binary protocol spoken by netServer and netLoad over a Unix
+// socket. Every value is sent in host byte order (both ends run on
+// the same machine):
+//
+//   server -> client, once per connection:  Hello
+//   client -> server, per request:           RequestHeader, numInputs doubles
+//   server -> client, per request:           ResponseHeader, numOutputs doubles
+//
+// A client may send any number of requests before reading the
+// responses. Responses carry the request id and come back in the
+// order the requests were sent.
+//
+#pragma once
+
+#include <cstdint>
+
+
+namespace server
+{
+
+
+constexpr uint32_t helloMagic      = 0x5354454E; // "NETS"
+constexpr uint32_t protocolVersion = 1;
+
+
+/// \brief Hello - describes the model served on this connection
+struct Hello
+{
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t numInputs;
+  uint32_t numOutputs;
+
+};
+
+
+/// \brief RequestHeader - followed by numInputs doubles
+struct RequestHeader
+{
+
+  uint64_t id;        ///< chosen by the client, echoed in the response
+  uint32_t numInputs; ///< must match Hello::numInputs
+  uint32_t reserved;
+
+};
+
+
+enum Status : uint32_t
+{
+
+  Ok         = 0,
+  BadRequest = 1, ///< wrong number of inputs (no outputs follow)
+
+};
+
+
+// a request with the wrong number of inputs is answered with
+// BadRequest when it has at most this many, otherwise the server
+// closes the connection without reading its inputs
+constexpr uint32_t maxBadRequestInputs = 65536;
+
+
+/// \brief ResponseHeader - followed by numOutputs doubles
+struct ResponseHeader
+{
+
+  uint64_t id;
+  uint32_t status;
+  uint32_t numOutputs; ///< 0 unless status is Ok
+
+};
+
+
+static_assert( sizeof( Hello )          == 16, "Protocol structs must not be padded" );
+static_assert( sizeof( RequestHeader )  == 16, "Protocol structs must not be padded" );
+static_assert( sizeof( ResponseHeader ) == 16, "Protocol structs must not be padded" );
+
+
+} // namespace server
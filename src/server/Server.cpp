@@ -0,0 +1,161 @@
+// Server.cpp
+//
+// netServer: serves a model saved with '--save' over a Unix socket,
+// batching concurrent requests (see InferenceServer.hpp)
+//
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "ConnectedNet.hpp"
+#include "InferenceServer.hpp"
+
+
+namespace
+{
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+
+extern "C" void
+onSignal( int )
+{
+
+  stopRequested = 1;
+
+}
+
+
+
+const char *
+usage( )
+{
+
+  return "usage: netServer --model <path> [options]\n"
+         "  --model <path>        model file written by an example's --save option\n"
+         "  --socket <path>       Unix socket to listen on (default /tmp/net.sock)\n"
+         "  --max-batch <n>       most requests evaluated together (default 64)\n"
+         "  --max-latency <us>    longest a request waits for its batch to fill (default 1000)\n"
+         "  --threads <n>         batch evaluation threads (default: one per core)\n"
+         "  --report <seconds>    seconds between latency reports, 0 for only the final one (default 5)\n"
+         "  --help                show this message\n";
+
+}
+
+} // namespace
+
+
+
+int
+main(
+     int    argc,
+     char **argv
+     )
+{
+
+  try
+  {
+
+    server::ServerOptions options;
+    std::string           modelPath;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+
+      std::string arg = argv[ i ];
+
+      auto value = [ & ]( )
+      {
+
+        if ( i + 1 >= argc )
+        {
+
+          throw std::runtime_error( "Missing value for " + arg + "\n" + usage( ) );
+
+        }
+
+        return std::string( argv[ ++i ] );
+
+      };
+
+      if ( arg == "--help" || arg == "-h" )
+      {
+
+        std::cout << usage( );
+        return EXIT_SUCCESS;
+
+      }
+      else if ( arg == "--model" )
+      {
+
+        modelPath = value( );
+
+      }
+      else if ( arg == "--socket" )
+      {
+
+        options.socketPath = value( );
+
+      }
+      else if ( arg == "--max-batch" )
+      {
+
+        options.maxBatch = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--max-latency" )
+      {
+
+        options.maxLatencyUs = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--threads" )
+      {
+
+        options.threads = static_cast< unsigned >( std::stoul( value( ) ) );
+
+      }
+      else if ( arg == "--report" )
+      {
+
+        options.reportInterval = std::stod( value( ) );
+
+      }
+      else
+      {
+
+        throw std::runtime_error( "Unknown option '" + arg + "'\n" + usage( ) );
+
+      }
+
+    }
+
+    if ( modelPath.empty( ) )
+    {
+
+      throw std::runtime_error( std::string( "Missing --model\n" ) + usage( ) );
+
+    }
+
+    std::signal( SIGINT,  &onSignal );
+    std::signal( SIGTERM, &onSignal );
+
+    server::InferenceServer inferenceServer( net::ConnectedNet::load( modelPath ), options );
+
+    inferenceServer.run( &stopRequested );
+
+  }
+  catch ( const std::exception &e )
+  {
+
+    std::cerr << "Program failed: " << e.what( ) << std::endl;
+    return EXIT_FAILURE;
+
+  }
+
+  return EXIT_SUCCESS;
+
+} // main
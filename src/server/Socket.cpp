@@ -0,0 +1,494 @@
+#include "Socket.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+namespace server
+{
+
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////
+/// \brief unixAddress
+////////////////////////////////////////////////////////////////////
+sockaddr_un
+unixAddress( const std::string &path )
+{
+
+  sockaddr_un address;
+
+  std::memset( &address, 0, sizeof( address ) );
+  address.sun_family = AF_UNIX;
+
+  if ( path.empty( ) || path.size( ) >= sizeof( address.sun_path ) )
+  {
+
+    throw std::runtime_error( "Invalid socket path '" + path + "'" );
+
+  }
+
+  std::memcpy( address.sun_path, path.c_str( ), path.size( ) );
+
+  return address;
+
+}
+
+
+
+[[noreturn]] void
+fail( const std::string &what )
+{
+
+  throw std::runtime_error( what + ": " + std::strerror( errno ) );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief resolve - getaddrinfo for a TCP stream socket
+////////////////////////////////////////////////////////////////////
+std::unique_ptr< addrinfo, void( * )( addrinfo* ) >
+resolve(
+        const std::string &host,
+        unsigned           port,
+        bool               passive
+        )
+{
+
+  addrinfo hints;
+
+  std::memset( &hints, 0, sizeof( hints ) );
+  hints.ai_family   = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags    = passive ? AI_PASSIVE : 0;
+
+  bool        anyHost = host.empty( ) || host == "*";
+  std::string service = std::to_string( port );
+  addrinfo   *pResult = nullptr;
+
+  int error = ::getaddrinfo( anyHost ? nullptr : host.c_str( ), service.c_str( ), &hints, &pResult );
+
+  if ( error != 0 )
+  {
+
+    throw std::runtime_error( "Could not resolve '" + host + ":" + service + "': " + ::gai_strerror( error ) );
+
+  }
+
+  return std::unique_ptr< addrinfo, void( * )( addrinfo* ) >( pResult, ::freeaddrinfo );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief splitAddress
+/// \return true for a TCP address, with its host and port in
+///         *pHost and *pPort, false for a Unix socket path in
+///         *pHost
+////////////////////////////////////////////////////////////////////
+bool
+splitAddress(
+             const std::string &address,
+             std::string       *pHost,
+             unsigned          *pPort
+             )
+{
+
+  if ( address.compare( 0, 4, "tcp:" ) != 0 )
+  {
+
+    *pHost = ( address.compare( 0, 5, "unix:" ) == 0 ? address.substr( 5 ) : address );
+    return false;
+
+  }
+
+  size_t colon = address.rfind( ':' );
+
+  if ( colon < 4 || colon + 1 >= address.size( ) )
+  {
+
+    throw std::runtime_error( "Invalid TCP address '" + address + "' (expected tcp:<host>:<port>)" );
+
+  }
+
+  *pHost = address.substr( 4, colon - 4 );
+
+  try
+  {
+
+    unsigned long port = std::stoul( address.substr( colon + 1 ) );
+
+    if ( port > 65535 )
+    {
+
+      throw std::out_of_range( "port" );
+
+    }
+
+    *pPort = static_cast< unsigned >( port );
+
+  }
+  catch ( const std::logic_error & )
+  {
+
+    throw std::runtime_error( "Invalid port in '" + address + "'" );
+
+  }
+
+  return true;
+
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief listenUnix
+////////////////////////////////////////////////////////////////////
+int
+listenUnix( const std::string &path )
+{
+
+  sockaddr_un address = unixAddress( path );
+
+  int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+
+  if ( fd < 0 )
+  {
+
+    fail( "socket" );
+
+  }
+
+  ::unlink( path.c_str( ) );
+
+  if ( ::bind( fd, reinterpret_cast< sockaddr* >( &address ), sizeof( address ) ) < 0
+      || ::listen( fd, SOMAXCONN ) < 0 )
+  {
+
+    int error = errno;
+
+    ::close( fd );
+    errno = error;
+    fail( "Could not listen on '" + path + "'" );
+
+  }
+
+  return fd;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief connectUnix
+////////////////////////////////////////////////////////////////////
+int
+connectUnix( const std::string &path )
+{
+
+  sockaddr_un address = unixAddress( path );
+
+  int fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+
+  if ( fd < 0 )
+  {
+
+    fail( "socket" );
+
+  }
+
+  if ( ::connect( fd, reinterpret_cast< sockaddr* >( &address ), sizeof( address ) ) < 0 )
+  {
+
+    int error = errno;
+
+    ::close( fd );
+    errno = error;
+    fail( "Could not connect to '" + path + "'" );
+
+  }
+
+  return fd;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief listenTcp
+////////////////////////////////////////////////////////////////////
+int
+listenTcp(
+          const std::string &host,
+          unsigned           port
+          )
+{
+
+  auto upAddresses = resolve( host, port, true );
+
+  int lastError = 0;
+
+  for ( addrinfo *pAddress = upAddresses.get( ); pAddress; pAddress = pAddress->ai_next )
+  {
+
+    int fd = ::socket( pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol );
+
+    if ( fd < 0 )
+    {
+
+      lastError = errno;
+      continue;
+
+    }
+
+    int on = 1;
+
+    ::setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof( on ) );
+
+    if ( ::bind( fd, pAddress->ai_addr, pAddress->ai_addrlen ) == 0
+        && ::listen( fd, SOMAXCONN ) == 0 )
+    {
+
+      return fd;
+
+    }
+
+    lastError = errno;
+    ::close( fd );
+
+  }
+
+  errno = lastError;
+  fail( "Could not listen on '" + host + ":" + std::to_string( port ) + "'" );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief connectTcp
+////////////////////////////////////////////////////////////////////
+int
+connectTcp(
+           const std::string &host,
+           unsigned           port
+           )
+{
+
+  auto upAddresses = resolve( host, port, false );
+
+  int lastError = 0;
+
+  for ( addrinfo *pAddress = upAddresses.get( ); pAddress; pAddress = pAddress->ai_next )
+  {
+
+    int fd = ::socket( pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol );
+
+    if ( fd < 0 )
+    {
+
+      lastError = errno;
+      continue;
+
+    }
+
+    if ( ::connect( fd, pAddress->ai_addr, pAddress->ai_addrlen ) == 0 )
+    {
+
+      int on = 1;
+
+      ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof( on ) );
+
+      return fd;
+
+    }
+
+    lastError = errno;
+    ::close( fd );
+
+  }
+
+  errno = lastError;
+  fail( "Could not connect to '" + host + ":" + std::to_string( port ) + "'" );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief listenAddress
+////////////////////////////////////////////////////////////////////
+int
+listenAddress( const std::string &address )
+{
+
+  std::string host;
+  unsigned    port = 0;
+
+  return splitAddress( address, &host, &port ) ? listenTcp( host, port ) : listenUnix( host );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief connectAddress
+////////////////////////////////////////////////////////////////////
+int
+connectAddress( const std::string &address )
+{
+
+  std::string host;
+  unsigned    port = 0;
+
+  return splitAddress( address, &host, &port ) ? connectTcp( host, port ) : connectUnix( host );
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief unlinkAddress
+////////////////////////////////////////////////////////////////////
+void
+unlinkAddress( const std::string &address )
+{
+
+  std::string host;
+  unsigned    port = 0;
+
+  if ( !splitAddress( address, &host, &port ) )
+  {
+
+    ::unlink( host.c_str( ) );
+
+  }
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief readAll
+////////////////////////////////////////////////////////////////////
+bool
+readAll(
+        int    fd,
+        void  *data,
+        size_t size
+        )
+{
+
+  char *bytes = static_cast< char* >( data );
+
+  while ( size > 0 )
+  {
+
+    ssize_t count = ::read( fd, bytes, size );
+
+    if ( count < 0 )
+    {
+
+      if ( errno == EINTR )
+      {
+
+        continue;
+
+      }
+
+      if ( errno == ECONNRESET )
+      {
+
+        return false;
+
+      }
+
+      fail( "read" );
+
+    }
+
+    if ( count == 0 )
+    {
+
+      return false;
+
+    }
+
+    bytes += count;
+    size  -= static_cast< size_t >( count );
+
+  }
+
+  return true;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief writeAll
+////////////////////////////////////////////////////////////////////
+bool
+writeAll(
+         int         fd,
+         const void *data,
+         size_t      size
+         )
+{
+
+  const char *bytes = static_cast< const char* >( data );
+
+  while ( size > 0 )
+  {
+
+    // MSG_NOSIGNAL: a vanished peer is an error code, not a SIGPIPE
+    ssize_t count = ::send( fd, bytes, size, MSG_NOSIGNAL );
+
+    if ( count < 0 )
+    {
+
+      if ( errno == EINTR )
+      {
+
+        continue;
+
+      }
+
+      if ( errno == EPIPE || errno == ECONNRESET )
+      {
+
+        return false;
+
+      }
+
+      fail( "send" );
+
+    }
+
+    bytes += count;
+    size  -= static_cast< size_t >( count );
+
+  }
+
+  return true;
+
+}
+
+
+} // namespace server
@@ -0,0 +1,97 @@
+// Socket.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+namespace server
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief listenUnix
+///
+///        Binds a stream socket to 'path' (replacing a stale socket
+///        file) and starts listening
+///
+/// \return listening descriptor (throws on failure)
+////////////////////////////////////////////////////////////////////
+int listenUnix ( const std::string &path );
+
+////////////////////////////////////////////////////////////////////
+/// \brief connectUnix
+/// \return connected descriptor (throws on failure)
+////////////////////////////////////////////////////////////////////
+int connectUnix ( const std::string &path );
+
+////////////////////////////////////////////////////////////////////
+/// \brief listenTcp
+///
+///        Binds a TCP socket to 'host' ("" or "*" for every
+///        interface) and 'port' and starts listening
+///
+/// \return listening descriptor (throws on failure)
+////////////////////////////////////////////////////////////////////
+int listenTcp (
+               const std::string &host,
+               unsigned           port
+               );
+
+////////////////////////////////////////////////////////////////////
+/// \brief connectTcp
+///
+///        Connects with Nagle's algorithm off (the protocols here
+///        send small headers and wait for the reply)
+///
+/// \return connected descriptor (throws on failure)
+////////////////////////////////////////////////////////////////////
+int connectTcp (
+                const std::string &host,
+                unsigned           port
+                );
+
+////////////////////////////////////////////////////////////////////
+/// \brief listenAddress
+/// \param address - "tcp:<host>:<port>", "unix:<path>" or a plain
+///                  Unix socket path
+/// \return listening descriptor (throws on failure)
+////////////////////////////////////////////////////////////////////
+int listenAddress ( const std::string &address );
+
+////////////////////////////////////////////////////////////////////
+/// \brief connectAddress
+/// \param address - same forms as listenAddress
+/// \return connected descriptor (throws on failure)
+////////////////////////////////////////////////////////////////////
+int connectAddress ( const std::string &address );
+
+////////////////////////////////////////////////////////////////////
+/// \brief unlinkAddress - removes the socket file listenAddress
+///        created for a Unix address (nothing for TCP)
+////////////////////////////////////////////////////////////////////
+void unlinkAddress ( const std::string &address );
+
+////////////////////////////////////////////////////////////////////
+/// \brief readAll
+/// \return false if the peer closed the connection before 'size'
+///         bytes arrived (throws on other errors)
+////////////////////////////////////////////////////////////////////
+bool readAll (
+              int    fd,
+              void  *data,
+              size_t size
+              );
+
+////////////////////////////////////////////////////////////////////
+/// \brief writeAll
+/// \return false if the peer is gone (throws on other errors)
+////////////////////////////////////////////////////////////////////
+bool writeAll (
+               int         fd,
+               const void *data,
+               size_t      size
+               );
+
+
+} // namespace server
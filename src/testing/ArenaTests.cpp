@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <new>
+
+#include "Arena.hpp"
+
+
+namespace
+{
+
+
+bool
+isAligned( const void *p )
+{
+
+  return reinterpret_cast< std::uintptr_t >( p ) % net::Arena::alignment == 0;
+
+}
+
+
+
+TEST( ArenaTest, AllocationsAreAlignedZeroedAndPacked )
+{
+
+  net::Arena arena( 1000 );
+
+  EXPECT_EQ( net::Arena::padded( 1000 ), arena.getCapacity( ) );
+  EXPECT_EQ( 0u, arena.getUsed( ) );
+  EXPECT_FALSE( arena.hasHugePages( ) );
+
+  // odd sizes, each padded to the next whole line
+  char   *a = arena.allocate< char >( 1 );
+  double *b = arena.allocate< double >( 9 );
+  int    *c = arena.allocate< int >( 17 );
+
+  EXPECT_TRUE( isAligned( a ) );
+  EXPECT_TRUE( isAligned( b ) );
+  EXPECT_TRUE( isAligned( c ) );
+
+  EXPECT_EQ( arena.data( ),       a );
+  EXPECT_EQ( arena.data( ) + 64,  reinterpret_cast< char* >( b ) );
+  EXPECT_EQ( arena.data( ) + 192, reinterpret_cast< char* >( c ) );
+  EXPECT_EQ( 64u + 128u + 128u,   arena.getUsed( ) );
+
+  for ( size_t i = 0; i < 9; ++i )
+  {
+
+    EXPECT_EQ( 0.0, b[ i ] );
+
+  }
+
+  for ( size_t i = 0; i < 17; ++i )
+  {
+
+    EXPECT_EQ( 0, c[ i ] );
+
+  }
+
+}
+
+
+
+TEST( ArenaTest, FixedCapacityThrowsInsteadOfGrowing )
+{
+
+  net::Arena arena( 256 );
+
+  double *first = arena.allocate< double >( 16 ); // 128 bytes
+  first[ 15 ]   = 3.0;
+
+  // too big: nothing is handed out and the arena is unchanged
+  EXPECT_THROW( arena.allocate< double >( 17 ), std::bad_alloc );
+  EXPECT_EQ   ( 128u, arena.getUsed( ) );
+
+  // what is left still fits exactly
+  double *second = arena.allocate< double >( 16 );
+
+  EXPECT_EQ( first + 16, second );
+  EXPECT_EQ( 256u, arena.getUsed( ) );
+  EXPECT_EQ( 3.0, first[ 15 ] );
+
+  EXPECT_THROW( arena.allocate< char >( 1 ), std::bad_alloc );
+
+  // an empty arena holds nothing
+  net::Arena empty;
+
+  EXPECT_EQ   ( 0u, empty.getCapacity( ) );
+  EXPECT_THROW( empty.allocate< char >( 1 ), std::bad_alloc );
+
+}
+
+
+
+TEST( ArenaTest, CopiesAreDeepAndReusable )
+{
+
+  net::Arena arena( 512 );
+
+  double *values = arena.allocate< double >( 8 );
+
+  for ( size_t i = 0; i < 8; ++i )
+  {
+
+    values[ i ] = i * 0.5;
+
+  }
+
+  net::Arena copy( arena );
+
+  EXPECT_NE( arena.data( ), copy.data( ) );
+  EXPECT_TRUE( isAligned( copy.data( ) ) );
+  EXPECT_EQ( arena.getUsed( ),     copy.getUsed( ) );
+  EXPECT_EQ( arena.getCapacity( ), copy.getCapacity( ) );
+
+  // same contents at the same offsets, then independent
+  double *copied = reinterpret_cast< double* >( copy.data( ) );
+
+  for ( size_t i = 0; i < 8; ++i )
+  {
+
+    EXPECT_EQ( values[ i ], copied[ i ] );
+
+  }
+
+  copied[ 0 ] = -1.0;
+
+  EXPECT_EQ( 0.0, values[ 0 ] );
+
+  // the copy goes on allocating after the copied part, zeroed
+  double *more = copy.allocate< double >( 8 );
+
+  EXPECT_EQ( copied + 8, more );
+  EXPECT_EQ( 0.0, more[ 7 ] );
+
+}
+
+
+
+TEST( ArenaTest, HugePagesFallBack )
+{
+
+  // below one huge page the request falls back to regular pages
+  net::Arena small( 4096, true );
+
+  EXPECT_FALSE( small.hasHugePages( ) );
+  EXPECT_TRUE ( isAligned( small.data( ) ) );
+
+  // larger arenas may or may not get huge pages; either way the
+  // memory is aligned, zeroed, writable and copyable
+  const size_t count = ( size_t( 3 ) << 20 ) / sizeof( double );
+
+  net::Arena large( count * sizeof( double ), true );
+
+  double *values = large.allocate< double >( count );
+
+  EXPECT_TRUE( isAligned( values ) );
+  EXPECT_EQ  ( 0.0, values[ 0 ] );
+  EXPECT_EQ  ( 0.0, values[ count - 1 ] );
+
+  values[ count - 1 ] = 2.0;
+
+  net::Arena copy( large );
+
+  EXPECT_EQ( 2.0, reinterpret_cast< double* >( copy.data( ) )[ count - 1 ] );
+
+}
+
+
+} // namespace
@@ -0,0 +1,559 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// trains a few hundred random samples so weights and momentum are non-trivial
+void
+trainRandom(
+            net::ConnectedNet *pNet,
+            unsigned           numSamples,
+            unsigned          *pState
+            )
+{
+
+  std::vector< unsigned > topology = pNet->getTopology( );
+
+  for ( unsigned s = 0; s < numSamples; ++s )
+  {
+
+    pNet->feedForward( nettest::randomInputs( topology.front( ), pState ) );
+    pNet->backProp   ( nettest::randomInputs( topology.back( ), pState ) );
+
+  }
+
+}
+
+
+
+// every weight of the net within tolerance of the reference's
+void
+expectWeightsNear(
+                  const net::ConnectedNet     &net,
+                  const nettest::ReferenceNet &reference,
+                  double                       tolerance
+                  )
+{
+
+  for ( unsigned layerNum = 1; layerNum < net.getTopology( ).size( ); ++layerNum )
+  {
+
+    std::vector< double > weights;
+    net.getWeights( layerNum, &weights );
+
+    const std::vector< double > &expected = reference.getWeights( layerNum );
+
+    ASSERT_EQ( expected.size( ), weights.size( ) );
+
+    for ( size_t i = 0; i < weights.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], weights[ i ], tolerance ) << "layer " << layerNum << ", weight " << i;
+
+    }
+
+  }
+
+}
+
+
+
+TEST( ConnectedNetTest, FeedForwardMatchesReference )
+{
+
+  net::ConnectedNet::seedWeights( 11 );
+
+  net::ConnectedNet net( { 5, 13, 7, 3 } );
+  unsigned          state = 1;
+
+  trainRandom( &net, 200, &state );
+
+  for ( unsigned s = 0; s < 20; ++s )
+  {
+
+    std::vector< double > inputs   = nettest::randomInputs( 5, &state );
+    std::vector< double > expected = nettest::referenceForward( net, inputs );
+    std::vector< double > results;
+
+    net.feedForward( inputs );
+    net.getResults( &results );
+
+    ASSERT_EQ( expected.size( ), results.size( ) );
+
+    for ( size_t i = 0; i < results.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], results[ i ], 1.0e-12 );
+
+    }
+
+  }
+
+}
+
+
+
+TEST( ConnectedNetTest, BatchMatchesReference )
+{
+
+  net::ConnectedNet::seedWeights( 12 );
+
+  net::ConnectedNet net( { 6, 33, 17, 4 } );
+  unsigned          state = 2;
+
+  trainRandom( &net, 200, &state );
+
+  // more samples than one tile, and not a whole number of tiles
+  const size_t          numSamples = 300;
+  std::vector< double > inputs     = nettest::randomInputs( numSamples * 6, &state );
+  std::vector< double > results;
+
+  net.feedForwardBatch( inputs, &results, 2 );
+
+  ASSERT_EQ( numSamples * 4, results.size( ) );
+
+  for ( size_t s = 0; s < numSamples; ++s )
+  {
+
+    std::vector< double > sample( inputs.begin( ) + s * 6, inputs.begin( ) + ( s + 1 ) * 6 );
+    std::vector< double > expected = nettest::referenceForward( net, sample );
+
+    for ( size_t i = 0; i < 4; ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], results[ s * 4 + i ], 1.0e-12 );
+
+    }
+
+  }
+
+}
+
+
+
+TEST( ConnectedNetTest, BatchFollowsTrainingAfterPrepare )
+{
+
+  net::ConnectedNet::seedWeights( 13 );
+
+  net::ConnectedNet net( { 3, 9, 2 } );
+  unsigned          state = 3;
+
+  std::vector< double > inputs = nettest::randomInputs( 3 * 10, &state );
+  std::vector< double > before;
+  std::vector< double > after;
+
+  net.prepareBatch( );
+  net.feedForwardBatch( inputs, &before, 1 );
+
+  // the packed copy is out of date once training changes the weights
+  trainRandom( &net, 50, &state );
+
+  net.feedForwardBatch( inputs, &after, 1 );
+
+  std::vector< double > sample( inputs.begin( ), inputs.begin( ) + 3 );
+  std::vector< double > expected = nettest::referenceForward( net, sample );
+
+  EXPECT_NEAR( expected[ 0 ], after[ 0 ], 1.0e-12 );
+  EXPECT_NEAR( expected[ 1 ], after[ 1 ], 1.0e-12 );
+  EXPECT_NE  ( before[ 0 ], after[ 0 ] );
+
+}
+
+
+
+TEST( ConnectedNetTest, ConcurrentBatchesAfterMixedPrecision )
+{
+
+  net::ConnectedNet::seedWeights( 14 );
+
+  net::ConnectedNet net( { 4, 24, 24, 2 } );
+  unsigned          state = 4;
+
+  // training leaves the double weights behind the fp32 master weights
+  net.setPrecision( net::Precision::BFloat16 );
+  trainRandom( &net, 100, &state );
+
+  const size_t          numSamples = 256;
+  std::vector< double > inputs     = nettest::randomInputs( numSamples * 4, &state );
+
+  std::vector< std::vector< double > > expected;
+
+  for ( size_t s = 0; s < numSamples; ++s )
+  {
+
+    std::vector< double > sample( inputs.begin( ) + s * 4, inputs.begin( ) + ( s + 1 ) * 4 );
+    expected.push_back( nettest::referenceForward( net, sample ) );
+
+  }
+
+  // unprepared calls pack privately, prepared ones share the packed copy
+  for ( bool prepared : { false, true } )
+  {
+
+    if ( prepared )
+    {
+
+      net.prepareBatch( );
+
+    }
+
+    const net::ConnectedNet &constNet = net;
+
+    std::vector< std::vector< double > > results( 4 );
+    std::vector< std::thread >           threads;
+
+    for ( auto &result : results )
+    {
+
+      threads.emplace_back( [ &constNet, &inputs, &result ]
+        {
+
+          constNet.feedForwardBatch( inputs, &result, 2 );
+
+        } );
+
+    }
+
+    for ( std::thread &thread : threads )
+    {
+
+      thread.join( );
+
+    }
+
+    for ( const auto &result : results )
+    {
+
+      ASSERT_EQ( numSamples * 2, result.size( ) );
+
+      for ( size_t s = 0; s < numSamples; ++s )
+      {
+
+        EXPECT_NEAR( expected[ s ][ 0 ], result[ s * 2     ], 1.0e-12 );
+        EXPECT_NEAR( expected[ s ][ 1 ], result[ s * 2 + 1 ], 1.0e-12 );
+
+      }
+
+    }
+
+  }
+
+}
+
+
+
+TEST( ConnectedNetTest, SparseInputTrainingMatchesReference )
+{
+
+  net::ConnectedNet::seedWeights( 15 );
+
+  net::ConnectedNet     net( { 12, 9, 3 } );
+  nettest::ReferenceNet reference( net );
+  net::LearningParams   params = net.getLearningParams( );
+  unsigned              state  = 5;
+
+  //
+  // most first layer rows sit idle for many steps, so their
+  // momentum is caught up lazily (by getWeights, a dense step and
+  // at the end of the run)
+  //
+  for ( unsigned s = 0; s < 120; ++s )
+  {
+
+    std::vector< double > values  = nettest::randomInputs( 3, &state );
+    std::vector< double > targets = nettest::randomInputs( 3, &state );
+    std::vector< double > inputs( 12, 0.0 );
+    net::SparseVals       sparse;
+
+    for ( unsigned i = 0; i < 2; ++i )
+    {
+
+      unsigned index = static_cast< unsigned >( ( values[ i ] + 1.0 ) * 6.0 ) % 12;
+
+      if ( inputs[ index ] == 0.0 )
+      {
+
+        inputs[ index ] = values[ 2 ];
+        sparse.push_back( std::make_pair( index, values[ 2 ] ) );
+
+      }
+
+    }
+
+    if ( s == 60 )
+    {
+
+      net.feedForward( inputs );
+
+    }
+    else if ( s % 7 == 0 )
+    {
+
+      // the active input form: inputs of 1.0
+      std::vector< unsigned > active;
+
+      for ( auto &value : sparse )
+      {
+
+        inputs[ value.first ] = value.second = 1.0;
+        active.push_back( value.first );
+
+      }
+
+      net.feedForwardSparse( active );
+
+    }
+    else
+    {
+
+      net.feedForwardSparse( sparse );
+
+    }
+
+    net.backProp( targets );
+
+    reference.feedForward( inputs );
+    reference.backProp( targets, params );
+
+    if ( s % 40 == 39 )
+    {
+
+      expectWeightsNear( net, reference, 1.0e-10 );
+
+    }
+
+  }
+
+  // a dense pass after the lazy rows reads the caught up weights
+  std::vector< double > inputs   = nettest::randomInputs( 12, &state );
+  std::vector< double > expected = reference.feedForward( inputs );
+  std::vector< double > results;
+
+  net.feedForward( inputs );
+  net.getResults( &results );
+
+  for ( size_t i = 0; i < results.size( ); ++i )
+  {
+
+    EXPECT_NEAR( expected[ i ], results[ i ], 1.0e-10 );
+
+  }
+
+}
+
+
+
+TEST( ConnectedNetTest, SetWeightsCanKeepMomentum )
+{
+
+  net::ConnectedNet::seedWeights( 16 );
+
+  net::ConnectedNet net( { 4, 7, 2 } );
+  unsigned          state = 6;
+
+  trainRandom( &net, 50, &state );
+
+  // reloading a net's own weights changes nothing if the momentum is kept
+  net::ConnectedNet kept( net );
+  net::ConnectedNet cleared( net );
+
+  for ( unsigned layerNum = 1; layerNum < 3; ++layerNum )
+  {
+
+    std::vector< double > weights;
+    net.getWeights( layerNum, &weights );
+
+    kept.setWeights   ( layerNum, weights, true );
+    cleared.setWeights( layerNum, weights );
+
+  }
+
+  std::vector< double > inputs  = nettest::randomInputs( 4, &state );
+  std::vector< double > targets = nettest::randomInputs( 2, &state );
+
+  for ( net::ConnectedNet *pNet : { &net, &kept, &cleared } )
+  {
+
+    pNet->feedForward( inputs );
+    pNet->backProp   ( targets );
+
+  }
+
+  std::vector< double > expected;
+  std::vector< double > keptWeights;
+  std::vector< double > clearedWeights;
+
+  net.getWeights    ( 1, &expected );
+  kept.getWeights   ( 1, &keptWeights );
+  cleared.getWeights( 1, &clearedWeights );
+
+  EXPECT_EQ( expected, keptWeights );
+  EXPECT_NE( expected, clearedWeights );
+
+}
+
+
+
+TEST( ConnectedNetTest, MixedPrecisionTracksDoubleTraining )
+{
+
+  //
+  // 16 bit weights round to 8 (bfloat16) or 11 (half) significant
+  // bits; with fp32 master weights training stays within a few of
+  // those roundings of double precision training
+  //
+  const std::vector< std::pair< net::Precision, double > > cases = {
+    { net::Precision::Double,   1.0e-12 },
+    { net::Precision::BFloat16, 3.0e-2  },
+    { net::Precision::Half,     6.0e-3  }
+  };
+
+  for ( const auto &precisionCase : cases )
+  {
+
+    net::ConnectedNet::seedWeights( 17 );
+
+    // (few inputs per neuron: no saturated tanh to magnify rounding)
+    net::ConnectedNet     net( { 3, 12, 2 } );
+    nettest::ReferenceNet reference( net );
+    net::LearningParams   params = net.getLearningParams( );
+    unsigned              state  = 7;
+
+    net.setPrecision( precisionCase.first );
+
+    for ( unsigned s = 0; s < 200; ++s )
+    {
+
+      std::vector< double > inputs  = nettest::randomInputs( 3, &state );
+      std::vector< double > targets = nettest::randomInputs( 2, &state );
+
+      net.feedForward( inputs );
+      net.backProp   ( targets );
+
+      reference.feedForward( inputs );
+      reference.backProp( targets, params );
+
+    }
+
+    double maxError = 0.0;
+
+    for ( unsigned s = 0; s < 50; ++s )
+    {
+
+      std::vector< double > inputs   = nettest::randomInputs( 3, &state );
+      std::vector< double > expected = reference.feedForward( inputs );
+      std::vector< double > results;
+
+      net.feedForward( inputs );
+      net.getResults( &results );
+
+      for ( size_t i = 0; i < results.size( ); ++i )
+      {
+
+        maxError = std::max( maxError, std::abs( expected[ i ] - results[ i ] ) );
+
+      }
+
+    }
+
+    EXPECT_LT( maxError, precisionCase.second );
+
+  }
+
+}
+
+
+
+TEST( ConnectedNetTest, LoadRejectsCorruptFiles )
+{
+
+  net::ConnectedNet::seedWeights( 18 );
+
+  net::ConnectedNet net( { 3, 5, 2 } );
+  std::string       path = ::testing::TempDir( ) + "connected_net_test.model";
+
+  net.save( path );
+
+  std::vector< char > bytes;
+
+  {
+
+    std::ifstream in( path, std::ios::binary );
+    bytes.assign( std::istreambuf_iterator< char >( in ), std::istreambuf_iterator< char >( ) );
+
+  }
+
+  // header, 3 sizes, 5 * 4 + 2 * 6 weights
+  ASSERT_EQ( ( 4 + 3 ) * sizeof( uint32_t ) + 32 * sizeof( double ), bytes.size( ) );
+
+  // an intact file loads the same net
+  std::unique_ptr< net::ConnectedNet > upLoaded = net::ConnectedNet::load( path );
+
+  for ( unsigned layerNum = 1; layerNum < 3; ++layerNum )
+  {
+
+    std::vector< double > expected;
+    std::vector< double > weights;
+
+    net.getWeights      ( layerNum, &expected );
+    upLoaded->getWeights( layerNum, &weights );
+
+    EXPECT_EQ( expected, weights );
+
+  }
+
+  auto loadEdited = [ & ]( size_t sizeIndex, uint32_t size, size_t numBytes )
+                    {
+
+                      std::vector< char > edited( bytes.begin( ), bytes.begin( ) + static_cast< long >( numBytes ) );
+
+                      std::copy( reinterpret_cast< const char* >( &size ),
+                                 reinterpret_cast< const char* >( &size ) + sizeof( size ),
+                                 edited.begin( ) + static_cast< long >( ( 4 + sizeIndex ) * sizeof( uint32_t ) ) );
+
+                      std::ofstream( path, std::ios::binary ).write( edited.data( ), static_cast< std::streamsize >( edited.size( ) ) );
+
+                      return net::ConnectedNet::load( path );
+
+                    };
+
+  // layer sizes of zero or beyond the cap
+  EXPECT_THROW( loadEdited( 1, 0,          bytes.size( ) ), std::runtime_error );
+  EXPECT_THROW( loadEdited( 1, 0x7FFFFFFF, bytes.size( ) ), std::runtime_error );
+
+  // a size that does not match the weights stored
+  EXPECT_THROW( loadEdited( 1, 6, bytes.size( ) ), std::runtime_error );
+
+  // missing or extra weights
+  EXPECT_THROW( loadEdited( 1, 5, bytes.size( ) - sizeof( double ) ), std::runtime_error );
+
+  bytes.push_back( 0 );
+
+  EXPECT_THROW( loadEdited( 1, 5, bytes.size( ) ), std::runtime_error );
+  EXPECT_TRUE ( loadEdited( 1, 5, bytes.size( ) - 1 ) );
+
+  std::remove( path.c_str( ) );
+
+}
+
+
+} // namespace
@@ -0,0 +1,413 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "ConvNet.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// shape of one weight layer, worked out again from the topology
+struct Geometry
+{
+
+  bool     conv;
+  unsigned inWidth, inHeight, inChannels;
+  unsigned outWidth, outHeight, outChannels;
+  unsigned kernel, stride, padding;
+
+  unsigned numCols ( ) const { return conv ? kernel * kernel * inChannels : inWidth * inHeight * inChannels; }
+  unsigned numPositions ( ) const { return conv ? outWidth * outHeight : 1; }
+
+};
+
+
+
+std::vector< Geometry >
+geometries( const std::vector< net::LayerDesc > &topology )
+{
+
+  std::vector< Geometry > layers;
+
+  unsigned width    = topology.front( ).width;
+  unsigned height   = topology.front( ).height;
+  unsigned channels = topology.front( ).channels;
+
+  for ( size_t l = 1; l < topology.size( ); ++l )
+  {
+
+    const net::LayerDesc &desc = topology[ l ];
+
+    Geometry g = { desc.type == net::LayerDesc::Type::Conv, width, height, channels, desc.width, 1, 1, 0, 1, 0 };
+
+    if ( g.conv )
+    {
+
+      g.kernel      = desc.kernel;
+      g.stride      = desc.stride;
+      g.padding     = desc.padding;
+      g.outWidth    = ( width  + 2 * desc.padding - desc.kernel ) / desc.stride + 1;
+      g.outHeight   = ( height + 2 * desc.padding - desc.kernel ) / desc.stride + 1;
+      g.outChannels = desc.channels;
+
+    }
+
+    layers.push_back( g );
+
+    width    = g.outWidth;
+    height   = g.outHeight;
+    channels = g.outChannels;
+
+  }
+
+  return layers;
+
+}
+
+
+
+// calls visit( output row, weight column, output position, input index )
+// for every weight application that lands inside the input
+template< typename Visit >
+void
+forEachTap(
+           const Geometry &g,
+           Visit           visit
+           )
+{
+
+  unsigned numRows = ( g.conv ? g.outChannels : g.outWidth );
+
+  for ( unsigned r = 0; r < numRows; ++r )
+  {
+
+    if ( !g.conv )
+    {
+
+      for ( unsigned i = 0; i < g.numCols( ); ++i )
+      {
+
+        visit( r, i, 0u, i );
+
+      }
+
+      continue;
+
+    }
+
+    for ( unsigned oy = 0; oy < g.outHeight; ++oy )
+    {
+
+      for ( unsigned ox = 0; ox < g.outWidth; ++ox )
+      {
+
+        for ( unsigned c = 0; c < g.inChannels; ++c )
+        {
+
+          for ( unsigned ky = 0; ky < g.kernel; ++ky )
+          {
+
+            for ( unsigned kx = 0; kx < g.kernel; ++kx )
+            {
+
+              int y = static_cast< int >( oy * g.stride + ky ) - static_cast< int >( g.padding );
+              int x = static_cast< int >( ox * g.stride + kx ) - static_cast< int >( g.padding );
+
+              if ( y >= 0 && y < static_cast< int >( g.inHeight ) && x >= 0 && x < static_cast< int >( g.inWidth ) )
+              {
+
+                visit(
+                      r,
+                      ( c * g.kernel + ky ) * g.kernel + kx,
+                      oy * g.outWidth + ox,
+                      ( c * g.inHeight + static_cast< unsigned >( y ) ) * g.inWidth + static_cast< unsigned >( x )
+                      );
+
+              }
+
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+}
+
+
+
+// direct (loop over every tap) convolution net in the
+// ConvNet::getWeights layout, trained like ConvNet
+class ReferenceNet
+{
+
+public:
+
+  ReferenceNet(
+               const std::vector< net::LayerDesc > &topology,
+               const net::ConvNet                  &convNet
+               )
+    : layers_( geometries( topology ) )
+  {
+
+    for ( unsigned l = 0; l < layers_.size( ); ++l )
+    {
+
+      std::vector< double > weights;
+      convNet.getWeights( l + 1, &weights );
+      weights_.push_back( weights );
+      deltas_.push_back( std::vector< double >( weights.size( ), 0.0 ) );
+
+    }
+
+  }
+
+
+  std::vector< double >
+  feedForward( const std::vector< double > &inputs )
+  {
+
+    outputs_ = { inputs };
+
+    for ( unsigned l = 0; l < layers_.size( ); ++l )
+    {
+
+      const Geometry              &g       = layers_[ l ];
+      const std::vector< double > &weights = weights_[ l ];
+      const std::vector< double > &input   = outputs_.back( );
+      unsigned                     numCols = g.numCols( ) + 1;
+      std::vector< double >        sums( weights.size( ) / numCols * g.numPositions( ) );
+
+      for ( size_t i = 0; i < sums.size( ); ++i )
+      {
+
+        sums[ i ] = weights[ ( i / g.numPositions( ) ) * numCols + numCols - 1 ];
+
+      }
+
+      forEachTap( g, [ & ]( unsigned r, unsigned col, unsigned pos, unsigned in )
+        {
+
+          sums[ r * g.numPositions( ) + pos ] += weights[ r * numCols + col ] * input[ in ];
+
+        } );
+
+      for ( double &sum : sums )
+      {
+
+        sum = std::tanh( sum );
+
+      }
+
+      outputs_.push_back( sums );
+
+    }
+
+    return outputs_.back( );
+
+  }
+
+
+  void
+  backProp(
+           const std::vector< double > &targets,
+           const net::LearningParams   &params
+           )
+  {
+
+    std::vector< double > gradient = outputs_.back( );
+
+    for ( size_t n = 0; n < gradient.size( ); ++n )
+    {
+
+      gradient[ n ] = ( targets[ n ] - gradient[ n ] ) * ( 1.0 - gradient[ n ] * gradient[ n ] );
+
+    }
+
+    for ( size_t l = layers_.size( ); l-- > 0; )
+    {
+
+      const Geometry              &g       = layers_[ l ];
+      std::vector< double >       &weights = weights_[ l ];
+      const std::vector< double > &input   = outputs_[ l ];
+      unsigned                     numCols = g.numCols( ) + 1;
+      std::vector< double >        weightGrads( weights.size( ), 0.0 );
+      std::vector< double >        inputGrads( input.size( ), 0.0 );
+
+      forEachTap( g, [ & ]( unsigned r, unsigned col, unsigned pos, unsigned in )
+        {
+
+          double grad = gradient[ r * g.numPositions( ) + pos ];
+
+          weightGrads[ r * numCols + col ] += grad * input[ in ];
+          inputGrads [ in ]                += grad * weights[ r * numCols + col ];
+
+        } );
+
+      for ( size_t i = 0; i < gradient.size( ); ++i )
+      {
+
+        weightGrads[ ( i / g.numPositions( ) ) * numCols + numCols - 1 ] += gradient[ i ];
+
+      }
+
+      for ( size_t i = 0; i < weights.size( ); ++i )
+      {
+
+        deltas_[ l ][ i ] = params.eta / g.numPositions( ) * weightGrads[ i ] + params.alpha * deltas_[ l ][ i ];
+        weights[ i ]     += deltas_[ l ][ i ];
+
+      }
+
+      for ( size_t n = 0; n < inputGrads.size( ); ++n )
+      {
+
+        inputGrads[ n ] *= 1.0 - input[ n ] * input[ n ];
+
+      }
+
+      gradient = inputGrads;
+
+    }
+
+  }
+
+
+  const std::vector< double > &getWeights ( unsigned layerNum ) const { return weights_[ layerNum - 1 ]; }
+
+
+private:
+
+  std::vector< Geometry >              layers_;
+  std::vector< std::vector< double > > weights_;
+  std::vector< std::vector< double > > deltas_;
+  std::vector< std::vector< double > > outputs_;
+
+};
+
+
+
+// padded, strided and multi-channel convolutions ahead of a dense layer
+const std::vector< net::LayerDesc > testTopology = {
+  net::LayerDesc::image( 7, 6, 2 ),
+  net::LayerDesc::conv ( 3, 3, 1, 1 ),
+  net::LayerDesc::conv ( 4, 2, 2, 0 ),
+  net::LayerDesc::dense( 3 )
+};
+
+
+
+TEST( ConvNetTest, ForwardMatchesDirectConvolution )
+{
+
+  net::ConvNet convNet( testTopology, 41 );
+  ReferenceNet reference( testTopology, convNet );
+  unsigned     state = 41;
+
+  for ( unsigned s = 0; s < 10; ++s )
+  {
+
+    std::vector< double > inputs   = nettest::randomInputs( 7 * 6 * 2, &state );
+    std::vector< double > expected = reference.feedForward( inputs );
+    std::vector< double > results;
+
+    convNet.feedForward( inputs );
+    convNet.getResults( &results );
+
+    ASSERT_EQ( expected.size( ), results.size( ) );
+
+    for ( size_t i = 0; i < results.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], results[ i ], 1.0e-12 );
+
+    }
+
+  }
+
+}
+
+
+
+TEST( ConvNetTest, TrainingMatchesDirectConvolution )
+{
+
+  net::LearningParams params;
+  params.eta   = 0.1;
+  params.alpha = 0.7;
+
+  net::ConvNet convNet( testTopology, 42, params );
+  ReferenceNet reference( testTopology, convNet );
+  unsigned     state = 42;
+
+  for ( unsigned s = 0; s < 20; ++s )
+  {
+
+    std::vector< double > inputs  = nettest::randomInputs( 7 * 6 * 2, &state );
+    std::vector< double > targets = nettest::randomInputs( 3, &state );
+
+    convNet.feedForward( inputs );
+    convNet.backProp( targets );
+
+    reference.feedForward( inputs );
+    reference.backProp( targets, params );
+
+  }
+
+  for ( unsigned layerNum = 1; layerNum < testTopology.size( ); ++layerNum )
+  {
+
+    std::vector< double > weights;
+    convNet.getWeights( layerNum, &weights );
+
+    const std::vector< double > &expected = reference.getWeights( layerNum );
+
+    ASSERT_EQ( expected.size( ), weights.size( ) );
+
+    for ( size_t i = 0; i < weights.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], weights[ i ], 1.0e-10 );
+
+    }
+
+  }
+
+}
+
+
+
+TEST( ConvNetTest, SeedRepeatsWeights )
+{
+
+  net::ConvNet first ( testTopology, 43 );
+  net::ConvNet second( testTopology, 43 );
+  net::ConvNet other ( testTopology, 44 );
+
+  std::vector< double > firstWeights;
+  std::vector< double > secondWeights;
+  std::vector< double > otherWeights;
+
+  first.getWeights ( 1, &firstWeights );
+  second.getWeights( 1, &secondWeights );
+  other.getWeights ( 1, &otherWeights );
+
+  EXPECT_EQ( firstWeights, secondWeights );
+  EXPECT_NE( firstWeights, otherWeights );
+
+  EXPECT_THROW( first.getWeights( 0, &firstWeights ), std::runtime_error );
+  EXPECT_THROW( first.getWeights( 4, &firstWeights ), std::runtime_error );
+
+}
+
+
+} // namespace
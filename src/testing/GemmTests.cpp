@@ -0,0 +1,226 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "Gemm.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// C = A * B with a triple loop
+std::vector< double >
+naiveMultiply(
+              size_t                 m,
+              size_t                 n,
+              size_t                 k,
+              const net::MatrixView &a,
+              const net::MatrixView &b
+              )
+{
+
+  std::vector< double > c( m * n, 0.0 );
+
+  for ( size_t r = 0; r < m; ++r )
+  {
+
+    for ( size_t col = 0; col < n; ++col )
+    {
+
+      for ( size_t i = 0; i < k; ++i )
+      {
+
+        c[ r * n + col ] += a( r, i ) * b( i, col );
+
+      }
+
+    }
+
+  }
+
+  return c;
+
+}
+
+
+
+std::vector< net::Connection >
+randomConnections(
+                  size_t    count,
+                  unsigned *pState
+                  )
+{
+
+  std::vector< double >          values = nettest::randomInputs( 2 * count, pState );
+  std::vector< net::Connection > connections( count );
+
+  for ( size_t i = 0; i < count; ++i )
+  {
+
+    connections[ i ] = { values[ 2 * i ], values[ 2 * i + 1 ] };
+
+  }
+
+  return connections;
+
+}
+
+
+
+TEST( GemmTest, MultiplyMatchesNaive )
+{
+
+  // odd sizes and small blocks so every edge of the blocking is hit
+  const size_t m = 37;
+  const size_t n = 29;
+  const size_t k = 53;
+
+  net::BlockSizes saved = net::Gemm::getBlockSizes( );
+
+  unsigned              state = 81;
+  std::vector< double > a     = nettest::randomInputs( m * k, &state );
+  std::vector< double > bT    = nettest::randomInputs( n * k, &state );
+
+  net::MatrixView aView = { a.data( ), k, 1 };
+  net::MatrixView bView = { bT.data( ), 1, k }; // B stored transposed
+
+  std::vector< double > expected = naiveMultiply( m, n, k, aView, bView );
+
+  for ( const net::BlockSizes &sizes : { saved, net::BlockSizes{ 8, 8, 8 } } )
+  {
+
+    net::Gemm::setBlockSizes( sizes );
+
+    // overwrite, accumulate into a strided C, and with B prepacked
+    std::vector< double > c( m * n, 0.0 );
+    std::vector< double > strided( m * ( n + 3 ), 1.0 );
+    std::vector< double > packed( m * n, 0.0 );
+
+    net::Gemm::multiply( m, n, k, aView, bView, c.data( ), n );
+    net::Gemm::multiply( m, n, k, aView, bView, strided.data( ), n + 3, true );
+    net::Gemm::multiply( m, aView, net::PackedMatrix( k, n, bView ), packed.data( ), n );
+
+    for ( size_t r = 0; r < m; ++r )
+    {
+
+      for ( size_t col = 0; col < n; ++col )
+      {
+
+        EXPECT_NEAR( expected[ r * n + col ],       c      [ r * n + col ],       1.0e-12 );
+        EXPECT_NEAR( expected[ r * n + col ] + 1.0, strided[ r * ( n + 3 ) + col ], 1.0e-12 );
+        EXPECT_NEAR( expected[ r * n + col ],       packed [ r * n + col ],       1.0e-12 );
+
+      }
+
+      // the padding between rows of C is left alone
+      for ( size_t col = n; col < n + 3; ++col )
+      {
+
+        EXPECT_EQ( 1.0, strided[ r * ( n + 3 ) + col ] );
+
+      }
+
+    }
+
+  }
+
+  net::Gemm::setBlockSizes( saved );
+
+}
+
+
+
+TEST( GemmTest, VectorKernelsMatchNaive )
+{
+
+  const size_t numRows = 3 * net::Gemm::vectorLanes;
+  const size_t numCols = 2 * net::Gemm::vectorLanes;
+
+  unsigned                       state   = 82;
+  std::vector< double >          x       = nettest::randomInputs( numRows, &state );
+  std::vector< double >          g       = nettest::randomInputs( numCols, &state );
+  std::vector< net::Connection > weights = randomConnections( numRows * numCols, &state );
+  std::vector< net::Connection > biases  = randomConnections( numCols, &state );
+
+  net::LearningParams params;
+  params.eta   = 0.2;
+  params.alpha = 0.6;
+
+  // forward: y = x * W + b, backward: W * g
+  std::vector< double > y( numCols );
+  std::vector< double > wg( numRows, 0.0 );
+
+  net::Gemm::multiplyVector( numRows, numCols, x.data( ), weights.data( ), biases.data( ), y.data( ) );
+
+  for ( size_t c = 0; c < numCols; ++c )
+  {
+
+    double sum = 0.0;
+
+    for ( size_t r = 0; r < numRows; ++r )
+    {
+
+      sum += x[ r ] * weights[ r * numCols + c ].weight;
+
+    }
+
+    EXPECT_NEAR( sum + biases[ c ].weight, y[ c ], 1.0e-12 );
+
+  }
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    for ( size_t c = 0; c < numCols; ++c )
+    {
+
+      wg[ r ] += weights[ r * numCols + c ].weight * g[ c ];
+
+    }
+
+  }
+
+  // momentum updates, separate and fused with the backward product
+  std::vector< net::Connection > updated       = weights;
+  std::vector< net::Connection > fused         = weights;
+  std::vector< net::Connection > updatedBiases = biases;
+  std::vector< double >          fusedWg( numRows );
+
+  net::Gemm::updateWeights( numRows, numCols, x.data( ), g.data( ), updated.data( ), params );
+  net::Gemm::updateWeightsAndPropagate( numRows, numCols, x.data( ), g.data( ), fused.data( ), params, fusedWg.data( ) );
+  net::Gemm::updateBiases( numCols, g.data( ), updatedBiases.data( ), params );
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    EXPECT_NEAR( wg[ r ], fusedWg[ r ], 1.0e-12 );
+
+    for ( size_t c = 0; c < numCols; ++c )
+    {
+
+      const net::Connection &old   = weights[ r * numCols + c ];
+      double                 delta = params.eta * x[ r ] * g[ c ] + params.alpha * old.deltaWeight;
+
+      EXPECT_NEAR( delta,              updated[ r * numCols + c ].deltaWeight, 1.0e-12 );
+      EXPECT_NEAR( old.weight + delta, updated[ r * numCols + c ].weight,      1.0e-12 );
+      EXPECT_NEAR( old.weight + delta, fused  [ r * numCols + c ].weight,      1.0e-12 );
+
+    }
+
+  }
+
+  for ( size_t c = 0; c < numCols; ++c )
+  {
+
+    double delta = params.eta * g[ c ] + params.alpha * biases[ c ].deltaWeight;
+
+    EXPECT_NEAR( biases[ c ].weight + delta, updatedBiases[ c ].weight, 1.0e-12 );
+
+  }
+
+}
+
+
+} // namespace
@@ -0,0 +1,187 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "HeaderExporter.hpp"
+#include "TestNets.hpp"
+
+
+// set by the build to the compiler of this test
+#ifndef NET_TEST_CXX
+#define NET_TEST_CXX "c++"
+#endif
+
+
+namespace
+{
+
+
+std::string
+readFile( const std::string &path )
+{
+
+  std::ifstream      in( path );
+  std::ostringstream text;
+
+  text << in.rdbuf( );
+
+  return text.str( );
+
+}
+
+
+
+TEST( HeaderExporterTest, CompiledHeaderMatchesTheNet )
+{
+
+  net::ConnectedNet::seedWeights( 81 );
+
+  // one unrolled and one looped hidden layer (30 * 41 weights)
+  net::ConnectedNet tanhNet( { 3, 40, 30, 2 } );
+  net::ConnectedNet softmaxNet( { 4, 8, 3 } );
+
+  softmaxNet.setOutputHead( net::OutputHead::Softmax );
+
+  std::string dir = ::testing::TempDir( );
+
+  net::HeaderExporter::writeFile( tanhNet,    dir + "exported_tanh.hpp" );
+  net::HeaderExporter::writeFile( softmaxNet, dir + "exported_softmax.hpp" );
+
+  //
+  // a program evaluating both headers on fixed inputs, printing
+  // every output at full precision
+  //
+  unsigned                             state = 81;
+  std::vector< std::vector< double > > inputs;
+  std::ofstream                        program( dir + "exported_main.cpp" );
+
+  program << std::setprecision( 17 )
+          << "#include <cstdio>\n"
+          << "#include \"exported_tanh.hpp\"\n"
+          << "#include \"exported_softmax.hpp\"\n\n"
+          << "int main( )\n{\n\n"
+          << "  double outputs[ 3 ];\n\n";
+
+  for ( unsigned s = 0; s < 20; ++s )
+  {
+
+    bool        softmax = s % 2 == 1;
+    std::string name    = softmax ? "exported_softmax" : "exported_tanh";
+
+    inputs.push_back( nettest::randomInputs( softmax ? 4 : 3, &state ) );
+
+    program << "  {\n    const double inputs[] = { ";
+
+    for ( double value : inputs.back( ) )
+    {
+
+      program << value << ", ";
+
+    }
+
+    program << "};\n"
+            << "    " << name << "::evaluate( inputs, outputs );\n"
+            << "    for ( unsigned i = 0; i < " << name << "::numOutputs; ++i ) std::printf( \"%.17g\\n\", outputs[ i ] );\n"
+            << "  }\n\n";
+
+  }
+
+  program << "  return 0;\n\n}\n";
+  program.close( );
+
+  std::string command = std::string( NET_TEST_CXX ) + " -std=c++14 -O1 -o " + dir + "exported_main "
+                        + dir + "exported_main.cpp && " + dir + "exported_main > " + dir + "exported_outputs.txt";
+
+  ASSERT_EQ( 0, std::system( command.c_str( ) ) ) << command;
+
+  std::istringstream printed( readFile( dir + "exported_outputs.txt" ) );
+
+  for ( size_t s = 0; s < inputs.size( ); ++s )
+  {
+
+    net::ConnectedNet    &net = ( s % 2 == 1 ? softmaxNet : tanhNet );
+    std::vector< double > expected;
+
+    net.feedForward( inputs[ s ] );
+    net.getResults( &expected );
+
+    for ( double value : expected )
+    {
+
+      double exported = 0.0;
+
+      ASSERT_TRUE( printed >> exported ) << "sample " << s;
+      EXPECT_NEAR( value, exported, 1.0e-12 ) << "sample " << s;
+
+    }
+
+  }
+
+  double extra = 0.0;
+
+  EXPECT_FALSE( printed >> extra );
+
+  for ( const char *file : { "exported_tanh.hpp", "exported_softmax.hpp", "exported_main.cpp",
+                             "exported_main", "exported_outputs.txt" } )
+  {
+
+    std::remove( ( dir + file ).c_str( ) );
+
+  }
+
+}
+
+
+
+TEST( HeaderExporterTest, NamesAreValidIdentifiers )
+{
+
+  net::ConnectedNet::seedWeights( 82 );
+
+  net::ConnectedNet  net( { 2, 3, 1 } );
+  std::ostringstream out;
+
+  EXPECT_THROW( net::HeaderExporter::write( net, "int",    out ), std::runtime_error );
+  EXPECT_THROW( net::HeaderExporter::write( net, "new",    out ), std::runtime_error );
+  EXPECT_THROW( net::HeaderExporter::write( net, "and_eq", out ), std::runtime_error );
+  EXPECT_THROW( net::HeaderExporter::write( net, "2net",   out ), std::runtime_error );
+  EXPECT_THROW( net::HeaderExporter::write( net, "a-b",    out ), std::runtime_error );
+  EXPECT_THROW( net::HeaderExporter::write( net, "",       out ), std::runtime_error );
+
+  EXPECT_NO_THROW( net::HeaderExporter::write( net, "int_net", out ) );
+
+  // writeFile turns any file name into one
+  const std::vector< std::pair< std::string, std::string > > cases = {
+    { "new.hpp",          "new_net"      },
+    { "int.hpp",          "int_net"      },
+    { "xor-net.v2.hpp",   "xor_net"      },
+    { "3layers.hpp",      "net_3layers"  },
+    { "exported_net.hpp", "exported_net" }
+  };
+
+  for ( const auto &fileCase : cases )
+  {
+
+    std::string path = ::testing::TempDir( ) + fileCase.first;
+
+    net::HeaderExporter::writeFile( net, path );
+
+    EXPECT_NE( std::string::npos, readFile( path ).find( "namespace " + fileCase.second + "\n" ) ) << fileCase.first;
+
+    std::remove( path.c_str( ) );
+
+  }
+
+}
+
+
+} // namespace
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "HyperSearch.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// target 0.5 * x for x in [ -1, 1 ): cheap, and only a candidate that
+// trains can fit it
+net::SearchResult
+searchLinear(
+             const net::SearchOptions &options,
+             unsigned                  numCandidates,
+             unsigned                  learner
+             )
+{
+
+  net::HyperSearch search( options );
+
+  for ( unsigned c = 0; c < numCandidates; ++c )
+  {
+
+    net::HyperConfig config;
+
+    config.topology     = { 1, 4, 1 };
+    config.params.eta   = ( c == learner ? 0.1 : 0.0 ); // the rest never learn
+    config.params.alpha = 0.5;
+    config.seed         = 70 + c;
+
+    search.addCandidate( config );
+
+  }
+
+  unsigned state = 70;
+  double   x     = 0.0;
+
+  return search.run(
+                    [ & ]( ) { x = nettest::randomInputs( 1, &state )[ 0 ]; return std::vector< double >( 1, x ); },
+                    [ & ]( ) { return std::vector< double >( 1, 0.5 * x ); }
+                    );
+
+}
+
+
+
+TEST( HyperSearchTest, HalvingKeepsTheBestCandidate )
+{
+
+  net::SearchOptions options;
+  options.minBudget      = 200;
+  options.keepFraction   = 0.5;
+  options.validationSize = 100;
+  options.numThreads     = 2;
+  options.batchSize      = 32;
+
+  net::SearchResult result = searchLinear( options, 8, 5 );
+
+  // 8 -> 4 -> 2 -> 1, the budget doubling every round
+  EXPECT_EQ( 4u, result.numRounds );
+  EXPECT_EQ( std::vector< size_t >( { 8, 4, 2, 1 } ), result.roundSizes );
+  EXPECT_EQ( 200ul + 400ul + 800ul + 1600ul, result.iterations );
+
+  EXPECT_EQ( 0.1, result.config.params.eta );
+  EXPECT_EQ( 75u, result.config.seed );
+  ASSERT_TRUE( result.upNet );
+
+  //
+  // the reported error is the returned net's RMS error on the
+  // validation samples (the first ones of the stream)
+  //
+  unsigned state      = 70;
+  double   sumSquares = 0.0;
+
+  for ( unsigned s = 0; s < options.validationSize; ++s )
+  {
+
+    std::vector< double > input = nettest::randomInputs( 1, &state );
+    double                delta = 0.5 * input[ 0 ] - nettest::referenceForward( *result.upNet, input )[ 0 ];
+
+    sumSquares += delta * delta;
+
+  }
+
+  EXPECT_NEAR( std::sqrt( sumSquares / options.validationSize ), result.validationError, 1.0e-12 );
+  EXPECT_LT  ( result.validationError, 0.05 );
+
+}
+
+
+
+TEST( HyperSearchTest, UnevenHalvingRoundsDown )
+{
+
+  net::SearchOptions options;
+  options.minBudget      = 100;
+  options.keepFraction   = 0.4;
+  options.validationSize = 50;
+  options.numThreads     = 1;
+
+  net::SearchResult result = searchLinear( options, 6, 2 );
+
+  // 6 * 0.4 keeps 2, 2 * 0.4 still keeps 1; budgets 100, 250, 625
+  EXPECT_EQ( std::vector< size_t >( { 6, 2, 1 } ), result.roundSizes );
+  EXPECT_EQ( 3u, result.numRounds );
+  EXPECT_EQ( 100ul + 250ul + 625ul, result.iterations );
+  EXPECT_EQ( 72u, result.config.seed );
+
+}
+
+
+} // namespace
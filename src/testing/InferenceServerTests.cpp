@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ConnectedNet.hpp"
+#include "InferenceServer.hpp"
+#include "Protocol.hpp"
+#include "Socket.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// sends one request and reads its response (outputs only for Ok)
+server::ResponseHeader
+request(
+        int                          fd,
+        uint64_t                     id,
+        const std::vector< double > &inputs,
+        std::vector< double >       *pOutputs
+        )
+{
+
+  server::RequestHeader  header   = { id, static_cast< uint32_t >( inputs.size( ) ), 0 };
+  server::ResponseHeader response = { 0, 0, 0 };
+
+  EXPECT_TRUE( server::writeAll( fd, &header, sizeof( header ) ) );
+  EXPECT_TRUE( server::writeAll( fd, inputs.data( ), inputs.size( ) * sizeof( double ) ) );
+  EXPECT_TRUE( server::readAll ( fd, &response, sizeof( response ) ) );
+
+  pOutputs->resize( response.numOutputs );
+
+  EXPECT_TRUE( server::readAll( fd, pOutputs->data( ), response.numOutputs * sizeof( double ) ) );
+
+  return response;
+
+}
+
+
+
+// connects once the server's listening socket appears
+int
+connectWhenReady( const std::string &socketPath )
+{
+
+  int fd = -1;
+
+  for ( unsigned attempt = 0; fd < 0 && attempt < 100; ++attempt )
+  {
+
+    try
+    {
+
+      fd = server::connectUnix( socketPath );
+
+    }
+    catch ( const std::exception& )
+    {
+
+      std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+
+    }
+
+  }
+
+  return fd;
+
+}
+
+
+
+TEST( InferenceServerTest, RejectsMismatchedRequestsWithoutAllocating )
+{
+
+  net::ConnectedNet::seedWeights( 71 );
+
+  net::ConnectedNet net( { 3, 6, 2 } );
+  std::string       socketPath = "/tmp/netTest." + std::to_string( ::getpid( ) ) + ".sock";
+
+  server::ServerOptions options;
+  options.socketPath     = socketPath;
+  options.maxLatencyUs   = 0;
+  options.threads        = 1;
+  options.reportInterval = 0.0;
+
+  server::InferenceServer server( std::unique_ptr< net::ConnectedNet >( new net::ConnectedNet( net ) ), options );
+
+  volatile std::sig_atomic_t stop = 0;
+  std::thread                runner( [ & ]{ server.run( &stop ); } );
+
+  int fd = connectWhenReady( socketPath );
+
+  ASSERT_GE( fd, 0 );
+
+  server::Hello hello;
+
+  ASSERT_TRUE( server::readAll( fd, &hello, sizeof( hello ) ) );
+  EXPECT_EQ( 3u, hello.numInputs );
+  EXPECT_EQ( 2u, hello.numOutputs );
+
+  unsigned              state  = 71;
+  std::vector< double > inputs = nettest::randomInputs( 3, &state );
+  std::vector< double > outputs;
+
+  // good, short bad, then good again (the bad inputs must be skipped)
+  server::ResponseHeader response = request( fd, 1, inputs, &outputs );
+
+  EXPECT_EQ( server::Ok, response.status );
+  ASSERT_EQ( 2u, outputs.size( ) );
+  EXPECT_NEAR( nettest::referenceForward( net, inputs )[ 0 ], outputs[ 0 ], 1.0e-12 );
+
+  response = request( fd, 2, nettest::randomInputs( 5, &state ), &outputs );
+
+  EXPECT_EQ( 2u, response.id );
+  EXPECT_EQ( server::BadRequest, response.status );
+  EXPECT_EQ( 0u, response.numOutputs );
+
+  response = request( fd, 3, inputs, &outputs );
+
+  EXPECT_EQ( 3u, response.id );
+  EXPECT_EQ( server::Ok, response.status );
+
+  //
+  // a header claiming about 32 GB of inputs closes the connection
+  // instead of being read
+  //
+  server::RequestHeader huge = { 4, 0xFFFFFFFFu, 0 };
+
+  ASSERT_TRUE( server::writeAll( fd, &huge, sizeof( huge ) ) );
+
+  server::ResponseHeader none;
+
+  EXPECT_FALSE( server::readAll( fd, &none, sizeof( none ) ) );
+
+  ::close( fd );
+
+  stop = 1;
+  runner.join( );
+
+}
+
+
+
+TEST( InferenceServerTest, VanishedClientsDoNotStopTheServer )
+{
+
+  net::ConnectedNet::seedWeights( 72 );
+
+  net::ConnectedNet net( { 3, 6, 2 } );
+  std::string       socketPath = "/tmp/netTest." + std::to_string( ::getpid( ) ) + ".gone.sock";
+
+  server::ServerOptions options;
+  options.socketPath     = socketPath;
+  options.maxLatencyUs   = 1000;
+  options.threads        = 1;
+  options.reportInterval = 0.0;
+
+  server::InferenceServer server( std::unique_ptr< net::ConnectedNet >( new net::ConnectedNet( net ) ), options );
+
+  volatile std::sig_atomic_t stop = 0;
+  std::thread                runner( [ & ]{ server.run( &stop ); } );
+
+  unsigned              state  = 72;
+  std::vector< double > inputs = nettest::randomInputs( 3, &state );
+
+  //
+  // clients that queue requests and close without reading the
+  // responses, so the batcher writes to sockets already gone
+  //
+  for ( unsigned client = 0; client < 20; ++client )
+  {
+
+    int gone = connectWhenReady( socketPath );
+
+    ASSERT_GE( gone, 0 );
+
+    for ( uint64_t id = 0; id < 50; ++id )
+    {
+
+      server::RequestHeader header = { id, 3, 0 };
+
+      ASSERT_TRUE( server::writeAll( gone, &header, sizeof( header ) ) );
+      ASSERT_TRUE( server::writeAll( gone, inputs.data( ), inputs.size( ) * sizeof( double ) ) );
+
+    }
+
+    ::close( gone );
+
+  }
+
+  // the server still answers everyone else
+  int fd = connectWhenReady( socketPath );
+
+  ASSERT_GE( fd, 0 );
+
+  server::Hello hello;
+
+  ASSERT_TRUE( server::readAll( fd, &hello, sizeof( hello ) ) );
+
+  std::vector< double >  outputs;
+  server::ResponseHeader response = request( fd, 7, inputs, &outputs );
+
+  EXPECT_EQ( 7u, response.id );
+  EXPECT_EQ( server::Ok, response.status );
+  ASSERT_EQ( 2u, outputs.size( ) );
+  EXPECT_NEAR( nettest::referenceForward( net, inputs )[ 1 ], outputs[ 1 ], 1.0e-12 );
+
+  ::close( fd );
+
+  stop = 1;
+  runner.join( );
+
+}
+
+
+} // namespace
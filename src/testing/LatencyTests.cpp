@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Latency.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+TEST( LatencyTest, HistogramMatchesExactPercentiles )
+{
+
+  unsigned                 state = 61;
+  std::vector< double >    latencies;
+  server::LatencyHistogram histogram;
+  server::LatencyHistogram first;
+  server::LatencyHistogram second;
+
+  // spread over several decades of microseconds
+  for ( double value : nettest::randomInputs( 100000, &state ) )
+  {
+
+    double latency = std::pow( 10.0, 2.0 + 1.5 * value );
+
+    latencies.push_back( latency );
+    histogram.add( latency );
+    ( latencies.size( ) % 2 ? first : second ).add( latency );
+
+  }
+
+  first.merge( second );
+
+  server::LatencySummary exact = server::summarize( &latencies );
+
+  for ( const server::LatencyHistogram *pHistogram : { &histogram, &first } )
+  {
+
+    server::LatencySummary summary = pHistogram->summarize( );
+
+    EXPECT_EQ       ( exact.count, summary.count );
+    EXPECT_NEAR     ( exact.mean,  summary.mean, exact.mean * 1.0e-12 );
+    EXPECT_DOUBLE_EQ( exact.max,   summary.max );
+    EXPECT_NEAR     ( exact.p50,   summary.p50, exact.p50 * 0.01 );
+    EXPECT_NEAR     ( exact.p99,   summary.p99, exact.p99 * 0.01 );
+
+  }
+
+  histogram.clear( );
+
+  EXPECT_EQ( 0u, histogram.summarize( ).count );
+
+}
+
+
+
+TEST( LatencyTest, HistogramKeepsOutliersInRange )
+{
+
+  server::LatencyHistogram histogram;
+
+  histogram.add( 0.25 );
+  histogram.add( 0.5 );
+  histogram.add( 1.0e15 );
+
+  server::LatencySummary summary = histogram.summarize( );
+
+  EXPECT_EQ       ( 3u, summary.count );
+  EXPECT_DOUBLE_EQ( 1.0e15, summary.max );
+  EXPECT_GE       ( summary.p50, 0.25 );
+  EXPECT_LE       ( summary.p50, 1.0 );
+  EXPECT_LE       ( summary.p99, 1.0e15 );
+
+}
+
+
+} // namespace
@@ -0,0 +1,295 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "LookupTable.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// cell and fraction of x on an evenly spaced grid, clamped to its ends
+void
+gridCell(
+         double    x,
+         double    min,
+         double    max,
+         unsigned  points,
+         unsigned *pCell,
+         double   *pFraction
+         )
+{
+
+  double step     = ( max - min ) / ( points - 1 );
+  double position = ( std::min( std::max( x, min ), max ) - min ) / step;
+  double cell     = std::min( std::floor( position ), static_cast< double >( points - 2 ) );
+
+  *pCell     = static_cast< unsigned >( cell );
+  *pFraction = position - cell;
+
+}
+
+
+
+TEST( LookupTableTest, DiscreteAxesReproduceNet )
+{
+
+  net::ConnectedNet::seedWeights( 101 );
+
+  net::ConnectedNet net( { 3, 8, 2 } );
+
+  std::vector< double >         middle = { -1.0, 0.0, 0.5, 1.0 };
+  std::vector< net::TableAxis > axes   = {
+                                           net::TableAxis::discrete( { 0.0, 1.0 } ),
+                                           net::TableAxis::discrete( middle ),
+                                           net::TableAxis::discrete( { 0.0, 1.0 } )
+                                         };
+
+  net::LookupTable table = net::LookupTable::compileToTable( net, axes, 2 );
+
+  EXPECT_EQ( 3u,  table.getNumInputs( ) );
+  EXPECT_EQ( 2u,  table.getNumOutputs( ) );
+  EXPECT_EQ( 16u, table.getNumPoints( ) );
+
+  std::vector< double > batch;
+  std::vector< double > expected;
+
+  for ( double a : { 0.0, 1.0 } )
+  {
+
+    for ( double b : middle )
+    {
+
+      for ( double c : { 0.0, 1.0 } )
+      {
+
+        std::vector< double > inputs  = { a, b, c };
+        std::vector< double > outputs = nettest::referenceForward( net, inputs );
+
+        // inputs off the axis values use the nearest one
+        std::vector< double > nudged = { a + 0.1, b - 0.05, c - 0.2 };
+        std::vector< double > result( 2 );
+        std::vector< double > nudgedResult( 2 );
+
+        table.lookup( inputs.data( ), result.data( ) );
+        table.lookup( nudged.data( ), nudgedResult.data( ) );
+
+        for ( size_t o = 0; o < 2; ++o )
+        {
+
+          EXPECT_NEAR( outputs[ o ], result[ o ],       1.0e-12 );
+          EXPECT_NEAR( outputs[ o ], nudgedResult[ o ], 1.0e-12 );
+
+        }
+
+        batch.insert( batch.end( ), inputs.begin( ), inputs.end( ) );
+        expected.insert( expected.end( ), outputs.begin( ), outputs.end( ) );
+
+      }
+
+    }
+
+  }
+
+  std::vector< double > batchResult;
+  table.lookupBatch( batch, &batchResult );
+
+  ASSERT_EQ( expected.size( ), batchResult.size( ) );
+
+  for ( size_t i = 0; i < expected.size( ); ++i )
+  {
+
+    EXPECT_NEAR( expected[ i ], batchResult[ i ], 1.0e-12 );
+
+  }
+
+  EXPECT_LT( table.measureError( net, batch, 1 ).maxError, 1.0e-12 );
+
+}
+
+
+
+TEST( LookupTableTest, GridAxesInterpolateActivationInputs )
+{
+
+  net::ConnectedNet::seedWeights( 102 );
+
+  net::ConnectedNet net( { 2, 6, 1 } );
+
+  const double   minX = -1.0, maxX = 1.0, minY = 0.0, maxY = 1.0;
+  const unsigned pointsX = 5, pointsY = 3;
+
+  net::LookupTable table = net::LookupTable::compileToTable(
+                                                            net,
+                                                            {
+                                                              net::TableAxis::grid( minX, maxX, pointsX ),
+                                                              net::TableAxis::grid( minY, maxY, pointsY )
+                                                            },
+                                                            1
+                                                            );
+
+  // atanh of the net's output at a grid point
+  auto corner = [ & ]( unsigned i, unsigned j )
+                {
+
+                  double x = minX + i * ( maxX - minX ) / ( pointsX - 1 );
+                  double y = minY + j * ( maxY - minY ) / ( pointsY - 1 );
+
+                  return std::atanh( nettest::referenceForward( net, { x, y } )[ 0 ] );
+
+                };
+
+  // exact at the grid points
+  for ( unsigned i = 0; i < pointsX; ++i )
+  {
+
+    for ( unsigned j = 0; j < pointsY; ++j )
+    {
+
+      double inputs[ 2 ] = {
+                             minX + i * ( maxX - minX ) / ( pointsX - 1 ),
+                             minY + j * ( maxY - minY ) / ( pointsY - 1 )
+                           };
+      double output;
+
+      table.lookup( inputs, &output );
+
+      EXPECT_NEAR( std::tanh( corner( i, j ) ), output, 1.0e-12 );
+
+    }
+
+  }
+
+  // bilinear in between (and clamped outside), with tanh applied after
+  unsigned              state   = 102;
+  std::vector< double > samples = nettest::randomInputs( 2 * 60, &state );
+
+  for ( size_t s = 1; s < samples.size( ); s += 2 )
+  {
+
+    samples[ s ] = 0.5 * ( samples[ s ] + 1.0 );
+
+  }
+
+  samples[ 0 ] = 1.5;
+  samples[ 1 ] = -0.5;
+
+  std::vector< double > results;
+  table.lookupBatch( samples, &results );
+
+  ASSERT_EQ( 60u, results.size( ) );
+
+  double maxError = 0.0;
+
+  for ( size_t s = 0; s < 60; ++s )
+  {
+
+    unsigned i, j;
+    double   fx, fy;
+
+    gridCell( samples[ 2 * s ],     minX, maxX, pointsX, &i, &fx );
+    gridCell( samples[ 2 * s + 1 ], minY, maxY, pointsY, &j, &fy );
+
+    double inner = ( 1.0 - fx ) * ( 1.0 - fy ) * corner( i,     j )
+                   + fx         * ( 1.0 - fy ) * corner( i + 1, j )
+                   + ( 1.0 - fx ) * fy         * corner( i,     j + 1 )
+                   + fx         * fy           * corner( i + 1, j + 1 );
+
+    double single;
+    table.lookup( &samples[ 2 * s ], &single );
+
+    EXPECT_NEAR( std::tanh( inner ), results[ s ], 1.0e-12 );
+    EXPECT_EQ( results[ s ], single );
+
+    double netOutput = nettest::referenceForward( net, { samples[ 2 * s ], samples[ 2 * s + 1 ] } )[ 0 ];
+
+    maxError = std::max( maxError, std::abs( netOutput - results[ s ] ) );
+
+  }
+
+  net::TableError error = table.measureError( net, samples, 1 );
+
+  EXPECT_EQ( 60u, error.samples );
+  EXPECT_NEAR( maxError, error.maxError, 1.0e-12 );
+  EXPECT_GT( error.maxError, 0.0 );
+
+}
+
+
+
+TEST( LookupTableTest, RejectsBadAxesAndNaNInputs )
+{
+
+  net::ConnectedNet::seedWeights( 103 );
+
+  net::ConnectedNet net( { 2, 4, 2 } );
+
+  net::TableAxis bits = net::TableAxis::discrete( { 0.0, 1.0 } );
+
+  // hand built axes: uneven grid, unsorted, repeated and non-finite values
+  net::TableAxis uneven;
+  uneven.values      = { 0.0, 0.1, 1.0 };
+  uneven.interpolate = true;
+
+  net::TableAxis unsorted;
+  unsorted.values = { 1.0, 0.0 };
+
+  net::TableAxis repeated;
+  repeated.values = { 0.0, 0.0, 1.0 };
+
+  net::TableAxis infinite;
+  infinite.values = { 0.0, std::numeric_limits< double >::infinity( ) };
+
+  for ( const net::TableAxis &axis : { uneven, unsorted, repeated, infinite } )
+  {
+
+    EXPECT_THROW( net::LookupTable::compileToTable( net, { bits, axis }, 1 ), std::runtime_error );
+
+  }
+
+  // an even grid written out by hand is fine, as is a single value
+  net::TableAxis even;
+  even.values      = { -1.0, -0.5, 0.0, 0.5, 1.0 };
+  even.interpolate = true;
+
+  net::TableAxis single;
+  single.values      = { 0.5 };
+  single.interpolate = true;
+
+  EXPECT_NO_THROW( net::LookupTable::compileToTable( net, { bits, single }, 1 ) );
+
+  net::LookupTable table = net::LookupTable::compileToTable( net, { bits, even }, 1 );
+
+  // NaN in either input gives NaN outputs, other inputs are unaffected
+  const double nan = std::numeric_limits< double >::quiet_NaN( );
+
+  std::vector< double > results;
+  table.lookupBatch( { nan, 0.25, 1.0, nan, 1.0, 0.25 }, &results );
+
+  ASSERT_EQ( 6u, results.size( ) );
+
+  for ( size_t o = 0; o < 4; ++o )
+  {
+
+    EXPECT_TRUE( std::isnan( results[ o ] ) );
+
+  }
+
+  double expected[ 2 ];
+  table.lookup( std::vector< double >( { 1.0, 0.25 } ).data( ), expected );
+
+  EXPECT_EQ( expected[ 0 ], results[ 4 ] );
+  EXPECT_EQ( expected[ 1 ], results[ 5 ] );
+  EXPECT_FALSE( std::isnan( expected[ 0 ] ) );
+
+}
+
+
+} // namespace
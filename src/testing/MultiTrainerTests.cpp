@@ -0,0 +1,196 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "MultiTrainer.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// net that records the sample numbers it trains on, with a
+// configurable cost per sample and an error that turns acceptable
+// after a given number of samples
+class RecordingNet : public net::Net
+{
+
+public:
+
+  RecordingNet(
+               unsigned      cost,
+               unsigned long doneAfter
+               )
+    : cost_     ( cost )
+    , doneAfter_( doneAfter )
+  {}
+
+  virtual
+  void feedForward ( const std::vector< double > &inputVals ) final
+  {
+
+    // uneven busy work, so tasks finish out of order and get stolen
+    volatile double sink = 0.0;
+
+    for ( unsigned i = 0; i < cost_; ++i )
+    {
+
+      sink = sink + i * 1.0e-9;
+
+    }
+
+    samples_.push_back( static_cast< unsigned long >( inputVals[ 0 ] ) );
+
+  }
+
+  virtual
+  void backProp ( const std::vector< double > & ) final {}
+
+  virtual
+  void getResults ( std::vector< double > *pResultVals ) const final { pResultVals->assign( 1, 0.0 ); }
+
+  virtual
+  double getAverageError ( ) final { return samples_.size( ) >= doneAfter_ ? 0.0 : 1.0; }
+
+  virtual
+  std::unique_ptr< net::Net > clone ( ) const final { return std::unique_ptr< net::Net >( new RecordingNet( *this ) ); }
+
+  const std::vector< unsigned long > &getSamples ( ) const { return samples_; }
+
+
+private:
+
+  unsigned                     cost_;
+  unsigned long                doneAfter_;
+  std::vector< unsigned long > samples_;
+
+};
+
+
+
+TEST( MultiTrainerTest, EveryNetSeesTheStreamOnce )
+{
+
+  // more nets than threads, costs from trivial to heavy and
+  // some nets finishing early, so batches hold fewer tasks
+  std::vector< std::unique_ptr< RecordingNet > > nets;
+
+  net::MultiTrainer trainer( 3, 8 );
+
+  for ( unsigned n = 0; n < 13; ++n )
+  {
+
+    unsigned long doneAfter = ( n % 4 == 3 ? 20 + n : 1000 );
+
+    nets.emplace_back( new RecordingNet( ( n * 7 % 13 ) * ( n * 7 % 13 ) * 200, doneAfter ) );
+    trainer.addNet( nets.back( ).get( ) );
+
+  }
+
+  unsigned long sample = 0;
+
+  std::vector< unsigned long > iterations = trainer.trainNets(
+                                                              [ & ]( ) { return std::vector< double >( 1, static_cast< double >( sample ) ); },
+                                                              [ & ]( ) { return std::vector< double >( 1, static_cast< double >( sample++ ) ); },
+                                                              0.5,
+                                                              100
+                                                              );
+
+  ASSERT_EQ( nets.size( ), iterations.size( ) );
+
+  for ( size_t n = 0; n < nets.size( ); ++n )
+  {
+
+    unsigned long expected = ( n % 4 == 3 ? 20 + n : 100 );
+
+    // each sample exactly once, in stream order
+    std::vector< unsigned long > stream( expected );
+
+    for ( unsigned long s = 0; s < expected; ++s )
+    {
+
+      stream[ s ] = s;
+
+    }
+
+    EXPECT_EQ( expected, iterations[ n ] );
+    EXPECT_EQ( stream, nets[ n ]->getSamples( ) );
+
+  }
+
+}
+
+
+
+TEST( MultiTrainerTest, MatchesSerialTraining )
+{
+
+  const std::vector< unsigned > hidden = { 2, 40, 5, 64, 3, 17, 9 };
+
+  std::vector< std::unique_ptr< net::ConnectedNet > > nets;
+  std::vector< std::unique_ptr< net::ConnectedNet > > serial;
+
+  net::MultiTrainer trainer( 2, 16 );
+
+  for ( unsigned n = 0; n < hidden.size( ); ++n )
+  {
+
+    net::ConnectedNet::seedWeights( 60 + n );
+    nets.emplace_back( new net::ConnectedNet( { 3, hidden[ n ], 2 } ) );
+
+    net::ConnectedNet::seedWeights( 60 + n );
+    serial.emplace_back( new net::ConnectedNet( { 3, hidden[ n ], 2 } ) );
+
+    trainer.addNet( nets.back( ).get( ) );
+
+  }
+
+  unsigned state = 60;
+
+  // 150 is not a whole number of batches
+  std::vector< unsigned long > iterations = trainer.trainNets(
+                                                              [ & ]( ) { return nettest::randomInputs( 3, &state ); },
+                                                              [ & ]( ) { return nettest::randomInputs( 2, &state ); },
+                                                              0.0,
+                                                              150
+                                                              );
+
+  for ( size_t n = 0; n < nets.size( ); ++n )
+  {
+
+    state = 60;
+
+    unsigned long serialIterations = serial[ n ]->trainNet(
+                                                           [ & ]( ) { return nettest::randomInputs( 3, &state ); },
+                                                           [ & ]( ) { return nettest::randomInputs( 2, &state ); },
+                                                           0.0,
+                                                           0,
+                                                           nullptr,
+                                                           150
+                                                           );
+
+    EXPECT_EQ( serialIterations, iterations[ n ] );
+
+    for ( unsigned layerNum = 1; layerNum < 3; ++layerNum )
+    {
+
+      std::vector< double > expected;
+      std::vector< double > weights;
+
+      serial[ n ]->getWeights( layerNum, &expected );
+      nets  [ n ]->getWeights( layerNum, &weights );
+
+      // the same arithmetic on the same samples, so bit for bit
+      EXPECT_EQ( expected, weights ) << "net " << n << " layer " << layerNum;
+
+    }
+
+  }
+
+}
+
+
+} // namespace
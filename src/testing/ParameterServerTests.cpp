@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ConnectedNet.hpp"
+#include "ParamProtocol.hpp"
+#include "ParameterServer.hpp"
+#include "Socket.hpp"
+
+
+namespace
+{
+
+
+// a reply's header and weights
+server::ParamHeader
+receive(
+        int                    fd,
+        std::vector< double > *pWeights
+        )
+{
+
+  server::ParamHeader header = { 0, 0, 0 };
+
+  EXPECT_TRUE( server::readAll( fd, &header, sizeof( header ) ) );
+
+  pWeights->resize( header.count );
+
+  EXPECT_TRUE( server::readAll( fd, pWeights->data( ), pWeights->size( ) * sizeof( double ) ) );
+
+  return header;
+
+}
+
+
+
+// a push of a { 1, 1, 1 } net: two layers of two values
+server::ParamHeader
+push(
+     int                          fd,
+     uint64_t                     baseVersion,
+     double                       error,
+     const std::vector< float >  &scales,
+     const std::vector< int8_t > &steps,
+     std::vector< double >       *pWeights
+     )
+{
+
+  server::ParamHeader header = { server::Push, 2, baseVersion };
+  server::PushStats   stats  = { 0, error };
+
+  EXPECT_TRUE( server::writeAll( fd, &header, sizeof( header ) ) );
+  EXPECT_TRUE( server::writeAll( fd, &stats,  sizeof( stats ) ) );
+  EXPECT_TRUE( server::writeAll( fd, scales.data( ), scales.size( ) * sizeof( float ) ) );
+  EXPECT_TRUE( server::writeAll( fd, steps.data( ), steps.size( ) ) );
+
+  return receive( fd, pWeights );
+
+}
+
+
+
+TEST( ParameterServerTest, StalenessDampingAndErrorFeedback )
+{
+
+  //
+  // one input neuron fed a tiny constant: its weight changes a
+  // thousand times less than its bias, far below one int8 step of
+  // the layer's scale. Only error feedback gets it to the server.
+  //
+  const double input     = 1.0e-3;
+  const size_t numRounds = 40;
+
+  net::ConnectedNet::seedWeights( 91 );
+
+  net::ConnectedNet serverNet( { 1, 1, 1 } );
+  net::ConnectedNet workerNet( serverNet );
+
+  std::vector< double > initial;
+  serverNet.getWeights( 1, &initial );
+
+  server::ParamOptions options;
+  options.address       = "tcp:127.0.0.1:" + std::to_string( 20000 + ::getpid( ) % 20000 );
+  options.numWorkers    = 2;
+  options.maxStaleness  = 1;
+  options.localSteps    = 8;
+  options.targetError   = 0.0;
+  options.maxSamples    = numRounds * options.localSteps;
+  options.acceptTimeout = 10.0;
+
+  server::ParameterServer server( options );
+  server::ParamStats      serverStats;
+
+  std::thread serving( [ & ]{ serverStats = server.train( &serverNet ); } );
+
+  // (retries until the server listens)
+  server::ParameterWorker worker( options );
+
+  int                other = server::connectAddress( options.address );
+  server::ParamHello hello;
+
+  ASSERT_TRUE( server::readAll( other, &hello, sizeof( hello ) ) );
+  EXPECT_EQ( 4u, hello.numValues );
+
+  //
+  // in the worker's fourth round (the weights at version 3) the
+  // other worker pushes once too stale and once within the limit
+  //
+  unsigned long         sample = 0;
+  std::vector< double > pulled;
+  std::vector< double > stale;
+  std::vector< double > damped;
+  server::ParamHeader   staleReply  = { 0, 0, 0 };
+  server::ParamHeader   dampedReply = { 0, 0, 0 };
+
+  auto inputFun = [ & ]( )
+                  {
+
+                    if ( sample++ == 3 * options.localSteps )
+                    {
+
+                      server::ParamHeader pull = { server::Pull, 0, 0 };
+
+                      EXPECT_TRUE( server::writeAll( other, &pull, sizeof( pull ) ) );
+                      EXPECT_EQ  ( 3u, receive( other, &pulled ).version );
+
+                      // an error of 0 would end training if it counted
+                      staleReply  = push( other, 0, 0.0, { 1.0f, 1.0f }, { 1, 1, 1, 1 }, &stale );
+                      dampedReply = push( other, 2, 1.0, { 0.0f, 0.25f }, { 0, 0, 4, -6 }, &damped );
+
+                      ::close( other );
+
+                    }
+
+                    return std::vector< double >( 1, input );
+
+                  };
+
+  server::ParamStats workerStats = worker.train( &workerNet, inputFun, [ ]{ return std::vector< double >( 1, 0.8 ); } );
+
+  serving.join( );
+
+  // three versions behind: dropped, the weights unchanged
+  EXPECT_EQ( server::Stale, staleReply.type );
+  EXPECT_EQ( 3u,            staleReply.version );
+  EXPECT_EQ( pulled,        stale );
+
+  // one version behind: applied at 1 / sqrt( 2 )
+  ASSERT_EQ( 4u, damped.size( ) );
+  EXPECT_EQ( server::Accepted, dampedReply.type );
+  EXPECT_EQ( 4u,               dampedReply.version );
+  EXPECT_EQ( pulled[ 0 ],      damped[ 0 ] );
+  EXPECT_EQ( pulled[ 1 ],      damped[ 1 ] );
+  EXPECT_DOUBLE_EQ( pulled[ 2 ] + 4 * ( 0.25 / std::sqrt( 2.0 ) ), damped[ 2 ] );
+  EXPECT_DOUBLE_EQ( pulled[ 3 ] - 6 * ( 0.25 / std::sqrt( 2.0 ) ), damped[ 3 ] );
+
+  // training ran to the sample limit
+  EXPECT_EQ( options.maxSamples, serverStats.samples );
+  EXPECT_EQ( numRounds + 1,      serverStats.pushes );
+  EXPECT_EQ( 1u,                 serverStats.stalePushes );
+  EXPECT_EQ( 2u,                 serverStats.numWorkers );
+  EXPECT_GT( serverStats.error,  0.0 );
+  EXPECT_EQ( 0u,                 workerStats.stalePushes );
+
+  //
+  // the input weight moved on the server (its bias about a thousand
+  // times as far), and the server ends where the worker did
+  //
+  std::vector< double > trained;
+  std::vector< double > served;
+
+  workerNet.getWeights( 1, &trained );
+  serverNet.getWeights( 1, &served );
+
+  EXPECT_GT  ( std::abs( served[ 0 ] - initial[ 0 ] ), 1.0e-4 );
+  EXPECT_NEAR( trained[ 0 ], served[ 0 ], 1.0e-6 );
+  EXPECT_NEAR( trained[ 1 ], served[ 1 ], 1.0e-3 );
+
+}
+
+
+
+TEST( ParameterServerTest, GivesUpOnMissingWorkers )
+{
+
+  net::ConnectedNet net( { 2, 3, 1 } );
+
+  server::ParamOptions options;
+  options.address       = "/tmp/netPsTest." + std::to_string( ::getpid( ) ) + ".sock";
+  options.numWorkers    = 2;
+  options.acceptTimeout = 0.2;
+
+  server::ParameterServer server( options );
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+
+  EXPECT_THROW( server.train( &net ), std::runtime_error );
+
+  double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now( ) - start ).count( );
+
+  EXPECT_GE( seconds, 0.2 );
+  EXPECT_LT( seconds, 5.0 );
+
+  // the socket file is gone again
+  EXPECT_NE( 0, ::access( options.address.c_str( ), F_OK ) );
+
+}
+
+
+} // namespace
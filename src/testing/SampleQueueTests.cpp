@@ -0,0 +1,284 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SamplePipeline.hpp"
+#include "SampleQueue.hpp"
+
+
+namespace
+{
+
+
+// values of sample i, distinct in every slot position
+void
+fillSample(
+           unsigned long i,
+           double       *inputs,
+           double       *targets
+           )
+{
+
+  inputs [ 0 ] = static_cast< double >( i );
+  inputs [ 1 ] = i + 0.5;
+  inputs [ 2 ] = -static_cast< double >( i );
+  targets[ 0 ] = 2.0 * i;
+
+}
+
+
+
+TEST( SampleQueueTest, LongStreamArrivesInOrder )
+{
+
+  const unsigned long numSamples = 200000;
+
+  // a single slot (every push waits for a pop), and a power of two
+  for ( size_t capacity : { 1u, 64u } )
+  {
+
+    net::SampleQueue queue( capacity, 3, 1 );
+
+    EXPECT_EQ( capacity, queue.getCapacity( ) );
+
+    std::thread producer( [ &queue, numSamples ]
+                         {
+
+                           double inputs[ 3 ];
+                           double targets[ 1 ];
+
+                           for ( unsigned long i = 0; i < numSamples; ++i )
+                           {
+
+                             fillSample( i, inputs, targets );
+                             queue.push( inputs, targets );
+
+                           }
+
+                           queue.close( );
+
+                         } );
+
+    double        expected[ 4 ];
+    unsigned long received   = 0;
+    unsigned long mismatches = 0;
+
+    while ( const double *sample = queue.front( ) )
+    {
+
+      fillSample( received, expected, expected + 3 );
+
+      for ( size_t v = 0; v < 4; ++v )
+      {
+
+        mismatches += ( sample[ v ] != expected[ v ] ? 1u : 0u );
+
+      }
+
+      queue.pop( );
+      ++received;
+
+    }
+
+    producer.join( );
+
+    net::QueueStats stats = queue.getStats( );
+
+    EXPECT_EQ( numSamples, received );
+    EXPECT_EQ( 0ul, mismatches );
+    EXPECT_EQ( numSamples, stats.pushed );
+    EXPECT_EQ( numSamples, stats.popped );
+    EXPECT_LE( stats.maxDepth, capacity );
+
+  }
+
+  // other capacities round up to a power of two
+  EXPECT_EQ( 8u, net::SampleQueue( 5, 1, 1 ).getCapacity( ) );
+
+}
+
+
+
+TEST( SampleQueueTest, DrainsAfterClose )
+{
+
+  net::SampleQueue queue( 8, 3, 1 );
+
+  double inputs[ 3 ];
+  double targets[ 1 ];
+
+  for ( unsigned long i = 0; i < 5; ++i )
+  {
+
+    fillSample( i, inputs, targets );
+    ASSERT_TRUE( queue.push( inputs, targets ) );
+
+  }
+
+  queue.close( );
+
+  // nothing more goes in, everything queued still comes out
+  EXPECT_FALSE( queue.push( inputs, targets ) );
+
+  for ( unsigned long i = 0; i < 5; ++i )
+  {
+
+    const double *sample = queue.front( );
+
+    ASSERT_NE( nullptr, sample );
+    EXPECT_EQ( static_cast< double >( i ), sample[ 0 ] );
+    EXPECT_EQ( 2.0 * i,                     sample[ 3 ] );
+
+    queue.pop( );
+
+  }
+
+  EXPECT_EQ( nullptr, queue.front( ) );
+  EXPECT_EQ( nullptr, queue.front( ) );
+
+}
+
+
+
+TEST( SampleQueueTest, FullQueueHoldsBackTheProducer )
+{
+
+  net::SampleQueue queue( 4, 3, 1 );
+
+  double inputs[ 3 ];
+  double targets[ 1 ];
+
+  for ( unsigned long i = 0; i < 4; ++i )
+  {
+
+    fillSample( i, inputs, targets );
+    ASSERT_TRUE( queue.push( inputs, targets ) );
+
+  }
+
+  std::atomic< int > pushed( 0 );
+
+  std::thread producer( [ & ]
+                       {
+
+                         double moreInputs[ 3 ];
+                         double moreTargets[ 1 ];
+
+                         fillSample( 4, moreInputs, moreTargets );
+                         pushed = queue.push( moreInputs, moreTargets ) ? 1 : -1;
+
+                       } );
+
+  // the fifth sample waits for a free slot
+  std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+
+  EXPECT_EQ( 0, pushed.load( ) );
+  EXPECT_EQ( 1ull, queue.getStats( ).producerStalls );
+
+  ASSERT_NE( nullptr, queue.front( ) );
+  queue.pop( );
+
+  producer.join( );
+
+  EXPECT_EQ( 1, pushed.load( ) );
+  EXPECT_EQ( 5ull, queue.getStats( ).pushed );
+
+  // a producer waiting on a full queue is released by close
+  std::thread blocked( [ & ]
+                      {
+
+                        pushed = queue.push( inputs, targets ) ? 1 : -1;
+
+                      } );
+
+  std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+  queue.close( );
+  blocked.join( );
+
+  EXPECT_EQ( -1, pushed.load( ) );
+
+  // the samples already queued are intact
+  for ( unsigned long i = 1; i < 5; ++i )
+  {
+
+    const double *sample = queue.front( );
+
+    ASSERT_NE( nullptr, sample );
+    EXPECT_EQ( static_cast< double >( i ), sample[ 0 ] );
+
+    queue.pop( );
+
+  }
+
+  EXPECT_EQ( nullptr, queue.front( ) );
+
+}
+
+
+
+TEST( SampleQueueTest, GeneratorErrorReachesTheConsumer )
+{
+
+  unsigned long generated = 0;
+  unsigned long target    = 0;
+
+  // the generator fails on its eleventh sample
+  net::SamplePipeline pipeline(
+                               [ &generated ]( )
+                               {
+
+                                 if ( generated == 10 )
+                                 {
+
+                                   throw std::runtime_error( "generator failed" );
+
+                                 }
+
+                                 return std::vector< double >( 2, static_cast< double >( generated++ ) );
+
+                               },
+                               [ &target ]( ) { return std::vector< double >( 1, static_cast< double >( target++ ) ); },
+                               4
+                               );
+
+  net::TrainFun inputFun  = pipeline.getInputFun( );
+  net::TrainFun targetFun = pipeline.getTargetFun( );
+
+  // the samples generated before the failure arrive first, in order
+  for ( unsigned long i = 0; i < 10; ++i )
+  {
+
+    EXPECT_EQ( std::vector< double >( 2, static_cast< double >( i ) ), inputFun( ) );
+    EXPECT_EQ( std::vector< double >( 1, static_cast< double >( i ) ), targetFun( ) );
+
+  }
+
+  std::string message;
+
+  try
+  {
+
+    inputFun( );
+
+  }
+  catch ( const std::runtime_error &error )
+  {
+
+    message = error.what( );
+
+  }
+
+  EXPECT_EQ( "generator failed", message );
+
+  // and stays reported
+  EXPECT_THROW( inputFun( ), std::runtime_error );
+
+}
+
+
+} // namespace
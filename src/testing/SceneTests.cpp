@@ -0,0 +1,462 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Intersections.hpp"
+#include "Scene.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+typedef glm::tvec3< double > Vec3;
+
+const double INF = std::numeric_limits< double >::infinity( );
+
+
+// primitive kept by the test to intersect without the hierarchy
+struct Shape
+{
+
+  enum Type
+  {
+    Sphere,
+    Triangle,
+    Box
+  };
+
+  Type   type;
+  Vec3   a; // sphere center, triangle vertex, box min
+  Vec3   b; // triangle vertex, box max
+  Vec3   c; // triangle vertex
+  double radius;
+
+};
+
+
+
+// ray parameter and normal of the hit with one shape (t is INF on a miss),
+// for rays starting outside every shape
+double
+intersectShape(
+               const Shape &shape,
+               const Vec3  &p,
+               const Vec3  &d,
+               Vec3        *pNormal
+               )
+{
+
+  switch ( shape.type )
+  {
+
+  case Shape::Sphere:
+  {
+
+    // | p + t d - center |^2 = radius^2, nearest root
+    Vec3   oc   = p - shape.a;
+    double a    = glm::dot( d, d );
+    double b    = 2.0 * glm::dot( oc, d );
+    double c    = glm::dot( oc, oc ) - shape.radius * shape.radius;
+    double disc = b * b - 4.0 * a * c;
+
+    if ( disc < 0.0 )
+    {
+
+      return INF;
+
+    }
+
+    double t = ( -b - std::sqrt( disc ) ) / ( 2.0 * a );
+
+    if ( t < 0.0 )
+    {
+
+      return INF;
+
+    }
+
+    *pNormal = ( p + d * t - shape.a ) / shape.radius;
+    return t;
+
+  }
+
+  case Shape::Triangle:
+  {
+
+    // plane hit, then the hit point must be on the inner side of every edge
+    Vec3   n     = glm::cross( shape.b - shape.a, shape.c - shape.a );
+    double denom = glm::dot( n, d );
+
+    if ( std::abs( denom ) < 1.0e-12 )
+    {
+
+      return INF;
+
+    }
+
+    double t = glm::dot( n, shape.a - p ) / denom;
+    Vec3   x = p + d * t;
+
+    if ( t < 0.0
+         || glm::dot( glm::cross( shape.b - shape.a, x - shape.a ), n ) < 0.0
+         || glm::dot( glm::cross( shape.c - shape.b, x - shape.b ), n ) < 0.0
+         || glm::dot( glm::cross( shape.a - shape.c, x - shape.c ), n ) < 0.0 )
+    {
+
+      return INF;
+
+    }
+
+    *pNormal = glm::normalize( n );
+    return t;
+
+  }
+
+  default:
+  {
+
+    // latest entry over the three slabs must come before the earliest exit
+    double tEnter = -INF;
+    double tExit  = INF;
+    int    axis   = 0;
+
+    for ( int i = 0; i < 3; ++i )
+    {
+
+      double t0 = ( shape.a[ i ] - p[ i ] ) / d[ i ];
+      double t1 = ( shape.b[ i ] - p[ i ] ) / d[ i ];
+
+      if ( std::min( t0, t1 ) > tEnter )
+      {
+
+        tEnter = std::min( t0, t1 );
+        axis   = i;
+
+      }
+
+      tExit = std::min( tExit, std::max( t0, t1 ) );
+
+    }
+
+    if ( tEnter > tExit || tEnter < 0.0 )
+    {
+
+      return INF;
+
+    }
+
+    *pNormal             = Vec3( 0.0 );
+    ( *pNormal )[ axis ] = ( d[ axis ] > 0.0 ? -1.0 : 1.0 );
+    return tEnter;
+
+  }
+
+  } // switch
+
+}
+
+
+
+Vec3
+randomPoint(
+            double    scale,
+            unsigned *pState
+            )
+{
+
+  std::vector< double > values = nettest::randomInputs( 3, pState );
+
+  return Vec3( values[ 0 ], values[ 1 ], values[ 2 ] ) * scale;
+
+}
+
+
+
+// every lane of intersectSpherePacket against intersectSphere, with the
+// unused lanes of the last packet repeating its final ray (as the
+// renderer pads them)
+template< typename T, unsigned N >
+void
+expectPacketMatchesScalar( const std::vector< std::pair< Vec3, Vec3 > > &rays )
+{
+
+  hit::RayPacket< T, N > packet;
+  hit::HitPacket< T, N > hits;
+
+  for ( size_t first = 0; first < rays.size( ); first += N )
+  {
+
+    for ( unsigned lane = 0; lane < N; ++lane )
+    {
+
+      const std::pair< Vec3, Vec3 > &ray = rays[ std::min( first + lane, rays.size( ) - 1 ) ];
+
+      packet.ox[ lane ] = static_cast< T >( ray.first.x );
+      packet.oy[ lane ] = static_cast< T >( ray.first.y );
+      packet.oz[ lane ] = static_cast< T >( ray.first.z );
+
+      packet.dx[ lane ] = static_cast< T >( ray.second.x );
+      packet.dy[ lane ] = static_cast< T >( ray.second.y );
+      packet.dz[ lane ] = static_cast< T >( ray.second.z );
+
+    }
+
+    hit::intersectSpherePacket( packet, &hits );
+
+    for ( unsigned lane = 0; lane < N; ++lane )
+    {
+
+      glm::tvec4< T > expected = hit::intersectSphere(
+                                                      glm::tvec3< T >( packet.ox[ lane ], packet.oy[ lane ], packet.oz[ lane ] ),
+                                                      glm::tvec3< T >( packet.dx[ lane ], packet.dy[ lane ], packet.dz[ lane ] )
+                                                      );
+
+      EXPECT_EQ( expected.w, hits.t [ lane ] ) << "ray " << first + lane;
+      EXPECT_EQ( expected.x, hits.nx[ lane ] ) << "ray " << first + lane;
+      EXPECT_EQ( expected.y, hits.ny[ lane ] ) << "ray " << first + lane;
+      EXPECT_EQ( expected.z, hits.nz[ lane ] ) << "ray " << first + lane;
+
+    }
+
+  }
+
+}
+
+
+
+TEST( SceneTest, SpherePacketMatchesScalar )
+{
+
+  std::vector< std::pair< Vec3, Vec3 > > rays = {
+    { Vec3( 0.0, 0.0, -5.0 ),          Vec3( 0.0, 0.0, 1.0 ) },                     // hit
+    { Vec3( 0.3, -0.2, -4.0 ),         glm::normalize( Vec3( 0.05, 0.02, 1.0 ) ) }, // hit off center
+    { Vec3( -3.0, 1.0, 0.0 ),          Vec3( 1.0, 0.0, 0.0 ) },                     // tangent
+    { Vec3( -3.0, 1.0 + 1.0e-7, 0.0 ), Vec3( 1.0, 0.0, 0.0 ) },                     // grazing (single root)
+    { Vec3( -3.0, 2.0, 0.0 ),          Vec3( 1.0, 0.0, 0.0 ) },                     // miss
+    { Vec3( 3.0, 0.0, 0.0 ),           Vec3( 1.0, 0.0, 0.0 ) },                     // sphere behind
+    { Vec3( 0.0, 0.0, 0.2 ),           Vec3( 0.0, 1.0, 0.0 ) },                     // origin inside
+    { Vec3( 0.0, 0.0, 0.0 ),           Vec3( 1.0, 0.0, 0.0 ) },                     // origin at the center
+    { Vec3( 0.0, 0.0, -3.0 ),          Vec3( 0.2, -0.4, 1.6 ) }                     // unnormalized, as the renderer sends
+  };
+
+  unsigned state = 53;
+
+  for ( unsigned r = 0; r < 70; ++r )
+  {
+
+    Vec3 p = randomPoint( 3.0, &state );
+    Vec3 d = randomPoint( 1.0, &state );
+
+    rays.push_back( { p, d } );
+
+  }
+
+  // 79 rays, so the last packet of every width has unused lanes
+  expectPacketMatchesScalar< float,  4  >( rays );
+  expectPacketMatchesScalar< float,  8  >( rays );
+  expectPacketMatchesScalar< float,  16 >( rays );
+  expectPacketMatchesScalar< double, 4  >( rays );
+  expectPacketMatchesScalar< double, 8  >( rays );
+  expectPacketMatchesScalar< double, 16 >( rays );
+
+}
+
+
+
+TEST( SceneTest, HemisphereBatchIsCosineWeighted )
+{
+
+  const size_t count = 100000;
+
+  unsigned state = 54;
+
+  std::vector< double > x( count ), y( count ), z( count );
+  std::vector< double > splitX( count ), splitY( count ), splitZ( count );
+
+  // the second normal takes the basis' fallback axis
+  for ( const Vec3 &normal : { Vec3( 0.0, 0.0, -1.0 ), Vec3( 0.0, 1.0, 0.0 ), glm::normalize( randomPoint( 1.0, &state ) ) } )
+  {
+
+    hit::cosine_sample_hemisphere_batch( normal, 7, 100, count, x.data( ), y.data( ), z.data( ) );
+
+    double cosSum = 0.0;
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+
+      Vec3   dir = Vec3( x[ i ], y[ i ], z[ i ] );
+      double cos = glm::dot( dir, normal );
+
+      EXPECT_NEAR( 1.0, glm::length( dir ), 1.0e-12 );
+      EXPECT_GE  ( cos, -1.0e-12 );
+
+      cosSum += cos;
+
+    }
+
+    // E[ cos ] = 2/3 for a cosine weighted hemisphere (standard
+    // deviation of the mean about 7.5e-4 here)
+    EXPECT_NEAR( 2.0 / 3.0, cosSum / count, 3.0e-3 );
+
+    // counters, not call order, decide the samples
+    const size_t half = count / 2;
+
+    hit::cosine_sample_hemisphere_batch( normal, 7, 100 + static_cast< std::uint32_t >( half ), count - half,
+                                         splitX.data( ) + half, splitY.data( ) + half, splitZ.data( ) + half );
+    hit::cosine_sample_hemisphere_batch( normal, 7, 100, half, splitX.data( ), splitY.data( ), splitZ.data( ) );
+
+    EXPECT_EQ( x, splitX );
+    EXPECT_EQ( y, splitY );
+    EXPECT_EQ( z, splitZ );
+
+    // another stream gives other directions
+    hit::cosine_sample_hemisphere_batch( normal, 8, 100, count, splitX.data( ), splitY.data( ), splitZ.data( ) );
+
+    EXPECT_NE( x, splitX );
+
+  }
+
+  // single precision
+  std::vector< float > fx( 1000 ), fy( 1000 ), fz( 1000 );
+
+  hit::cosine_sample_hemisphere_batch( glm::vec3( 1.0f, 0.0f, 0.0f ), 3, 0, 1000, fx.data( ), fy.data( ), fz.data( ) );
+
+  for ( size_t i = 0; i < 1000; ++i )
+  {
+
+    EXPECT_NEAR( 1.0f, glm::length( glm::vec3( fx[ i ], fy[ i ], fz[ i ] ) ), 1.0e-5f );
+    EXPECT_GE  ( fx[ i ], -1.0e-6f );
+
+  }
+
+}
+
+
+
+TEST( SceneTest, HierarchyMatchesBruteForce )
+{
+
+  unsigned             state = 51;
+  std::vector< Shape > shapes;
+  hit::Scene< double > scene;
+
+  for ( unsigned i = 0; i < 300; ++i )
+  {
+
+    Vec3  center = randomPoint( 10.0, &state );
+    Shape shape  = { static_cast< Shape::Type >( i % 3 ), center, center, center, 0.0 };
+
+    switch ( shape.type )
+    {
+
+    case Shape::Sphere:
+      shape.radius = 0.2 + std::abs( randomPoint( 0.5, &state ).x );
+      scene.addSphere( shape.a, shape.radius );
+      break;
+
+    case Shape::Triangle:
+      shape.b = center + randomPoint( 1.0, &state );
+      shape.c = center + randomPoint( 1.0, &state );
+      scene.addTriangle( shape.a, shape.b, shape.c );
+      break;
+
+    default:
+    {
+
+      Vec3 extent = randomPoint( 1.0, &state );
+      shape.b     = center + Vec3( std::abs( extent.x ), std::abs( extent.y ), std::abs( extent.z ) ) + Vec3( 0.1 );
+      scene.addBox( shape.a, shape.b );
+      break;
+
+    }
+
+    } // switch
+
+    shapes.push_back( shape );
+
+  }
+
+  scene.build( );
+
+  EXPECT_EQ( shapes.size( ), scene.getNumPrimitives( ) );
+  EXPECT_GT( scene.getNumNodes( ), 1u );
+
+  unsigned numHits = 0;
+
+  // rays from outside the scene towards random points inside it
+  for ( unsigned r = 0; r < 2000; ++r )
+  {
+
+    Vec3 p = glm::normalize( randomPoint( 1.0, &state ) ) * 30.0;
+    Vec3 d = randomPoint( 12.0, &state ) - p;
+
+    double closest = INF;
+    Vec3   normal( 0.0 );
+
+    for ( const Shape &shape : shapes )
+    {
+
+      Vec3   shapeNormal;
+      double t = intersectShape( shape, p, d, &shapeNormal );
+
+      if ( t < closest )
+      {
+
+        closest = t;
+        normal  = shapeNormal;
+
+      }
+
+    }
+
+    glm::tvec4< double > result = scene.intersect( p, d );
+
+    if ( closest == INF )
+    {
+
+      EXPECT_EQ( INF, result.w );
+      continue;
+
+    }
+
+    ++numHits;
+
+    EXPECT_NEAR( closest,  result.w, 1.0e-9 );
+    EXPECT_NEAR( normal.x, result.x, 1.0e-9 );
+    EXPECT_NEAR( normal.y, result.y, 1.0e-9 );
+    EXPECT_NEAR( normal.z, result.z, 1.0e-9 );
+
+  }
+
+  // enough of both outcomes to mean something
+  EXPECT_GT( numHits, 200u );
+  EXPECT_LT( numHits, 1800u );
+
+}
+
+
+
+TEST( SceneTest, EmptySceneMisses )
+{
+
+  hit::Scene< float > scene;
+
+  scene.build( );
+
+  glm::vec4 result = scene.intersect( glm::vec3( 0.0f, 0.0f, -5.0f ), glm::vec3( 0.0f, 0.0f, 1.0f ) );
+
+  EXPECT_EQ( std::numeric_limits< float >::infinity( ), result.w );
+  EXPECT_EQ( 0.0f, result.x );
+
+}
+
+
+} // namespace
@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "Softmax.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+TEST( SoftmaxTest, KernelsMatchDefinition )
+{
+
+  unsigned state = 91;
+
+  // counts around the vector widths, logits that would overflow
+  // exp, and one whose probability underflows
+  for ( size_t count : { 1u, 3u, 8u, 13u, 37u } )
+  {
+
+    std::vector< double > logits = nettest::randomInputs( count, &state );
+
+    for ( double &logit : logits )
+    {
+
+      logit = 700.0 + 30.0 * logit;
+
+    }
+
+    if ( count > 2 )
+    {
+
+      logits[ 1 ] = -1000.0;
+
+    }
+
+    std::vector< double > targets( count, 0.0 );
+    targets[ count / 2 ] = 1.0;
+
+    double largest = *std::max_element( logits.begin( ), logits.end( ) );
+    double total   = 0.0;
+
+    for ( double logit : logits )
+    {
+
+      total += std::exp( logit - largest );
+
+    }
+
+    double logSumExp = largest + std::log( total );
+
+    std::vector< double > probs( count );
+    std::vector< double > gradients( count );
+
+    double result = net::Softmax::forward( count, logits.data( ), probs.data( ) );
+    double loss   = net::Softmax::crossEntropy( count, logits.data( ), result, probs.data( ), targets.data( ), gradients.data( ) );
+
+    EXPECT_NEAR( logSumExp, result, 1.0e-12 * std::abs( logSumExp ) );
+
+    // the loss from the logits, even where the probability underflows
+    EXPECT_NEAR( logSumExp - logits[ count / 2 ], loss, 1.0e-9 * std::max( 1.0, loss ) );
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+
+      double prob = std::exp( logits[ i ] - logSumExp );
+
+      EXPECT_NEAR( prob,                probs[ i ],     1.0e-12 );
+      EXPECT_NEAR( targets[ i ] - prob, gradients[ i ], 1.0e-12 );
+
+    }
+
+  }
+
+}
+
+
+
+TEST( SoftmaxTest, TrainingMatchesReference )
+{
+
+  net::ConnectedNet::seedWeights( 92 );
+
+  net::ConnectedNet net( { 4, 10, 6 } );
+  net.setOutputHead( net::OutputHead::Softmax );
+
+  nettest::ReferenceNet reference( net );
+  net::LearningParams   params = net.getLearningParams( );
+  unsigned              state  = 92;
+
+  for ( unsigned s = 0; s < 100; ++s )
+  {
+
+    std::vector< double > inputs = nettest::randomInputs( 4, &state );
+    std::vector< double > targets( 6, 0.0 );
+
+    targets[ s % 6 ] = 1.0;
+
+    net.feedForward( inputs );
+    net.backProp   ( targets );
+
+    reference.feedForward( inputs );
+    reference.backProp( targets, params );
+
+  }
+
+  for ( unsigned layerNum = 1; layerNum < 3; ++layerNum )
+  {
+
+    std::vector< double > weights;
+    net.getWeights( layerNum, &weights );
+
+    const std::vector< double > &expected = reference.getWeights( layerNum );
+
+    ASSERT_EQ( expected.size( ), weights.size( ) );
+
+    for ( size_t i = 0; i < weights.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], weights[ i ], 1.0e-10 );
+
+    }
+
+  }
+
+}
+
+
+} // namespace
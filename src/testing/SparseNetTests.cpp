@@ -0,0 +1,275 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "SparseNet.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+// fraction of the non-bias weights of one layer that are zero
+double
+zeroFraction(
+             const net::ConnectedNet &net,
+             unsigned                 layerNum
+             )
+{
+
+  std::vector< unsigned > topology = net.getTopology( );
+  std::vector< double >   weights;
+
+  net.getWeights( layerNum, &weights );
+
+  size_t numCols  = topology[ layerNum - 1 ] + 1;
+  size_t numZeros = 0;
+
+  for ( size_t i = 0; i < weights.size( ); ++i )
+  {
+
+    if ( i % numCols != numCols - 1 && weights[ i ] == 0.0 )
+    {
+
+      ++numZeros;
+
+    }
+
+  }
+
+  return numZeros * 1.0 / ( weights.size( ) - weights.size( ) / numCols );
+
+}
+
+
+
+void
+expectSameOutputs(
+                  net::SparseNet          *pSparse,
+                  const net::ConnectedNet &dense,
+                  unsigned                 numSamples,
+                  unsigned                *pState
+                  )
+{
+
+  unsigned numInputs = dense.getTopology( ).front( );
+
+  for ( unsigned s = 0; s < numSamples; ++s )
+  {
+
+    std::vector< double > inputs   = nettest::randomInputs( numInputs, pState );
+    std::vector< double > expected = nettest::referenceForward( dense, inputs );
+    std::vector< double > results;
+
+    pSparse->feedForward( inputs );
+    pSparse->getResults( &results );
+
+    ASSERT_EQ( expected.size( ), results.size( ) );
+
+    for ( size_t i = 0; i < results.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], results[ i ], 1.0e-12 );
+
+    }
+
+  }
+
+}
+
+
+
+TEST( SparseNetTest, PrunedSparseMatchesDense )
+{
+
+  net::ConnectedNet::seedWeights( 31 );
+
+  net::ConnectedNet net( { 6, 20, 10, 3 } );
+  unsigned          state = 31;
+
+  for ( unsigned s = 0; s < 200; ++s )
+  {
+
+    net.feedForward( nettest::randomInputs( 6, &state ) );
+    net.backProp   ( nettest::randomInputs( 3, &state ) );
+
+  }
+
+  net::PruneOptions options;
+  options.targetSparsity = 0.6;
+
+  std::vector< double > sparsities = net::pruneNet( &net, options );
+
+  ASSERT_EQ( 3u, sparsities.size( ) );
+
+  size_t numWeights = 0;
+
+  for ( unsigned layerNum = 1; layerNum < 4; ++layerNum )
+  {
+
+    EXPECT_DOUBLE_EQ( zeroFraction( net, layerNum ), sparsities[ layerNum - 1 ] );
+    EXPECT_NEAR( 0.6, sparsities[ layerNum - 1 ], 0.05 );
+
+    std::vector< double > weights;
+    net.getWeights( layerNum, &weights );
+
+    for ( double weight : weights )
+    {
+
+      numWeights += ( weight != 0.0 ? 1u : 0u );
+
+    }
+
+  }
+
+  net::SparseNet sparse( net );
+
+  EXPECT_EQ( numWeights, sparse.getNumWeights( ) );
+
+  expectSameOutputs( &sparse, net, 20, &state );
+
+}
+
+
+
+TEST( SparseNetTest, SoftmaxHeadMatchesDense )
+{
+
+  net::ConnectedNet::seedWeights( 32 );
+
+  net::ConnectedNet net( { 4, 12, 5 } );
+  unsigned          state = 32;
+
+  net.setOutputHead( net::OutputHead::Softmax );
+
+  net::SparseNet sparse( net );
+
+  expectSameOutputs( &sparse, net, 10, &state );
+
+  //
+  // with nothing pruned one training step on each net must give the
+  // same weights (cross entropy gradients, not tanh RMS ones)
+  //
+  std::vector< double > inputs  = nettest::randomInputs( 4, &state );
+  std::vector< double > targets = { 0.0, 0.0, 1.0, 0.0, 0.0 };
+
+  sparse.feedForward( inputs );
+  sparse.backProp   ( targets );
+
+  net.feedForward( inputs );
+  net.backProp   ( targets );
+
+  net::ConnectedNet copy( { 4, 12, 5 } );
+  copy.setOutputHead( net::OutputHead::Softmax );
+  sparse.copyWeightsTo( &copy );
+
+  for ( unsigned layerNum = 1; layerNum < 3; ++layerNum )
+  {
+
+    std::vector< double > expected;
+    std::vector< double > weights;
+
+    net.getWeights ( layerNum, &expected );
+    copy.getWeights( layerNum, &weights );
+
+    ASSERT_EQ( expected.size( ), weights.size( ) );
+
+    for ( size_t i = 0; i < weights.size( ); ++i )
+    {
+
+      EXPECT_NEAR( expected[ i ], weights[ i ], 1.0e-12 );
+
+    }
+
+  }
+
+  // a tanh net can not take the softmax net's weights
+  net::ConnectedNet tanhNet( { 4, 12, 5 } );
+
+  EXPECT_THROW( sparse.copyWeightsTo( &tanhNet ), std::runtime_error );
+
+}
+
+
+
+TEST( SparseNetTest, FineTuningKeepsPrunedWeights )
+{
+
+  net::ConnectedNet::seedWeights( 33 );
+
+  net::ConnectedNet net( { 5, 16, 2 } );
+  unsigned          state = 33;
+
+  net::PruneOptions options;
+  options.targetSparsity = 0.5;
+
+  net::pruneNet( &net, options );
+
+  // a bias that happens to be 0.0 must still train
+  std::vector< double > weights;
+  net.getWeights( 1, &weights );
+  weights[ 5 ] = 0.0;
+  net.setWeights( 1, weights, true );
+
+  net::SparseNet sparse( net );
+
+  for ( unsigned s = 0; s < 300; ++s )
+  {
+
+    sparse.feedForward( nettest::randomInputs( 5, &state ) );
+    sparse.backProp   ( nettest::randomInputs( 2, &state ) );
+
+  }
+
+  net::ConnectedNet tuned( { 5, 16, 2 } );
+  sparse.copyWeightsTo( &tuned );
+
+  for ( unsigned layerNum = 1; layerNum < 3; ++layerNum )
+  {
+
+    std::vector< double > before;
+    std::vector< double > after;
+
+    net.getWeights  ( layerNum, &before );
+    tuned.getWeights( layerNum, &after );
+
+    bool   changed = false;
+    size_t numCols = layerNum == 1 ? 6 : 17;
+
+    for ( size_t i = 0; i < before.size( ); ++i )
+    {
+
+      if ( before[ i ] == 0.0 )
+      {
+
+        if ( i % numCols == numCols - 1 )
+        {
+
+          EXPECT_NE( 0.0, after[ i ] );
+
+        }
+        else
+        {
+
+          EXPECT_EQ( 0.0, after[ i ] );
+
+        }
+
+      }
+
+      changed = changed || ( before[ i ] != after[ i ] );
+
+    }
+
+    EXPECT_TRUE( changed );
+
+  }
+
+  expectSameOutputs( &sparse, tuned, 10, &state );
+
+}
+
+
+} // namespace
@@ -0,0 +1,271 @@
+// TestNets.hpp
+//
+// Reference results for the unit tests, computed straight from the
+// definitions with plain loops (none of the library's kernels), so
+// the optimized paths are checked against something independent.
+//
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+
+
+namespace nettest
+{
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief referenceLayer - tanh (or softmax) of W * x + b for one
+///        weight matrix in the ConnectedNet::getWeights layout
+////////////////////////////////////////////////////////////////////
+inline
+std::vector< double >
+referenceLayer(
+               const std::vector< double > &weights,
+               const std::vector< double > &inputs,
+               bool                         softmax
+               )
+{
+
+  size_t                numCols = inputs.size( ) + 1;
+  size_t                numRows = weights.size( ) / numCols;
+  std::vector< double > outputs( numRows );
+
+  for ( size_t r = 0; r < numRows; ++r )
+  {
+
+    double sum = weights[ r * numCols + numCols - 1 ];
+
+    for ( size_t c = 0; c + 1 < numCols; ++c )
+    {
+
+      sum += weights[ r * numCols + c ] * inputs[ c ];
+
+    }
+
+    outputs[ r ] = ( softmax ? sum : std::tanh( sum ) );
+
+  }
+
+  if ( softmax )
+  {
+
+    double largest = *std::max_element( outputs.begin( ), outputs.end( ) );
+    double total   = 0.0;
+
+    for ( double &output : outputs )
+    {
+
+      output = std::exp( output - largest );
+      total += output;
+
+    }
+
+    for ( double &output : outputs )
+    {
+
+      output /= total;
+
+    }
+
+  }
+
+  return outputs;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief referenceForward - a net's outputs for one sample from
+///        its weights
+////////////////////////////////////////////////////////////////////
+inline
+std::vector< double >
+referenceForward(
+                 const net::ConnectedNet     &net,
+                 const std::vector< double > &inputs
+                 )
+{
+
+  std::vector< unsigned > topology = net.getTopology( );
+  std::vector< double >   values   = inputs;
+  std::vector< double >   weights;
+
+  for ( unsigned layerNum = 1; layerNum < topology.size( ); ++layerNum )
+  {
+
+    bool softmax = ( layerNum + 1 == topology.size( )
+                     && net.getOutputHead( ) == net::OutputHead::Softmax );
+
+    net.getWeights( layerNum, &weights );
+    values = referenceLayer( weights, values, softmax );
+
+  }
+
+  return values;
+
+}
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief The ReferenceNet class
+///
+///        A net's weights trained by plain per weight backprop with
+///        momentum (every gradient from the weights before the
+///        step), to compare the net's own training with
+///
+////////////////////////////////////////////////////////////////////
+class ReferenceNet
+{
+
+public:
+
+  explicit
+  ReferenceNet( const net::ConnectedNet &net )
+    : softmax_( net.getOutputHead( ) == net::OutputHead::Softmax )
+  {
+
+    for ( unsigned layerNum = 1; layerNum < net.getTopology( ).size( ); ++layerNum )
+    {
+
+      std::vector< double > weights;
+      net.getWeights( layerNum, &weights );
+
+      weights_.push_back( weights );
+      deltas_.push_back( std::vector< double >( weights.size( ), 0.0 ) );
+
+    }
+
+  }
+
+
+  std::vector< double >
+  feedForward( const std::vector< double > &inputs )
+  {
+
+    outputs_ = { inputs };
+
+    for ( size_t l = 0; l < weights_.size( ); ++l )
+    {
+
+      outputs_.push_back( referenceLayer( weights_[ l ], outputs_.back( ), softmax_ && l + 1 == weights_.size( ) ) );
+
+    }
+
+    return outputs_.back( );
+
+  }
+
+
+  void
+  backProp(
+           const std::vector< double > &targets,
+           const net::LearningParams   &params
+           )
+  {
+
+    // output gradients: cross entropy for softmax, RMS through tanh otherwise
+    std::vector< double > gradients = outputs_.back( );
+
+    for ( size_t n = 0; n < gradients.size( ); ++n )
+    {
+
+      double output = gradients[ n ];
+
+      gradients[ n ] = ( softmax_ ? targets[ n ] - output : ( targets[ n ] - output ) * ( 1.0 - output * output ) );
+
+    }
+
+    for ( size_t l = weights_.size( ); l-- > 0; )
+    {
+
+      std::vector< double >       &weights = weights_[ l ];
+      const std::vector< double > &inputs  = outputs_[ l ];
+      size_t                       numCols = inputs.size( ) + 1;
+      std::vector< double >        inputGradients( inputs.size( ), 0.0 );
+
+      for ( size_t r = 0; r < gradients.size( ); ++r )
+      {
+
+        for ( size_t c = 0; c < numCols; ++c )
+        {
+
+          double  input  = ( c + 1 < numCols ? inputs[ c ] : 1.0 );
+          double &weight = weights[ r * numCols + c ];
+          double &delta  = deltas_[ l ][ r * numCols + c ];
+
+          if ( c + 1 < numCols )
+          {
+
+            inputGradients[ c ] += weight * gradients[ r ];
+
+          }
+
+          delta   = params.eta * input * gradients[ r ] + params.alpha * delta;
+          weight += delta;
+
+        }
+
+      }
+
+      for ( size_t c = 0; c < inputs.size( ); ++c )
+      {
+
+        inputGradients[ c ] *= 1.0 - inputs[ c ] * inputs[ c ];
+
+      }
+
+      gradients = inputGradients;
+
+    }
+
+  }
+
+
+  const std::vector< double > &getWeights ( unsigned layerNum ) const { return weights_[ layerNum - 1 ]; }
+
+
+private:
+
+  bool                                 softmax_;
+  std::vector< std::vector< double > > weights_;
+  std::vector< std::vector< double > > deltas_;
+  std::vector< std::vector< double > > outputs_;
+
+};
+
+
+
+////////////////////////////////////////////////////////////////////
+/// \brief randomInputs - count values in [-1, 1) from a fixed
+///        sequence (no library generator involved)
+////////////////////////////////////////////////////////////////////
+inline
+std::vector< double >
+randomInputs(
+             size_t    count,
+             unsigned *pState
+             )
+{
+
+  std::vector< double > values( count );
+
+  for ( double &value : values )
+  {
+
+    *pState = *pState * 1664525u + 1013904223u;
+    value   = ( *pState >> 8 ) / 8388608.0 - 1.0;
+
+  }
+
+  return values;
+
+}
+
+
+} // namespace nettest
@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "TestNets.hpp"
+#include "ThresholdClassifier.hpp"
+
+
+namespace
+{
+
+
+TEST( ThresholdClassifierTest, DecisionsMatchNetOutputs )
+{
+
+  net::ConnectedNet::seedWeights( 111 );
+
+  net::ConnectedNet net( { 4, 16, 12, 2 } );
+
+  //
+  // make it look trained: one saturated last hidden neuron carries
+  // most of output 1's weight, so most samples are decided after a
+  // neuron or two and only those near the boundary need the rest
+  //
+  std::vector< double > hidden;
+  std::vector< double > output;
+
+  net.getWeights( 2, &hidden );
+  net.getWeights( 3, &output );
+
+  for ( size_t c = 0; c < 17; ++c )
+  {
+
+    hidden[ 5 * 17 + c ] *= 8.0;
+
+  }
+
+  for ( size_t c = 0; c < 12; ++c )
+  {
+
+    output[ 13 + c ] *= ( c == 5 ? 1.0 : 0.3 );
+
+  }
+
+  output[ 13 + 5 ] = 1.0;
+
+  net.setWeights( 2, hidden );
+  net.setWeights( 3, output );
+
+  const size_t numSamples = 300;
+  const double threshold  = 0.1;
+
+  unsigned              state  = 111;
+  std::vector< double > inputs = nettest::randomInputs( 4 * numSamples, &state );
+
+  // the default probe, a small one, and the whole layer
+  for ( unsigned probeNeurons : { 0u, 3u, 12u } )
+  {
+
+    net::ThresholdClassifier classifier( net, 1, threshold, probeNeurons );
+    net::ThresholdStats      singleStats;
+    net::ThresholdStats      batchStats;
+    std::vector< char >      above;
+    size_t                   numAbove = 0;
+
+    classifier.classifyBatch( inputs, &above, &batchStats );
+
+    ASSERT_EQ( numSamples, above.size( ) );
+
+    for ( size_t s = 0; s < numSamples; ++s )
+    {
+
+      std::vector< double > sample( inputs.begin( ) + static_cast< long >( 4 * s ),
+                                    inputs.begin( ) + static_cast< long >( 4 * s + 4 ) );
+
+      double output = nettest::referenceForward( net, sample )[ 1 ];
+      bool   single = classifier.classify( sample, &singleStats );
+
+      // sums within rounding of the threshold may go either way
+      if ( std::abs( output - threshold ) > 1.0e-9 )
+      {
+
+        EXPECT_EQ( output > threshold, single );
+        EXPECT_EQ( output > threshold, above[ s ] != 0 );
+
+      }
+
+      numAbove += single ? 1u : 0u;
+
+    }
+
+    // both answers occur
+    EXPECT_GT( numAbove, 0u );
+    EXPECT_LT( numAbove, numSamples );
+
+    for ( const net::ThresholdStats &stats : { singleStats, batchStats } )
+    {
+
+      EXPECT_EQ( numSamples, stats.samples );
+      EXPECT_EQ( 12u * numSamples, stats.neuronsTotal );
+
+    }
+
+    // single samples stop early whatever the probe
+    EXPECT_GT( singleStats.decidedEarly,    numSamples / 2 );
+    EXPECT_LT( singleStats.neuronsComputed, singleStats.neuronsTotal / 2 );
+
+    // a batch skips whatever lies beyond the probe once decided
+    if ( classifier.getNumProbeNeurons( ) < 12 )
+    {
+
+      EXPECT_GT( batchStats.decidedEarly,    numSamples / 2 );
+      EXPECT_LT( batchStats.neuronsComputed, batchStats.neuronsTotal );
+
+    }
+    else
+    {
+
+      EXPECT_EQ( 0u,                        batchStats.decidedEarly );
+      EXPECT_EQ( batchStats.neuronsTotal, batchStats.neuronsComputed );
+
+    }
+
+  }
+
+}
+
+
+} // namespace
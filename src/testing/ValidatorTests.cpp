@@ -0,0 +1,218 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "ConnectedNet.hpp"
+#include "Validator.hpp"
+#include "TestNets.hpp"
+
+
+namespace
+{
+
+
+TEST( ValidatorTest, EvaluateMatchesReference )
+{
+
+  net::ConnectedNet::seedWeights( 21 );
+
+  net::ConnectedNet net( { 3, 8, 2 } );
+  unsigned          state = 21;
+
+  std::vector< std::vector< double > > inputs;
+  std::vector< std::vector< double > > targets;
+
+  for ( unsigned s = 0; s < 200; ++s )
+  {
+
+    inputs.push_back ( nettest::randomInputs( 3, &state ) );
+    targets.push_back( nettest::randomInputs( 2, &state ) );
+
+  }
+
+  //
+  // per sample RMS and argmax agreement, from the reference outputs
+  //
+  double   errorSum   = 0.0;
+  unsigned numCorrect = 0;
+
+  for ( size_t s = 0; s < inputs.size( ); ++s )
+  {
+
+    std::vector< double > results = nettest::referenceForward( net, inputs[ s ] );
+
+    double error = 0.0;
+
+    for ( size_t n = 0; n < 2; ++n )
+    {
+
+      error += ( targets[ s ][ n ] - results[ n ] ) * ( targets[ s ][ n ] - results[ n ] );
+
+    }
+
+    errorSum += std::sqrt( error / 2.0 );
+
+    if ( ( results[ 0 ] > results[ 1 ] ) == ( targets[ s ][ 0 ] > targets[ s ][ 1 ] ) )
+    {
+
+      ++numCorrect;
+
+    }
+
+  }
+
+  net::Validator         validator( inputs, targets, 100, 2 );
+  net::ValidationReport  report = validator.evaluate( net );
+
+  EXPECT_NEAR( errorSum / inputs.size( ), report.rmsError, 1.0e-12 );
+  EXPECT_DOUBLE_EQ( numCorrect * 1.0 / inputs.size( ), report.accuracy );
+
+}
+
+
+
+TEST( ValidatorTest, BackgroundAccuracyStopsTraining )
+{
+
+  net::ConnectedNet::seedWeights( 22 );
+
+  net::ConnectedNet net( { 2, 4, 1 } );
+
+  const std::vector< std::vector< double > > inputs  = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+  const std::vector< std::vector< double > > targets = { { 0 }, { 1 }, { 1 }, { 0 } };
+
+  net::Validator validator( inputs, targets, 500 );
+
+  std::atomic< unsigned > numReports( 0 );
+
+  validator.setStopAccuracy( 1.0 );
+  validator.setReportFunction( [ &numReports ]( const net::ValidationReport & ) { ++numReports; } );
+
+  unsigned sample = 0;
+
+  // an acceptable error of zero leaves the stopping to the validator
+  unsigned long iterations = net.trainNet(
+                                          [ & ]( ) { return inputs[ sample % 4 ]; },
+                                          [ & ]( ) { return targets[ sample++ % 4 ]; },
+                                          0.0,
+                                          0,
+                                          &validator,
+                                          2000000
+                                          );
+
+  validator.wait( );
+
+  net::ValidationReport report;
+
+  ASSERT_TRUE( validator.getLatestReport( &report ) );
+
+  EXPECT_TRUE( validator.shouldStop( ) );
+  EXPECT_LT  ( iterations, 2000000ul );
+  EXPECT_GE  ( numReports.load( ), 1u );
+  EXPECT_EQ  ( 0u, report.iteration % 500 );
+  EXPECT_LE  ( report.iteration, iterations );
+  EXPECT_DOUBLE_EQ( 1.0, report.accuracy );
+
+  // the trained net itself classifies every sample
+  EXPECT_DOUBLE_EQ( 1.0, validator.evaluate( net ).accuracy );
+
+}
+
+
+TEST( ValidatorTest, ReusedValidatorStartsEachRunAfresh )
+{
+
+  net::ConnectedNet::seedWeights( 23 );
+
+  net::ConnectedNet net( { 2, 4, 1 } );
+
+  const std::vector< std::vector< double > > inputs  = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+  const std::vector< std::vector< double > > targets = { { 0 }, { 1 }, { 1 }, { 0 } };
+
+  net::Validator validator( inputs, targets, 10, 1 );
+
+  // any report stops the first run
+  validator.setStopError( 10.0 );
+
+  unsigned sample = 0;
+
+  auto inputFun  = [ & ]( ) { return inputs[ sample % 4 ]; };
+  auto targetFun = [ & ]( ) { return targets[ sample++ % 4 ]; };
+
+  net.trainNet( inputFun, targetFun, 0.0, 0, &validator, 100000 );
+  validator.wait( );
+
+  ASSERT_TRUE( validator.shouldStop( ) );
+
+  // a second run must not see the first run's stop
+  validator.setStopError( -1.0 );
+
+  EXPECT_EQ( 5ul, net.trainNet( inputFun, targetFun, 0.0, 0, &validator, 5 ) );
+  EXPECT_FALSE( validator.shouldStop( ) );
+
+  net::ValidationReport report;
+  EXPECT_FALSE( validator.getLatestReport( &report ) );
+
+}
+
+
+
+TEST( ValidatorTest, BackgroundExceptionReachesWait )
+{
+
+  net::ConnectedNet::seedWeights( 24 );
+
+  net::ConnectedNet net( { 2, 4, 1 } );
+
+  const std::vector< std::vector< double > > inputs  = { { 0, 0 }, { 1, 1 } };
+  const std::vector< std::vector< double > > targets = { { 0 }, { 1 } };
+
+  net::Validator validator( inputs, targets, 10, 1 );
+
+  validator.setReportFunction( []( const net::ValidationReport & )
+                              {
+
+                                throw std::runtime_error( "report failed" );
+
+                              } );
+
+  unsigned long iterations = 0;
+  bool          thrown     = false;
+
+  // the error stops training and is rethrown by whichever call joins
+  // the thread first (the next snapshot's or wait)
+  try
+  {
+
+    iterations = net.trainNet(
+                              [ & ]( ) { return inputs[ 0 ]; },
+                              [ & ]( ) { return targets[ 0 ]; },
+                              0.0,
+                              0,
+                              &validator,
+                              1000000
+                              );
+
+    validator.wait( );
+
+  }
+  catch ( const std::runtime_error & )
+  {
+
+    thrown = true;
+
+  }
+
+  EXPECT_TRUE( thrown );
+  EXPECT_LT  ( iterations, 1000000ul );
+
+  // once delivered it is cleared
+  EXPECT_NO_THROW( validator.wait( ) );
+
+}
+
+
+} // namespace